@@ -0,0 +1,193 @@
+// AFChunkedUploader.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+#import "AFURLSessionManager.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AFChunkedUploadTask;
+
+/**
+ The ways in which `AFChunkedUploader` splits files into parts.
+
+ - `AFChunkedUploadFixedSizeChunking`: Every part but the last is `partSize` bytes long.
+ - `AFChunkedUploadContentDefinedChunking`: Part boundaries are chosen by a rolling hash of the contents of the file, so that they move along with the data when bytes are inserted or removed. Parts average `partSize` bytes, and are between a quarter and eight times as long. Each part is identified by its SHA-256 hash, and parts the server already has are not uploaded again.
+ */
+typedef NS_ENUM(NSUInteger, AFChunkedUploadChunking) {
+    AFChunkedUploadFixedSizeChunking = 0,
+    AFChunkedUploadContentDefinedChunking,
+};
+
+/**
+ `AFChunkedUploader` uploads large files in fixed-size parts, several at once, using the tasks of an `AFURLSessionManager`. A stalled or failed part is retried on its own, rather than restarting the whole transfer, and the parts are spread over several connections.
+
+ ## Upload Protocol
+
+ By default, part `n` of an upload, counting from `1`, is sent as `PUT <URL>?uploadId=<upload identifier>&partNumber=<n>`, with a `Content-Range: bytes <first>-<last>/<total>` header. Once every part has been uploaded, the upload is committed with `POST <URL>?uploadId=<upload identifier>`, whose JSON body lists the parts in order together with the `ETag` the server returned for each one:
+
+    {"uploadId": "…", "parts": [{"partNumber": 1, "etag": "…"}, …]}
+
+ The response to the commit request is serialized by the response serializer of the session manager, and passed to the completion handler of the upload. Use `partRequestBlock`, `commitRequestBlock` and `missingPartsRequestBlock` to talk to services with a different protocol.
+
+ ## Deduplication
+
+ With `AFChunkedUploadContentDefinedChunking`, the uploader first asks the server which parts it is missing, with `POST <URL>?uploadId=<upload identifier>&missing`, whose JSON body lists the lowercase hexadecimal SHA-256 hash of every part as `{"hashes": […]}`. The server responds with the hashes it does not have yet as `{"missing": […]}`, which requires a session manager with a JSON response serializer. If the request fails, every part is uploaded. Otherwise only the missing parts are uploaded, with an additional `hash=<hash>` query parameter, and every part in the commit request carries a `hash` as well. Since content-defined boundaries only change around an edit, uploading a new version of a file only sends the parts touching what changed.
+
+ ## Resuming Uploads
+
+ The parts of an upload that have been accepted by the server are recorded in `stateDirectoryURL`, keyed by the upload identifier. Starting an upload with the same identifier, for the same file, unmodified since, skips the recorded parts, so an upload interrupted by a failure, by cancellation, or by the termination of the process resumes where it left off. The record is removed once the upload has been committed.
+ */
+@interface AFChunkedUploader : NSObject
+
+/**
+ The session manager whose upload and data tasks transfer the parts and commit the upload.
+ */
+@property (readonly, nonatomic, strong) AFURLSessionManager *sessionManager;
+
+/**
+ The way in which files are split into parts. `AFChunkedUploadFixedSizeChunking` by default.
+ */
+@property (nonatomic, assign) AFChunkedUploadChunking chunking;
+
+/**
+ The size of each part, in bytes, or the average size of parts with content-defined chunking. The last part of a file may be smaller. `8 MB` by default.
+ */
+@property (nonatomic, assign) unsigned long long partSize;
+
+/**
+ The maximum number of parts of an upload that are transferred at the same time. `4` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfConcurrentParts;
+
+/**
+ The number of times a part is retried after it fails, before the upload fails. `3` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfRetriesPerPart;
+
+/**
+ The delay before the first retry of a failed part, which is doubled for each further retry of the same part. `1` second by default.
+ */
+@property (nonatomic, assign) NSTimeInterval retryInterval;
+
+/**
+ The directory in which the progress of uploads is recorded. By default, a directory in the caches directory of the application.
+ */
+@property (nonatomic, strong) NSURL *stateDirectoryURL;
+
+/**
+ A block returning the request for a part of an upload, or `nil` to use the default protocol. The body of the part is supplied by the uploader. With content-defined chunking, `hash` is the lowercase hexadecimal SHA-256 hash of the part, and `nil` otherwise.
+ */
+@property (nonatomic, copy, nullable) NSURLRequest * (^partRequestBlock)(NSURL *URL, NSString *uploadIdentifier, NSUInteger partNumber, unsigned long long offset, unsigned long long length, unsigned long long totalLength, NSString * _Nullable hash);
+
+/**
+ A block returning the request committing an upload, given the part numbers and `ETag` values of its parts, or `nil` to use the default protocol.
+ */
+@property (nonatomic, copy, nullable) NSURLRequest * (^commitRequestBlock)(NSURL *URL, NSString *uploadIdentifier, NSArray <NSDictionary <NSString *, id> *> *parts);
+
+/**
+ A block returning the request asking the server which of the specified part hashes it is missing, or `nil` to use the default protocol. Only used with content-defined chunking. The response must still be serialized as `{"missing": […]}`; any other response, or a failed request, uploads every part.
+ */
+@property (nonatomic, copy, nullable) NSURLRequest * (^missingPartsRequestBlock)(NSURL *URL, NSString *uploadIdentifier, NSArray <NSString *> *hashes);
+
+/**
+ Initializes an uploader transferring parts with the specified session manager.
+
+ @param sessionManager The session manager. This parameter must not be `nil`.
+ */
+- (instancetype)initWithSessionManager:(AFURLSessionManager *)sessionManager NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Creates an upload of the specified file. The upload starts when it is resumed.
+
+ @param fileURL The URL of the file to upload.
+ @param URL The URL of the upload resource, to which the parts and the commit request are sent.
+ @param uploadIdentifier A string identifying the upload with the server, and under which its progress is recorded. Reuse the identifier to resume an interrupted upload.
+ @param uploadProgressBlock A block object to be executed as parts are transferred. Note this block is called on a private queue, not the main queue.
+ @param completionHandler A block object to be executed when the upload has been committed, or has failed. It is called on the `completionQueue` of the session manager, or the main queue.
+ */
+- (AFChunkedUploadTask *)uploadTaskWithFileURL:(NSURL *)fileURL
+                                         toURL:(NSURL *)URL
+                              uploadIdentifier:(NSString *)uploadIdentifier
+                                      progress:(nullable void (^)(NSProgress *uploadProgress))uploadProgressBlock
+                             completionHandler:(nullable void (^)(NSURLResponse * _Nullable response, id _Nullable responseObject, NSError * _Nullable error))completionHandler;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFChunkedUploadTask` is a single upload created by an `AFChunkedUploader`.
+ */
+@interface AFChunkedUploadTask : NSObject
+
+/**
+ The identifier of the upload.
+ */
+@property (readonly, nonatomic, copy) NSString *uploadIdentifier;
+
+/**
+ The URL of the file being uploaded.
+ */
+@property (readonly, nonatomic, copy) NSURL *fileURL;
+
+/**
+ The number of parts of the file, known once the task has been resumed.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfParts;
+
+/**
+ The number of parts that were not sent again, because they had been uploaded before the task was resumed.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfResumedParts;
+
+/**
+ The number of parts that were not sent, because the server already had a part with the same contents.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfDeduplicatedParts;
+
+/**
+ The number of bytes in parts that were not sent, because the server already had them.
+ */
+@property (readonly, atomic, assign) unsigned long long numberOfDeduplicatedBytes;
+
+/**
+ The progress of the upload, in bytes. Cancelling the progress cancels the upload.
+ */
+@property (readonly, nonatomic, strong) NSProgress *progress;
+
+/**
+ Starts the upload, skipping any parts recorded as uploaded earlier.
+ */
+- (void)resume;
+
+/**
+ Cancels the parts being transferred. The parts already uploaded remain recorded, so that the upload can be resumed later.
+ */
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
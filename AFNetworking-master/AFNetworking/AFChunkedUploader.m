@@ -0,0 +1,665 @@
+// AFChunkedUploader.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "AFChunkedUploader.h"
+
+#import <CommonCrypto/CommonDigest.h>
+
+static NSString * const AFChunkedUploadStateURLKey = @"URL";
+static NSString * const AFChunkedUploadStateFileSizeKey = @"fileSize";
+static NSString * const AFChunkedUploadStateFileModificationDateKey = @"fileModificationDate";
+static NSString * const AFChunkedUploadStatePartSizeKey = @"partSize";
+static NSString * const AFChunkedUploadStateChunkingKey = @"chunking";
+static NSString * const AFChunkedUploadStatePartsKey = @"parts";
+
+static NSURL * AFURLByAppendingQueryItems(NSURL *URL, NSArray <NSURLQueryItem *> *queryItems) {
+    NSURLComponents *components = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:YES];
+    components.queryItems = [(components.queryItems ?: @[]) arrayByAddingObjectsFromArray:queryItems];
+
+    return components.URL;
+}
+
+#pragma mark -
+
+static uint64_t AFGearTable[256];
+
+static void AFInitializeGearTable(void) {
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        // The table must be the same everywhere, so that the same contents are always split the same way
+        uint64_t state = 0x9E3779B97F4A7C15ULL;
+        for (NSUInteger idx = 0; idx < 256; idx++) {
+            uint64_t value = (state += 0x9E3779B97F4A7C15ULL);
+            value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+            AFGearTable[idx] = value ^ (value >> 31);
+        }
+    });
+}
+
+// Finds the end of the chunk starting at `bytes` using a gear rolling hash, with a stricter mask before the average length than after it, which keeps chunk lengths close to the average
+static NSUInteger AFContentDefinedChunkLength(const uint8_t *bytes, NSUInteger length, NSUInteger averageLength) {
+    NSUInteger minimumLength = averageLength / 4;
+    NSUInteger maximumLength = MIN(length, averageLength * 8);
+    if (length <= minimumLength) {
+        return length;
+    }
+
+    NSUInteger numberOfBits = 0;
+    while (((NSUInteger)1 << (numberOfBits + 1)) <= averageLength) {
+        numberOfBits++;
+    }
+
+    // The high bits of the hash depend on the most bytes, so the masks select those
+    uint64_t strictMask = ~0ULL << (64 - MIN(numberOfBits + 1, (NSUInteger)63));
+    uint64_t looseMask = ~0ULL << (64 - MAX(numberOfBits, (NSUInteger)2) + 1);
+
+    uint64_t fingerprint = 0;
+    NSUInteger idx = minimumLength;
+    for (NSUInteger normalLength = MIN(maximumLength, averageLength); idx < normalLength; idx++) {
+        fingerprint = (fingerprint << 1) + AFGearTable[bytes[idx]];
+        if (!(fingerprint & strictMask)) {
+            return idx + 1;
+        }
+    }
+
+    for (; idx < maximumLength; idx++) {
+        fingerprint = (fingerprint << 1) + AFGearTable[bytes[idx]];
+        if (!(fingerprint & looseMask)) {
+            return idx + 1;
+        }
+    }
+
+    return maximumLength;
+}
+
+static NSArray <NSValue *> * AFPartRangesOfData(NSData *data, unsigned long long partSize, AFChunkedUploadChunking chunking) {
+    NSMutableArray *ranges = [NSMutableArray array];
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSUInteger averageLength = (NSUInteger)MIN(MAX(partSize, 64ULL), (unsigned long long)NSUIntegerMax / 8);
+
+    if (chunking == AFChunkedUploadContentDefinedChunking) {
+        AFInitializeGearTable();
+    }
+
+    for (NSUInteger offset = 0; offset < length;) {
+        NSUInteger partLength = 0;
+        if (chunking == AFChunkedUploadContentDefinedChunking) {
+            partLength = AFContentDefinedChunkLength(bytes + offset, length - offset, averageLength);
+        } else {
+            partLength = (NSUInteger)MIN(partSize, (unsigned long long)(length - offset));
+        }
+
+        [ranges addObject:[NSValue valueWithRange:NSMakeRange(offset, partLength)]];
+        offset += partLength;
+    }
+
+    return ranges;
+}
+
+static NSString * AFSHA256HashOfBytes(const void *bytes, NSUInteger length) {
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256(bytes, (CC_LONG)length, digest);
+
+    NSMutableString *hash = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSUInteger idx = 0; idx < CC_SHA256_DIGEST_LENGTH; idx++) {
+        [hash appendFormat:@"%02x", digest[idx]];
+    }
+
+    return hash;
+}
+
+#pragma mark -
+
+@interface AFChunkedUploadTask ()
+@property (readwrite, nonatomic, copy) NSString *uploadIdentifier;
+@property (readwrite, nonatomic, copy) NSURL *fileURL;
+@property (readwrite, nonatomic, copy) NSURL *URL;
+@property (readwrite, atomic, assign) NSUInteger numberOfParts;
+@property (readwrite, atomic, assign) NSUInteger numberOfResumedParts;
+@property (readwrite, atomic, assign) NSUInteger numberOfDeduplicatedParts;
+@property (readwrite, atomic, assign) unsigned long long numberOfDeduplicatedBytes;
+@property (readwrite, nonatomic, strong) NSProgress *progress;
+
+@property (readwrite, nonatomic, strong) AFChunkedUploader *uploader;
+@property (readwrite, nonatomic, assign) unsigned long long partSize;
+@property (readwrite, nonatomic, assign) AFChunkedUploadChunking chunking;
+@property (readwrite, nonatomic, strong) dispatch_queue_t queue;
+@property (readwrite, nonatomic, copy) void (^uploadProgressBlock)(NSProgress *uploadProgress);
+@property (readwrite, nonatomic, copy) void (^completionHandler)(NSURLResponse *response, id responseObject, NSError *error);
+
+@property (readwrite, nonatomic, strong) NSData *fileData;
+@property (readwrite, nonatomic, strong) NSDictionary *fileValidators;
+@property (readwrite, nonatomic, copy) NSArray <NSValue *> *partRanges;
+@property (readwrite, nonatomic, copy) NSArray <NSString *> *partHashes;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSNumber *, NSString *> *completedParts;
+@property (readwrite, nonatomic, strong) NSMutableIndexSet *pendingParts;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSNumber *, NSURLSessionTask *> *runningTasks;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSNumber *, NSNumber *> *numberOfBytesSentByRunningPart;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSNumber *, NSNumber *> *numberOfFailuresByPart;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *missingPartsTask;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *commitTask;
+@property (readwrite, nonatomic, assign, getter = isResumed) BOOL resumed;
+@property (readwrite, nonatomic, assign, getter = isFinished) BOOL finished;
+
+- (instancetype)initWithUploader:(AFChunkedUploader *)uploader
+                         fileURL:(NSURL *)fileURL
+                             URL:(NSURL *)URL
+                uploadIdentifier:(NSString *)uploadIdentifier;
+@end
+
+#pragma mark -
+
+@interface AFChunkedUploader ()
+@property (readwrite, nonatomic, strong) AFURLSessionManager *sessionManager;
+@end
+
+@implementation AFChunkedUploader
+
+- (instancetype)initWithSessionManager:(AFURLSessionManager *)sessionManager {
+    NSParameterAssert(sessionManager);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.sessionManager = sessionManager;
+    self.partSize = 1024 * 1024 * 8;
+    self.maximumNumberOfConcurrentParts = 4;
+    self.maximumNumberOfRetriesPerPart = 3;
+    self.retryInterval = 1.0;
+
+    NSURL *cachesDirectoryURL = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+    self.stateDirectoryURL = [cachesDirectoryURL URLByAppendingPathComponent:@"com.alamofire.networking.chunked-uploads" isDirectory:YES];
+
+    return self;
+}
+
+- (AFChunkedUploadTask *)uploadTaskWithFileURL:(NSURL *)fileURL
+                                         toURL:(NSURL *)URL
+                              uploadIdentifier:(NSString *)uploadIdentifier
+                                      progress:(void (^)(NSProgress *uploadProgress))uploadProgressBlock
+                             completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
+{
+    NSParameterAssert([fileURL isFileURL]);
+    NSParameterAssert(URL);
+    NSParameterAssert([uploadIdentifier length] > 0);
+
+    AFChunkedUploadTask *task = [[AFChunkedUploadTask alloc] initWithUploader:self fileURL:fileURL URL:URL uploadIdentifier:uploadIdentifier];
+    task.uploadProgressBlock = uploadProgressBlock;
+    task.completionHandler = completionHandler;
+
+    return task;
+}
+
+#pragma mark -
+
+- (NSURLRequest *)requestForPartNumber:(NSUInteger)partNumber
+                                offset:(unsigned long long)offset
+                                length:(unsigned long long)length
+                           totalLength:(unsigned long long)totalLength
+                                  hash:(NSString *)hash
+                                 ofURL:(NSURL *)URL
+                      uploadIdentifier:(NSString *)uploadIdentifier
+{
+    if (self.partRequestBlock) {
+        return self.partRequestBlock(URL, uploadIdentifier, partNumber, offset, length, totalLength, hash);
+    }
+
+    NSMutableArray *queryItems = [NSMutableArray arrayWithObjects:[NSURLQueryItem queryItemWithName:@"uploadId" value:uploadIdentifier], [NSURLQueryItem queryItemWithName:@"partNumber" value:[NSString stringWithFormat:@"%lu", (unsigned long)partNumber]], nil];
+    if (hash) {
+        [queryItems addObject:[NSURLQueryItem queryItemWithName:@"hash" value:hash]];
+    }
+    NSURL *partURL = AFURLByAppendingQueryItems(URL, queryItems);
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:partURL];
+    request.HTTPMethod = @"PUT";
+    [request setValue:@"application/octet-stream" forHTTPHeaderField:@"Content-Type"];
+    [request setValue:[NSString stringWithFormat:@"bytes %llu-%llu/%llu", offset, offset + length - 1, totalLength] forHTTPHeaderField:@"Content-Range"];
+
+    return request;
+}
+
+- (NSURLRequest *)commitRequestForParts:(NSArray <NSDictionary <NSString *, id> *> *)parts
+                                  ofURL:(NSURL *)URL
+                       uploadIdentifier:(NSString *)uploadIdentifier
+{
+    if (self.commitRequestBlock) {
+        return self.commitRequestBlock(URL, uploadIdentifier, parts);
+    }
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:AFURLByAppendingQueryItems(URL, @[[NSURLQueryItem queryItemWithName:@"uploadId" value:uploadIdentifier]])];
+    request.HTTPMethod = @"POST";
+    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+    request.HTTPBody = [NSJSONSerialization dataWithJSONObject:@{@"uploadId": uploadIdentifier, @"parts": parts} options:(NSJSONWritingOptions)0 error:nil];
+
+    return request;
+}
+
+- (NSURLRequest *)missingPartsRequestForHashes:(NSArray <NSString *> *)hashes
+                                          ofURL:(NSURL *)URL
+                               uploadIdentifier:(NSString *)uploadIdentifier
+{
+    if (self.missingPartsRequestBlock) {
+        return self.missingPartsRequestBlock(URL, uploadIdentifier, hashes);
+    }
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:AFURLByAppendingQueryItems(URL, @[[NSURLQueryItem queryItemWithName:@"uploadId" value:uploadIdentifier], [NSURLQueryItem queryItemWithName:@"missing" value:nil]])];
+    request.HTTPMethod = @"POST";
+    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+    request.HTTPBody = [NSJSONSerialization dataWithJSONObject:@{@"hashes": hashes} options:(NSJSONWritingOptions)0 error:nil];
+
+    return request;
+}
+
+- (NSURL *)stateURLForUploadIdentifier:(NSString *)uploadIdentifier {
+    NSString *fileName = [uploadIdentifier stringByAddingPercentEncodingWithAllowedCharacters:[NSCharacterSet alphanumericCharacterSet]];
+
+    return [self.stateDirectoryURL URLByAppendingPathComponent:[fileName stringByAppendingPathExtension:@"plist"]];
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFChunkedUploadTask
+
+- (instancetype)initWithUploader:(AFChunkedUploader *)uploader
+                         fileURL:(NSURL *)fileURL
+                             URL:(NSURL *)URL
+                uploadIdentifier:(NSString *)uploadIdentifier
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.uploader = uploader;
+    self.fileURL = fileURL;
+    self.URL = URL;
+    self.uploadIdentifier = uploadIdentifier;
+    self.partSize = MAX(uploader.partSize, 1ULL);
+    self.chunking = uploader.chunking;
+    self.queue = dispatch_queue_create("com.alamofire.networking.chunked-upload", DISPATCH_QUEUE_SERIAL);
+
+    self.completedParts = [NSMutableDictionary dictionary];
+    self.pendingParts = [NSMutableIndexSet indexSet];
+    self.runningTasks = [NSMutableDictionary dictionary];
+    self.numberOfBytesSentByRunningPart = [NSMutableDictionary dictionary];
+    self.numberOfFailuresByPart = [NSMutableDictionary dictionary];
+
+    self.progress = [[NSProgress alloc] initWithParent:nil userInfo:nil];
+    self.progress.totalUnitCount = NSURLSessionTransferSizeUnknown;
+    self.progress.cancellable = YES;
+    __weak __typeof__(self) weakSelf = self;
+    self.progress.cancellationHandler = ^{
+        [weakSelf cancel];
+    };
+
+    return self;
+}
+
+- (void)resume {
+    dispatch_async(self.queue, ^{
+        if ([self isResumed] || [self isFinished]) {
+            return;
+        }
+        self.resumed = YES;
+
+        NSError *error = nil;
+        if (![self loadFile:&error]) {
+            [self finishWithResponse:nil responseObject:nil error:error];
+            return;
+        }
+
+        [self loadState];
+        [self updateProgress];
+
+        if (self.chunking == AFChunkedUploadContentDefinedChunking) {
+            [self skipPartsKnownToServer];
+        } else {
+            [self startPendingParts];
+        }
+    });
+}
+
+- (void)cancel {
+    dispatch_async(self.queue, ^{
+        if ([self isFinished]) {
+            return;
+        }
+
+        for (NSURLSessionTask *task in [self.runningTasks allValues]) {
+            [task cancel];
+        }
+        [self.missingPartsTask cancel];
+        [self.commitTask cancel];
+
+        [self finishWithResponse:nil responseObject:nil error:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+    });
+}
+
+#pragma mark -
+
+- (BOOL)loadFile:(NSError * __autoreleasing *)error {
+    NSDictionary *resourceValues = [self.fileURL resourceValuesForKeys:@[NSURLFileSizeKey, NSURLContentModificationDateKey] error:error];
+    if (!resourceValues) {
+        return NO;
+    }
+
+    // Parts are sliced out of the mapped file, so no part is ever copied into memory as a whole
+    self.fileData = [NSData dataWithContentsOfURL:self.fileURL options:NSDataReadingMappedIfSafe error:error];
+    if (!self.fileData) {
+        return NO;
+    }
+
+    unsigned long long fileLength = [self.fileData length];
+    self.fileValidators = @{
+        AFChunkedUploadStateURLKey: [self.URL absoluteString],
+        AFChunkedUploadStateFileSizeKey: @(fileLength),
+        AFChunkedUploadStateFileModificationDateKey: @([resourceValues[NSURLContentModificationDateKey] timeIntervalSince1970]),
+        AFChunkedUploadStatePartSizeKey: @(self.partSize),
+        AFChunkedUploadStateChunkingKey: @(self.chunking),
+    };
+
+    self.partRanges = AFPartRangesOfData(self.fileData, self.partSize, self.chunking);
+    self.numberOfParts = [self.partRanges count];
+
+    if (self.chunking == AFChunkedUploadContentDefinedChunking) {
+        NSMutableArray *partHashes = [NSMutableArray arrayWithCapacity:self.numberOfParts];
+        for (NSValue *partRange in self.partRanges) {
+            [partHashes addObject:AFSHA256HashOfBytes((const uint8_t *)[self.fileData bytes] + [partRange rangeValue].location, [partRange rangeValue].length)];
+        }
+        self.partHashes = partHashes;
+    }
+    [self.pendingParts addIndexesInRange:NSMakeRange(1, self.numberOfParts)];
+    self.progress.totalUnitCount = (int64_t)fileLength;
+
+    return YES;
+}
+
+- (unsigned long long)offsetOfPart:(NSUInteger)partNumber {
+    return [self.partRanges[partNumber - 1] rangeValue].location;
+}
+
+- (unsigned long long)lengthOfPart:(NSUInteger)partNumber {
+    return [self.partRanges[partNumber - 1] rangeValue].length;
+}
+
+- (NSString *)hashOfPart:(NSUInteger)partNumber {
+    return self.partHashes[partNumber - 1];
+}
+
+#pragma mark - State
+
+- (void)loadState {
+    NSData *data = [NSData dataWithContentsOfURL:[self.uploader stateURLForUploadIdentifier:self.uploadIdentifier]];
+    NSDictionary *state = data ? [NSPropertyListSerialization propertyListWithData:data options:NSPropertyListImmutable format:NULL error:nil] : nil;
+    if (![state isKindOfClass:[NSDictionary class]]) {
+        return;
+    }
+
+    // Recorded parts are only valid for the same file and destination, sliced the same way
+    for (NSString *key in self.fileValidators) {
+        if (![state[key] isEqual:self.fileValidators[key]]) {
+            return;
+        }
+    }
+
+    NSDictionary *parts = state[AFChunkedUploadStatePartsKey];
+    for (NSString *partNumberString in parts) {
+        NSUInteger partNumber = (NSUInteger)[partNumberString integerValue];
+        if (partNumber >= 1 && partNumber <= self.numberOfParts && [parts[partNumberString] isKindOfClass:[NSString class]]) {
+            self.completedParts[@(partNumber)] = parts[partNumberString];
+            [self.pendingParts removeIndex:partNumber];
+        }
+    }
+
+    self.numberOfResumedParts = [self.completedParts count];
+}
+
+- (void)saveState {
+    NSMutableDictionary *parts = [NSMutableDictionary dictionaryWithCapacity:[self.completedParts count]];
+    [self.completedParts enumerateKeysAndObjectsUsingBlock:^(NSNumber *partNumber, NSString *ETag, __unused BOOL *stop) {
+        parts[[partNumber stringValue]] = ETag;
+    }];
+
+    NSMutableDictionary *state = [self.fileValidators mutableCopy];
+    state[AFChunkedUploadStatePartsKey] = parts;
+
+    NSData *data = [NSPropertyListSerialization dataWithPropertyList:state format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    [[NSFileManager defaultManager] createDirectoryAtURL:self.uploader.stateDirectoryURL withIntermediateDirectories:YES attributes:nil error:nil];
+    [data writeToURL:[self.uploader stateURLForUploadIdentifier:self.uploadIdentifier] atomically:YES];
+}
+
+- (void)removeState {
+    [[NSFileManager defaultManager] removeItemAtURL:[self.uploader stateURLForUploadIdentifier:self.uploadIdentifier] error:nil];
+}
+
+#pragma mark - Parts
+
+- (void)skipPartsKnownToServer {
+    NSMutableArray *hashes = [NSMutableArray arrayWithCapacity:[self.pendingParts count]];
+    [self.pendingParts enumerateIndexesUsingBlock:^(NSUInteger partNumber, __unused BOOL *stop) {
+        [hashes addObject:[self hashOfPart:partNumber]];
+    }];
+
+    if ([hashes count] == 0) {
+        [self startPendingParts];
+        return;
+    }
+
+    NSURLRequest *request = [self.uploader missingPartsRequestForHashes:hashes ofURL:self.URL uploadIdentifier:self.uploadIdentifier];
+    self.missingPartsTask = [self.uploader.sessionManager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            if ([self isFinished]) {
+                return;
+            }
+
+            // Without a usable answer, including a failed request, every part is treated as missing
+            NSArray *missingHashes = (!error && [responseObject isKindOfClass:[NSDictionary class]]) ? responseObject[@"missing"] : nil;
+            if ([missingHashes isKindOfClass:[NSArray class]]) {
+                NSSet *missingHashSet = [NSSet setWithArray:missingHashes];
+                NSIndexSet *knownParts = [self.pendingParts indexesPassingTest:^BOOL(NSUInteger partNumber, __unused BOOL *stop) {
+                    return ![missingHashSet containsObject:[self hashOfPart:partNumber]];
+                }];
+
+                [knownParts enumerateIndexesUsingBlock:^(NSUInteger partNumber, __unused BOOL *stop) {
+                    self.completedParts[@(partNumber)] = @"";
+                    self.numberOfDeduplicatedBytes += [self lengthOfPart:partNumber];
+                }];
+                self.numberOfDeduplicatedParts += [knownParts count];
+                [self.pendingParts removeIndexes:knownParts];
+
+                [self saveState];
+                [self updateProgress];
+            }
+
+            [self startPendingParts];
+        });
+    }];
+    [self.missingPartsTask resume];
+}
+
+- (void)startPendingParts {
+    if ([self isFinished]) {
+        return;
+    }
+
+    NSUInteger maximumNumberOfConcurrentParts = MAX(self.uploader.maximumNumberOfConcurrentParts, (NSUInteger)1);
+    while ([self.runningTasks count] < maximumNumberOfConcurrentParts && [self.pendingParts count] > 0) {
+        NSUInteger partNumber = [self.pendingParts firstIndex];
+        [self.pendingParts removeIndex:partNumber];
+        [self startPart:partNumber];
+    }
+
+    if ([self.runningTasks count] == 0 && [self.completedParts count] == self.numberOfParts && !self.commitTask) {
+        [self commit];
+    }
+}
+
+- (void)startPart:(NSUInteger)partNumber {
+    unsigned long long offset = [self offsetOfPart:partNumber];
+    unsigned long long length = [self lengthOfPart:partNumber];
+
+    // The part borrows the bytes of the mapped file, which it keeps alive until it is released
+    NSData *fileData = self.fileData;
+    NSData *partData = [[NSData alloc] initWithBytesNoCopy:(uint8_t *)[fileData bytes] + offset length:(NSUInteger)length deallocator:^(__unused void *bytes, __unused NSUInteger length) {
+        (void)fileData;
+    }];
+
+    NSString *hash = self.partHashes ? [self hashOfPart:partNumber] : nil;
+    NSURLRequest *request = [self.uploader requestForPartNumber:partNumber offset:offset length:length totalLength:[fileData length] hash:hash ofURL:self.URL uploadIdentifier:self.uploadIdentifier];
+
+    // The session manager holds on to these blocks until the part completes, which keeps the upload alive while it is running
+    NSURLSessionUploadTask *task = [self.uploader.sessionManager uploadTaskWithRequest:request fromData:partData progress:^(NSProgress * _Nonnull uploadProgress) {
+        int64_t completedUnitCount = uploadProgress.completedUnitCount;
+        dispatch_async(self.queue, ^{
+            if (self.runningTasks[@(partNumber)]) {
+                self.numberOfBytesSentByRunningPart[@(partNumber)] = @(completedUnitCount);
+                [self updateProgress];
+            }
+        });
+    } completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            [self part:partNumber didCompleteWithResponse:response error:error];
+        });
+    }];
+
+    self.runningTasks[@(partNumber)] = task;
+    [task resume];
+}
+
+- (void)part:(NSUInteger)partNumber
+didCompleteWithResponse:(NSURLResponse *)response
+       error:(NSError *)error
+{
+    [self.runningTasks removeObjectForKey:@(partNumber)];
+    [self.numberOfBytesSentByRunningPart removeObjectForKey:@(partNumber)];
+
+    if ([self isFinished]) {
+        return;
+    }
+
+    if (error) {
+        NSUInteger numberOfFailures = [self.numberOfFailuresByPart[@(partNumber)] unsignedIntegerValue] + 1;
+        self.numberOfFailuresByPart[@(partNumber)] = @(numberOfFailures);
+
+        if (numberOfFailures > self.uploader.maximumNumberOfRetriesPerPart) {
+            for (NSURLSessionTask *task in [self.runningTasks allValues]) {
+                [task cancel];
+            }
+
+            [self finishWithResponse:response responseObject:nil error:error];
+            return;
+        }
+
+        NSTimeInterval delay = self.uploader.retryInterval * pow(2.0, (double)(numberOfFailures - 1));
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.queue, ^{
+            [self.pendingParts addIndex:partNumber];
+            [self startPendingParts];
+        });
+        [self updateProgress];
+
+        return;
+    }
+
+    NSString *ETag = nil;
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        ETag = [(NSHTTPURLResponse *)response allHeaderFields][@"ETag"];
+    }
+
+    self.completedParts[@(partNumber)] = ETag ?: @"";
+    [self saveState];
+    [self updateProgress];
+    [self startPendingParts];
+}
+
+- (void)updateProgress {
+    unsigned long long completedUnitCount = 0;
+    for (NSNumber *partNumber in self.completedParts) {
+        completedUnitCount += [self lengthOfPart:[partNumber unsignedIntegerValue]];
+    }
+
+    for (NSNumber *numberOfBytesSent in [self.numberOfBytesSentByRunningPart allValues]) {
+        completedUnitCount += [numberOfBytesSent unsignedLongLongValue];
+    }
+
+    self.progress.completedUnitCount = (int64_t)completedUnitCount;
+
+    if (self.uploadProgressBlock) {
+        self.uploadProgressBlock(self.progress);
+    }
+}
+
+#pragma mark - Commit
+
+- (void)commit {
+    NSMutableArray *parts = [NSMutableArray arrayWithCapacity:self.numberOfParts];
+    for (NSUInteger partNumber = 1; partNumber <= self.numberOfParts; partNumber++) {
+        NSMutableDictionary *part = [NSMutableDictionary dictionaryWithObjectsAndKeys:@(partNumber), @"partNumber", self.completedParts[@(partNumber)], @"etag", nil];
+        if (self.partHashes) {
+            part[@"hash"] = [self hashOfPart:partNumber];
+        }
+        [parts addObject:part];
+    }
+
+    NSURLRequest *request = [self.uploader commitRequestForParts:parts ofURL:self.URL uploadIdentifier:self.uploadIdentifier];
+
+    self.commitTask = [self.uploader.sessionManager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            if ([self isFinished]) {
+                return;
+            }
+
+            // A failed commit keeps the record of the parts, so resuming the upload commits it again without resending them
+            if (!error) {
+                [self removeState];
+            }
+
+            [self finishWithResponse:response responseObject:responseObject error:error];
+        });
+    }];
+    [self.commitTask resume];
+}
+
+- (void)finishWithResponse:(NSURLResponse *)response
+            responseObject:(id)responseObject
+                     error:(NSError *)error
+{
+    self.finished = YES;
+    self.fileData = nil;
+
+    void (^completionHandler)(NSURLResponse *, id, NSError *) = self.completionHandler;
+    self.completionHandler = nil;
+    self.uploadProgressBlock = nil;
+
+    if (completionHandler) {
+        dispatch_async(self.uploader.sessionManager.completionQueue ?: dispatch_get_main_queue(), ^{
+            completionHandler(response, responseObject, error);
+        });
+    }
+}
+
+@end
@@ -0,0 +1,90 @@
+// AFCompletionCoalescer.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ `AFCompletionCoalescer` delivers blocks enqueued from any thread on a single queue, a batch at a time. When many tasks finish together, their completion handlers are run by a few drains of the queue rather than by one dispatch each, so the main thread wakes up once per run loop iteration instead of once per task.
+
+ Blocks are run in the order they were enqueued. The first block enqueued while no drain is scheduled schedules one; every block enqueued before the drain runs is delivered by it, up to `maximumNumberOfBlocksPerDrain`. Remaining blocks are left to a later drain, so that other work on the queue, such as touch handling on the main queue, is not held back by a large batch.
+
+ Coalescers are opt-in: set one as the `completionCoalescer` of an `AFURLSessionManager` or of an `AFImageDownloader`. A coalescer can be shared by several of them.
+ */
+@interface AFCompletionCoalescer : NSObject
+
+/**
+ The queue blocks are delivered on.
+ */
+@property (readonly, nonatomic, strong) dispatch_queue_t queue;
+
+/**
+ The maximum number of blocks run by a single drain, or `0` for no limit. `64` by default.
+ */
+@property (atomic, assign) NSUInteger maximumNumberOfBlocksPerDrain;
+
+/**
+ The minimum interval between the start of two drains, such as `1.0 / 60.0` to deliver at most once per display frame. Blocks enqueued in the meantime wait for the next drain. `0` by default, in which case a drain is scheduled as soon as a block is enqueued.
+ */
+@property (atomic, assign) NSTimeInterval drainInterval;
+
+/**
+ The number of blocks enqueued and not yet delivered.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfPendingBlocks;
+
+/**
+ The number of drains that have delivered blocks so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfDrains;
+
+/**
+ Initializes a coalescer delivering blocks on the main queue.
+ */
+- (instancetype)init;
+
+/**
+ Initializes a coalescer delivering blocks on the specified queue.
+
+ @param queue The queue blocks are delivered on. If `NULL`, the main queue is used.
+ */
+- (instancetype)initWithQueue:(nullable dispatch_queue_t)queue NS_DESIGNATED_INITIALIZER;
+
+/**
+ Enqueues a block, to be run by the next drain.
+
+ @param block The block to run. This parameter must not be `nil`.
+ */
+- (void)enqueueBlock:(dispatch_block_t)block;
+
+/**
+ Enqueues a block, to be run by the next drain, as part of the specified group. The group is entered when the block is enqueued and left once it has run, as with `dispatch_group_async`.
+
+ @param block The block to run. This parameter must not be `nil`.
+ @param group The group the block is associated with, or `NULL`.
+ */
+- (void)enqueueBlock:(dispatch_block_t)block
+               group:(nullable dispatch_group_t)group;
+
+@end
+
+NS_ASSUME_NONNULL_END
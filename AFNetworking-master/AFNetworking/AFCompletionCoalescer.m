@@ -0,0 +1,140 @@
+// AFCompletionCoalescer.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFCompletionCoalescer.h"
+
+static NSUInteger const AFCompletionCoalescerDefaultMaximumNumberOfBlocksPerDrain = 64;
+
+@interface AFCompletionCoalescer ()
+@property (readwrite, nonatomic, strong) dispatch_queue_t queue;
+@property (readwrite, nonatomic, strong) NSLock *lock;
+@property (readwrite, nonatomic, strong) NSMutableArray <dispatch_block_t> *pendingBlocks;
+@property (readwrite, nonatomic, assign, getter=isDrainScheduled) BOOL drainScheduled;
+@property (readwrite, nonatomic, assign) CFAbsoluteTime lastDrainTime;
+@property (readwrite, atomic, assign) NSUInteger numberOfDrains;
+@end
+
+@implementation AFCompletionCoalescer
+
+- (instancetype)init {
+    return [self initWithQueue:nil];
+}
+
+- (instancetype)initWithQueue:(dispatch_queue_t)queue {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.queue = queue ?: dispatch_get_main_queue();
+    self.lock = [[NSLock alloc] init];
+    self.pendingBlocks = [NSMutableArray array];
+    self.maximumNumberOfBlocksPerDrain = AFCompletionCoalescerDefaultMaximumNumberOfBlocksPerDrain;
+
+    return self;
+}
+
+- (NSUInteger)numberOfPendingBlocks {
+    [self.lock lock];
+    NSUInteger numberOfPendingBlocks = [self.pendingBlocks count];
+    [self.lock unlock];
+
+    return numberOfPendingBlocks;
+}
+
+- (void)enqueueBlock:(dispatch_block_t)block {
+    [self enqueueBlock:block group:nil];
+}
+
+- (void)enqueueBlock:(dispatch_block_t)block
+               group:(dispatch_group_t)group
+{
+    NSParameterAssert(block);
+
+    if (group) {
+        dispatch_group_enter(group);
+        dispatch_block_t groupBlock = block;
+        block = ^{
+            groupBlock();
+            dispatch_group_leave(group);
+        };
+    }
+
+    [self.lock lock];
+    [self.pendingBlocks addObject:[block copy]];
+    BOOL schedulesDrain = !self.drainScheduled;
+    self.drainScheduled = YES;
+    [self.lock unlock];
+
+    if (schedulesDrain) {
+        [self scheduleDrain];
+    }
+}
+
+- (void)scheduleDrain {
+    NSTimeInterval delay = 0;
+    NSTimeInterval drainInterval = self.drainInterval;
+    if (drainInterval > 0) {
+        [self.lock lock];
+        delay = self.lastDrainTime + drainInterval - CFAbsoluteTimeGetCurrent();
+        [self.lock unlock];
+    }
+
+    if (delay > 0) {
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.queue, ^{
+            [self drain];
+        });
+    } else {
+        dispatch_async(self.queue, ^{
+            [self drain];
+        });
+    }
+}
+
+- (void)drain {
+    NSUInteger maximumNumberOfBlocks = self.maximumNumberOfBlocksPerDrain;
+
+    [self.lock lock];
+    NSUInteger numberOfBlocks = maximumNumberOfBlocks > 0 ? MIN(maximumNumberOfBlocks, [self.pendingBlocks count]) : [self.pendingBlocks count];
+    NSArray <dispatch_block_t> *blocks = [self.pendingBlocks subarrayWithRange:NSMakeRange(0, numberOfBlocks)];
+    [self.pendingBlocks removeObjectsInRange:NSMakeRange(0, numberOfBlocks)];
+    BOOL hasRemainingBlocks = [self.pendingBlocks count] > 0;
+    self.drainScheduled = hasRemainingBlocks;
+    self.lastDrainTime = CFAbsoluteTimeGetCurrent();
+    [self.lock unlock];
+
+    if (numberOfBlocks > 0) {
+        self.numberOfDrains++;
+    }
+
+    for (dispatch_block_t block in blocks) {
+        @autoreleasepool {
+            block();
+        }
+    }
+
+    // Blocks left over are delivered by a later drain, after whatever else was submitted to the queue in the meantime
+    if (hasRemainingBlocks) {
+        [self scheduleDrain];
+    }
+}
+
+@end
@@ -32,6 +32,8 @@
 #endif
 
 #import "AFURLSessionManager.h"
+#import "AFRequestScheduler.h"
+#import "AFHedgingPolicy.h"
 
 /**
  `AFHTTPSessionManager` is a subclass of `AFURLSessionManager` with convenience methods for making HTTP requests. When a `baseURL` is provided, requests made with the `GET` / `POST` / et al. convenience methods can be made with relative paths.
@@ -73,6 +75,8 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class AFServerSentEventSource;
+
 @interface AFHTTPSessionManager : AFURLSessionManager <NSSecureCoding, NSCopying>
 
 /**
@@ -103,6 +107,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, strong) AFSecurityPolicy *securityPolicy;
 
+///---------------------------
+/// @name Scheduling Requests
+///---------------------------
+
+/**
+ The scheduler the tasks of the `GET` / `POST` / et al. convenience methods are resumed by, which limits the number of requests running at once, overall and per host, and starts queued requests by priority. The returned task may then still be queued; it can be reprioritized or cancelled through the scheduler. `nil` by default, in which case tasks are resumed as soon as they are created. Changing the scheduler only affects the tasks created afterwards: tasks already scheduled still free their slots in the scheduler they were scheduled on when they complete.
+
+ Tasks created with the `AFURLSessionManager` methods are not scheduled, nor are the connections of event sources.
+ */
+@property (nonatomic, strong, nullable) AFRequestScheduler *requestScheduler;
+
+/**
+ The priority class the tasks of the convenience methods are scheduled with by `requestScheduler`. `AFRequestPriorityNormal` by default.
+ */
+@property (nonatomic, assign) AFRequestPriority defaultRequestPriority;
+
+///-------------------------
+/// @name Hedging Requests
+///-------------------------
+
+/**
+ The policy the `GET` requests of the convenience methods are hedged by. A request that has not received a response within the `hedgeDelay` of the policy is sent a second time, and the first of the two to receive a valid response is used: the other is cancelled, so the response is serialized once, and `success` or `failure` is called once. The task passed to them is the one whose response is used, which may not be the returned task. Cancelling the returned task cancels its hedge, also once the hedge has won: the returned task is then suspended rather than cancelled, until the hedge completes. `nil` by default, in which case requests are not hedged.
+
+ @warning Only set a hedging policy for idempotent `GET` requests to backends that can serve the same request twice.
+ */
+@property (nonatomic, strong, nullable) AFHedgingPolicy *hedgingPolicy;
+
 ///---------------------
 /// @name Initialization
 ///---------------------
@@ -425,6 +456,79 @@ NS_ASSUME_NONNULL_BEGIN
                                   success:(nullable void (^)(NSURLSessionDataTask *task, id _Nullable responseObject))success
                                   failure:(nullable void (^)(NSURLSessionDataTask * _Nullable task, NSError *error))failure;
 
+/**
+ Creates and connects an event source receiving the Server-Sent Events of a `GET` request, decoded by an `AFServerSentEventResponseSerializer` as they are received, rather than by the `responseSerializer` of the manager.
+
+ The event source reconnects when the connection is lost or the response ends, sending the last event ID received in a `Last-Event-ID` header, until it is closed, the server responds with `204 No Content` or an invalid response, or `maximumNumberOfReconnectionAttempts` consecutive connections receive no event.
+
+ @param URLString The URL string used to create the request URL.
+ @param parameters The parameters to be encoded according to the client request serializer.
+ @param headers The headers appended to the default headers for this request.
+ @param queue The queue events, and the completion handler, are executed on. If `NULL`, the main queue is used.
+ @param eventHandler A block object to be executed with the events received. This block has no return value and takes a single argument: the events decoded from the same data, in order.
+ @param completionHandler A block object to be executed once, when the event source stops reconnecting or is closed. This block has no return value and takes a single argument: the error that ended the event source, or `nil` if it was closed, or ended by the server.
+ */
+- (nullable AFServerSentEventSource *)eventSourceWithURLString:(NSString *)URLString
+                                                    parameters:(nullable id)parameters
+                                                       headers:(nullable NSDictionary <NSString *, NSString *> *)headers
+                                                         queue:(nullable dispatch_queue_t)queue
+                                                  eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler
+                                             completionHandler:(nullable void (^)(NSError * _Nullable error))completionHandler;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFServerSentEventSource` is a long-lived connection to a `text/event-stream` resource, created by `-[AFHTTPSessionManager eventSourceWithURLString:parameters:headers:queue:eventHandler:completionHandler:]`. Each connection is a data task of the session manager, whose events are decoded by an `AFServerSentEventStream`.
+ */
+@interface AFServerSentEventSource : NSObject
+
+/**
+ The request of the event source, which each connection is made with.
+ */
+@property (readonly, nonatomic, strong) NSURLRequest *request;
+
+/**
+ The data task of the current connection, or `nil` while the event source is waiting to reconnect.
+ */
+@property (readonly, atomic, strong, nullable) NSURLSessionDataTask *dataTask;
+
+/**
+ The last event ID received, sent in the `Last-Event-ID` header of each reconnection.
+ */
+@property (readonly, atomic, copy, nullable) NSString *lastEventID;
+
+/**
+ The time to wait before reconnecting, which the server may change with a `retry` field. `3` seconds by default.
+ */
+@property (atomic, assign) NSTimeInterval reconnectionTime;
+
+/**
+ The number of consecutive connections receiving no event after which the event source stops reconnecting. `NSUIntegerMax` by default.
+ */
+@property (atomic, assign) NSUInteger maximumNumberOfReconnectionAttempts;
+
+/**
+ The number of connections made, including the first.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfConnections;
+
+/**
+ The number of events received over all connections.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfEvents;
+
+/**
+ Whether the event source has stopped, because it was closed or stopped reconnecting.
+ */
+@property (readonly, atomic, assign, getter=isClosed) BOOL closed;
+
+/**
+ Cancels the current connection, stops reconnecting, and executes the completion handler without an error.
+ */
+- (void)close;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -40,8 +40,190 @@
 #import <WatchKit/WatchKit.h>
 #endif
 
+@interface AFServerSentEventSource ()
+@property (readwrite, nonatomic, strong) AFHTTPSessionManager *sessionManager;
+@property (readwrite, nonatomic, strong) NSURLRequest *request;
+@property (readwrite, nonatomic, strong) AFServerSentEventResponseSerializer *responseSerializer;
+@property (readwrite, nonatomic, strong) dispatch_queue_t queue;
+@property (readwrite, nonatomic, copy) void (^eventHandler)(NSArray <AFServerSentEvent *> *events);
+@property (readwrite, nonatomic, copy) void (^completionHandler)(NSError *error);
+@property (readwrite, nonatomic, assign) NSUInteger numberOfReconnectionAttempts;
+@property (readwrite, atomic, strong) NSURLSessionDataTask *dataTask;
+@property (readwrite, atomic, copy) NSString *lastEventID;
+@property (readwrite, atomic, assign) NSUInteger numberOfConnections;
+@property (readwrite, atomic, assign) NSUInteger numberOfEvents;
+@property (readwrite, atomic, assign, getter=isClosed) BOOL closed;
+@end
+
+@implementation AFServerSentEventSource
+
+- (instancetype)initWithSessionManager:(AFHTTPSessionManager *)sessionManager
+                               request:(NSURLRequest *)request
+                                 queue:(dispatch_queue_t)queue
+                          eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler
+                     completionHandler:(void (^)(NSError *error))completionHandler
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.sessionManager = sessionManager;
+    self.request = request;
+    self.responseSerializer = [AFServerSentEventResponseSerializer serializer];
+    self.queue = queue ?: dispatch_get_main_queue();
+    self.eventHandler = eventHandler;
+    self.completionHandler = completionHandler;
+    self.reconnectionTime = 3.0;
+    self.maximumNumberOfReconnectionAttempts = NSUIntegerMax;
+
+    return self;
+}
+
+- (void)connect {
+    NSMutableURLRequest *request = [self.request mutableCopy];
+    if ([self.lastEventID length] > 0) {
+        [request setValue:self.lastEventID forHTTPHeaderField:@"Last-Event-ID"];
+    }
+
+    AFServerSentEventStream *stream = [self.responseSerializer streamWithQueue:self.queue eventHandler:^(NSArray <AFServerSentEvent *> *events) {
+        void (^eventHandler)(NSArray <AFServerSentEvent *> *events) = self.eventHandler;
+        if (self.closed || !eventHandler) {
+            return;
+        }
+
+        self.numberOfEvents += [events count];
+        eventHandler(events);
+    }];
+    stream.lastEventID = self.lastEventID;
+
+    NSURLSessionDataTask *dataTask = [self.sessionManager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        [self stream:stream didCompleteWithResponse:response error:error];
+    }];
+
+    @synchronized (self) {
+        if (self.closed) {
+            [dataTask cancel];
+            return;
+        }
+
+        self.dataTask = dataTask;
+        self.numberOfConnections++;
+    }
+
+    [dataTask resume];
+}
+
+- (void)stream:(AFServerSentEventStream *)stream
+didCompleteWithResponse:(NSURLResponse *)response
+         error:(NSError *)error
+{
+    self.lastEventID = stream.lastEventID;
+    if (stream.reconnectionTime >= 0) {
+        self.reconnectionTime = stream.reconnectionTime;
+    }
+
+    @synchronized (self) {
+        if (self.closed) {
+            return;
+        }
+
+        self.dataTask = nil;
+        self.numberOfReconnectionAttempts = stream.numberOfEvents > 0 ? 0 : self.numberOfReconnectionAttempts + 1;
+    }
+
+    // Invalid responses, and `204 No Content`, tell the client to stop reconnecting. Responses without data are not validated by the stream.
+    BOOL isNoContent = [response isKindOfClass:[NSHTTPURLResponse class]] && [(NSHTTPURLResponse *)response statusCode] == 204;
+    NSError *validationError = stream.error;
+    if (!validationError && response && !isNoContent) {
+        [self.responseSerializer validateResponse:(NSHTTPURLResponse *)response data:nil error:&validationError];
+    }
+
+    if (validationError) {
+        [self finishWithError:validationError];
+        return;
+    } else if (isNoContent) {
+        [self finishWithError:nil];
+        return;
+    } else if (self.numberOfReconnectionAttempts >= self.maximumNumberOfReconnectionAttempts) {
+        [self finishWithError:error];
+        return;
+    }
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(self.reconnectionTime * NSEC_PER_SEC)), self.queue, ^{
+        if (!self.closed) {
+            [self connect];
+        }
+    });
+}
+
+- (void)finishWithError:(NSError *)error {
+    void (^completionHandler)(NSError *error) = nil;
+    @synchronized (self) {
+        completionHandler = self.completionHandler;
+        self.completionHandler = nil;
+        self.eventHandler = nil;
+        self.closed = YES;
+    }
+
+    if (completionHandler) {
+        dispatch_async(self.queue, ^{
+            completionHandler(error);
+        });
+    }
+}
+
+- (void)close {
+    NSURLSessionDataTask *dataTask = nil;
+    @synchronized (self) {
+        if (self.closed) {
+            return;
+        }
+
+        dataTask = self.dataTask;
+        self.dataTask = nil;
+    }
+
+    [self finishWithError:nil];
+    [dataTask cancel];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFHedgedRequest : NSObject
+@property (readwrite, nonatomic, strong) AFHedgingPolicy *hedgingPolicy;
+@property (readwrite, nonatomic, copy) void (^success)(NSURLSessionDataTask *task, id responseObject);
+@property (readwrite, nonatomic, copy) void (^failure)(NSURLSessionDataTask *task, NSError *error);
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *primaryTask;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *hedgeTask;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *winningTask;
+@property (readwrite, nonatomic, assign) CFAbsoluteTime primaryStartTime;
+@property (readwrite, nonatomic, assign, getter=isFinished) BOOL finished;
+@end
+
+@implementation AFHedgedRequest
+
+- (NSURLSessionDataTask *)otherTaskThan:(NSURLSessionDataTask *)task {
+    return task == self.primaryTask ? self.hedgeTask : self.primaryTask;
+}
+
+// Measured from the start of the original request even when the hedge wins, so that the slow tail hedges cut short is still sampled, at least as long as it was outstanding
+- (NSTimeInterval)latency {
+    return CFAbsoluteTimeGetCurrent() - self.primaryStartTime;
+}
+
+@end
+
+#pragma mark -
+
 @interface AFHTTPSessionManager ()
 @property (readwrite, nonatomic, strong) NSURL *baseURL;
+@property (readwrite, nonatomic, strong) NSLock *hedgingLock;
+@property (readwrite, nonatomic, strong) NSMapTable <NSURLSessionDataTask *, AFHedgedRequest *> *hedgedRequests;
+@property (readwrite, nonatomic, strong) NSLock *requestSchedulerLock;
+@property (readwrite, nonatomic, strong) NSMapTable <NSURLSessionTask *, AFRequestScheduler *> *requestSchedulersByTask;
 @end
 
 @implementation AFHTTPSessionManager
@@ -81,6 +263,13 @@
     self.requestSerializer = [AFHTTPRequestSerializer serializer];
     //这里的responseSerializer本来已经设置了AFJSONResponseSerializer，多态性，所以再设置一遍也是为了便于区分和管理
     self.responseSerializer = [AFJSONResponseSerializer serializer];
+    self.defaultRequestPriority = AFRequestPriorityNormal;
+
+    self.hedgingLock = [[NSLock alloc] init];
+    self.hedgedRequests = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+
+    self.requestSchedulerLock = [[NSLock alloc] init];
+    self.requestSchedulersByTask = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
 
     return self;
 }
@@ -145,7 +334,17 @@
                       success:(void (^)(NSURLSessionDataTask * _Nonnull, id _Nullable))success
                       failure:(void (^)(NSURLSessionDataTask * _Nullable, NSError * _Nonnull))failure
 {
-    
+    AFHedgingPolicy *hedgingPolicy = self.hedgingPolicy;
+    if (hedgingPolicy) {
+        return [self hedgedDataTaskWithURLString:URLString
+                                      parameters:parameters
+                                         headers:headers
+                                   hedgingPolicy:hedgingPolicy
+                                downloadProgress:downloadProgress
+                                         success:success
+                                         failure:failure];
+    }
+
     NSURLSessionDataTask *dataTask = [self dataTaskWithHTTPMethod:@"GET"
                                                         URLString:URLString
                                                        parameters:parameters
@@ -155,7 +354,7 @@
                                                           success:success
                                                           failure:failure];
     
-    [dataTask resume];
+    [self resumeTask:dataTask];
     
     return dataTask;
 }
@@ -180,7 +379,7 @@
         }
     } failure:failure];
     
-    [dataTask resume];
+    [self resumeTask:dataTask];
     
     return dataTask;
 }
@@ -211,7 +410,7 @@
 {
     NSURLSessionDataTask *dataTask = [self dataTaskWithHTTPMethod:@"POST" URLString:URLString parameters:parameters headers:headers uploadProgress:uploadProgress downloadProgress:nil success:success failure:failure];
     
-    [dataTask resume];
+    [self resumeTask:dataTask];
     
     return dataTask;
 }
@@ -269,7 +468,7 @@
         }
     }];
     
-    [task resume];
+    [self resumeTask:task];
     
     return task;
 }
@@ -290,7 +489,7 @@
 {
     NSURLSessionDataTask *dataTask = [self dataTaskWithHTTPMethod:@"PUT" URLString:URLString parameters:parameters headers:headers uploadProgress:nil downloadProgress:nil success:success failure:failure];
     
-    [dataTask resume];
+    [self resumeTask:dataTask];
     
     return dataTask;
 }
@@ -311,7 +510,7 @@
 {
     NSURLSessionDataTask *dataTask = [self dataTaskWithHTTPMethod:@"PATCH" URLString:URLString parameters:parameters headers:headers uploadProgress:nil downloadProgress:nil success:success failure:failure];
     
-    [dataTask resume];
+    [self resumeTask:dataTask];
     
     return dataTask;
 }
@@ -332,7 +531,7 @@
 {
     NSURLSessionDataTask *dataTask = [self dataTaskWithHTTPMethod:@"DELETE" URLString:URLString parameters:parameters headers:headers uploadProgress:nil downloadProgress:nil success:success failure:failure];
     
-    [dataTask resume];
+    [self resumeTask:dataTask];
     
     return dataTask;
 }
@@ -380,8 +579,312 @@
     return dataTask;
 }
 
+- (AFServerSentEventSource *)eventSourceWithURLString:(NSString *)URLString
+                                           parameters:(id)parameters
+                                              headers:(NSDictionary <NSString *, NSString *> *)headers
+                                                queue:(dispatch_queue_t)queue
+                                         eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler
+                                    completionHandler:(void (^)(NSError *error))completionHandler
+{
+    NSParameterAssert(eventHandler);
+
+    NSError *serializationError = nil;
+    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"GET" URLString:[[NSURL URLWithString:URLString relativeToURL:self.baseURL] absoluteString] parameters:parameters error:&serializationError];
+    for (NSString *headerField in headers.keyEnumerator) {
+        [request addValue:headers[headerField] forHTTPHeaderField:headerField];
+    }
+    if (serializationError) {
+        if (completionHandler) {
+            dispatch_async(queue ?: dispatch_get_main_queue(), ^{
+                completionHandler(serializationError);
+            });
+        }
+
+        return nil;
+    }
+
+    [request setValue:@"text/event-stream" forHTTPHeaderField:@"Accept"];
+    if (![request valueForHTTPHeaderField:@"Cache-Control"]) {
+        [request setValue:@"no-cache" forHTTPHeaderField:@"Cache-Control"];
+    }
+
+    AFServerSentEventSource *eventSource = [[AFServerSentEventSource alloc] initWithSessionManager:self request:request queue:queue eventHandler:eventHandler completionHandler:completionHandler];
+    [eventSource connect];
+
+    return eventSource;
+}
+
+#pragma mark - Hedging
+
+- (NSURLSessionDataTask *)hedgedDataTaskWithURLString:(NSString *)URLString
+                                           parameters:(id)parameters
+                                              headers:(NSDictionary <NSString *, NSString *> *)headers
+                                        hedgingPolicy:(AFHedgingPolicy *)hedgingPolicy
+                                     downloadProgress:(void (^)(NSProgress *downloadProgress))downloadProgress
+                                              success:(void (^)(NSURLSessionDataTask *, id))success
+                                              failure:(void (^)(NSURLSessionDataTask *, NSError *))failure
+{
+    NSError *serializationError = nil;
+    NSMutableURLRequest *request = [self.requestSerializer requestWithMethod:@"GET" URLString:[[NSURL URLWithString:URLString relativeToURL:self.baseURL] absoluteString] parameters:parameters error:&serializationError];
+    for (NSString *headerField in headers.keyEnumerator) {
+        [request addValue:headers[headerField] forHTTPHeaderField:headerField];
+    }
+    if (serializationError) {
+        if (failure) {
+            dispatch_async(self.completionQueue ?: dispatch_get_main_queue(), ^{
+                failure(nil, serializationError);
+            });
+        }
+
+        return nil;
+    }
+
+    AFHedgedRequest *hedgedRequest = [[AFHedgedRequest alloc] init];
+    hedgedRequest.hedgingPolicy = hedgingPolicy;
+    hedgedRequest.success = success;
+    hedgedRequest.failure = failure;
+
+    NSURLSessionDataTask *dataTask = [self dataTaskWithRequest:request hedgedRequest:hedgedRequest downloadProgress:downloadProgress];
+    [self.hedgingLock lock];
+    hedgedRequest.primaryTask = dataTask;
+    hedgedRequest.primaryStartTime = CFAbsoluteTimeGetCurrent();
+    [self.hedgingLock unlock];
+
+    [hedgingPolicy didStartRequest];
+    [self resumeTask:dataTask];
+
+    __weak __typeof__(self) weakSelf = self;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)([hedgingPolicy hedgeDelay] * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        [weakSelf sendHedgeOfRequest:request hedgedRequest:hedgedRequest downloadProgress:downloadProgress];
+    });
+
+    return dataTask;
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                                hedgedRequest:(AFHedgedRequest *)hedgedRequest
+                             downloadProgress:(void (^)(NSProgress *downloadProgress))downloadProgress
+{
+    __block NSURLSessionDataTask *dataTask = nil;
+    dataTask = [self dataTaskWithRequest:request
+                          uploadProgress:nil
+                        downloadProgress:downloadProgress
+                       completionHandler:^(NSURLResponse * __unused response, id responseObject, NSError *error) {
+        [self hedgedRequest:hedgedRequest task:dataTask didCompleteWithResponseObject:responseObject error:error];
+    }];
+
+    [self.hedgingLock lock];
+    [self.hedgedRequests setObject:hedgedRequest forKey:dataTask];
+    [self.hedgingLock unlock];
+
+    return dataTask;
+}
+
+- (void)sendHedgeOfRequest:(NSURLRequest *)request
+             hedgedRequest:(AFHedgedRequest *)hedgedRequest
+          downloadProgress:(void (^)(NSProgress *downloadProgress))downloadProgress
+{
+    [self.hedgingLock lock];
+    BOOL shouldSendHedge = !hedgedRequest.finished && !hedgedRequest.winningTask && !hedgedRequest.hedgeTask;
+    [self.hedgingLock unlock];
+
+    if (!shouldSendHedge || ![hedgedRequest.hedgingPolicy shouldSendHedge]) {
+        return;
+    }
+
+    NSURLSessionDataTask *hedgeTask = [self dataTaskWithRequest:request hedgedRequest:hedgedRequest downloadProgress:downloadProgress];
+    [self.hedgingLock lock];
+    hedgedRequest.hedgeTask = hedgeTask;
+    // The request may have completed, or received its response, while the hedge was being created.
+    shouldSendHedge = !hedgedRequest.finished && !hedgedRequest.winningTask;
+    [self.hedgingLock unlock];
+
+    if (shouldSendHedge) {
+        [self resumeTask:hedgeTask];
+    } else {
+        [self cancelTask:hedgeTask];
+    }
+}
+
+- (BOOL)hedgedRequest:(AFHedgedRequest *)hedgedRequest
+                 task:(NSURLSessionDataTask *)task
+   didReceiveResponse:(NSURLResponse *)response
+{
+    NSURLSessionDataTask *losingTask = nil;
+    NSTimeInterval latency = 0;
+    BOOL isHedgeTask = NO;
+    BOOL didWin = NO;
+
+    [self.hedgingLock lock];
+    // 第一个有效的响应胜出，另一个请求被取消，所以响应只会被序列化一次。无效的响应不会胜出，另一个请求仍然可以成功
+    if (!hedgedRequest.winningTask && !hedgedRequest.finished && [self.responseSerializer validateResponse:(NSHTTPURLResponse *)response data:nil error:NULL]) {
+        hedgedRequest.winningTask = task;
+        losingTask = [hedgedRequest otherTaskThan:task];
+        latency = [hedgedRequest latency];
+        isHedgeTask = task == hedgedRequest.hedgeTask;
+        didWin = YES;
+    }
+    BOOL isLosingTask = hedgedRequest.winningTask && hedgedRequest.winningTask != task;
+    [self.hedgingLock unlock];
+
+    if (didWin) {
+        if (losingTask && losingTask == hedgedRequest.primaryTask) {
+            // The returned task is suspended rather than cancelled, so that the caller cancelling it still reaches the hedge. It is cancelled once the hedge completes.
+            [losingTask suspend];
+        } else {
+            [self cancelTask:losingTask];
+        }
+        [hedgedRequest.hedgingPolicy didReceiveResponseWithLatency:latency fromHedge:isHedgeTask];
+    }
+
+    return !isLosingTask;
+}
+
+- (void)hedgedRequest:(AFHedgedRequest *)hedgedRequest
+                 task:(NSURLSessionDataTask *)task
+didCompleteWithResponseObject:(id)responseObject
+                error:(NSError *)error
+{
+    NSURLSessionDataTask *otherTask = nil;
+    NSURLSessionDataTask *cancelledWinningTask = nil;
+    NSTimeInterval latency = 0;
+    BOOL isHedgeTask = NO;
+    BOOL didWin = NO;
+    BOOL shouldFinish = NO;
+    BOOL isCancelled = [error.domain isEqualToString:NSURLErrorDomain] && error.code == NSURLErrorCancelled;
+
+    [self.hedgingLock lock];
+    [self.hedgedRequests removeObjectForKey:task];
+    otherTask = [hedgedRequest otherTaskThan:task];
+    if (!hedgedRequest.finished) {
+        // Responses are normally claimed as they are received; this covers tasks whose response was not reported to the manager.
+        if (!hedgedRequest.winningTask && !error) {
+            hedgedRequest.winningTask = task;
+            latency = [hedgedRequest latency];
+            isHedgeTask = task == hedgedRequest.hedgeTask;
+            didWin = YES;
+        }
+
+        if (hedgedRequest.winningTask == task) {
+            shouldFinish = YES;
+        } else if (!hedgedRequest.winningTask) {
+            // A failed request waits for the other one, unless it was cancelled by the caller, or there is no other one.
+            shouldFinish = isCancelled || !otherTask || ![self.hedgedRequests objectForKey:otherTask];
+        } else if (isCancelled && task == hedgedRequest.primaryTask) {
+            // The returned task is only suspended when the hedge wins, so its cancellation comes from the caller, and is passed on to the hedge.
+            cancelledWinningTask = hedgedRequest.winningTask;
+        }
+        hedgedRequest.finished = shouldFinish;
+    }
+    [self.hedgingLock unlock];
+
+    if (didWin) {
+        [hedgedRequest.hedgingPolicy didReceiveResponseWithLatency:latency fromHedge:isHedgeTask];
+    }
+
+    [self cancelTask:cancelledWinningTask];
+
+    if (!shouldFinish) {
+        return;
+    }
+
+    [self cancelTask:otherTask];
+
+    if (error) {
+        if (hedgedRequest.failure) {
+            hedgedRequest.failure(task, error);
+        }
+    } else {
+        if (hedgedRequest.success) {
+            hedgedRequest.success(task, responseObject);
+        }
+    }
+}
+
+- (void)resumeTask:(NSURLSessionTask *)task {
+    if (!task) {
+        return;
+    }
+
+    AFRequestScheduler *requestScheduler = self.requestScheduler;
+    if (requestScheduler) {
+        // The task is completed and cancelled through the scheduler it was scheduled on, even if `requestScheduler` is changed in the meantime
+        [self.requestSchedulerLock lock];
+        [self.requestSchedulersByTask setObject:requestScheduler forKey:task];
+        [self.requestSchedulerLock unlock];
+
+        [requestScheduler scheduleTask:task priority:self.defaultRequestPriority];
+    } else {
+        [task resume];
+    }
+}
+
+- (void)cancelTask:(NSURLSessionTask *)task {
+    if (!task) {
+        return;
+    }
+
+    [self.requestSchedulerLock lock];
+    AFRequestScheduler *requestScheduler = [self.requestSchedulersByTask objectForKey:task];
+    [self.requestSchedulerLock unlock];
+
+    if (requestScheduler) {
+        [requestScheduler cancelTask:task];
+    } else {
+        [task cancel];
+    }
+}
+
+#pragma mark - NSURLSessionTaskDelegate
+
+- (void)URLSession:(NSURLSession *)session
+              task:(NSURLSessionTask *)task
+didCompleteWithError:(NSError *)error
+{
+    [super URLSession:session task:task didCompleteWithError:error];
+
+    [self.requestSchedulerLock lock];
+    AFRequestScheduler *requestScheduler = [self.requestSchedulersByTask objectForKey:task];
+    [self.requestSchedulersByTask removeObjectForKey:task];
+    [self.requestSchedulerLock unlock];
+
+    // Tasks scheduled directly on the scheduler, rather than by the manager, are reported to the current one
+    [requestScheduler ?: self.requestScheduler didCompleteTask:task];
+}
+
+#pragma mark - NSURLSessionDataDelegate
+
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
+didReceiveResponse:(NSURLResponse *)response
+ completionHandler:(void (^)(NSURLSessionResponseDisposition disposition))completionHandler
+{
+    [self.hedgingLock lock];
+    AFHedgedRequest *hedgedRequest = [self.hedgedRequests objectForKey:dataTask];
+    [self.hedgingLock unlock];
+
+    if (hedgedRequest && ![self hedgedRequest:hedgedRequest task:dataTask didReceiveResponse:response]) {
+        if (completionHandler) {
+            completionHandler(NSURLSessionResponseCancel);
+        }
+
+        return;
+    }
+
+    [super URLSession:session dataTask:dataTask didReceiveResponse:response completionHandler:completionHandler];
+}
+
 #pragma mark - NSObject
 
+- (BOOL)respondsToSelector:(SEL)selector {
+    // 设置了hedgingPolicy时需要在收到响应时决定哪个请求胜出
+    if (selector == @selector(URLSession:dataTask:didReceiveResponse:completionHandler:) && self.hedgingPolicy) {
+        return YES;
+    }
+
+    return [super respondsToSelector:selector];
+}
+
 - (NSString *)description {
     return [NSString stringWithFormat:@"<%@: %p, baseURL: %@, session: %@, operationQueue: %@>", NSStringFromClass([self class]), self, [self.baseURL absoluteString], self.session, self.operationQueue];
 }
@@ -0,0 +1,128 @@
+// AFHedgingPolicy.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ `AFHedgingPolicy` decides when a slow request is hedged: sent a second time, so that whichever copy responds first is used. Hedging trims the latency tail caused by the occasional slow server or connection, at the cost of a few duplicate requests, and must only be used for idempotent requests to replicated backends.
+
+ A request is hedged once it has not received a response within `hedgeDelay`, the `latencyPercentile` of the latencies recently recorded by the policy. Until `minimumNumberOfLatencySamples` latencies have been recorded, `initialHedgeDelay` is used instead. Hedges are capped by `maximumHedgeRatio`, so that a slow backend is not sent twice its load.
+
+ Policies are opt-in: set one as the `hedgingPolicy` of an `AFHTTPSessionManager`, which then hedges its `GET` requests. A policy can be shared by several managers, so that their latencies and budget are tracked together.
+ */
+@interface AFHedgingPolicy : NSObject
+
+/**
+ The percentile of recent latencies after which a request without a response is hedged, between `0.0` and `1.0`. `0.95` by default.
+ */
+@property (atomic, assign) double latencyPercentile;
+
+/**
+ The delay after which requests are hedged until enough latencies have been recorded. `0.5` seconds by default.
+ */
+@property (atomic, assign) NSTimeInterval initialHedgeDelay;
+
+/**
+ The delay below which requests are never hedged, however fast recent responses were. `0.01` seconds by default.
+ */
+@property (atomic, assign) NSTimeInterval minimumHedgeDelay;
+
+/**
+ The number of latencies to record before `latencyPercentile` is used. `20` by default.
+ */
+@property (atomic, assign) NSUInteger minimumNumberOfLatencySamples;
+
+/**
+ The maximum number of latencies kept, the oldest being replaced by new ones.
+ */
+@property (readonly, nonatomic, assign) NSUInteger maximumNumberOfLatencySamples;
+
+/**
+ The maximum ratio of hedges to requests. A request is not hedged if it would take `numberOfHedges` above this ratio of `numberOfRequests`. `0.1` by default.
+ */
+@property (atomic, assign) double maximumHedgeRatio;
+
+/**
+ The number of requests started under the policy.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfRequests;
+
+/**
+ The number of hedges sent.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfHedges;
+
+/**
+ The number of hedges that responded before the request they duplicate.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfHedgesWon;
+
+/**
+ Initializes a policy keeping the last `100` latencies.
+ */
+- (instancetype)init;
+
+/**
+ Initializes a policy keeping the specified number of latencies.
+
+ @param maximumNumberOfLatencySamples The maximum number of latencies kept. At least one latency is kept.
+ */
+- (instancetype)initWithMaximumNumberOfLatencySamples:(NSUInteger)maximumNumberOfLatencySamples NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns the delay after which a request started now should be hedged.
+ */
+- (NSTimeInterval)hedgeDelay;
+
+/**
+ Records a latency, replacing the oldest one if `maximumNumberOfLatencySamples` are already kept.
+
+ @param latency The time a request took to receive its response.
+ */
+- (void)recordLatency:(NSTimeInterval)latency;
+
+/**
+ Tells the policy that a request has started, which counts towards the budget of hedges. Called by `AFHTTPSessionManager` for the requests it hedges.
+ */
+- (void)didStartRequest;
+
+/**
+ Asks the policy whether a request can be hedged within its budget, counting the hedge if so. Called by `AFHTTPSessionManager` once a request has gone without a response for `hedgeDelay`.
+
+ @return `YES` if the hedge should be sent, `NO` if it would exceed `maximumHedgeRatio`.
+ */
+- (BOOL)shouldSendHedge;
+
+/**
+ Tells the policy that a request, or its hedge, received the response that is used. Called by `AFHTTPSessionManager`.
+
+ @param latency The time from the start of the request to the response used, which is recorded. When the hedge wins, this is still measured from the start of the original request, so that slow requests are sampled even when hedges cut them short.
+ @param fromHedge Whether the response was received by the hedge, which counts towards `numberOfHedgesWon`.
+ */
+- (void)didReceiveResponseWithLatency:(NSTimeInterval)latency
+                            fromHedge:(BOOL)fromHedge;
+
+@end
+
+NS_ASSUME_NONNULL_END
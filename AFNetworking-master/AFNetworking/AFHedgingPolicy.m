@@ -0,0 +1,146 @@
+// AFHedgingPolicy.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "AFHedgingPolicy.h"
+
+static NSUInteger const AFHedgingPolicyDefaultMaximumNumberOfLatencySamples = 100;
+
+static int AFLatencyCompare(const void *a, const void *b) {
+    NSTimeInterval lhs = *(const NSTimeInterval *)a;
+    NSTimeInterval rhs = *(const NSTimeInterval *)b;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+@interface AFHedgingPolicy ()
+@property (readwrite, nonatomic, strong) NSLock *lock;
+@property (readwrite, nonatomic, assign) NSUInteger maximumNumberOfLatencySamples;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfLatencySamples;
+@property (readwrite, nonatomic, assign) NSUInteger nextLatencySampleIndex;
+@property (readwrite, atomic, assign) NSUInteger numberOfRequests;
+@property (readwrite, atomic, assign) NSUInteger numberOfHedges;
+@property (readwrite, atomic, assign) NSUInteger numberOfHedgesWon;
+@end
+
+@implementation AFHedgingPolicy {
+    NSTimeInterval *_latencySamples;
+    NSTimeInterval *_sortedLatencySamples;
+}
+
+- (instancetype)init {
+    return [self initWithMaximumNumberOfLatencySamples:AFHedgingPolicyDefaultMaximumNumberOfLatencySamples];
+}
+
+- (instancetype)initWithMaximumNumberOfLatencySamples:(NSUInteger)maximumNumberOfLatencySamples {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.lock = [[NSLock alloc] init];
+    self.maximumNumberOfLatencySamples = MAX(maximumNumberOfLatencySamples, (NSUInteger)1);
+    _latencySamples = calloc(self.maximumNumberOfLatencySamples, sizeof(NSTimeInterval));
+    _sortedLatencySamples = calloc(self.maximumNumberOfLatencySamples, sizeof(NSTimeInterval));
+
+    self.latencyPercentile = 0.95;
+    self.initialHedgeDelay = 0.5;
+    self.minimumHedgeDelay = 0.01;
+    self.minimumNumberOfLatencySamples = 20;
+    self.maximumHedgeRatio = 0.1;
+
+    return self;
+}
+
+- (void)dealloc {
+    free(_latencySamples);
+    free(_sortedLatencySamples);
+}
+
+- (NSTimeInterval)hedgeDelay {
+    NSTimeInterval hedgeDelay = self.initialHedgeDelay;
+    NSUInteger minimumNumberOfLatencySamples = MAX(self.minimumNumberOfLatencySamples, (NSUInteger)1);
+    double latencyPercentile = MIN(MAX(self.latencyPercentile, 0.0), 1.0);
+
+    [self.lock lock];
+    NSUInteger numberOfLatencySamples = self.numberOfLatencySamples;
+    if (numberOfLatencySamples >= minimumNumberOfLatencySamples) {
+        // Nearest rank: the smallest latency that at least `latencyPercentile` of the samples do not exceed.
+        memcpy(_sortedLatencySamples, _latencySamples, numberOfLatencySamples * sizeof(NSTimeInterval));
+        qsort(_sortedLatencySamples, numberOfLatencySamples, sizeof(NSTimeInterval), AFLatencyCompare);
+        NSUInteger rank = (NSUInteger)ceil(latencyPercentile * numberOfLatencySamples);
+        hedgeDelay = _sortedLatencySamples[MIN(MAX(rank, (NSUInteger)1), numberOfLatencySamples) - 1];
+    }
+    [self.lock unlock];
+
+    return MAX(hedgeDelay, self.minimumHedgeDelay);
+}
+
+- (void)recordLatency:(NSTimeInterval)latency {
+    if (latency < 0) {
+        return;
+    }
+
+    [self.lock lock];
+    _latencySamples[self.nextLatencySampleIndex] = latency;
+    self.nextLatencySampleIndex = (self.nextLatencySampleIndex + 1) % self.maximumNumberOfLatencySamples;
+    self.numberOfLatencySamples = MIN(self.numberOfLatencySamples + 1, self.maximumNumberOfLatencySamples);
+    [self.lock unlock];
+}
+
+- (void)didStartRequest {
+    [self.lock lock];
+    self.numberOfRequests++;
+    [self.lock unlock];
+}
+
+- (BOOL)shouldSendHedge {
+    double maximumHedgeRatio = self.maximumHedgeRatio;
+
+    [self.lock lock];
+    BOOL shouldSendHedge = (double)(self.numberOfHedges + 1) <= maximumHedgeRatio * (double)self.numberOfRequests;
+    if (shouldSendHedge) {
+        self.numberOfHedges++;
+    }
+    [self.lock unlock];
+
+    return shouldSendHedge;
+}
+
+- (void)didReceiveResponseWithLatency:(NSTimeInterval)latency
+                            fromHedge:(BOOL)fromHedge
+{
+    [self recordLatency:latency];
+
+    if (fromHedge) {
+        [self.lock lock];
+        self.numberOfHedgesWon++;
+        [self.lock unlock];
+    }
+}
+
+#pragma mark - NSObject
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, hedgeDelay: %f, numberOfRequests: %lu, numberOfHedges: %lu, numberOfHedgesWon: %lu>", NSStringFromClass([self class]), self, [self hedgeDelay], (unsigned long)self.numberOfRequests, (unsigned long)self.numberOfHedges, (unsigned long)self.numberOfHedgesWon];
+}
+
+@end
@@ -0,0 +1,286 @@
+// AFJSONParser.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AFJSONDocument, AFJSONModelSchema;
+
+/**
+ The instruction sets `AFJSONParser` can find the structural characters of JSON text with.
+
+ - `AFJSONParserInstructionSetAutomatic`: The fastest instruction set supported by the processor.
+ - `AFJSONParserInstructionSetScalar`: Portable C, one byte at a time.
+ - `AFJSONParserInstructionSetSSE2`: 16 bytes at a time, on x86 processors.
+ - `AFJSONParserInstructionSetAVX2`: 32 bytes at a time, on x86 processors with AVX2.
+ - `AFJSONParserInstructionSetNEON`: 16 bytes at a time, on 64-bit ARM processors.
+ */
+typedef NS_ENUM(NSInteger, AFJSONParserInstructionSet) {
+    AFJSONParserInstructionSetAutomatic = 0,
+    AFJSONParserInstructionSetScalar,
+    AFJSONParserInstructionSetSSE2,
+    AFJSONParserInstructionSetAVX2,
+    AFJSONParserInstructionSetNEON,
+};
+
+/**
+ `AFJSONParser` decodes UTF-8 JSON text into Foundation objects. It is a drop-in alternative to `+[NSJSONSerialization JSONObjectWithData:options:error:]`, used by `AFJSONResponseSerializer` when its `parsingBackend` is `AFJSONParsingBackendStructuralIndex`.
+
+ ## Parsing in Two Stages
+
+ The first stage classifies the text 64 bytes at a time with vector instructions, and records the offset of every structural character: the brackets, braces, colons and commas outside of strings, the quotes around strings, and the first character of every number and literal. Escaped quotes are told apart from the quotes ending strings without branching, so the cost of this stage depends on the length of the text only.
+
+ The second stage walks the offsets, and creates the objects. Strings without escape sequences are created from the text as is, and repeated object keys are created once per document.
+
+ ## Compatibility
+
+ The objects created are those `NSJSONSerialization` creates for the same text and options, and malformed text fails with an error in `NSCocoaErrorDomain`, with the code `NSPropertyListReadCorruptError`. `NSJSONReadingMutableContainers`, `NSJSONReadingMutableLeaves` and `NSJSONReadingAllowFragments` are supported; text encoded in UTF-16 or UTF-32, text longer than 4 GB, and any other reading options are passed on to `NSJSONSerialization`.
+ */
+@interface AFJSONParser : NSObject
+
+/**
+ The instruction set the parser finds structural characters with. Never `AFJSONParserInstructionSetAutomatic`.
+ */
+@property (readonly, nonatomic, assign) AFJSONParserInstructionSet instructionSet;
+
+/**
+ Returns whether the processor supports the specified instruction set.
+
+ @param instructionSet The instruction set.
+ */
++ (BOOL)isInstructionSetSupported:(AFJSONParserInstructionSet)instructionSet;
+
+/**
+ Initializes a parser using the fastest instruction set supported by the processor.
+ */
+- (instancetype)init;
+
+/**
+ Initializes a parser using the specified instruction set.
+
+ @param instructionSet The instruction set.
+
+ @return The parser, or `nil` if the processor does not support the instruction set.
+ */
+- (nullable instancetype)initWithInstructionSet:(AFJSONParserInstructionSet)instructionSet NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns the Foundation object decoded from the specified JSON text.
+
+ @param data The JSON text.
+ @param options The options for reading the JSON text and creating the Foundation objects. For possible values, see the `NSJSONSerialization` documentation section "NSJSONReadingOptions".
+ @param error The error that occurred while decoding the JSON text.
+
+ @return The Foundation object, or `nil` if the JSON text could not be decoded.
+ */
+- (nullable id)JSONObjectWithData:(NSData *)data
+                          options:(NSJSONReadingOptions)options
+                            error:(NSError * _Nullable __autoreleasing *)error;
+
+/**
+ Returns a document for the specified JSON text, whose values are created only when they are accessed.
+
+ The whole text is validated, and the structural index is kept with the document, along with the position after each array and object, so that values can be found without creating the values before them. No objects are created for the values of the text.
+
+ @param data The JSON text. Text encoded in UTF-16 or UTF-32 is converted to UTF-8 first.
+ @param options The options for creating the Foundation objects of the values accessed. For possible values, see the `NSJSONSerialization` documentation section "NSJSONReadingOptions".
+ @param error The error that occurred while validating the JSON text.
+
+ @return The document, or `nil` if the JSON text is malformed.
+ */
+- (nullable AFJSONDocument *)documentWithData:(NSData *)data
+                                      options:(NSJSONReadingOptions)options
+                                        error:(NSError * _Nullable __autoreleasing *)error;
+
+/**
+ Returns the model decoded from the specified JSON text, as described by a schema.
+
+ The members of JSON objects are assigned to the properties of models as they are found in the structural index, without creating dictionaries and arrays for the objects and arrays of the text on the way, and without creating `NSNumber` objects for numeric properties. Members without a property are skipped.
+
+ @param data The JSON text. Text encoded in UTF-16 or UTF-32 is converted to UTF-8 first.
+ @param schema The schema of the model, if the text is an object, or of the elements of the text, if it is an array.
+ @param error The error that occurred while decoding the JSON text. Values of the text not matching the schema fail with an error in `NSCocoaErrorDomain`, with the code `NSCoderReadCorruptError`, and the key paths of all of them in its `AFJSONModelMismatchesErrorKey`.
+
+ @return The model, an array of models if the text is an array, or `nil` if the JSON text is malformed or does not match the schema.
+ */
+- (nullable id)modelWithData:(NSData *)data
+                      schema:(AFJSONModelSchema *)schema
+                       error:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFJSONDocument` is an immutable handle on validated JSON text and its structural index, created by `-[AFJSONParser documentWithData:options:error:]`.
+
+ Values are created only when they are accessed, and only the value accessed is created: finding a value skips over whole arrays and objects before it using the structural index. Memory and time spent on a document therefore scale with the values read, rather than with the length of the text. Values are created anew each time they are accessed.
+
+ Documents may be accessed from any thread.
+ */
+@interface AFJSONDocument : NSObject <NSCopying>
+
+/**
+ The UTF-8 JSON text of the document.
+ */
+@property (readonly, nonatomic, copy) NSData *data;
+
+/**
+ The options the values of the document are created with.
+ */
+@property (readonly, nonatomic, assign) NSJSONReadingOptions readingOptions;
+
+/**
+ Whether keys with `NSNull` values, and `NSNull` elements of arrays, are left out of the values of the document, as by `AFJSONObjectByRemovingKeysWithNullValues`.
+ */
+@property (readonly, nonatomic, assign) BOOL removesKeysWithNullValues;
+
+/**
+ The value of the whole document, created each time this property is accessed.
+ */
+@property (readonly, nonatomic, strong) id JSONObject;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Returns the value at the specified key path.
+
+ @param keyPath The components of the key path, separated by periods. A component is a key of an object, or the decimal index of an element of an array. The empty key path is the whole document.
+
+ @return The value, or `nil` if the key path does not name a value.
+ */
+- (nullable id)objectForKeyPath:(NSString *)keyPath;
+
+/**
+ Returns the value at the specified key path, as `objectForKeyPath:` does, for subscripting.
+ */
+- (nullable id)objectForKeyedSubscript:(NSString *)keyPath;
+
+/**
+ Returns the value at the specified path. Unlike those of key paths, the keys of a path may contain periods.
+
+ @param path The components of the path, each an `NSString` key of an object, or an `NSNumber` index of an element of an array.
+
+ @return The value, or `nil` if the path does not name a value.
+ */
+- (nullable id)objectAtPath:(NSArray *)path;
+
+/**
+ Returns the number of elements or members of the array or object at the specified key path, without creating them.
+
+ @param keyPath The key path of the array or object.
+
+ @return The number of elements or members, or `NSNotFound` if the key path does not name an array or object.
+ */
+- (NSUInteger)countForKeyPath:(NSString *)keyPath;
+
+/**
+ Returns a document sharing the text and structural index of the receiver, which leaves keys with `NSNull` values, and `NSNull` elements of arrays, out of its values.
+ */
+- (AFJSONDocument *)documentByRemovingKeysWithNullValues;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFJSONModelSchema` describes how the members of JSON objects are assigned to the properties of a model class, for `-[AFJSONParser modelWithData:schema:error:]` and `AFJSONModelResponseSerializer`.
+
+ Schemas are compiled when they are created: the type and the setter of every property are looked up once, and values are assigned by calling the setters directly, rather than with key-value coding.
+
+ ## Property Types
+
+ - Integer and floating point types, and `BOOL`, are assigned numbers, and `true` or `false` as `1` or `0`. Integer properties are not assigned numbers with a fractional part, or outside of their range.
+ - `NSString` and `NSURL` properties are assigned strings.
+ - `NSNumber` properties are assigned numbers, `true` and `false`.
+ - Properties of a model class are assigned objects, decoded with the schema set for the property.
+ - `NSArray` properties are assigned arrays. Their elements are decoded with the schema set for the property if there is one, or created as Foundation objects otherwise.
+ - `NSDictionary` properties are assigned objects, and `id` properties any value, created as Foundation objects.
+
+ Properties of mutable classes are assigned mutable objects. Properties are left unassigned by `null` values, and assigned the last of duplicate keys. `null` elements of arrays decoded with a schema are left out.
+
+ Schemas should not be changed once they are used for decoding.
+ */
+@interface AFJSONModelSchema : NSObject <NSSecureCoding>
+
+/**
+ The class of the models. Models are created with `init`.
+ */
+@property (readonly, nonatomic, strong) Class modelClass;
+
+/**
+ The names of the properties of the models, by the keys of the members of JSON objects assigned to them.
+ */
+@property (readonly, nonatomic, copy) NSDictionary <NSString *, NSString *> *propertyNamesByJSONKey;
+
+/**
+ The schemas set for properties, by property name.
+ */
+@property (readonly, nonatomic, copy) NSDictionary <NSString *, AFJSONModelSchema *> *schemasByPropertyName;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Creates and returns a schema for the specified model class.
+
+ @param modelClass The class of the models.
+ @param propertyNamesByJSONKey The names of the properties of the models, by the keys of the members of JSON objects assigned to them. If `nil`, every read-write property of the class and its superclasses is assigned the member with its name.
+
+ @warning Properties must be read-write, and of one of the supported types.
+ */
++ (instancetype)schemaWithModelClass:(Class)modelClass
+              propertyNamesByJSONKey:(nullable NSDictionary <NSString *, NSString *> *)propertyNamesByJSONKey;
+
+/**
+ Sets the schema objects assigned to the specified property are decoded with, for properties of a model class, or the schema the elements of arrays assigned to the property are decoded with, for `NSArray` properties.
+
+ A schema may be set for its own properties, for models nested in models of the same class.
+
+ @param schema The schema.
+ @param propertyName The name of the property.
+ */
+- (void)setSchema:(AFJSONModelSchema *)schema
+  forPropertyName:(NSString *)propertyName;
+
+@end
+
+///----------------
+/// @name Constants
+///----------------
+
+/**
+ ## User info dictionary keys
+
+ These keys may exist in the user info dictionary, in addition to those defined for NSError.
+
+ - `NSString * const AFJSONModelMismatchesErrorKey`
+
+ ### Constants
+
+ `AFJSONModelMismatchesErrorKey`
+ The corresponding value is an `NSArray` of `NSString` descriptions of the values not matching a schema, each starting with the key path of the value. This key is only present in errors with the code `NSCoderReadCorruptError`.
+ */
+FOUNDATION_EXPORT NSString * const AFJSONModelMismatchesErrorKey;
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,2108 @@
+// AFJSONParser.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#import "AFJSONParser.h"
+#import "AFURLResponseSerialization.h"
+
+#import <objc/runtime.h>
+#import <sys/sysctl.h>
+#import <xlocale.h>
+
+#if defined(__SSE2__)
+#import <immintrin.h>
+#define AF_JSON_PARSER_SSE2 1
+#if defined(__clang__) || defined(__GNUC__)
+#define AF_JSON_PARSER_AVX2 1
+#endif
+#endif
+
+#if defined(__ARM_NEON) && (defined(__aarch64__) || defined(__arm64__))
+#import <arm_neon.h>
+#define AF_JSON_PARSER_NEON 1
+#endif
+
+static NSUInteger const AFJSONMaximumDepth = 512;
+static NSUInteger const AFJSONKeyCacheSize = 256;
+static NSUInteger const AFJSONMaximumCachedKeyLength = 32;
+
+#pragma mark - Structural Index
+
+// The characters of a 64 byte block of JSON text, one bit per byte
+typedef struct {
+    uint64_t quotes;
+    uint64_t backslashes;
+    uint64_t operators;
+    uint64_t whitespace;
+    uint64_t controlCharacters;
+} AFJSONBlockCharacters;
+
+typedef void (*AFJSONClassifyBlockFunction)(const uint8_t *block, AFJSONBlockCharacters *characters);
+
+static void AFJSONClassifyBlockScalar(const uint8_t *block, AFJSONBlockCharacters *characters) {
+    uint64_t quotes = 0, backslashes = 0, operators = 0, whitespace = 0, controlCharacters = 0;
+    for (unsigned int idx = 0; idx < 64; idx++) {
+        uint64_t bit = 1ULL << idx;
+        switch (block[idx]) {
+            case '"':
+                quotes |= bit;
+                break;
+            case '\\':
+                backslashes |= bit;
+                break;
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                operators |= bit;
+                break;
+            case ' ':
+                whitespace |= bit;
+                break;
+            case '\t': case '\n': case '\r':
+                whitespace |= bit;
+                controlCharacters |= bit;
+                break;
+            default:
+                if (block[idx] < 0x20) {
+                    controlCharacters |= bit;
+                }
+                break;
+        }
+    }
+
+    characters->quotes = quotes;
+    characters->backslashes = backslashes;
+    characters->operators = operators;
+    characters->whitespace = whitespace;
+    characters->controlCharacters = controlCharacters;
+}
+
+#ifdef AF_JSON_PARSER_SSE2
+static void AFJSONClassifyBlockSSE2(const uint8_t *block, AFJSONBlockCharacters *characters) {
+    // Setting bit 5 folds `[` and `]` into `{` and `}`, and no other byte into either
+    const __m128i bit5 = _mm_set1_epi8(0x20);
+    const __m128i lastControlCharacter = _mm_set1_epi8(0x1F);
+
+    memset(characters, 0, sizeof(AFJSONBlockCharacters));
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        __m128i input = _mm_loadu_si128((const __m128i *)(const void *)(block + lane * 16));
+        __m128i folded = _mm_or_si128(input, bit5);
+        __m128i operators = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}'))),
+                                         _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8(':')), _mm_cmpeq_epi8(input, _mm_set1_epi8(','))));
+        __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(input, _mm_set1_epi8('\t'))),
+                                          _mm_or_si128(_mm_cmpeq_epi8(input, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(input, _mm_set1_epi8('\r'))));
+        __m128i controlCharacters = _mm_cmpeq_epi8(_mm_min_epu8(input, lastControlCharacter), input);
+
+        unsigned int shift = lane * 16;
+        characters->quotes |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(input, _mm_set1_epi8('"'))) << shift;
+        characters->backslashes |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(input, _mm_set1_epi8('\\'))) << shift;
+        characters->operators |= (uint64_t)(uint16_t)_mm_movemask_epi8(operators) << shift;
+        characters->whitespace |= (uint64_t)(uint16_t)_mm_movemask_epi8(whitespace) << shift;
+        characters->controlCharacters |= (uint64_t)(uint16_t)_mm_movemask_epi8(controlCharacters) << shift;
+    }
+}
+#endif
+
+#ifdef AF_JSON_PARSER_AVX2
+__attribute__((target("avx2")))
+static void AFJSONClassifyBlockAVX2(const uint8_t *block, AFJSONBlockCharacters *characters) {
+    const __m256i bit5 = _mm256_set1_epi8(0x20);
+    const __m256i lastControlCharacter = _mm256_set1_epi8(0x1F);
+
+    memset(characters, 0, sizeof(AFJSONBlockCharacters));
+    for (unsigned int lane = 0; lane < 2; lane++) {
+        __m256i input = _mm256_loadu_si256((const __m256i *)(const void *)(block + lane * 32));
+        __m256i folded = _mm256_or_si256(input, bit5);
+        __m256i operators = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(folded, _mm256_set1_epi8('}'))),
+                                            _mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(input, _mm256_set1_epi8(','))));
+        __m256i whitespace = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\t'))),
+                                             _mm256_or_si256(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(input, _mm256_set1_epi8('\r'))));
+        __m256i controlCharacters = _mm256_cmpeq_epi8(_mm256_min_epu8(input, lastControlCharacter), input);
+
+        unsigned int shift = lane * 32;
+        characters->quotes |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('"'))) << shift;
+        characters->backslashes |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(input, _mm256_set1_epi8('\\'))) << shift;
+        characters->operators |= (uint64_t)(uint32_t)_mm256_movemask_epi8(operators) << shift;
+        characters->whitespace |= (uint64_t)(uint32_t)_mm256_movemask_epi8(whitespace) << shift;
+        characters->controlCharacters |= (uint64_t)(uint32_t)_mm256_movemask_epi8(controlCharacters) << shift;
+    }
+}
+
+static BOOL AFJSONProcessorSupportsAVX2(void) {
+    static BOOL supportsAVX2 = NO;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        int value = 0;
+        size_t size = sizeof(value);
+        supportsAVX2 = sysctlbyname("hw.optional.avx2_0", &value, &size, NULL, 0) == 0 && value != 0;
+    });
+
+    return supportsAVX2;
+}
+#endif
+
+#ifdef AF_JSON_PARSER_NEON
+// Packs the comparison results of 64 bytes into one bit per byte
+static inline uint64_t AFJSONNEONBitmask(uint8x16_t v0, uint8x16_t v1, uint8x16_t v2, uint8x16_t v3) {
+    const uint8x16_t bits = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+    uint8x16_t sum01 = vpaddq_u8(vandq_u8(v0, bits), vandq_u8(v1, bits));
+    uint8x16_t sum23 = vpaddq_u8(vandq_u8(v2, bits), vandq_u8(v3, bits));
+    uint8x16_t sum = vpaddq_u8(sum01, sum23);
+    sum = vpaddq_u8(sum, sum);
+
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum), 0);
+}
+
+static void AFJSONClassifyBlockNEON(const uint8_t *block, AFJSONBlockCharacters *characters) {
+    const uint8x16_t bit5 = vdupq_n_u8(0x20);
+    const uint8x16_t lastControlCharacter = vdupq_n_u8(0x1F);
+
+    uint8x16_t quotes[4], backslashes[4], operators[4], whitespace[4], controlCharacters[4];
+    for (unsigned int lane = 0; lane < 4; lane++) {
+        uint8x16_t input = vld1q_u8(block + lane * 16);
+        uint8x16_t folded = vorrq_u8(input, bit5);
+        quotes[lane] = vceqq_u8(input, vdupq_n_u8('"'));
+        backslashes[lane] = vceqq_u8(input, vdupq_n_u8('\\'));
+        operators[lane] = vorrq_u8(vorrq_u8(vceqq_u8(folded, vdupq_n_u8('{')), vceqq_u8(folded, vdupq_n_u8('}'))),
+                                   vorrq_u8(vceqq_u8(input, vdupq_n_u8(':')), vceqq_u8(input, vdupq_n_u8(','))));
+        whitespace[lane] = vorrq_u8(vorrq_u8(vceqq_u8(input, vdupq_n_u8(' ')), vceqq_u8(input, vdupq_n_u8('\t'))),
+                                    vorrq_u8(vceqq_u8(input, vdupq_n_u8('\n')), vceqq_u8(input, vdupq_n_u8('\r'))));
+        controlCharacters[lane] = vcleq_u8(input, lastControlCharacter);
+    }
+
+    characters->quotes = AFJSONNEONBitmask(quotes[0], quotes[1], quotes[2], quotes[3]);
+    characters->backslashes = AFJSONNEONBitmask(backslashes[0], backslashes[1], backslashes[2], backslashes[3]);
+    characters->operators = AFJSONNEONBitmask(operators[0], operators[1], operators[2], operators[3]);
+    characters->whitespace = AFJSONNEONBitmask(whitespace[0], whitespace[1], whitespace[2], whitespace[3]);
+    characters->controlCharacters = AFJSONNEONBitmask(controlCharacters[0], controlCharacters[1], controlCharacters[2], controlCharacters[3]);
+}
+#endif
+
+static AFJSONClassifyBlockFunction AFJSONClassifyBlockFunctionForInstructionSet(AFJSONParserInstructionSet instructionSet) {
+    switch (instructionSet) {
+        case AFJSONParserInstructionSetScalar:
+            return AFJSONClassifyBlockScalar;
+#ifdef AF_JSON_PARSER_SSE2
+        case AFJSONParserInstructionSetSSE2:
+            return AFJSONClassifyBlockSSE2;
+#endif
+#ifdef AF_JSON_PARSER_AVX2
+        case AFJSONParserInstructionSetAVX2:
+            return AFJSONProcessorSupportsAVX2() ? AFJSONClassifyBlockAVX2 : NULL;
+#endif
+#ifdef AF_JSON_PARSER_NEON
+        case AFJSONParserInstructionSetNEON:
+            return AFJSONClassifyBlockNEON;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+// Returns the characters escaped by an odd number of backslashes, carrying whether the first character of the next block is escaped
+static inline uint64_t AFJSONEscapedCharacters(uint64_t backslashes, uint64_t *previousEscaped) {
+    const uint64_t evenBits = 0x5555555555555555ULL;
+
+    backslashes &= ~*previousEscaped;
+    uint64_t followsEscape = (backslashes << 1) | *previousEscaped;
+
+    // Adding the first backslash of each sequence starting on an odd bit carries past the end of the sequence, leaving the sequences starting on even bits in place
+    uint64_t oddSequenceStarts = backslashes & ~evenBits & ~followsEscape;
+    uint64_t sequencesStartingOnEvenBits = 0;
+    *previousEscaped = __builtin_add_overflow(oddSequenceStarts, backslashes, &sequencesStartingOnEvenBits) ? 1 : 0;
+    uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+
+    return (evenBits ^ invertMask) & followsEscape;
+}
+
+// Sets every bit from each set bit up to, but not including, the next set bit
+static inline uint64_t AFJSONPrefixXOR(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+
+    return bits;
+}
+
+/**
+ Writes the offsets of the structural characters of `bytes` to `offsets`, which has room for `length` offsets: the operators outside of strings, both quotes of every string, and the first character of every other value.
+
+ @return `NULL`, or the reason the text is malformed, with `errorOffset` set to the offending character.
+ */
+static const char * AFJSONIndexStructuralCharacters(const uint8_t *bytes, NSUInteger length, AFJSONClassifyBlockFunction classifyBlock, uint32_t *offsets, NSUInteger *count, NSUInteger *errorOffset) {
+    uint64_t previousEscaped = 0, previousInString = 0, previousScalar = 0;
+    NSUInteger numberOfOffsets = 0;
+    uint8_t lastBlock[64];
+
+    for (NSUInteger blockOffset = 0; blockOffset < length; blockOffset += 64) {
+        const uint8_t *block = bytes + blockOffset;
+        if (length - blockOffset < 64) {
+            memset(lastBlock, ' ', sizeof(lastBlock));
+            memcpy(lastBlock, block, length - blockOffset);
+            block = lastBlock;
+        }
+
+        AFJSONBlockCharacters characters;
+        classifyBlock(block, &characters);
+
+        uint64_t quotes = characters.quotes & ~AFJSONEscapedCharacters(characters.backslashes, &previousEscaped);
+        uint64_t inString = AFJSONPrefixXOR(quotes) ^ previousInString;
+        previousInString = (uint64_t)((int64_t)inString >> 63);
+
+        uint64_t unescapedControlCharacters = characters.controlCharacters & inString;
+        if (unescapedControlCharacters) {
+            *errorOffset = blockOffset + (NSUInteger)__builtin_ctzll(unescapedControlCharacters);
+            return "Unescaped control character";
+        }
+
+        uint64_t scalars = ~(characters.operators | characters.whitespace | quotes | inString);
+        uint64_t scalarStarts = scalars & ~((scalars << 1) | previousScalar);
+        previousScalar = scalars >> 63;
+
+        uint64_t structurals = (characters.operators & ~inString) | quotes | scalarStarts;
+        while (structurals) {
+            offsets[numberOfOffsets++] = (uint32_t)(blockOffset + (NSUInteger)__builtin_ctzll(structurals));
+            structurals &= structurals - 1;
+        }
+    }
+
+    if (previousInString) {
+        *errorOffset = length;
+        return "Unterminated string";
+    }
+
+    *count = numberOfOffsets;
+
+    return NULL;
+}
+
+#pragma mark - Scalars
+
+static inline BOOL AFJSONIsWhitespace(uint8_t character) {
+    return character == ' ' || character == '\t' || character == '\n' || character == '\r';
+}
+
+static inline BOOL AFJSONIsDigit(uint8_t character) {
+    return character >= '0' && character <= '9';
+}
+
+static BOOL AFJSONParseHexQuad(const uint8_t *bytes, NSUInteger length, uint32_t *value) {
+    if (length < 4) {
+        return NO;
+    }
+
+    uint32_t result = 0;
+    for (NSUInteger idx = 0; idx < 4; idx++) {
+        uint8_t character = bytes[idx];
+        uint32_t digit;
+        if (AFJSONIsDigit(character)) {
+            digit = (uint32_t)(character - '0');
+        } else if (character >= 'a' && character <= 'f') {
+            digit = (uint32_t)(character - 'a' + 10);
+        } else if (character >= 'A' && character <= 'F') {
+            digit = (uint32_t)(character - 'A' + 10);
+        } else {
+            return NO;
+        }
+        result = (result << 4) | digit;
+    }
+    *value = result;
+
+    return YES;
+}
+
+static NSUInteger AFJSONEncodeUTF8(uint32_t codePoint, uint8_t *buffer) {
+    if (codePoint < 0x80) {
+        buffer[0] = (uint8_t)codePoint;
+        return 1;
+    } else if (codePoint < 0x800) {
+        buffer[0] = (uint8_t)(0xC0 | (codePoint >> 6));
+        buffer[1] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 2;
+    } else if (codePoint < 0x10000) {
+        buffer[0] = (uint8_t)(0xE0 | (codePoint >> 12));
+        buffer[1] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+        buffer[2] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 3;
+    } else {
+        buffer[0] = (uint8_t)(0xF0 | (codePoint >> 18));
+        buffer[1] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+        buffer[2] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+        buffer[3] = (uint8_t)(0x80 | (codePoint & 0x3F));
+        return 4;
+    }
+}
+
+/**
+ Decodes the escape sequences of the contents of a string into `buffer`, which has room for `length` bytes; no escape sequence is shorter than the UTF-8 it decodes to.
+
+ @return The length of the decoded string, or `NSNotFound`, with `errorOffset` set to the malformed escape sequence.
+ */
+static NSUInteger AFJSONUnescapeString(const uint8_t *bytes, NSUInteger length, uint8_t *buffer, NSUInteger *errorOffset) {
+    NSUInteger idx = 0, bufferLength = 0;
+    while (idx < length) {
+        const uint8_t *backslash = memchr(bytes + idx, '\\', length - idx);
+        NSUInteger runLength = (backslash ? (NSUInteger)(backslash - bytes) : length) - idx;
+        memcpy(buffer + bufferLength, bytes + idx, runLength);
+        bufferLength += runLength;
+        idx += runLength;
+        if (!backslash) {
+            break;
+        }
+
+        *errorOffset = idx;
+        if (idx + 1 >= length) {
+            return NSNotFound;
+        }
+
+        uint8_t escape = bytes[idx + 1];
+        idx += 2;
+        switch (escape) {
+            case '"': case '\\': case '/':
+                buffer[bufferLength++] = escape;
+                break;
+            case 'b':
+                buffer[bufferLength++] = '\b';
+                break;
+            case 'f':
+                buffer[bufferLength++] = '\f';
+                break;
+            case 'n':
+                buffer[bufferLength++] = '\n';
+                break;
+            case 'r':
+                buffer[bufferLength++] = '\r';
+                break;
+            case 't':
+                buffer[bufferLength++] = '\t';
+                break;
+            case 'u': {
+                uint32_t codePoint = 0;
+                if (!AFJSONParseHexQuad(bytes + idx, length - idx, &codePoint)) {
+                    return NSNotFound;
+                }
+                idx += 4;
+
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    uint32_t lowSurrogate = 0;
+                    if (idx + 6 > length || bytes[idx] != '\\' || bytes[idx + 1] != 'u' || !AFJSONParseHexQuad(bytes + idx + 2, length - idx - 2, &lowSurrogate) || lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF) {
+                        return NSNotFound;
+                    }
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                    idx += 6;
+                } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    return NSNotFound;
+                }
+
+                bufferLength += AFJSONEncodeUTF8(codePoint, buffer + bufferLength);
+                break;
+            }
+            default:
+                return NSNotFound;
+        }
+    }
+
+    return bufferLength;
+}
+
+static locale_t AFJSONNumericLocale(void) {
+    static locale_t locale = NULL;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        locale = newlocale(LC_NUMERIC_MASK, "C", NULL);
+    });
+
+    return locale;
+}
+
+// The decimal digits of a number, with up to 19 significant digits in `mantissa`
+typedef struct {
+    BOOL negative;
+    BOOL isInteger;
+    BOOL mantissaOverflowed;
+    uint64_t mantissa;
+    int64_t exponent;
+} AFJSONNumberComponents;
+
+// Returns whether a token matches the JSON number grammar
+static BOOL AFJSONScanNumber(const uint8_t *token, NSUInteger length, AFJSONNumberComponents *components) {
+    NSUInteger idx = 0;
+    BOOL negative = token[0] == '-';
+    if (negative) {
+        idx++;
+    }
+
+    uint64_t mantissa = 0;
+    BOOL mantissaOverflowed = NO;
+    int64_t exponent = 0;
+    BOOL isInteger = YES;
+
+    if (idx < length && token[idx] == '0') {
+        idx++;
+    } else if (idx < length && token[idx] >= '1' && token[idx] <= '9') {
+        for (; idx < length && AFJSONIsDigit(token[idx]); idx++) {
+            if (mantissa <= (UINT64_MAX - 9) / 10) {
+                mantissa = mantissa * 10 + (uint64_t)(token[idx] - '0');
+            } else {
+                mantissaOverflowed = YES;
+                exponent++;
+            }
+        }
+    } else {
+        return NO;
+    }
+
+    if (idx < length && token[idx] == '.') {
+        isInteger = NO;
+        idx++;
+        if (idx >= length || !AFJSONIsDigit(token[idx])) {
+            return NO;
+        }
+        for (; idx < length && AFJSONIsDigit(token[idx]); idx++) {
+            if (mantissa <= (UINT64_MAX - 9) / 10) {
+                mantissa = mantissa * 10 + (uint64_t)(token[idx] - '0');
+                exponent--;
+            } else {
+                mantissaOverflowed = YES;
+            }
+        }
+    }
+
+    if (idx < length && (token[idx] == 'e' || token[idx] == 'E')) {
+        isInteger = NO;
+        idx++;
+        BOOL negativeExponent = NO;
+        if (idx < length && (token[idx] == '+' || token[idx] == '-')) {
+            negativeExponent = token[idx] == '-';
+            idx++;
+        }
+        if (idx >= length || !AFJSONIsDigit(token[idx])) {
+            return NO;
+        }
+        int64_t explicitExponent = 0;
+        for (; idx < length && AFJSONIsDigit(token[idx]); idx++) {
+            if (explicitExponent < 100000) {
+                explicitExponent = explicitExponent * 10 + (token[idx] - '0');
+            }
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    components->negative = negative;
+    components->isInteger = isInteger;
+    components->mantissaOverflowed = mantissaOverflowed;
+    components->mantissa = mantissa;
+    components->exponent = exponent;
+
+    return idx == length;
+}
+
+/**
+ Returns the value of a number token scanned by `AFJSONScanNumber`, as a double.
+
+ Numbers with up to 15 significant digits and a small exponent are exactly the product or quotient of two doubles, and the rest are converted by `strtod_l`.
+ */
+static double AFJSONDoubleValueOfNumber(const uint8_t *token, NSUInteger length, const AFJSONNumberComponents *components) {
+    static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    uint64_t mantissa = components->mantissa;
+    int64_t exponent = components->exponent;
+    if (!components->mantissaOverflowed && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        double value = (double)mantissa;
+        value = exponent < 0 ? value / powersOfTen[-exponent] : value * powersOfTen[exponent];
+        return components->negative ? -value : value;
+    }
+
+    char stackBuffer[64];
+    char *buffer = length < sizeof(stackBuffer) ? stackBuffer : malloc(length + 1);
+    memcpy(buffer, token, length);
+    buffer[length] = '\0';
+    double value = strtod_l(buffer, NULL, AFJSONNumericLocale());
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+
+    return value;
+}
+
+// Returns the number for a token matching the JSON number grammar, or `nil`. Integers are created from their 64-bit value.
+static NSNumber * AFJSONCreateNumber(const uint8_t *token, NSUInteger length) {
+    AFJSONNumberComponents components;
+    if (!AFJSONScanNumber(token, length, &components)) {
+        return nil;
+    }
+
+    uint64_t mantissa = components.mantissa;
+    if (components.isInteger && !components.mantissaOverflowed) {
+        if (!components.negative) {
+            return mantissa <= (uint64_t)LLONG_MAX ? @((long long)mantissa) : @((unsigned long long)mantissa);
+        } else if (mantissa <= (uint64_t)LLONG_MAX) {
+            return @(-(long long)mantissa);
+        } else if (mantissa == (uint64_t)LLONG_MAX + 1) {
+            return @(LLONG_MIN);
+        }
+    }
+
+    return @(AFJSONDoubleValueOfNumber(token, length, &components));
+}
+
+// Returns whether a UTF-8 sequence is well formed, without overlong encodings or surrogates
+static BOOL AFJSONIsValidUTF8(const uint8_t *bytes, NSUInteger length, NSUInteger *errorOffset) {
+    NSUInteger idx = 0;
+    while (idx < length) {
+        if (idx + 8 <= length) {
+            uint64_t word;
+            memcpy(&word, bytes + idx, sizeof(word));
+            if ((word & 0x8080808080808080ULL) == 0) {
+                idx += 8;
+                continue;
+            }
+        }
+
+        uint8_t byte = bytes[idx];
+        if (byte < 0x80) {
+            idx++;
+            continue;
+        }
+
+        NSUInteger sequenceLength;
+        uint32_t codePoint, minimumCodePoint;
+        if ((byte & 0xE0) == 0xC0) {
+            sequenceLength = 2;
+            codePoint = byte & 0x1F;
+            minimumCodePoint = 0x80;
+        } else if ((byte & 0xF0) == 0xE0) {
+            sequenceLength = 3;
+            codePoint = byte & 0x0F;
+            minimumCodePoint = 0x800;
+        } else if ((byte & 0xF8) == 0xF0) {
+            sequenceLength = 4;
+            codePoint = byte & 0x07;
+            minimumCodePoint = 0x10000;
+        } else {
+            *errorOffset = idx;
+            return NO;
+        }
+
+        if (idx + sequenceLength > length) {
+            *errorOffset = idx;
+            return NO;
+        }
+        for (NSUInteger continuation = 1; continuation < sequenceLength; continuation++) {
+            uint8_t continuationByte = bytes[idx + continuation];
+            if ((continuationByte & 0xC0) != 0x80) {
+                *errorOffset = idx;
+                return NO;
+            }
+            codePoint = (codePoint << 6) | (continuationByte & 0x3F);
+        }
+        if (codePoint < minimumCodePoint || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            *errorOffset = idx;
+            return NO;
+        }
+
+        idx += sequenceLength;
+    }
+
+    return YES;
+}
+
+#pragma mark - Object Creation
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+} AFJSONKeyCacheEntry;
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    const uint32_t *offsets;
+    NSUInteger count;
+    NSUInteger position;
+    NSJSONReadingOptions options;
+
+    // The values and keys of the arrays and objects being created, from the outermost to the innermost
+    __strong id *values;
+    NSUInteger numberOfValues;
+    NSUInteger valuesCapacity;
+    __strong id *keys;
+    NSUInteger numberOfKeys;
+    NSUInteger keysCapacity;
+
+    // Short keys without escape sequences, by a hash of their bytes
+    __strong id *cachedKeys;
+    AFJSONKeyCacheEntry *keyCacheEntries;
+
+    // When validating only, no objects are created, and the position after each array and object is written to `ends`, at the position of its opening character
+    BOOL validatesOnly;
+    uint32_t *ends;
+
+    const char *errorReason;
+    NSUInteger errorOffset;
+} AFJSONObjectBuilder;
+
+static id AFJSONBuilderFail(AFJSONObjectBuilder *builder, const char *reason, NSUInteger offset) {
+    builder->errorReason = reason;
+    builder->errorOffset = offset;
+
+    return nil;
+}
+
+static inline uint8_t AFJSONBuilderCurrentCharacter(AFJSONObjectBuilder *builder) {
+    return builder->position < builder->count ? builder->bytes[builder->offsets[builder->position]] : 0;
+}
+
+static inline NSUInteger AFJSONBuilderCurrentOffset(AFJSONObjectBuilder *builder) {
+    return builder->position < builder->count ? builder->offsets[builder->position] : builder->length;
+}
+
+static void AFJSONBuilderPush(__strong id **stack, NSUInteger *count, NSUInteger *capacity, id object) {
+    if (*count == *capacity) {
+        NSUInteger newCapacity = MAX(*capacity * 2, (NSUInteger)64);
+        *stack = (__strong id *)realloc(*stack, newCapacity * sizeof(id));
+        memset(*stack + *capacity, 0, (newCapacity - *capacity) * sizeof(id));
+        *capacity = newCapacity;
+    }
+
+    (*stack)[(*count)++] = object;
+}
+
+static void AFJSONBuilderPop(__strong id *stack, NSUInteger *count, NSUInteger base) {
+    for (NSUInteger idx = base; idx < *count; idx++) {
+        stack[idx] = nil;
+    }
+    *count = base;
+}
+
+static id AFJSONBuildValue(AFJSONObjectBuilder *builder, NSUInteger depth);
+
+// Returns the position after the value at `position`, skipping over arrays and objects with the `ends` of a validated text
+static inline NSUInteger AFJSONPositionAfterValue(const uint8_t *bytes, const uint32_t *offsets, const uint32_t *ends, NSUInteger position) {
+    switch (bytes[offsets[position]]) {
+        case '{': case '[':
+            return ends[position];
+        case '"':
+            return position + 2;
+        default:
+            return position + 1;
+    }
+}
+
+static id AFJSONBuildString(AFJSONObjectBuilder *builder, BOOL isKey) {
+    NSUInteger start = builder->offsets[builder->position] + 1;
+    NSUInteger end = builder->offsets[builder->position + 1];
+    builder->position += 2;
+
+    const uint8_t *bytes = builder->bytes + start;
+    NSUInteger length = end - start;
+    BOOL hasEscapeSequences = memchr(bytes, '\\', length) != NULL;
+    if (builder->validatesOnly && !hasEscapeSequences) {
+        return [NSNull null];
+    }
+    Class stringClass = (!isKey && (builder->options & NSJSONReadingMutableLeaves)) ? [NSMutableString class] : [NSString class];
+
+    if (!hasEscapeSequences) {
+        AFJSONKeyCacheEntry *entry = NULL;
+        NSUInteger hash = 0;
+        if (isKey && length <= AFJSONMaximumCachedKeyLength) {
+            // FNV-1a
+            uint32_t fnv = 2166136261U;
+            for (NSUInteger idx = 0; idx < length; idx++) {
+                fnv = (fnv ^ bytes[idx]) * 16777619U;
+            }
+            hash = fnv & (AFJSONKeyCacheSize - 1);
+            entry = &builder->keyCacheEntries[hash];
+            if (builder->cachedKeys[hash] && entry->length == length && memcmp(entry->bytes, bytes, length) == 0) {
+                return builder->cachedKeys[hash];
+            }
+        }
+
+        NSString *string = [[stringClass alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+        if (!string) {
+            return AFJSONBuilderFail(builder, "Unable to convert data to string", start - 1);
+        }
+
+        if (entry) {
+            entry->bytes = bytes;
+            entry->length = length;
+            builder->cachedKeys[hash] = string;
+        }
+
+        return string;
+    }
+
+    uint8_t stackBuffer[256];
+    uint8_t *buffer = length <= sizeof(stackBuffer) ? stackBuffer : malloc(length);
+    NSUInteger errorOffset = 0;
+    NSUInteger unescapedLength = AFJSONUnescapeString(bytes, length, buffer, &errorOffset);
+    id string = nil;
+    if (unescapedLength != NSNotFound) {
+        string = builder->validatesOnly ? [NSNull null] : [[stringClass alloc] initWithBytes:buffer length:unescapedLength encoding:NSUTF8StringEncoding];
+        errorOffset = 0;
+    }
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+
+    if (!string) {
+        return AFJSONBuilderFail(builder, unescapedLength == NSNotFound ? "Invalid escape sequence" : "Unable to convert data to string", start + errorOffset);
+    }
+
+    return string;
+}
+
+static id AFJSONBuildArray(AFJSONObjectBuilder *builder, NSUInteger depth) {
+    NSUInteger start = builder->position;
+    builder->position++;
+
+    NSUInteger base = builder->numberOfValues;
+    if (AFJSONBuilderCurrentCharacter(builder) == ']') {
+        builder->position++;
+    } else {
+        for (;;) {
+            id value = AFJSONBuildValue(builder, depth + 1);
+            if (!value) {
+                return nil;
+            }
+            if (!builder->validatesOnly) {
+                AFJSONBuilderPush(&builder->values, &builder->numberOfValues, &builder->valuesCapacity, value);
+            }
+
+            uint8_t character = AFJSONBuilderCurrentCharacter(builder);
+            if (character == ',') {
+                builder->position++;
+            } else if (character == ']') {
+                builder->position++;
+                break;
+            } else {
+                return AFJSONBuilderFail(builder, "Badly formed array", AFJSONBuilderCurrentOffset(builder));
+            }
+        }
+    }
+
+    if (builder->validatesOnly) {
+        builder->ends[start] = (uint32_t)builder->position;
+        return [NSNull null];
+    }
+
+    NSUInteger count = builder->numberOfValues - base;
+    Class arrayClass = (builder->options & NSJSONReadingMutableContainers) ? [NSMutableArray class] : [NSArray class];
+    NSArray *array = [arrayClass arrayWithObjects:builder->values + base count:count];
+    AFJSONBuilderPop(builder->values, &builder->numberOfValues, base);
+
+    return array;
+}
+
+static id AFJSONBuildObject(AFJSONObjectBuilder *builder, NSUInteger depth) {
+    NSUInteger start = builder->position;
+    builder->position++;
+
+    NSUInteger keyBase = builder->numberOfKeys;
+    NSUInteger valueBase = builder->numberOfValues;
+    if (AFJSONBuilderCurrentCharacter(builder) == '}') {
+        builder->position++;
+    } else {
+        for (;;) {
+            if (AFJSONBuilderCurrentCharacter(builder) != '"') {
+                return AFJSONBuilderFail(builder, "No string key for value in object", AFJSONBuilderCurrentOffset(builder));
+            }
+            id key = AFJSONBuildString(builder, YES);
+            if (!key) {
+                return nil;
+            }
+
+            if (AFJSONBuilderCurrentCharacter(builder) != ':') {
+                return AFJSONBuilderFail(builder, "No value for key in object", AFJSONBuilderCurrentOffset(builder));
+            }
+            builder->position++;
+
+            id value = AFJSONBuildValue(builder, depth + 1);
+            if (!value) {
+                return nil;
+            }
+            if (!builder->validatesOnly) {
+                AFJSONBuilderPush(&builder->keys, &builder->numberOfKeys, &builder->keysCapacity, key);
+                AFJSONBuilderPush(&builder->values, &builder->numberOfValues, &builder->valuesCapacity, value);
+            }
+
+            uint8_t character = AFJSONBuilderCurrentCharacter(builder);
+            if (character == ',') {
+                builder->position++;
+            } else if (character == '}') {
+                builder->position++;
+                break;
+            } else {
+                return AFJSONBuilderFail(builder, "Badly formed object", AFJSONBuilderCurrentOffset(builder));
+            }
+        }
+    }
+
+    if (builder->validatesOnly) {
+        builder->ends[start] = (uint32_t)builder->position;
+        return [NSNull null];
+    }
+
+    NSUInteger count = builder->numberOfValues - valueBase;
+    BOOL mutableContainers = (builder->options & NSJSONReadingMutableContainers) != 0;
+    Class dictionaryClass = mutableContainers ? [NSMutableDictionary class] : [NSDictionary class];
+    NSDictionary *dictionary = [dictionaryClass dictionaryWithObjects:builder->values + valueBase forKeys:builder->keys + keyBase count:count];
+    if ([dictionary count] != count) {
+        // Like `NSJSONSerialization`, the last of duplicate keys wins
+        NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionaryWithCapacity:count];
+        for (NSUInteger idx = 0; idx < count; idx++) {
+            mutableDictionary[builder->keys[keyBase + idx]] = builder->values[valueBase + idx];
+        }
+        dictionary = mutableContainers ? mutableDictionary : [mutableDictionary copy];
+    }
+    AFJSONBuilderPop(builder->keys, &builder->numberOfKeys, keyBase);
+    AFJSONBuilderPop(builder->values, &builder->numberOfValues, valueBase);
+
+    return dictionary;
+}
+
+// Returns the length of the number or literal at `position`, which runs up to the next structural character, less any whitespace
+static inline NSUInteger AFJSONBuilderScalarLength(AFJSONObjectBuilder *builder, NSUInteger position) {
+    NSUInteger start = builder->offsets[position];
+    NSUInteger end = position + 1 < builder->count ? builder->offsets[position + 1] : builder->length;
+    while (end > start && AFJSONIsWhitespace(builder->bytes[end - 1])) {
+        end--;
+    }
+
+    return end - start;
+}
+
+static id AFJSONBuildScalar(AFJSONObjectBuilder *builder) {
+    NSUInteger start = builder->offsets[builder->position];
+    NSUInteger length = AFJSONBuilderScalarLength(builder, builder->position);
+    builder->position++;
+
+    const uint8_t *token = builder->bytes + start;
+    switch (token[0]) {
+        case 't':
+            if (length == 4 && memcmp(token, "true", 4) == 0) {
+                return @YES;
+            }
+            break;
+        case 'f':
+            if (length == 5 && memcmp(token, "false", 5) == 0) {
+                return @NO;
+            }
+            break;
+        case 'n':
+            if (length == 4 && memcmp(token, "null", 4) == 0) {
+                return [NSNull null];
+            }
+            break;
+        default: {
+            if (builder->validatesOnly) {
+                AFJSONNumberComponents components;
+                if (AFJSONScanNumber(token, length, &components)) {
+                    return [NSNull null];
+                }
+                break;
+            }
+
+            NSNumber *number = AFJSONCreateNumber(token, length);
+            if (number) {
+                return number;
+            }
+            break;
+        }
+    }
+
+    return AFJSONBuilderFail(builder, "Invalid value", start);
+}
+
+static id AFJSONBuildValue(AFJSONObjectBuilder *builder, NSUInteger depth) {
+    if (builder->position >= builder->count) {
+        return AFJSONBuilderFail(builder, "Unexpected end of file", builder->length);
+    }
+
+    switch (AFJSONBuilderCurrentCharacter(builder)) {
+        case '{':
+        case '[':
+            if (depth >= AFJSONMaximumDepth) {
+                return AFJSONBuilderFail(builder, "Too many nested arrays or dictionaries", AFJSONBuilderCurrentOffset(builder));
+            }
+            return AFJSONBuilderCurrentCharacter(builder) == '{' ? AFJSONBuildObject(builder, depth) : AFJSONBuildArray(builder, depth);
+        case '"':
+            return AFJSONBuildString(builder, NO);
+        case '}': case ']': case ':': case ',':
+            return AFJSONBuilderFail(builder, "Invalid value", AFJSONBuilderCurrentOffset(builder));
+        default:
+            return AFJSONBuildScalar(builder);
+    }
+}
+
+static void AFJSONBuilderInitialize(AFJSONObjectBuilder *builder, const uint8_t *bytes, NSUInteger length, const uint32_t *offsets, NSUInteger count, NSJSONReadingOptions options) {
+    memset(builder, 0, sizeof(AFJSONObjectBuilder));
+    builder->bytes = bytes;
+    builder->length = length;
+    builder->offsets = offsets;
+    builder->count = count;
+    builder->options = options;
+    builder->cachedKeys = (__strong id *)calloc(AFJSONKeyCacheSize, sizeof(id));
+    builder->keyCacheEntries = calloc(AFJSONKeyCacheSize, sizeof(AFJSONKeyCacheEntry));
+}
+
+static void AFJSONBuilderDestroy(AFJSONObjectBuilder *builder) {
+    // Values left by a failure are released before the buffers holding them are freed
+    AFJSONBuilderPop(builder->values, &builder->numberOfValues, 0);
+    AFJSONBuilderPop(builder->keys, &builder->numberOfKeys, 0);
+    NSUInteger numberOfCachedKeys = AFJSONKeyCacheSize;
+    AFJSONBuilderPop(builder->cachedKeys, &numberOfCachedKeys, 0);
+    free(builder->values);
+    free(builder->keys);
+    free(builder->cachedKeys);
+    free(builder->keyCacheEntries);
+}
+
+// Builds the value of the whole text, which must be a single array or object unless fragments are allowed
+static id AFJSONBuildText(AFJSONObjectBuilder *builder) {
+    if (builder->count == 0) {
+        return AFJSONBuilderFail(builder, "No value", 0);
+    }
+
+    uint8_t character = AFJSONBuilderCurrentCharacter(builder);
+    if (!(builder->options & NSJSONReadingAllowFragments) && character != '{' && character != '[') {
+        return AFJSONBuilderFail(builder, "JSON text did not start with array or object and option to allow fragments not set", 0);
+    }
+
+    id object = AFJSONBuildValue(builder, 0);
+    if (object && builder->position != builder->count) {
+        return AFJSONBuilderFail(builder, "Garbage at end", builder->offsets[builder->position]);
+    }
+
+    return object;
+}
+
+static id AFJSONObjectWithStructuralIndex(const uint8_t *bytes, NSUInteger length, const uint32_t *offsets, NSUInteger count, NSJSONReadingOptions options, const char **errorReason, NSUInteger *errorOffset) {
+    AFJSONObjectBuilder builder;
+    AFJSONBuilderInitialize(&builder, bytes, length, offsets, count, options);
+    id object = AFJSONBuildText(&builder);
+    AFJSONBuilderDestroy(&builder);
+
+    *errorReason = builder.errorReason;
+    *errorOffset = builder.errorOffset;
+
+    return object;
+}
+
+#pragma mark -
+
+// RFC 4627: the first two characters are ASCII, so the encoding of the text is told by the pattern of zero bytes among its first four
+static BOOL AFJSONDataIsUTF8(const uint8_t *bytes, NSUInteger length) {
+    if (length >= 2 && ((bytes[0] == 0xFE && bytes[1] == 0xFF) || (bytes[0] == 0xFF && bytes[1] == 0xFE))) {
+        return NO;
+    }
+
+    for (NSUInteger idx = 0; idx < MIN(length, (NSUInteger)4); idx++) {
+        if (bytes[idx] == 0) {
+            return NO;
+        }
+    }
+
+    return YES;
+}
+
+static NSError * AFJSONParserError(const char *reason, NSUInteger offset) {
+    NSString *description = [NSString stringWithFormat:@"%s around character %lu.", reason, (unsigned long)offset];
+
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:@{@"NSDebugDescription": description}];
+}
+
+// RFC 4627: UTF-16 and UTF-32 are told apart by the zero bytes around the first character
+static NSStringEncoding AFJSONUnicodeEncodingOfData(const uint8_t *bytes, NSUInteger length) {
+    if (length >= 4 && bytes[0] == 0 && bytes[1] == 0) {
+        return bytes[2] == 0xFE ? NSUTF32StringEncoding : NSUTF32BigEndianStringEncoding;
+    } else if (length >= 4 && bytes[2] == 0 && bytes[3] == 0 && (bytes[0] != 0xFF || bytes[1] != 0xFE)) {
+        return NSUTF32LittleEndianStringEncoding;
+    } else if (length >= 4 && bytes[0] == 0xFF && bytes[1] == 0xFE && bytes[2] == 0 && bytes[3] == 0) {
+        return NSUTF32StringEncoding;
+    } else if (length >= 2 && ((bytes[0] == 0xFE && bytes[1] == 0xFF) || (bytes[0] == 0xFF && bytes[1] == 0xFE))) {
+        return NSUTF16StringEncoding;
+    }
+
+    return bytes[0] == 0 ? NSUTF16BigEndianStringEncoding : NSUTF16LittleEndianStringEncoding;
+}
+
+static inline BOOL AFJSONStringEqualsBytes(const uint8_t *string, NSUInteger length, const uint8_t *bytes, NSUInteger bytesLength) {
+    if (!memchr(string, '\\', length)) {
+        return length == bytesLength && memcmp(string, bytes, length) == 0;
+    } else if (length < bytesLength) {
+        return NO;
+    }
+
+    uint8_t stackBuffer[256];
+    uint8_t *buffer = length <= sizeof(stackBuffer) ? stackBuffer : malloc(length);
+    NSUInteger errorOffset = 0;
+    NSUInteger unescapedLength = AFJSONUnescapeString(string, length, buffer, &errorOffset);
+    BOOL isEqual = unescapedLength == bytesLength && memcmp(buffer, bytes, bytesLength) == 0;
+    if (buffer != stackBuffer) {
+        free(buffer);
+    }
+
+    return isEqual;
+}
+
+// Validated JSON text, with the offsets of its structural characters, and the position after each array and object
+@interface AFJSONStructuralIndex : NSObject
+@property (readonly, nonatomic, strong) NSData *data;
+@property (readonly, nonatomic, assign) const uint8_t *bytes;
+@property (readonly, nonatomic, assign) NSUInteger length;
+@property (readonly, nonatomic, assign) uint32_t *offsets;
+@property (readonly, nonatomic, assign) uint32_t *ends;
+@property (readonly, nonatomic, assign) NSUInteger count;
+
+- (instancetype)initWithData:(NSData *)data
+                       bytes:(const uint8_t *)bytes
+                      length:(NSUInteger)length
+                     offsets:(uint32_t *)offsets
+                        ends:(uint32_t *)ends
+                       count:(NSUInteger)count;
+@end
+
+@implementation AFJSONStructuralIndex
+
+- (instancetype)initWithData:(NSData *)data
+                       bytes:(const uint8_t *)bytes
+                      length:(NSUInteger)length
+                     offsets:(uint32_t *)offsets
+                        ends:(uint32_t *)ends
+                       count:(NSUInteger)count
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    _data = data;
+    _bytes = bytes;
+    _length = length;
+    _offsets = offsets;
+    _ends = ends;
+    _count = count;
+
+    return self;
+}
+
+- (void)dealloc {
+    free(_offsets);
+    free(_ends);
+}
+
+- (uint8_t)characterAtPosition:(NSUInteger)position {
+    return position < _count ? _bytes[_offsets[position]] : 0;
+}
+
+- (NSUInteger)positionAfterValueAtPosition:(NSUInteger)position {
+    return AFJSONPositionAfterValue(_bytes, _offsets, _ends, position);
+}
+
+- (NSUInteger)positionOfMemberNamed:(NSString *)key
+                 inObjectAtPosition:(NSUInteger)position
+                 skippingNullValues:(BOOL)skipsNullValues
+{
+    const uint8_t *keyBytes = (const uint8_t *)[key UTF8String];
+    NSUInteger keyLength = [key lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+
+    // Like `NSJSONSerialization`, the last of duplicate keys wins
+    NSUInteger memberPosition = NSNotFound;
+    position++;
+    while ([self characterAtPosition:position] == '"') {
+        NSUInteger start = _offsets[position] + 1;
+        NSUInteger valuePosition = position + 3;
+        if (AFJSONStringEqualsBytes(_bytes + start, _offsets[position + 1] - start, keyBytes, keyLength)) {
+            memberPosition = (skipsNullValues && [self characterAtPosition:valuePosition] == 'n') ? NSNotFound : valuePosition;
+        }
+
+        position = [self positionAfterValueAtPosition:valuePosition];
+        if ([self characterAtPosition:position] != ',') {
+            break;
+        }
+        position++;
+    }
+
+    return memberPosition;
+}
+
+- (NSUInteger)positionOfElementAtIndex:(NSUInteger)index
+                     inArrayAtPosition:(NSUInteger)position
+                    skippingNullValues:(BOOL)skipsNullValues
+{
+    position++;
+    if ([self characterAtPosition:position] == ']') {
+        return NSNotFound;
+    }
+
+    for (;;) {
+        if (!skipsNullValues || [self characterAtPosition:position] != 'n') {
+            if (index == 0) {
+                return position;
+            }
+            index--;
+        }
+
+        position = [self positionAfterValueAtPosition:position];
+        if ([self characterAtPosition:position] != ',') {
+            return NSNotFound;
+        }
+        position++;
+    }
+}
+
+- (NSUInteger)countOfValueAtPosition:(NSUInteger)position
+                  skippingNullValues:(BOOL)skipsNullValues
+{
+    uint8_t character = [self characterAtPosition:position];
+    if (character != '{' && character != '[') {
+        return NSNotFound;
+    }
+
+    NSUInteger count = 0;
+    position++;
+    while ([self characterAtPosition:position] != (character == '{' ? '}' : ']')) {
+        NSUInteger valuePosition = character == '{' ? position + 3 : position;
+        if (!skipsNullValues || [self characterAtPosition:valuePosition] != 'n') {
+            count++;
+        }
+
+        position = [self positionAfterValueAtPosition:valuePosition];
+        if ([self characterAtPosition:position] == ',') {
+            position++;
+        }
+    }
+
+    return count;
+}
+
+- (id)objectAtPosition:(NSUInteger)position
+               options:(NSJSONReadingOptions)options
+{
+    AFJSONObjectBuilder builder;
+    AFJSONBuilderInitialize(&builder, _bytes, _length, _offsets, _count, options);
+    builder.position = position;
+    id object = AFJSONBuildValue(&builder, 0);
+    AFJSONBuilderDestroy(&builder);
+
+    return object;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFJSONDocument ()
+@property (readwrite, nonatomic, strong) AFJSONStructuralIndex *structuralIndex;
+@property (readwrite, nonatomic, assign) NSJSONReadingOptions readingOptions;
+@property (readwrite, nonatomic, assign) BOOL removesKeysWithNullValues;
+
+- (instancetype)initWithStructuralIndex:(AFJSONStructuralIndex *)structuralIndex
+                         readingOptions:(NSJSONReadingOptions)readingOptions
+              removesKeysWithNullValues:(BOOL)removesKeysWithNullValues NS_DESIGNATED_INITIALIZER;
+@end
+
+#pragma mark - Models
+
+NSString * const AFJSONModelMismatchesErrorKey = @"AFJSONModelMismatchesErrorKey";
+
+typedef NS_ENUM(NSInteger, AFJSONModelPropertyType) {
+    AFJSONModelPropertyTypePrimitive = 0,
+    AFJSONModelPropertyTypeString,
+    AFJSONModelPropertyTypeURL,
+    AFJSONModelPropertyTypeNumber,
+    AFJSONModelPropertyTypeArray,
+    AFJSONModelPropertyTypeDictionary,
+    AFJSONModelPropertyTypeObject,
+    AFJSONModelPropertyTypeModel,
+};
+
+// A property of a model class, with its type and setter looked up once
+@interface AFJSONModelProperty : NSObject
+@property (readwrite, nonatomic, copy) NSString *name;
+@property (readwrite, nonatomic, assign) AFJSONModelPropertyType type;
+@property (readwrite, nonatomic, assign) char primitiveType;
+@property (readwrite, nonatomic, assign, getter=isMutable) BOOL mutable;
+@property (readwrite, nonatomic, assign) SEL setter;
+@property (readwrite, nonatomic, assign) IMP setterImplementation;
+// Schemas set for their own properties are not retained by them
+@property (readwrite, nonatomic, weak) AFJSONModelSchema *schema;
+
++ (instancetype)propertyNamed:(NSString *)name
+                 ofModelClass:(Class)modelClass;
+@end
+
+@implementation AFJSONModelProperty
+
++ (instancetype)propertyNamed:(NSString *)name
+                 ofModelClass:(Class)modelClass
+{
+    objc_property_t runtimeProperty = class_getProperty(modelClass, [name UTF8String]);
+    if (!runtimeProperty) {
+        return nil;
+    }
+
+    NSString *typeEncoding = nil;
+    NSString *setterName = nil;
+    for (NSString *attribute in [@(property_getAttributes(runtimeProperty)) componentsSeparatedByString:@","]) {
+        if ([attribute hasPrefix:@"T"]) {
+            typeEncoding = [attribute substringFromIndex:1];
+        } else if ([attribute hasPrefix:@"S"]) {
+            setterName = [attribute substringFromIndex:1];
+        } else if ([attribute isEqualToString:@"R"]) {
+            return nil;
+        }
+    }
+
+    AFJSONModelProperty *property = [[self alloc] init];
+    property.name = name;
+    property.setter = NSSelectorFromString(setterName ?: [NSString stringWithFormat:@"set%@%@:", [[name substringToIndex:1] uppercaseString], [name substringFromIndex:1]]);
+    if (![modelClass instancesRespondToSelector:property.setter]) {
+        return nil;
+    }
+    property.setterImplementation = class_getMethodImplementation(modelClass, property.setter);
+
+    if ([typeEncoding hasPrefix:@"@"]) {
+        // `@"NSString<Protocol>"`, or `@` for `id`
+        NSString *className = [[typeEncoding stringByTrimmingCharactersInSet:[NSCharacterSet characterSetWithCharactersInString:@"@\""]] componentsSeparatedByString:@"<"][0];
+        Class valueClass = [className length] > 0 ? NSClassFromString(className) : Nil;
+        if (!valueClass || valueClass == [NSObject class]) {
+            property.type = AFJSONModelPropertyTypeObject;
+        } else if ([valueClass isSubclassOfClass:[NSString class]]) {
+            property.type = AFJSONModelPropertyTypeString;
+            property.mutable = [valueClass isSubclassOfClass:[NSMutableString class]];
+        } else if ([valueClass isSubclassOfClass:[NSURL class]]) {
+            property.type = AFJSONModelPropertyTypeURL;
+        } else if ([valueClass isSubclassOfClass:[NSNumber class]]) {
+            property.type = AFJSONModelPropertyTypeNumber;
+        } else if ([valueClass isSubclassOfClass:[NSArray class]]) {
+            property.type = AFJSONModelPropertyTypeArray;
+            property.mutable = [valueClass isSubclassOfClass:[NSMutableArray class]];
+        } else if ([valueClass isSubclassOfClass:[NSDictionary class]]) {
+            property.type = AFJSONModelPropertyTypeDictionary;
+            property.mutable = [valueClass isSubclassOfClass:[NSMutableDictionary class]];
+        } else {
+            property.type = AFJSONModelPropertyTypeModel;
+        }
+    } else if ([typeEncoding length] == 1 && strchr("csilqCSILQfdB", [typeEncoding UTF8String][0])) {
+        property.type = AFJSONModelPropertyTypePrimitive;
+        property.primitiveType = [typeEncoding UTF8String][0];
+    } else {
+        return nil;
+    }
+
+    return property;
+}
+
+@end
+
+// A JSON key of a schema, matched against the bytes of member keys
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    __unsafe_unretained AFJSONModelProperty *property;
+} AFJSONModelPropertyKey;
+
+@interface AFJSONModelSchema ()
+@property (readwrite, nonatomic, strong) Class modelClass;
+@property (readwrite, nonatomic, copy) NSDictionary <NSString *, NSString *> *propertyNamesByJSONKey;
+@property (readwrite, nonatomic, strong) NSDictionary <NSString *, AFJSONModelProperty *> *propertiesByName;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSString *, AFJSONModelSchema *> *mutableSchemasByPropertyName;
+@property (readwrite, nonatomic, copy) NSArray <NSData *> *propertyKeyData;
+@property (readwrite, nonatomic, assign) AFJSONModelPropertyKey *propertyKeys;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfPropertyKeys;
+
+- (instancetype)initWithModelClass:(Class)modelClass
+            propertyNamesByJSONKey:(NSDictionary <NSString *, NSString *> *)propertyNamesByJSONKey NS_DESIGNATED_INITIALIZER;
+@end
+
+// A key path from the root of the text, as a list of members and elements linked from the innermost up
+typedef struct AFJSONModelKeyPath {
+    const struct AFJSONModelKeyPath *parent;
+    const uint8_t *key;
+    NSUInteger keyLength;
+    NSUInteger index;
+} AFJSONModelKeyPath;
+
+typedef struct {
+    AFJSONObjectBuilder builder;
+    const uint32_t *ends;
+    __unsafe_unretained NSMutableArray <NSString *> *mismatches;
+} AFJSONModelDecoder;
+
+static inline uint8_t AFJSONModelDecoderCharacter(AFJSONModelDecoder *decoder, NSUInteger position) {
+    return decoder->builder.bytes[decoder->builder.offsets[position]];
+}
+
+static AFJSONModelProperty * AFJSONModelSchemaPropertyForKey(AFJSONModelSchema *schema, const uint8_t *bytes, NSUInteger length) {
+    AFJSONModelPropertyKey *propertyKeys = schema.propertyKeys;
+    NSUInteger numberOfPropertyKeys = schema.numberOfPropertyKeys;
+    if (!memchr(bytes, '\\', length)) {
+        for (NSUInteger idx = 0; idx < numberOfPropertyKeys; idx++) {
+            if (propertyKeys[idx].length == length && memcmp(propertyKeys[idx].bytes, bytes, length) == 0) {
+                return propertyKeys[idx].property;
+            }
+        }
+    } else {
+        for (NSUInteger idx = 0; idx < numberOfPropertyKeys; idx++) {
+            if (AFJSONStringEqualsBytes(bytes, length, propertyKeys[idx].bytes, propertyKeys[idx].length)) {
+                return propertyKeys[idx].property;
+            }
+        }
+    }
+
+    return nil;
+}
+
+static NSString * AFJSONModelKeyPathDescription(const AFJSONModelKeyPath *keyPath) {
+    NSMutableArray *components = [NSMutableArray array];
+    for (; keyPath; keyPath = keyPath->parent) {
+        NSString *component = nil;
+        if (keyPath->key) {
+            uint8_t *buffer = malloc(MAX(keyPath->keyLength, (NSUInteger)1));
+            NSUInteger errorOffset = 0;
+            NSUInteger length = AFJSONUnescapeString(keyPath->key, keyPath->keyLength, buffer, &errorOffset);
+            component = [[NSString alloc] initWithBytes:buffer length:length encoding:NSUTF8StringEncoding];
+            free(buffer);
+        } else {
+            component = [@(keyPath->index) stringValue];
+        }
+        [components insertObject:component ?: @"" atIndex:0];
+    }
+
+    return [components count] > 0 ? [components componentsJoinedByString:@"."] : @"(root)";
+}
+
+static void AFJSONModelDecoderMismatch(AFJSONModelDecoder *decoder, const AFJSONModelKeyPath *keyPath, NSUInteger position, NSString *expectation) {
+    NSString *found = nil;
+    switch (AFJSONModelDecoderCharacter(decoder, position)) {
+        case '{':
+            found = @"an object";
+            break;
+        case '[':
+            found = @"an array";
+            break;
+        case '"':
+            found = @"a string";
+            break;
+        case 't': case 'f':
+            found = @"a boolean";
+            break;
+        case 'n':
+            found = @"null";
+            break;
+        default:
+            found = @"a number";
+            break;
+    }
+
+    [decoder->mismatches addObject:[NSString stringWithFormat:@"%@: expected %@, found %@", AFJSONModelKeyPathDescription(keyPath), expectation, found]];
+}
+
+static NSString * AFJSONModelPropertyExpectation(AFJSONModelProperty *property) {
+    switch (property.type) {
+        case AFJSONModelPropertyTypePrimitive:
+            return strchr("fdB", property.primitiveType) ? @"a number" : @"an integer within the range of the property";
+        case AFJSONModelPropertyTypeString:
+            return @"a string";
+        case AFJSONModelPropertyTypeURL:
+            return @"a URL string";
+        case AFJSONModelPropertyTypeNumber:
+            return @"a number or a boolean";
+        case AFJSONModelPropertyTypeArray:
+            return @"an array";
+        case AFJSONModelPropertyTypeDictionary:
+            return @"an object";
+        case AFJSONModelPropertyTypeObject:
+            return @"a value";
+        case AFJSONModelPropertyTypeModel:
+            break;
+    }
+
+    return property.schema ? @"an object" : @"an object, and a schema for the property";
+}
+
+// Returns the largest magnitudes of the positive and negative values of an integer type
+static void AFJSONModelIntegerRange(char primitiveType, uint64_t *maximum, uint64_t *negativeMaximum) {
+    switch (primitiveType) {
+        case 'c': *maximum = SCHAR_MAX; *negativeMaximum = (uint64_t)SCHAR_MAX + 1; break;
+        case 's': *maximum = SHRT_MAX; *negativeMaximum = (uint64_t)SHRT_MAX + 1; break;
+        case 'i': *maximum = INT_MAX; *negativeMaximum = (uint64_t)INT_MAX + 1; break;
+        case 'l': *maximum = LONG_MAX; *negativeMaximum = (uint64_t)LONG_MAX + 1; break;
+        case 'q': *maximum = LLONG_MAX; *negativeMaximum = (uint64_t)LLONG_MAX + 1; break;
+        case 'C': *maximum = UCHAR_MAX; *negativeMaximum = 0; break;
+        case 'S': *maximum = USHRT_MAX; *negativeMaximum = 0; break;
+        case 'I': *maximum = UINT_MAX; *negativeMaximum = 0; break;
+        case 'L': *maximum = ULONG_MAX; *negativeMaximum = 0; break;
+        default: *maximum = ULLONG_MAX; *negativeMaximum = 0; break;
+    }
+}
+
+// Assigns a number, `true` or `false` to a primitive property, without creating an `NSNumber`
+static BOOL AFJSONModelAssignPrimitive(id model, AFJSONModelProperty *property, const uint8_t *token, NSUInteger length) {
+    AFJSONNumberComponents components;
+    if (token[0] == 't' || token[0] == 'f') {
+        components = (AFJSONNumberComponents){NO, YES, NO, token[0] == 't' ? 1 : 0, 0};
+    } else if (!AFJSONScanNumber(token, length, &components)) {
+        return NO;
+    }
+
+    SEL setter = property.setter;
+    IMP implementation = property.setterImplementation;
+    char primitiveType = property.primitiveType;
+    switch (primitiveType) {
+        case 'f':
+            ((void (*)(id, SEL, float))implementation)(model, setter, (float)AFJSONDoubleValueOfNumber(token, length, &components));
+            return YES;
+        case 'd':
+            ((void (*)(id, SEL, double))implementation)(model, setter, AFJSONDoubleValueOfNumber(token, length, &components));
+            return YES;
+        case 'B':
+            ((void (*)(id, SEL, bool))implementation)(model, setter, AFJSONDoubleValueOfNumber(token, length, &components) != 0.0);
+            return YES;
+        default:
+            break;
+    }
+
+    // Numbers with an exponent or a fractional part are assigned to integers only if they are whole
+    BOOL negative = components.negative;
+    uint64_t magnitude = components.mantissa;
+    if (!components.isInteger || components.mantissaOverflowed) {
+        double value = AFJSONDoubleValueOfNumber(token, length, &components);
+        if (value != trunc(value) || fabs(value) >= 18446744073709551616.0) {
+            return NO;
+        }
+        negative = value < 0.0;
+        magnitude = (uint64_t)fabs(value);
+    }
+
+    uint64_t maximum = 0, negativeMaximum = 0;
+    AFJSONModelIntegerRange(primitiveType, &maximum, &negativeMaximum);
+    if (magnitude > (negative ? negativeMaximum : maximum)) {
+        return NO;
+    }
+    long long value = negative && magnitude > 0 ? -(long long)(magnitude - 1) - 1 : (long long)magnitude;
+
+    switch (primitiveType) {
+        case 'c':
+            ((void (*)(id, SEL, char))implementation)(model, setter, (char)value);
+            break;
+        case 's':
+            ((void (*)(id, SEL, short))implementation)(model, setter, (short)value);
+            break;
+        case 'i':
+            ((void (*)(id, SEL, int))implementation)(model, setter, (int)value);
+            break;
+        case 'l':
+            ((void (*)(id, SEL, long))implementation)(model, setter, (long)value);
+            break;
+        case 'q':
+            ((void (*)(id, SEL, long long))implementation)(model, setter, value);
+            break;
+        case 'C':
+            ((void (*)(id, SEL, unsigned char))implementation)(model, setter, (unsigned char)magnitude);
+            break;
+        case 'S':
+            ((void (*)(id, SEL, unsigned short))implementation)(model, setter, (unsigned short)magnitude);
+            break;
+        case 'I':
+            ((void (*)(id, SEL, unsigned int))implementation)(model, setter, (unsigned int)magnitude);
+            break;
+        case 'L':
+            ((void (*)(id, SEL, unsigned long))implementation)(model, setter, (unsigned long)magnitude);
+            break;
+        default:
+            ((void (*)(id, SEL, unsigned long long))implementation)(model, setter, (unsigned long long)magnitude);
+            break;
+    }
+
+    return YES;
+}
+
+// Creates the Foundation object for the value at `position`, for properties without a schema
+static id AFJSONModelDecoderBuildValue(AFJSONModelDecoder *decoder, NSUInteger position, NSJSONReadingOptions options) {
+    decoder->builder.position = position;
+    decoder->builder.options = options;
+
+    return AFJSONBuildValue(&decoder->builder, 0);
+}
+
+static id AFJSONModelDecodeModel(AFJSONModelDecoder *decoder, NSUInteger position, AFJSONModelSchema *schema, const AFJSONModelKeyPath *keyPath);
+
+static NSArray * AFJSONModelDecodeModels(AFJSONModelDecoder *decoder, NSUInteger position, AFJSONModelSchema *schema, BOOL mutable, const AFJSONModelKeyPath *keyPath) {
+    const uint8_t *bytes = decoder->builder.bytes;
+    const uint32_t *offsets = decoder->builder.offsets;
+
+    NSMutableArray *models = [NSMutableArray array];
+    position++;
+    for (NSUInteger idx = 0; bytes[offsets[position]] != ']'; idx++) {
+        AFJSONModelKeyPath elementKeyPath = {keyPath, NULL, 0, idx};
+        uint8_t character = bytes[offsets[position]];
+        if (character == '{') {
+            [models addObject:AFJSONModelDecodeModel(decoder, position, schema, &elementKeyPath)];
+        } else if (character != 'n') {
+            AFJSONModelDecoderMismatch(decoder, &elementKeyPath, position, @"an object");
+        }
+
+        position = AFJSONPositionAfterValue(bytes, offsets, decoder->ends, position);
+        if (bytes[offsets[position]] == ',') {
+            position++;
+        }
+    }
+
+    return mutable ? models : [models copy];
+}
+
+static void AFJSONModelDecodeProperty(AFJSONModelDecoder *decoder, NSUInteger position, id model, AFJSONModelProperty *property, const AFJSONModelKeyPath *keyPath) {
+    uint8_t character = AFJSONModelDecoderCharacter(decoder, position);
+    BOOL isScalar = character != '{' && character != '[' && character != '"';
+
+    id value = nil;
+    switch (property.type) {
+        case AFJSONModelPropertyTypePrimitive:
+            if (isScalar && AFJSONModelAssignPrimitive(model, property, decoder->builder.bytes + decoder->builder.offsets[position], AFJSONBuilderScalarLength(&decoder->builder, position))) {
+                return;
+            }
+            break;
+        case AFJSONModelPropertyTypeString:
+            if (character == '"') {
+                value = AFJSONModelDecoderBuildValue(decoder, position, property.mutable ? NSJSONReadingMutableLeaves : 0);
+            }
+            break;
+        case AFJSONModelPropertyTypeURL:
+            if (character == '"') {
+                value = [NSURL URLWithString:AFJSONModelDecoderBuildValue(decoder, position, 0)];
+            }
+            break;
+        case AFJSONModelPropertyTypeNumber:
+            if (isScalar) {
+                value = AFJSONModelDecoderBuildValue(decoder, position, 0);
+            }
+            break;
+        case AFJSONModelPropertyTypeArray:
+            if (character == '[') {
+                AFJSONModelSchema *schema = property.schema;
+                value = schema ? AFJSONModelDecodeModels(decoder, position, schema, property.mutable, keyPath) : AFJSONModelDecoderBuildValue(decoder, position, property.mutable ? NSJSONReadingMutableContainers : 0);
+            }
+            break;
+        case AFJSONModelPropertyTypeDictionary:
+            if (character == '{') {
+                value = AFJSONModelDecoderBuildValue(decoder, position, property.mutable ? NSJSONReadingMutableContainers : 0);
+            }
+            break;
+        case AFJSONModelPropertyTypeObject:
+            value = AFJSONModelDecoderBuildValue(decoder, position, 0);
+            break;
+        case AFJSONModelPropertyTypeModel: {
+            AFJSONModelSchema *schema = property.schema;
+            if (character == '{' && schema) {
+                value = AFJSONModelDecodeModel(decoder, position, schema, keyPath);
+            }
+            break;
+        }
+    }
+
+    if (!value) {
+        AFJSONModelDecoderMismatch(decoder, keyPath, position, AFJSONModelPropertyExpectation(property));
+        return;
+    }
+
+    ((void (*)(id, SEL, id))property.setterImplementation)(model, property.setter, value);
+}
+
+static id AFJSONModelDecodeModel(AFJSONModelDecoder *decoder, NSUInteger position, AFJSONModelSchema *schema, const AFJSONModelKeyPath *keyPath) {
+    const uint8_t *bytes = decoder->builder.bytes;
+    const uint32_t *offsets = decoder->builder.offsets;
+
+    id model = [[schema.modelClass alloc] init];
+    position++;
+    while (bytes[offsets[position]] == '"') {
+        // The key is followed by its closing quote and a colon
+        const uint8_t *key = bytes + offsets[position] + 1;
+        NSUInteger keyLength = offsets[position + 1] - offsets[position] - 1;
+        NSUInteger valuePosition = position + 3;
+
+        AFJSONModelProperty *property = AFJSONModelSchemaPropertyForKey(schema, key, keyLength);
+        if (property && bytes[offsets[valuePosition]] != 'n') {
+            AFJSONModelKeyPath memberKeyPath = {keyPath, key, keyLength, 0};
+            AFJSONModelDecodeProperty(decoder, valuePosition, model, property, &memberKeyPath);
+        }
+
+        position = AFJSONPositionAfterValue(bytes, offsets, decoder->ends, valuePosition);
+        if (bytes[offsets[position]] != ',') {
+            break;
+        }
+        position++;
+    }
+
+    return model;
+}
+
+#pragma mark -
+
+@interface AFJSONParser ()
+@property (readwrite, nonatomic, assign) AFJSONParserInstructionSet instructionSet;
+@property (readwrite, nonatomic, assign) AFJSONClassifyBlockFunction classifyBlock;
+@end
+
+@implementation AFJSONParser
+
++ (BOOL)isInstructionSetSupported:(AFJSONParserInstructionSet)instructionSet {
+    return instructionSet == AFJSONParserInstructionSetAutomatic || AFJSONClassifyBlockFunctionForInstructionSet(instructionSet) != NULL;
+}
+
+- (instancetype)init {
+    return [self initWithInstructionSet:AFJSONParserInstructionSetAutomatic];
+}
+
+- (instancetype)initWithInstructionSet:(AFJSONParserInstructionSet)instructionSet {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    if (instructionSet == AFJSONParserInstructionSetAutomatic) {
+        for (NSNumber *fastestInstructionSet in @[@(AFJSONParserInstructionSetAVX2), @(AFJSONParserInstructionSetSSE2), @(AFJSONParserInstructionSetNEON), @(AFJSONParserInstructionSetScalar)]) {
+            if ([[self class] isInstructionSetSupported:[fastestInstructionSet integerValue]]) {
+                instructionSet = [fastestInstructionSet integerValue];
+                break;
+            }
+        }
+    }
+
+    self.classifyBlock = AFJSONClassifyBlockFunctionForInstructionSet(instructionSet);
+    if (!self.classifyBlock) {
+        return nil;
+    }
+    self.instructionSet = instructionSet;
+
+    return self;
+}
+
+- (id)JSONObjectWithData:(NSData *)data
+                 options:(NSJSONReadingOptions)options
+                   error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(data);
+
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSJSONReadingOptions supportedOptions = NSJSONReadingMutableContainers | NSJSONReadingMutableLeaves | NSJSONReadingAllowFragments;
+    if ((options & ~supportedOptions) != 0 || length >= UINT32_MAX || !AFJSONDataIsUTF8(bytes, length)) {
+        return [NSJSONSerialization JSONObjectWithData:data options:options error:error];
+    }
+
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        bytes += 3;
+        length -= 3;
+    }
+
+    uint32_t *offsets = malloc(MAX(length, (NSUInteger)1) * sizeof(uint32_t));
+    if (!offsets) {
+        return [NSJSONSerialization JSONObjectWithData:data options:options error:error];
+    }
+
+    NSUInteger count = 0;
+    NSUInteger errorOffset = 0;
+    id object = nil;
+    const char *errorReason = AFJSONIndexStructuralCharacters(bytes, length, self.classifyBlock, offsets, &count, &errorOffset);
+    if (!errorReason) {
+        object = AFJSONObjectWithStructuralIndex(bytes, length, offsets, count, options, &errorReason, &errorOffset);
+    }
+    free(offsets);
+
+    if (!object && error) {
+        *error = AFJSONParserError(errorReason, errorOffset);
+    }
+
+    return object;
+}
+
+- (AFJSONDocument *)documentWithData:(NSData *)data
+                             options:(NSJSONReadingOptions)options
+                               error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(data);
+
+    AFJSONStructuralIndex *structuralIndex = [self structuralIndexWithData:data options:options error:error];
+    if (!structuralIndex) {
+        return nil;
+    }
+
+    return [[AFJSONDocument alloc] initWithStructuralIndex:structuralIndex readingOptions:options removesKeysWithNullValues:NO];
+}
+
+- (id)modelWithData:(NSData *)data
+             schema:(AFJSONModelSchema *)schema
+              error:(NSError * __autoreleasing *)error
+{
+    NSParameterAssert(data);
+    NSParameterAssert(schema);
+
+    AFJSONStructuralIndex *structuralIndex = [self structuralIndexWithData:data options:0 error:error];
+    if (!structuralIndex) {
+        return nil;
+    }
+
+    NSMutableArray <NSString *> *mismatches = [NSMutableArray array];
+    AFJSONModelDecoder decoder;
+    AFJSONBuilderInitialize(&decoder.builder, structuralIndex.bytes, structuralIndex.length, structuralIndex.offsets, structuralIndex.count, 0);
+    decoder.ends = structuralIndex.ends;
+    decoder.mismatches = mismatches;
+
+    id model = nil;
+    if (AFJSONModelDecoderCharacter(&decoder, 0) == '{') {
+        model = AFJSONModelDecodeModel(&decoder, 0, schema, NULL);
+    } else {
+        model = AFJSONModelDecodeModels(&decoder, 0, schema, NO, NULL);
+    }
+    AFJSONBuilderDestroy(&decoder.builder);
+
+    if ([mismatches count] > 0) {
+        if (error) {
+            NSString *description = [NSString stringWithFormat:@"%lu value(s) do not match the schema of %@, starting with %@", (unsigned long)[mismatches count], NSStringFromClass(schema.modelClass), [mismatches firstObject]];
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSCoderReadCorruptError userInfo:@{@"NSDebugDescription": description, AFJSONModelMismatchesErrorKey: [mismatches copy]}];
+        }
+        return nil;
+    }
+
+    return model;
+}
+
+// Validates the text, and returns its structural index along with the position after each array and object
+- (AFJSONStructuralIndex *)structuralIndexWithData:(NSData *)data
+                                           options:(NSJSONReadingOptions)options
+                                             error:(NSError * __autoreleasing *)error
+{
+    if (!AFJSONDataIsUTF8([data bytes], [data length])) {
+        NSString *string = [[NSString alloc] initWithData:data encoding:AFJSONUnicodeEncodingOfData([data bytes], [data length])];
+        data = [string dataUsingEncoding:NSUTF8StringEncoding];
+        if (!data) {
+            if (error) {
+                *error = AFJSONParserError("Unable to convert data to string", 0);
+            }
+            return nil;
+        }
+    }
+    data = [data copy];
+
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    if (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) {
+        bytes += 3;
+        length -= 3;
+    }
+
+    if (length >= UINT32_MAX) {
+        if (error) {
+            *error = AFJSONParserError("JSON text too long", 0);
+        }
+        return nil;
+    }
+
+    uint32_t *offsets = malloc(MAX(length, (NSUInteger)1) * sizeof(uint32_t));
+    if (!offsets) {
+        if (error) {
+            *error = AFJSONParserError("Unable to allocate structural index", 0);
+        }
+        return nil;
+    }
+
+    uint32_t *ends = NULL;
+    NSUInteger count = 0;
+    NSUInteger errorOffset = 0;
+    const char *errorReason = NULL;
+
+    // Strings are created from the text as is when accessed, so the text is checked for malformed UTF-8 up front
+    if (!AFJSONIsValidUTF8(bytes, length, &errorOffset)) {
+        errorReason = "Unable to convert data to string";
+    } else {
+        errorReason = AFJSONIndexStructuralCharacters(bytes, length, self.classifyBlock, offsets, &count, &errorOffset);
+    }
+
+    if (!errorReason) {
+        // The index outlives parsing in every document, so it only keeps the space of the characters it found
+        uint32_t *shrunkOffsets = realloc(offsets, MAX(count, (NSUInteger)1) * sizeof(uint32_t));
+        if (shrunkOffsets) {
+            offsets = shrunkOffsets;
+        }
+
+        ends = malloc(MAX(count, (NSUInteger)1) * sizeof(uint32_t));
+        if (!ends) {
+            errorReason = "Unable to allocate structural index";
+            errorOffset = 0;
+        }
+    }
+
+    if (!errorReason) {
+        AFJSONObjectBuilder builder;
+        AFJSONBuilderInitialize(&builder, bytes, length, offsets, count, options);
+        builder.validatesOnly = YES;
+        builder.ends = ends;
+        if (!AFJSONBuildText(&builder)) {
+            errorReason = builder.errorReason;
+            errorOffset = builder.errorOffset;
+        }
+        AFJSONBuilderDestroy(&builder);
+    }
+
+    if (errorReason) {
+        free(offsets);
+        free(ends);
+        if (error) {
+            *error = AFJSONParserError(errorReason, errorOffset);
+        }
+        return nil;
+    }
+
+    return [[AFJSONStructuralIndex alloc] initWithData:data bytes:bytes length:length offsets:offsets ends:ends count:count];
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFJSONDocument
+
+- (instancetype)initWithStructuralIndex:(AFJSONStructuralIndex *)structuralIndex
+                         readingOptions:(NSJSONReadingOptions)readingOptions
+              removesKeysWithNullValues:(BOOL)removesKeysWithNullValues
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.structuralIndex = structuralIndex;
+    self.readingOptions = readingOptions;
+    self.removesKeysWithNullValues = removesKeysWithNullValues;
+
+    return self;
+}
+
+- (NSData *)data {
+    return self.structuralIndex.data;
+}
+
+- (id)JSONObject {
+    return [self objectAtPath:@[]];
+}
+
+- (id)objectForKeyPath:(NSString *)keyPath {
+    return [self objectAtPath:[keyPath length] > 0 ? [keyPath componentsSeparatedByString:@"."] : @[]];
+}
+
+- (id)objectForKeyedSubscript:(NSString *)keyPath {
+    return [self objectForKeyPath:keyPath];
+}
+
+- (id)objectAtPath:(NSArray *)path {
+    NSUInteger position = [self positionOfValueAtPath:path];
+    if (position == NSNotFound) {
+        return nil;
+    }
+
+    id object = [self.structuralIndex objectAtPosition:position options:self.readingOptions];
+    if (self.removesKeysWithNullValues) {
+        return AFJSONObjectByRemovingKeysWithNullValues(object, self.readingOptions);
+    }
+
+    return object;
+}
+
+- (NSUInteger)countForKeyPath:(NSString *)keyPath {
+    NSUInteger position = [self positionOfValueAtPath:[keyPath length] > 0 ? [keyPath componentsSeparatedByString:@"."] : @[]];
+    if (position == NSNotFound) {
+        return NSNotFound;
+    }
+
+    return [self.structuralIndex countOfValueAtPosition:position skippingNullValues:self.removesKeysWithNullValues];
+}
+
+- (AFJSONDocument *)documentByRemovingKeysWithNullValues {
+    return [[[self class] alloc] initWithStructuralIndex:self.structuralIndex readingOptions:self.readingOptions removesKeysWithNullValues:YES];
+}
+
+- (NSUInteger)positionOfValueAtPath:(NSArray *)path {
+    AFJSONStructuralIndex *structuralIndex = self.structuralIndex;
+    NSUInteger position = 0;
+    for (id component in path) {
+        uint8_t character = [structuralIndex characterAtPosition:position];
+        if (character == '{' && [component isKindOfClass:[NSString class]]) {
+            position = [structuralIndex positionOfMemberNamed:component inObjectAtPosition:position skippingNullValues:self.removesKeysWithNullValues];
+        } else if (character == '[' && [component isKindOfClass:[NSNumber class]]) {
+            position = [component integerValue] >= 0 ? [structuralIndex positionOfElementAtIndex:[component unsignedIntegerValue] inArrayAtPosition:position skippingNullValues:self.removesKeysWithNullValues] : NSNotFound;
+        } else if (character == '[' && [component isKindOfClass:[NSString class]] && [component length] > 0 && [component rangeOfCharacterFromSet:[[NSCharacterSet characterSetWithCharactersInString:@"0123456789"] invertedSet]].location == NSNotFound) {
+            position = [structuralIndex positionOfElementAtIndex:(NSUInteger)[component longLongValue] inArrayAtPosition:position skippingNullValues:self.removesKeysWithNullValues];
+        } else {
+            position = NSNotFound;
+        }
+
+        if (position == NSNotFound) {
+            break;
+        }
+    }
+
+    return position;
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    return self;
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFJSONModelSchema
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
++ (instancetype)schemaWithModelClass:(Class)modelClass
+              propertyNamesByJSONKey:(NSDictionary <NSString *, NSString *> *)propertyNamesByJSONKey
+{
+    return [[self alloc] initWithModelClass:modelClass propertyNamesByJSONKey:propertyNamesByJSONKey];
+}
+
+- (instancetype)initWithModelClass:(Class)modelClass
+            propertyNamesByJSONKey:(NSDictionary <NSString *, NSString *> *)propertyNamesByJSONKey
+{
+    NSParameterAssert(modelClass);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    NSMutableDictionary *mutablePropertyNamesByJSONKey = [NSMutableDictionary dictionary];
+    if (propertyNamesByJSONKey) {
+        [mutablePropertyNamesByJSONKey addEntriesFromDictionary:propertyNamesByJSONKey];
+    } else {
+        for (Class currentClass = modelClass; currentClass && currentClass != [NSObject class]; currentClass = class_getSuperclass(currentClass)) {
+            unsigned int numberOfProperties = 0;
+            objc_property_t *properties = class_copyPropertyList(currentClass, &numberOfProperties);
+            for (unsigned int idx = 0; idx < numberOfProperties; idx++) {
+                NSString *propertyName = @(property_getName(properties[idx]));
+                if (!mutablePropertyNamesByJSONKey[propertyName] && [AFJSONModelProperty propertyNamed:propertyName ofModelClass:modelClass]) {
+                    mutablePropertyNamesByJSONKey[propertyName] = propertyName;
+                }
+            }
+            free(properties);
+        }
+    }
+
+    NSMutableDictionary *mutablePropertiesByName = [NSMutableDictionary dictionary];
+    for (NSString *JSONKey in [mutablePropertyNamesByJSONKey allKeys]) {
+        NSString *propertyName = mutablePropertyNamesByJSONKey[JSONKey];
+        AFJSONModelProperty *property = mutablePropertiesByName[propertyName] ?: [AFJSONModelProperty propertyNamed:propertyName ofModelClass:modelClass];
+        NSAssert(property, @"%@ has no read-write property named %@ of a supported type", modelClass, propertyName);
+        if (property) {
+            mutablePropertiesByName[propertyName] = property;
+        } else {
+            [mutablePropertyNamesByJSONKey removeObjectForKey:JSONKey];
+        }
+    }
+
+    self.modelClass = modelClass;
+    self.propertyNamesByJSONKey = mutablePropertyNamesByJSONKey;
+    self.propertiesByName = mutablePropertiesByName;
+    self.mutableSchemasByPropertyName = [NSMutableDictionary dictionary];
+
+    // The bytes matched against member keys are held by `propertyKeyData`
+    NSMutableArray *mutablePropertyKeyData = [NSMutableArray array];
+    self.propertyKeys = calloc(MAX([mutablePropertyNamesByJSONKey count], (NSUInteger)1), sizeof(AFJSONModelPropertyKey));
+    for (NSString *JSONKey in mutablePropertyNamesByJSONKey) {
+        NSData *keyData = [JSONKey dataUsingEncoding:NSUTF8StringEncoding];
+        [mutablePropertyKeyData addObject:keyData];
+        self.propertyKeys[self.numberOfPropertyKeys++] = (AFJSONModelPropertyKey){[keyData bytes], [keyData length], mutablePropertiesByName[mutablePropertyNamesByJSONKey[JSONKey]]};
+    }
+    self.propertyKeyData = mutablePropertyKeyData;
+
+    return self;
+}
+
+- (void)dealloc {
+    free(_propertyKeys);
+}
+
+- (NSDictionary <NSString *, AFJSONModelSchema *> *)schemasByPropertyName {
+    NSMutableDictionary *mutableSchemasByPropertyName = [self.mutableSchemasByPropertyName mutableCopy];
+    for (NSString *propertyName in self.propertiesByName) {
+        if (self.propertiesByName[propertyName].schema == self) {
+            mutableSchemasByPropertyName[propertyName] = self;
+        }
+    }
+
+    return [mutableSchemasByPropertyName copy];
+}
+
+- (void)setSchema:(AFJSONModelSchema *)schema
+  forPropertyName:(NSString *)propertyName
+{
+    NSParameterAssert(schema);
+    NSParameterAssert(propertyName);
+
+    AFJSONModelProperty *property = self.propertiesByName[propertyName];
+    NSAssert(property.type == AFJSONModelPropertyTypeModel || property.type == AFJSONModelPropertyTypeArray, @"%@ is not a property of %@ with a model or array type", propertyName, self.modelClass);
+
+    property.schema = schema;
+    // Schemas set for their own properties are not retained, to avoid a retain cycle
+    self.mutableSchemasByPropertyName[propertyName] = schema != self ? schema : nil;
+}
+
+#pragma mark - NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    Class modelClass = NSClassFromString([decoder decodeObjectOfClass:[NSString class] forKey:NSStringFromSelector(@selector(modelClass))]);
+    NSDictionary *propertyNamesByJSONKey = [decoder decodeObjectOfClasses:[NSSet setWithObjects:[NSDictionary class], [NSString class], nil] forKey:NSStringFromSelector(@selector(propertyNamesByJSONKey))];
+    if (!modelClass || !propertyNamesByJSONKey) {
+        return nil;
+    }
+
+    self = [self initWithModelClass:modelClass propertyNamesByJSONKey:propertyNamesByJSONKey];
+    if (!self) {
+        return nil;
+    }
+
+    NSDictionary *schemasByPropertyName = [decoder decodeObjectOfClasses:[NSSet setWithObjects:[NSDictionary class], [NSString class], [AFJSONModelSchema class], nil] forKey:NSStringFromSelector(@selector(schemasByPropertyName))];
+    for (NSString *propertyName in schemasByPropertyName) {
+        if (self.propertiesByName[propertyName]) {
+            [self setSchema:schemasByPropertyName[propertyName] forPropertyName:propertyName];
+        }
+    }
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [coder encodeObject:NSStringFromClass(self.modelClass) forKey:NSStringFromSelector(@selector(modelClass))];
+    [coder encodeObject:self.propertyNamesByJSONKey forKey:NSStringFromSelector(@selector(propertyNamesByJSONKey))];
+    [coder encodeObject:self.schemasByPropertyName forKey:NSStringFromSelector(@selector(schemasByPropertyName))];
+}
+
+@end
@@ -0,0 +1,126 @@
+// AFMessagePackSerialization.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Options for creating Foundation objects from MessagePack data.
+
+ - `AFMessagePackReadingMutableContainers`: Arrays and dictionaries are created as mutable objects.
+ */
+typedef NS_OPTIONS(NSUInteger, AFMessagePackReadingOptions) {
+    AFMessagePackReadingMutableContainers = (1UL << 0),
+};
+
+/**
+ `AFMessagePackSerialization` converts between Foundation objects and MessagePack, a binary format with the data model of JSON, as specified at https://github.com/msgpack/msgpack/blob/master/spec.md. MessagePack data is usually much shorter than the equivalent JSON text, and numbers are decoded from their binary representation rather than parsed from decimal digits.
+
+ The following objects are written and read:
+
+ - `NSDictionary`, as a map. Keys can be any object that can be written, usually strings.
+ - `NSArray`, as an array.
+ - `NSString`, as a UTF-8 string.
+ - `NSNumber`, as a boolean, an integer of the smallest size holding its value, or a floating point number.
+ - `NSNull`, as nil.
+ - `NSData`, as binary data.
+ - `NSDate`, as the timestamp extension type, with nanosecond precision.
+
+ Other extension types fail to decode.
+ */
+@interface AFMessagePackSerialization : NSObject
+
+/**
+ Returns whether the specified object, and every object it contains, can be written as MessagePack.
+
+ @param object The object.
+ */
++ (BOOL)isValidMessagePackObject:(id)object;
+
+/**
+ Returns the MessagePack data for the specified object.
+
+ @param object The object.
+ @param error The error that occurred if the object, or an object it contains, cannot be written.
+
+ @return The MessagePack data, or `nil` if the object cannot be written.
+ */
++ (nullable NSData *)dataWithMessagePackObject:(id)object
+                                         error:(NSError * _Nullable __autoreleasing *)error;
+
+/**
+ Returns the Foundation object decoded from the specified MessagePack data, which must contain a single object.
+
+ @param data The MessagePack data.
+ @param options The options for creating the Foundation objects.
+ @param error The error that occurred while decoding the data. Malformed data fails with an error in `NSCocoaErrorDomain`, with the code `NSPropertyListReadCorruptError`.
+
+ @return The Foundation object, or `nil` if the data could not be decoded.
+ */
++ (nullable id)messagePackObjectWithData:(NSData *)data
+                                 options:(AFMessagePackReadingOptions)options
+                                   error:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFMessagePackStreamDecoder` decodes a sequence of MessagePack objects from data received in any number of pieces, such as the body of a response as it is received.
+
+ Data is scanned once to find where each object ends, without creating any object, and each object is decoded once it has been received whole. The data of an object is only copied when it is split across pieces.
+ */
+@interface AFMessagePackStreamDecoder : NSObject
+
+/**
+ The options for creating the Foundation objects.
+ */
+@property (readonly, nonatomic, assign) AFMessagePackReadingOptions readingOptions;
+
+/**
+ Whether part of an object has been received but not decoded yet.
+ */
+@property (readonly, nonatomic, assign) BOOL hasPartialObject;
+
+/**
+ Initializes a decoder with the specified options.
+
+ @param readingOptions The options for creating the Foundation objects.
+ */
+- (instancetype)initWithReadingOptions:(AFMessagePackReadingOptions)readingOptions NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init;
+
+/**
+ Returns the objects ended by the specified data, keeping any trailing partial object until more data is received.
+
+ @param data The data received.
+ @param error The error that occurred while decoding the data. The decoder decodes no more data after an error.
+
+ @return The objects ended by the data, in order, or `nil` if the data could not be decoded.
+ */
+- (nullable NSArray *)objectsByDecodingData:(NSData *)data
+                                      error:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+NS_ASSUME_NONNULL_END
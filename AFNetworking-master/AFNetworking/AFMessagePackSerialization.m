@@ -0,0 +1,871 @@
+// AFMessagePackSerialization.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFMessagePackSerialization.h"
+
+static NSUInteger const AFMessagePackMaximumDepth = 512;
+static NSUInteger const AFMessagePackKeyCacheSize = 256;
+static NSUInteger const AFMessagePackMaximumCachedKeyLength = 32;
+static int8_t const AFMessagePackTimestampExtensionType = -1;
+
+static NSError * AFMessagePackReadingError(const char *reason, NSUInteger offset) {
+    NSString *description = [NSString stringWithFormat:@"%s around byte %lu.", reason, (unsigned long)offset];
+
+    return [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListReadCorruptError userInfo:@{@"NSDebugDescription": description}];
+}
+
+#pragma mark - Format
+
+typedef NS_ENUM(NSUInteger, AFMessagePackType) {
+    AFMessagePackTypeNil,
+    AFMessagePackTypeBoolean,
+    AFMessagePackTypeUnsignedInteger,
+    AFMessagePackTypeSignedInteger,
+    AFMessagePackTypeFloat,
+    AFMessagePackTypeDouble,
+    AFMessagePackTypeString,
+    AFMessagePackTypeBinary,
+    AFMessagePackTypeExtension,
+    AFMessagePackTypeArray,
+    AFMessagePackTypeMap,
+};
+
+typedef NS_ENUM(NSUInteger, AFMessagePackHeaderStatus) {
+    AFMessagePackHeaderComplete,
+    AFMessagePackHeaderTruncated,
+    AFMessagePackHeaderInvalid,
+};
+
+// The bytes a value starts with: the whole of a nil, boolean or number, and the length of the payload of a string, binary data or extension, or the number of elements of an array or map
+typedef struct {
+    AFMessagePackType type;
+    NSUInteger headerLength;
+    uint64_t length;
+    uint64_t value;
+} AFMessagePackHeader;
+
+static inline uint64_t AFMessagePackReadBigEndian(const uint8_t *bytes, NSUInteger size) {
+    uint64_t value = 0;
+    for (NSUInteger idx = 0; idx < size; idx++) {
+        value = (value << 8) | bytes[idx];
+    }
+
+    return value;
+}
+
+static AFMessagePackHeaderStatus AFMessagePackReadHeader(const uint8_t *bytes, NSUInteger length, AFMessagePackHeader *header) {
+    if (length == 0) {
+        return AFMessagePackHeaderTruncated;
+    }
+
+    uint8_t byte = bytes[0];
+    memset(header, 0, sizeof(AFMessagePackHeader));
+    header->headerLength = 1;
+
+    if (byte <= 0x7F) {
+        header->type = AFMessagePackTypeUnsignedInteger;
+        header->value = byte;
+        return AFMessagePackHeaderComplete;
+    } else if (byte <= 0x8F) {
+        header->type = AFMessagePackTypeMap;
+        header->length = byte & 0x0F;
+        return AFMessagePackHeaderComplete;
+    } else if (byte <= 0x9F) {
+        header->type = AFMessagePackTypeArray;
+        header->length = byte & 0x0F;
+        return AFMessagePackHeaderComplete;
+    } else if (byte <= 0xBF) {
+        header->type = AFMessagePackTypeString;
+        header->length = byte & 0x1F;
+        return AFMessagePackHeaderComplete;
+    } else if (byte >= 0xE0) {
+        header->type = AFMessagePackTypeSignedInteger;
+        header->value = (uint64_t)(int64_t)(int8_t)byte;
+        return AFMessagePackHeaderComplete;
+    }
+
+    // The other types are followed by a big-endian length or value of `size` bytes, and extensions by their type
+    NSUInteger size = 0;
+    BOOL isLength = NO;
+    BOOL hasExtensionType = NO;
+    switch (byte) {
+        case 0xC0:
+            header->type = AFMessagePackTypeNil;
+            return AFMessagePackHeaderComplete;
+        case 0xC2:
+        case 0xC3:
+            header->type = AFMessagePackTypeBoolean;
+            header->value = byte & 0x01;
+            return AFMessagePackHeaderComplete;
+        case 0xC4: case 0xC5: case 0xC6:
+            header->type = AFMessagePackTypeBinary;
+            size = (NSUInteger)1 << (byte - 0xC4);
+            isLength = YES;
+            break;
+        case 0xC7: case 0xC8: case 0xC9:
+            header->type = AFMessagePackTypeExtension;
+            size = (NSUInteger)1 << (byte - 0xC7);
+            isLength = YES;
+            hasExtensionType = YES;
+            break;
+        case 0xCA:
+            header->type = AFMessagePackTypeFloat;
+            size = 4;
+            break;
+        case 0xCB:
+            header->type = AFMessagePackTypeDouble;
+            size = 8;
+            break;
+        case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+            header->type = AFMessagePackTypeUnsignedInteger;
+            size = (NSUInteger)1 << (byte - 0xCC);
+            break;
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+            header->type = AFMessagePackTypeSignedInteger;
+            size = (NSUInteger)1 << (byte - 0xD0);
+            break;
+        case 0xD4: case 0xD5: case 0xD6: case 0xD7: case 0xD8:
+            header->type = AFMessagePackTypeExtension;
+            header->length = (uint64_t)1 << (byte - 0xD4);
+            hasExtensionType = YES;
+            break;
+        case 0xD9: case 0xDA: case 0xDB:
+            header->type = AFMessagePackTypeString;
+            size = (NSUInteger)1 << (byte - 0xD9);
+            isLength = YES;
+            break;
+        case 0xDC: case 0xDD:
+            header->type = AFMessagePackTypeArray;
+            size = (NSUInteger)2 << (byte - 0xDC);
+            isLength = YES;
+            break;
+        case 0xDE: case 0xDF:
+            header->type = AFMessagePackTypeMap;
+            size = (NSUInteger)2 << (byte - 0xDE);
+            isLength = YES;
+            break;
+        default:
+            return AFMessagePackHeaderInvalid;
+    }
+
+    NSUInteger headerLength = 1 + size + (hasExtensionType ? 1 : 0);
+    if (length < headerLength) {
+        return AFMessagePackHeaderTruncated;
+    }
+
+    uint64_t value = AFMessagePackReadBigEndian(bytes + 1, size);
+    if (isLength) {
+        header->length = value;
+    } else if (header->type == AFMessagePackTypeSignedInteger && size < 8) {
+        NSUInteger shift = 64 - size * 8;
+        header->value = (uint64_t)((int64_t)(value << shift) >> shift);
+    } else {
+        header->value = value;
+    }
+
+    if (hasExtensionType) {
+        header->value = bytes[1 + size];
+    }
+    header->headerLength = headerLength;
+
+    return AFMessagePackHeaderComplete;
+}
+
+#pragma mark - Reading
+
+typedef struct {
+    uint8_t bytes[32];
+    NSUInteger length;
+} AFMessagePackKeyCacheEntry;
+
+typedef struct {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger position;
+    AFMessagePackReadingOptions options;
+
+    // The elements, keys and values of the arrays and maps being created, from the outermost to the innermost
+    __strong id *values;
+    NSUInteger numberOfValues;
+    NSUInteger valuesCapacity;
+    __strong id *keys;
+    NSUInteger numberOfKeys;
+    NSUInteger keysCapacity;
+
+    // Short string keys, by a hash of their bytes. Entries keep a copy of the bytes, so that keys are shared by the objects of a stream.
+    __strong id *cachedKeys;
+    AFMessagePackKeyCacheEntry *keyCacheEntries;
+
+    const char *errorReason;
+    NSUInteger errorOffset;
+} AFMessagePackReader;
+
+static id AFMessagePackReaderFail(AFMessagePackReader *reader, const char *reason, NSUInteger offset) {
+    reader->errorReason = reason;
+    reader->errorOffset = offset;
+
+    return nil;
+}
+
+static void AFMessagePackReaderPush(__strong id **stack, NSUInteger *count, NSUInteger *capacity, id object) {
+    if (*count == *capacity) {
+        NSUInteger newCapacity = MAX(*capacity * 2, (NSUInteger)64);
+        *stack = (__strong id *)realloc(*stack, newCapacity * sizeof(id));
+        memset(*stack + *capacity, 0, (newCapacity - *capacity) * sizeof(id));
+        *capacity = newCapacity;
+    }
+
+    (*stack)[(*count)++] = object;
+}
+
+static void AFMessagePackReaderPop(__strong id *stack, NSUInteger *count, NSUInteger base) {
+    for (NSUInteger idx = base; idx < *count; idx++) {
+        stack[idx] = nil;
+    }
+    *count = base;
+}
+
+static void AFMessagePackReaderInitialize(AFMessagePackReader *reader, AFMessagePackReadingOptions options) {
+    memset(reader, 0, sizeof(AFMessagePackReader));
+    reader->options = options;
+    reader->cachedKeys = (__strong id *)calloc(AFMessagePackKeyCacheSize, sizeof(id));
+    reader->keyCacheEntries = calloc(AFMessagePackKeyCacheSize, sizeof(AFMessagePackKeyCacheEntry));
+}
+
+static void AFMessagePackReaderDestroy(AFMessagePackReader *reader) {
+    // Values left by a failure are released before the buffers holding them are freed
+    AFMessagePackReaderPop(reader->values, &reader->numberOfValues, 0);
+    AFMessagePackReaderPop(reader->keys, &reader->numberOfKeys, 0);
+    NSUInteger numberOfCachedKeys = AFMessagePackKeyCacheSize;
+    AFMessagePackReaderPop(reader->cachedKeys, &numberOfCachedKeys, 0);
+    free(reader->values);
+    free(reader->keys);
+    free(reader->cachedKeys);
+    free(reader->keyCacheEntries);
+}
+
+static id AFMessagePackReadString(AFMessagePackReader *reader, const uint8_t *bytes, NSUInteger length, BOOL isKey, NSUInteger offset) {
+    AFMessagePackKeyCacheEntry *entry = NULL;
+    NSUInteger hash = 0;
+    if (isKey && length <= AFMessagePackMaximumCachedKeyLength) {
+        // FNV-1a
+        uint32_t fnv = 2166136261U;
+        for (NSUInteger idx = 0; idx < length; idx++) {
+            fnv = (fnv ^ bytes[idx]) * 16777619U;
+        }
+        hash = fnv & (AFMessagePackKeyCacheSize - 1);
+        entry = &reader->keyCacheEntries[hash];
+        if (reader->cachedKeys[hash] && entry->length == length && memcmp(entry->bytes, bytes, length) == 0) {
+            return reader->cachedKeys[hash];
+        }
+    }
+
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (!string) {
+        return AFMessagePackReaderFail(reader, "Unable to convert data to string", offset);
+    }
+
+    if (entry) {
+        memcpy(entry->bytes, bytes, length);
+        entry->length = length;
+        reader->cachedKeys[hash] = string;
+    }
+
+    return string;
+}
+
+// The timestamp extension type holds seconds and nanoseconds since 1970 in 4, 8 or 12 bytes
+static NSDate * AFMessagePackReadTimestamp(const uint8_t *bytes, NSUInteger length) {
+    int64_t seconds = 0;
+    uint64_t nanoseconds = 0;
+    if (length == 4) {
+        seconds = (int64_t)AFMessagePackReadBigEndian(bytes, 4);
+    } else if (length == 8) {
+        uint64_t value = AFMessagePackReadBigEndian(bytes, 8);
+        nanoseconds = value >> 34;
+        seconds = (int64_t)(value & 0x3FFFFFFFFULL);
+    } else if (length == 12) {
+        nanoseconds = AFMessagePackReadBigEndian(bytes, 4);
+        seconds = (int64_t)AFMessagePackReadBigEndian(bytes + 4, 8);
+    } else {
+        return nil;
+    }
+
+    if (nanoseconds >= NSEC_PER_SEC) {
+        return nil;
+    }
+
+    return [NSDate dateWithTimeIntervalSince1970:(NSTimeInterval)seconds + (NSTimeInterval)nanoseconds / NSEC_PER_SEC];
+}
+
+static id AFMessagePackReadObject(AFMessagePackReader *reader, NSUInteger depth, BOOL isKey);
+
+static id AFMessagePackReadContainer(AFMessagePackReader *reader, AFMessagePackHeader header, NSUInteger depth, NSUInteger start) {
+    if (depth >= AFMessagePackMaximumDepth) {
+        return AFMessagePackReaderFail(reader, "Too many nested arrays or maps", start);
+    }
+
+    // Every element, key and value takes at least one byte, which bounds the number of objects allocated for malformed data
+    BOOL isMap = header.type == AFMessagePackTypeMap;
+    NSUInteger count = (NSUInteger)header.length;
+    if (header.length > (reader->length - reader->position) / (isMap ? 2 : 1)) {
+        return AFMessagePackReaderFail(reader, "Unexpected end of data", reader->length);
+    }
+
+    BOOL mutableContainers = (reader->options & AFMessagePackReadingMutableContainers) != 0;
+    NSUInteger valueBase = reader->numberOfValues;
+    if (!isMap) {
+        for (NSUInteger idx = 0; idx < count; idx++) {
+            id value = AFMessagePackReadObject(reader, depth + 1, NO);
+            if (!value) {
+                return nil;
+            }
+            AFMessagePackReaderPush(&reader->values, &reader->numberOfValues, &reader->valuesCapacity, value);
+        }
+
+        Class arrayClass = mutableContainers ? [NSMutableArray class] : [NSArray class];
+        NSArray *array = [arrayClass arrayWithObjects:reader->values + valueBase count:count];
+        AFMessagePackReaderPop(reader->values, &reader->numberOfValues, valueBase);
+
+        return array;
+    }
+
+    NSUInteger keyBase = reader->numberOfKeys;
+    for (NSUInteger idx = 0; idx < count; idx++) {
+        id key = AFMessagePackReadObject(reader, depth + 1, YES);
+        if (!key) {
+            return nil;
+        }
+        id value = AFMessagePackReadObject(reader, depth + 1, NO);
+        if (!value) {
+            return nil;
+        }
+        AFMessagePackReaderPush(&reader->keys, &reader->numberOfKeys, &reader->keysCapacity, key);
+        AFMessagePackReaderPush(&reader->values, &reader->numberOfValues, &reader->valuesCapacity, value);
+    }
+
+    Class dictionaryClass = mutableContainers ? [NSMutableDictionary class] : [NSDictionary class];
+    NSDictionary *dictionary = [dictionaryClass dictionaryWithObjects:reader->values + valueBase forKeys:reader->keys + keyBase count:count];
+    if ([dictionary count] != count) {
+        // As in JSON, the last of duplicate keys wins
+        NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionaryWithCapacity:count];
+        for (NSUInteger idx = 0; idx < count; idx++) {
+            mutableDictionary[reader->keys[keyBase + idx]] = reader->values[valueBase + idx];
+        }
+        dictionary = mutableContainers ? mutableDictionary : [mutableDictionary copy];
+    }
+    AFMessagePackReaderPop(reader->keys, &reader->numberOfKeys, keyBase);
+    AFMessagePackReaderPop(reader->values, &reader->numberOfValues, valueBase);
+
+    return dictionary;
+}
+
+static id AFMessagePackReadObject(AFMessagePackReader *reader, NSUInteger depth, BOOL isKey) {
+    NSUInteger start = reader->position;
+    AFMessagePackHeader header;
+    switch (AFMessagePackReadHeader(reader->bytes + start, reader->length - start, &header)) {
+        case AFMessagePackHeaderTruncated:
+            return AFMessagePackReaderFail(reader, "Unexpected end of data", reader->length);
+        case AFMessagePackHeaderInvalid:
+            return AFMessagePackReaderFail(reader, "Invalid type", start);
+        case AFMessagePackHeaderComplete:
+            break;
+    }
+    reader->position += header.headerLength;
+
+    switch (header.type) {
+        case AFMessagePackTypeNil:
+            return [NSNull null];
+        case AFMessagePackTypeBoolean:
+            return header.value ? @YES : @NO;
+        case AFMessagePackTypeUnsignedInteger:
+            return header.value <= INT64_MAX ? @((long long)header.value) : @((unsigned long long)header.value);
+        case AFMessagePackTypeSignedInteger:
+            return @((long long)(int64_t)header.value);
+        case AFMessagePackTypeFloat: {
+            uint32_t bits = (uint32_t)header.value;
+            float value = 0;
+            memcpy(&value, &bits, sizeof(value));
+            return @(value);
+        }
+        case AFMessagePackTypeDouble: {
+            uint64_t bits = header.value;
+            double value = 0;
+            memcpy(&value, &bits, sizeof(value));
+            return @(value);
+        }
+        case AFMessagePackTypeString:
+        case AFMessagePackTypeBinary:
+        case AFMessagePackTypeExtension: {
+            if (header.length > reader->length - reader->position) {
+                return AFMessagePackReaderFail(reader, "Unexpected end of data", reader->length);
+            }
+
+            const uint8_t *payload = reader->bytes + reader->position;
+            NSUInteger payloadLength = (NSUInteger)header.length;
+            reader->position += payloadLength;
+
+            if (header.type == AFMessagePackTypeString) {
+                return AFMessagePackReadString(reader, payload, payloadLength, isKey, start);
+            } else if (header.type == AFMessagePackTypeBinary) {
+                return [NSData dataWithBytes:payload length:payloadLength];
+            } else if ((int8_t)header.value != AFMessagePackTimestampExtensionType) {
+                return AFMessagePackReaderFail(reader, "Unsupported extension type", start);
+            }
+
+            return AFMessagePackReadTimestamp(payload, payloadLength) ?: AFMessagePackReaderFail(reader, "Invalid timestamp", start);
+        }
+        case AFMessagePackTypeArray:
+        case AFMessagePackTypeMap:
+            return AFMessagePackReadContainer(reader, header, depth, start);
+    }
+
+    return AFMessagePackReaderFail(reader, "Invalid type", start);
+}
+
+// Reads the single object of the bytes, with the caches of the reader
+static id AFMessagePackReadBytes(AFMessagePackReader *reader, const uint8_t *bytes, NSUInteger length) {
+    reader->bytes = bytes;
+    reader->length = length;
+    reader->position = 0;
+    reader->errorReason = NULL;
+    reader->errorOffset = 0;
+
+    if (length == 0) {
+        return AFMessagePackReaderFail(reader, "No value", 0);
+    }
+
+    id object = AFMessagePackReadObject(reader, 0, NO);
+    if (object && reader->position != length) {
+        return AFMessagePackReaderFail(reader, "Garbage at end", reader->position);
+    }
+
+    return object;
+}
+
+#pragma mark - Writing
+
+typedef struct {
+    uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger capacity;
+    __unsafe_unretained id invalidObject;
+} AFMessagePackWriter;
+
+static inline uint8_t * AFMessagePackWriterReserve(AFMessagePackWriter *writer, NSUInteger length) {
+    if (writer->length + length > writer->capacity) {
+        writer->capacity = MAX(MAX(writer->capacity * 2, writer->length + length), (NSUInteger)256);
+        writer->bytes = realloc(writer->bytes, writer->capacity);
+    }
+
+    uint8_t *bytes = writer->bytes + writer->length;
+    writer->length += length;
+
+    return bytes;
+}
+
+static inline void AFMessagePackStoreBigEndian(uint8_t *bytes, uint64_t value, NSUInteger size) {
+    for (NSUInteger idx = 0; idx < size; idx++) {
+        bytes[size - 1 - idx] = (uint8_t)(value >> (idx * 8));
+    }
+}
+
+static inline void AFMessagePackWriteBigEndian(AFMessagePackWriter *writer, uint8_t byte, uint64_t value, NSUInteger size) {
+    uint8_t *bytes = AFMessagePackWriterReserve(writer, 1 + size);
+    bytes[0] = byte;
+    AFMessagePackStoreBigEndian(bytes + 1, value, size);
+}
+
+// Writes the header of a string, binary data, array or map: the form holding the length in the first byte, if `fixPrefix` is not 0, then the forms with a length of 1 byte, if `prefix8` is not 0, 2 and 4 bytes
+static void AFMessagePackWriteLength(AFMessagePackWriter *writer, NSUInteger length, uint8_t fixPrefix, NSUInteger fixMaximum, uint8_t prefix8, uint8_t prefix16, uint8_t prefix32) {
+    if (fixPrefix && length <= fixMaximum) {
+        *AFMessagePackWriterReserve(writer, 1) = fixPrefix | (uint8_t)length;
+    } else if (prefix8 && length <= UINT8_MAX) {
+        AFMessagePackWriteBigEndian(writer, prefix8, length, 1);
+    } else if (length <= UINT16_MAX) {
+        AFMessagePackWriteBigEndian(writer, prefix16, length, 2);
+    } else {
+        AFMessagePackWriteBigEndian(writer, prefix32, length, 4);
+    }
+}
+
+static void AFMessagePackWriteNumber(AFMessagePackWriter *writer, NSNumber *number) {
+    if (CFGetTypeID((__bridge CFTypeRef)number) == CFBooleanGetTypeID()) {
+        *AFMessagePackWriterReserve(writer, 1) = [number boolValue] ? 0xC3 : 0xC2;
+        return;
+    }
+
+    const char *type = [number objCType];
+    if (CFNumberIsFloatType((__bridge CFNumberRef)number)) {
+        if (type[0] == 'f') {
+            float value = [number floatValue];
+            uint32_t bits = 0;
+            memcpy(&bits, &value, sizeof(bits));
+            AFMessagePackWriteBigEndian(writer, 0xCA, bits, 4);
+        } else {
+            double value = [number doubleValue];
+            uint64_t bits = 0;
+            memcpy(&bits, &value, sizeof(bits));
+            AFMessagePackWriteBigEndian(writer, 0xCB, bits, 8);
+        }
+        return;
+    }
+
+    BOOL isUnsigned = type[0] != '\0' && strchr("CISLQ", type[0]) != NULL;
+    long long signedValue = [number longLongValue];
+    if (!isUnsigned && signedValue < 0) {
+        if (signedValue >= -32) {
+            *AFMessagePackWriterReserve(writer, 1) = (uint8_t)(int8_t)signedValue;
+        } else if (signedValue >= INT8_MIN) {
+            AFMessagePackWriteBigEndian(writer, 0xD0, (uint64_t)signedValue, 1);
+        } else if (signedValue >= INT16_MIN) {
+            AFMessagePackWriteBigEndian(writer, 0xD1, (uint64_t)signedValue, 2);
+        } else if (signedValue >= INT32_MIN) {
+            AFMessagePackWriteBigEndian(writer, 0xD2, (uint64_t)signedValue, 4);
+        } else {
+            AFMessagePackWriteBigEndian(writer, 0xD3, (uint64_t)signedValue, 8);
+        }
+        return;
+    }
+
+    unsigned long long value = isUnsigned ? [number unsignedLongLongValue] : (unsigned long long)signedValue;
+    if (value <= 0x7F) {
+        *AFMessagePackWriterReserve(writer, 1) = (uint8_t)value;
+    } else if (value <= UINT8_MAX) {
+        AFMessagePackWriteBigEndian(writer, 0xCC, value, 1);
+    } else if (value <= UINT16_MAX) {
+        AFMessagePackWriteBigEndian(writer, 0xCD, value, 2);
+    } else if (value <= UINT32_MAX) {
+        AFMessagePackWriteBigEndian(writer, 0xCE, value, 4);
+    } else {
+        AFMessagePackWriteBigEndian(writer, 0xCF, value, 8);
+    }
+}
+
+static void AFMessagePackWriteString(AFMessagePackWriter *writer, NSString *string) {
+    // The bytes of ASCII strings are often available as they are. The pointer alone says nothing of how many bytes there are, so it is only used when the C string is exactly as long as the string, which rules out characters encoded in several bytes and embedded NULs
+    const char *UTF8String = CFStringGetCStringPtr((__bridge CFStringRef)string, kCFStringEncodingUTF8);
+    if (UTF8String) {
+        NSUInteger length = strlen(UTF8String);
+        if (length == (NSUInteger)CFStringGetLength((__bridge CFStringRef)string)) {
+            AFMessagePackWriteLength(writer, length, 0xA0, 31, 0xD9, 0xDA, 0xDB);
+            memcpy(AFMessagePackWriterReserve(writer, length), UTF8String, length);
+            return;
+        }
+    }
+
+    NSUInteger length = [string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+    AFMessagePackWriteLength(writer, length, 0xA0, 31, 0xD9, 0xDA, 0xDB);
+    [string getBytes:AFMessagePackWriterReserve(writer, length) maxLength:length usedLength:NULL encoding:NSUTF8StringEncoding options:0 range:NSMakeRange(0, [string length]) remainingRange:NULL];
+}
+
+static void AFMessagePackWriteTimestamp(AFMessagePackWriter *writer, NSDate *date) {
+    NSTimeInterval timeInterval = [date timeIntervalSince1970];
+    int64_t seconds = (int64_t)floor(timeInterval);
+    uint64_t nanoseconds = (uint64_t)llround((timeInterval - floor(timeInterval)) * NSEC_PER_SEC);
+    if (nanoseconds >= NSEC_PER_SEC) {
+        seconds++;
+        nanoseconds -= NSEC_PER_SEC;
+    }
+
+    if (nanoseconds == 0 && seconds >= 0 && seconds <= UINT32_MAX) {
+        uint8_t *bytes = AFMessagePackWriterReserve(writer, 6);
+        bytes[0] = 0xD6;
+        bytes[1] = (uint8_t)AFMessagePackTimestampExtensionType;
+        AFMessagePackStoreBigEndian(bytes + 2, (uint64_t)seconds, 4);
+    } else if (seconds >= 0 && seconds <= 0x3FFFFFFFFLL) {
+        uint8_t *bytes = AFMessagePackWriterReserve(writer, 10);
+        bytes[0] = 0xD7;
+        bytes[1] = (uint8_t)AFMessagePackTimestampExtensionType;
+        AFMessagePackStoreBigEndian(bytes + 2, (nanoseconds << 34) | (uint64_t)seconds, 8);
+    } else {
+        uint8_t *bytes = AFMessagePackWriterReserve(writer, 15);
+        bytes[0] = 0xC7;
+        bytes[1] = 12;
+        bytes[2] = (uint8_t)AFMessagePackTimestampExtensionType;
+        AFMessagePackStoreBigEndian(bytes + 3, nanoseconds, 4);
+        AFMessagePackStoreBigEndian(bytes + 7, (uint64_t)seconds, 8);
+    }
+}
+
+static BOOL AFMessagePackWriteObject(AFMessagePackWriter *writer, id object, NSUInteger depth) {
+    if (depth >= AFMessagePackMaximumDepth) {
+        writer->invalidObject = object;
+        return NO;
+    }
+
+    if ([object isKindOfClass:[NSString class]]) {
+        AFMessagePackWriteString(writer, object);
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        AFMessagePackWriteNumber(writer, object);
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        NSDictionary *dictionary = object;
+        AFMessagePackWriteLength(writer, [dictionary count], 0x80, 15, 0, 0xDE, 0xDF);
+
+        __block BOOL succeeded = YES;
+        [dictionary enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            if (!AFMessagePackWriteObject(writer, key, depth + 1) || !AFMessagePackWriteObject(writer, value, depth + 1)) {
+                succeeded = NO;
+                *stop = YES;
+            }
+        }];
+
+        return succeeded;
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        NSArray *array = object;
+        AFMessagePackWriteLength(writer, [array count], 0x90, 15, 0, 0xDC, 0xDD);
+        for (id element in array) {
+            if (!AFMessagePackWriteObject(writer, element, depth + 1)) {
+                return NO;
+            }
+        }
+    } else if (object == [NSNull null]) {
+        *AFMessagePackWriterReserve(writer, 1) = 0xC0;
+    } else if ([object isKindOfClass:[NSData class]]) {
+        NSData *data = object;
+        AFMessagePackWriteLength(writer, [data length], 0, 0, 0xC4, 0xC5, 0xC6);
+        [data getBytes:AFMessagePackWriterReserve(writer, [data length]) length:[data length]];
+    } else if ([object isKindOfClass:[NSDate class]]) {
+        AFMessagePackWriteTimestamp(writer, object);
+    } else {
+        writer->invalidObject = object;
+        return NO;
+    }
+
+    return YES;
+}
+
+#pragma mark -
+
+@implementation AFMessagePackSerialization
+
++ (BOOL)isValidMessagePackObject:(id)object {
+    if ([object isKindOfClass:[NSDictionary class]]) {
+        __block BOOL isValid = YES;
+        [(NSDictionary *)object enumerateKeysAndObjectsUsingBlock:^(id key, id value, BOOL *stop) {
+            if (![self isValidMessagePackObject:key] || ![self isValidMessagePackObject:value]) {
+                isValid = NO;
+                *stop = YES;
+            }
+        }];
+
+        return isValid;
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        for (id element in object) {
+            if (![self isValidMessagePackObject:element]) {
+                return NO;
+            }
+        }
+
+        return YES;
+    }
+
+    return [object isKindOfClass:[NSString class]] || [object isKindOfClass:[NSNumber class]] || object == [NSNull null] || [object isKindOfClass:[NSData class]] || [object isKindOfClass:[NSDate class]];
+}
+
++ (NSData *)dataWithMessagePackObject:(id)object
+                                error:(NSError *__autoreleasing *)error
+{
+    NSParameterAssert(object);
+
+    AFMessagePackWriter writer;
+    memset(&writer, 0, sizeof(AFMessagePackWriter));
+
+    if (!AFMessagePackWriteObject(&writer, object, 0)) {
+        if (error) {
+            NSString *description = [NSString stringWithFormat:@"Invalid type in MessagePack write (%@)", NSStringFromClass([writer.invalidObject class])];
+            *error = [NSError errorWithDomain:NSCocoaErrorDomain code:NSPropertyListWriteInvalidError userInfo:@{@"NSDebugDescription": description}];
+        }
+        free(writer.bytes);
+
+        return nil;
+    }
+
+    return [NSData dataWithBytesNoCopy:writer.bytes length:writer.length freeWhenDone:YES];
+}
+
++ (id)messagePackObjectWithData:(NSData *)data
+                        options:(AFMessagePackReadingOptions)options
+                          error:(NSError *__autoreleasing *)error
+{
+    NSParameterAssert(data);
+
+    AFMessagePackReader reader;
+    AFMessagePackReaderInitialize(&reader, options);
+    id object = AFMessagePackReadBytes(&reader, [data bytes], [data length]);
+    if (!object && error) {
+        *error = AFMessagePackReadingError(reader.errorReason, reader.errorOffset);
+    }
+    AFMessagePackReaderDestroy(&reader);
+
+    return object;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFMessagePackStreamDecoder () {
+    AFMessagePackReader _reader;
+
+    // The number of values left in the arrays and maps of the partial object, from the outermost to the innermost
+    uint64_t *_remainingValues;
+    NSUInteger _depth;
+
+    // The number of bytes left in the payload of the string, binary data or extension being scanned
+    uint64_t _remainingPayloadLength;
+}
+@property (readwrite, nonatomic, assign) AFMessagePackReadingOptions readingOptions;
+@property (readwrite, nonatomic, strong) NSMutableData *partialObjectData;
+@property (readwrite, nonatomic, assign) NSUInteger scannedLength;
+@property (readwrite, nonatomic, assign) NSUInteger decodedLength;
+@property (readwrite, nonatomic, strong) NSError *error;
+@end
+
+@implementation AFMessagePackStreamDecoder
+
+- (instancetype)init {
+    return [self initWithReadingOptions:0];
+}
+
+- (instancetype)initWithReadingOptions:(AFMessagePackReadingOptions)readingOptions {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.readingOptions = readingOptions;
+    self.partialObjectData = [NSMutableData data];
+    AFMessagePackReaderInitialize(&_reader, readingOptions);
+    _remainingValues = calloc(AFMessagePackMaximumDepth, sizeof(uint64_t));
+
+    return self;
+}
+
+- (void)dealloc {
+    AFMessagePackReaderDestroy(&_reader);
+    free(_remainingValues);
+}
+
+- (BOOL)hasPartialObject {
+    return [self.partialObjectData length] > 0;
+}
+
+- (NSArray *)failWithReason:(const char *)reason
+                     offset:(NSUInteger)offset
+                      error:(NSError *__autoreleasing *)error
+{
+    self.error = AFMessagePackReadingError(reason, self.decodedLength + offset);
+    if (error) {
+        *error = self.error;
+    }
+
+    return nil;
+}
+
+- (NSArray *)objectsByDecodingData:(NSData *)data
+                             error:(NSError *__autoreleasing *)error
+{
+    if (self.error) {
+        if (error) {
+            *error = self.error;
+        }
+        return nil;
+    }
+
+    // Objects are scanned in the data itself, unless the data continues a partial object
+    BOOL continuesPartialObject = [self.partialObjectData length] > 0;
+    if (continuesPartialObject) {
+        [self.partialObjectData appendData:data];
+    }
+    NSData *scannedData = continuesPartialObject ? self.partialObjectData : data;
+    const uint8_t *bytes = [scannedData bytes];
+    NSUInteger length = [scannedData length];
+
+    NSMutableArray *objects = [NSMutableArray array];
+    NSUInteger objectStart = 0;
+    NSUInteger offset = self.scannedLength;
+    while (offset < length) {
+        if (_remainingPayloadLength > 0) {
+            NSUInteger skippedLength = (NSUInteger)MIN(_remainingPayloadLength, (uint64_t)(length - offset));
+            offset += skippedLength;
+            _remainingPayloadLength -= skippedLength;
+            if (_remainingPayloadLength > 0) {
+                break;
+            }
+        } else {
+            AFMessagePackHeader header;
+            AFMessagePackHeaderStatus status = AFMessagePackReadHeader(bytes + offset, length - offset, &header);
+            if (status == AFMessagePackHeaderTruncated) {
+                break;
+            } else if (status == AFMessagePackHeaderInvalid) {
+                return [self failWithReason:"Invalid type" offset:offset error:error];
+            }
+
+            offset += header.headerLength;
+            if (_depth > 0) {
+                _remainingValues[_depth - 1]--;
+            }
+
+            if (header.type == AFMessagePackTypeArray || header.type == AFMessagePackTypeMap) {
+                uint64_t numberOfValues = header.type == AFMessagePackTypeMap ? header.length * 2 : header.length;
+                if (numberOfValues > 0) {
+                    if (_depth >= AFMessagePackMaximumDepth) {
+                        return [self failWithReason:"Too many nested arrays or maps" offset:offset - header.headerLength error:error];
+                    }
+                    _remainingValues[_depth++] = numberOfValues;
+                    continue;
+                }
+            } else if (header.type == AFMessagePackTypeString || header.type == AFMessagePackTypeBinary || header.type == AFMessagePackTypeExtension) {
+                _remainingPayloadLength = header.length;
+                if (_remainingPayloadLength > 0) {
+                    continue;
+                }
+            }
+        }
+
+        // A value has ended, and with it any array or map it was the last value of
+        while (_depth > 0 && _remainingValues[_depth - 1] == 0) {
+            _depth--;
+        }
+
+        if (_depth == 0) {
+            id object = AFMessagePackReadBytes(&_reader, bytes + objectStart, offset - objectStart);
+            if (!object) {
+                return [self failWithReason:_reader.errorReason offset:objectStart + _reader.errorOffset error:error];
+            }
+            [objects addObject:object];
+            objectStart = offset;
+        }
+    }
+
+    self.scannedLength = offset - objectStart;
+    self.decodedLength += objectStart;
+    if (continuesPartialObject) {
+        [self.partialObjectData replaceBytesInRange:NSMakeRange(0, objectStart) withBytes:NULL length:0];
+    } else {
+        [self.partialObjectData appendBytes:bytes + objectStart length:length - objectStart];
+    }
+
+    return objects;
+}
+
+@end
@@ -29,6 +29,9 @@
 
     #import "AFURLRequestSerialization.h"
     #import "AFURLResponseSerialization.h"
+    #import "AFJSONParser.h"
+    #import "AFMessagePackSerialization.h"
+    #import "AFXMLPushParser.h"
     #import "AFSecurityPolicy.h"
 
 #if !TARGET_OS_WATCH
@@ -37,5 +40,10 @@
 
     #import "AFURLSessionManager.h"
     #import "AFHTTPSessionManager.h"
+    #import "AFChunkedUploader.h"
+    #import "AFSegmentedDownloader.h"
+    #import "AFCompletionCoalescer.h"
+    #import "AFRequestScheduler.h"
+    #import "AFHedgingPolicy.h"
 
 #endif /* _AFNETWORKING_ */
@@ -0,0 +1,67 @@
+// AFRangeRequests.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ Returns the position of the first byte of a `Content-Range: bytes <first>-<last>/<total>` header of the specified response, or `-1` if it cannot be parsed.
+ */
+static inline int64_t AFContentRangeStartOfResponse(NSHTTPURLResponse *response) {
+    NSString *contentRange = [response allHeaderFields][@"Content-Range"];
+    NSScanner *scanner = contentRange ? [NSScanner scannerWithString:contentRange] : nil;
+    long long start = 0;
+    if (![scanner scanString:@"bytes" intoString:NULL] || ![scanner scanLongLong:&start] || ![scanner scanString:@"-" intoString:NULL]) {
+        return -1;
+    }
+
+    return start;
+}
+
+/**
+ Returns the complete length of the representation in a `Content-Range: bytes <first>-<last>/<total>` header of the specified response, which has `*` in place of `<first>-<last>` for an unsatisfiable range, or `-1` if it cannot be parsed or is unknown.
+ */
+static inline int64_t AFContentRangeCompleteLengthOfResponse(NSHTTPURLResponse *response) {
+    NSString *contentRange = [response allHeaderFields][@"Content-Range"];
+    NSScanner *scanner = contentRange ? [NSScanner scannerWithString:contentRange] : nil;
+    long long completeLength = 0;
+    if (![scanner scanString:@"bytes" intoString:NULL] || ![scanner scanUpToString:@"/" intoString:NULL] || ![scanner scanString:@"/" intoString:NULL] || ![scanner scanLongLong:&completeLength]) {
+        return -1;
+    }
+
+    return completeLength;
+}
+
+/**
+ Returns the value of an `If-Range` header for a representation with the specified `ETag` and `Last-Modified` values, or `nil` if neither can be used.
+
+ Weak entity tags only mark semantically equivalent representations, which may differ byte for byte, so `Last-Modified` is used instead of them.
+ */
+static inline NSString * _Nullable AFRangeValidatorForRepresentation(id _Nullable ETag, id _Nullable lastModified) {
+    if ([ETag isKindOfClass:[NSString class]] && ![ETag hasPrefix:@"W/"]) {
+        return ETag;
+    }
+
+    return [lastModified isKindOfClass:[NSString class]] ? lastModified : nil;
+}
+
+NS_ASSUME_NONNULL_END
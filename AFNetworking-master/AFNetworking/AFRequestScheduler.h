@@ -0,0 +1,113 @@
+// AFRequestScheduler.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ The priority classes of the requests of an `AFRequestScheduler`. Queued requests of a higher class are started first, and each class sets the `priority` of its tasks, which `NSURLSession` uses to order the requests sharing a connection.
+
+ - `AFRequestPriorityBackground`: Prefetching and other work nobody is waiting for. Task priority `0.0`.
+ - `AFRequestPriorityLow`: Task priority `NSURLSessionTaskPriorityLow`.
+ - `AFRequestPriorityNormal`: Task priority `NSURLSessionTaskPriorityDefault`.
+ - `AFRequestPriorityHigh`: Requests for content the user is waiting for. Task priority `NSURLSessionTaskPriorityHigh`.
+ */
+typedef NS_ENUM(NSInteger, AFRequestPriority) {
+    AFRequestPriorityBackground = 0,
+    AFRequestPriorityLow,
+    AFRequestPriorityNormal,
+    AFRequestPriorityHigh,
+};
+
+/**
+ `AFRequestScheduler` decides when the tasks scheduled with it are resumed, so that a burst of low priority requests does not hold back the requests the user is waiting for.
+
+ A scheduled task is resumed as soon as fewer than `maximumNumberOfConcurrentRequests` scheduled tasks are running, and fewer than `maximumNumberOfConcurrentRequestsPerHost` to its host. Otherwise it is queued, and queued tasks are resumed highest priority first, in the order they were scheduled within a priority class. A queued task whose host is at its limit does not hold back the tasks for other hosts.
+
+ Queued tasks can be reprioritized or cancelled at any time, without scanning the queue. A scheduler must be told when its tasks complete with `-didCompleteTask:`; `AFHTTPSessionManager` does so for the tasks it scheduled, on the scheduler they were scheduled on, and for any other task of its session on its current `requestScheduler`. A scheduler can be shared by several managers, so that their limits are enforced together.
+ */
+@interface AFRequestScheduler : NSObject
+
+/**
+ The maximum number of scheduled tasks running at once. `8` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfConcurrentRequests;
+
+/**
+ The maximum number of scheduled tasks running at once to the same host. `4` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfConcurrentRequestsPerHost;
+
+/**
+ The number of scheduled tasks that have been resumed and have not completed.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfRunningTasks;
+
+/**
+ The number of scheduled tasks waiting to be resumed.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfQueuedTasks;
+
+/**
+ Schedules a task, which is resumed immediately if the limits allow it, or queued otherwise.
+
+ @param task The task, which must not have been resumed. Its `priority` is set from the specified priority class.
+ @param priority The priority class of the task.
+ */
+- (void)scheduleTask:(NSURLSessionTask *)task
+            priority:(AFRequestPriority)priority;
+
+/**
+ Changes the priority class of a scheduled task. A queued task is moved to the queue of its new class; the `priority` of a running task is updated.
+
+ @param priority The new priority class of the task.
+ @param task The scheduled task.
+
+ @return `YES` if the task is queued or running, `NO` if it was not scheduled or has completed.
+ */
+- (BOOL)setPriority:(AFRequestPriority)priority
+            forTask:(NSURLSessionTask *)task;
+
+/**
+ Returns the priority class of a scheduled task, or `AFRequestPriorityNormal` if the task is not queued or running.
+
+ @param task The task.
+ */
+- (AFRequestPriority)priorityForTask:(NSURLSessionTask *)task;
+
+/**
+ Cancels a scheduled task. A queued task is removed from its queue before it is cancelled, so it is never sent.
+
+ @param task The task to cancel.
+ */
+- (void)cancelTask:(NSURLSessionTask *)task;
+
+/**
+ Tells the scheduler that a task has completed, so that its slot is given to the next queued task. Called by `AFHTTPSessionManager` from `URLSession:task:didCompleteWithError:` for the tasks it scheduled, and for any other task of its session when it is the manager's `requestScheduler`. Tasks that were not scheduled are ignored.
+
+ @param task The task that completed.
+ */
+- (void)didCompleteTask:(NSURLSessionTask *)task;
+
+@end
+
+NS_ASSUME_NONNULL_END
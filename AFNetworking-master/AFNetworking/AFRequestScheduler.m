@@ -0,0 +1,230 @@
+// AFRequestScheduler.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFRequestScheduler.h"
+
+static NSUInteger const AFRequestSchedulerDefaultMaximumNumberOfConcurrentRequests = 8;
+static NSUInteger const AFRequestSchedulerDefaultMaximumNumberOfConcurrentRequestsPerHost = 4;
+static NSUInteger const AFRequestSchedulerNumberOfPriorities = AFRequestPriorityHigh + 1;
+
+static float AFTaskPriorityForRequestPriority(AFRequestPriority priority) {
+    switch (priority) {
+        case AFRequestPriorityBackground:
+            return 0.0f;
+        case AFRequestPriorityLow:
+            return NSURLSessionTaskPriorityLow;
+        case AFRequestPriorityHigh:
+            return NSURLSessionTaskPriorityHigh;
+        case AFRequestPriorityNormal:
+        default:
+            return NSURLSessionTaskPriorityDefault;
+    }
+}
+
+static AFRequestPriority AFRequestPriorityClamp(AFRequestPriority priority) {
+    return MIN(MAX(priority, AFRequestPriorityBackground), AFRequestPriorityHigh);
+}
+
+@interface AFScheduledTask : NSObject
+@property (readwrite, nonatomic, strong) NSURLSessionTask *task;
+@property (readwrite, nonatomic, copy) NSString *host;
+@property (readwrite, nonatomic, assign) AFRequestPriority priority;
+@property (readwrite, nonatomic, assign, getter=isRunning) BOOL running;
+@end
+
+@implementation AFScheduledTask
+@end
+
+#pragma mark -
+
+@interface AFRequestScheduler ()
+@property (readwrite, nonatomic, strong) NSLock *lock;
+@property (readwrite, nonatomic, strong) NSMapTable <NSURLSessionTask *, AFScheduledTask *> *scheduledTasks;
+@property (readwrite, nonatomic, copy) NSArray <NSMutableOrderedSet <AFScheduledTask *> *> *queues;
+@property (readwrite, nonatomic, strong) NSCountedSet <NSString *> *runningHosts;
+@property (readwrite, atomic, assign) NSUInteger numberOfRunningTasks;
+@property (readwrite, atomic, assign) NSUInteger numberOfQueuedTasks;
+@end
+
+@implementation AFRequestScheduler
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.lock = [[NSLock alloc] init];
+    self.scheduledTasks = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory | NSPointerFunctionsObjectPointerPersonality valueOptions:NSPointerFunctionsStrongMemory];
+    NSMutableArray *mutableQueues = [NSMutableArray arrayWithCapacity:AFRequestSchedulerNumberOfPriorities];
+    for (NSUInteger idx = 0; idx < AFRequestSchedulerNumberOfPriorities; idx++) {
+        [mutableQueues addObject:[NSMutableOrderedSet orderedSet]];
+    }
+    self.queues = mutableQueues;
+    self.runningHosts = [NSCountedSet set];
+
+    _maximumNumberOfConcurrentRequests = AFRequestSchedulerDefaultMaximumNumberOfConcurrentRequests;
+    _maximumNumberOfConcurrentRequestsPerHost = AFRequestSchedulerDefaultMaximumNumberOfConcurrentRequestsPerHost;
+
+    return self;
+}
+
+- (void)setMaximumNumberOfConcurrentRequests:(NSUInteger)maximumNumberOfConcurrentRequests {
+    _maximumNumberOfConcurrentRequests = maximumNumberOfConcurrentRequests;
+
+    [self resumeQueuedTasks];
+}
+
+- (void)setMaximumNumberOfConcurrentRequestsPerHost:(NSUInteger)maximumNumberOfConcurrentRequestsPerHost {
+    _maximumNumberOfConcurrentRequestsPerHost = maximumNumberOfConcurrentRequestsPerHost;
+
+    [self resumeQueuedTasks];
+}
+
+- (void)scheduleTask:(NSURLSessionTask *)task
+            priority:(AFRequestPriority)priority
+{
+    NSParameterAssert(task);
+
+    AFScheduledTask *scheduledTask = [[AFScheduledTask alloc] init];
+    scheduledTask.task = task;
+    scheduledTask.host = [task.originalRequest.URL.host lowercaseString] ?: @"";
+    scheduledTask.priority = AFRequestPriorityClamp(priority);
+    task.priority = AFTaskPriorityForRequestPriority(scheduledTask.priority);
+
+    [self.lock lock];
+    if (![self.scheduledTasks objectForKey:task]) {
+        [self.scheduledTasks setObject:scheduledTask forKey:task];
+        [self.queues[scheduledTask.priority] addObject:scheduledTask];
+        self.numberOfQueuedTasks++;
+    }
+    [self.lock unlock];
+
+    [self resumeQueuedTasks];
+}
+
+- (BOOL)setPriority:(AFRequestPriority)priority
+            forTask:(NSURLSessionTask *)task
+{
+    priority = AFRequestPriorityClamp(priority);
+
+    [self.lock lock];
+    AFScheduledTask *scheduledTask = [self.scheduledTasks objectForKey:task];
+    if (scheduledTask && scheduledTask.priority != priority) {
+        if (!scheduledTask.running) {
+            [self.queues[scheduledTask.priority] removeObject:scheduledTask];
+            [self.queues[priority] addObject:scheduledTask];
+        }
+        scheduledTask.priority = priority;
+    }
+    [self.lock unlock];
+
+    if (!scheduledTask) {
+        return NO;
+    }
+
+    task.priority = AFTaskPriorityForRequestPriority(priority);
+
+    // A task moved ahead of others may fit where the head of its previous queue did not
+    [self resumeQueuedTasks];
+
+    return YES;
+}
+
+- (AFRequestPriority)priorityForTask:(NSURLSessionTask *)task {
+    [self.lock lock];
+    AFScheduledTask *scheduledTask = [self.scheduledTasks objectForKey:task];
+    AFRequestPriority priority = scheduledTask ? scheduledTask.priority : AFRequestPriorityNormal;
+    [self.lock unlock];
+
+    return priority;
+}
+
+- (void)cancelTask:(NSURLSessionTask *)task {
+    [self.lock lock];
+    AFScheduledTask *scheduledTask = [self.scheduledTasks objectForKey:task];
+    if (scheduledTask && !scheduledTask.running) {
+        [self.queues[scheduledTask.priority] removeObject:scheduledTask];
+        [self.scheduledTasks removeObjectForKey:task];
+        self.numberOfQueuedTasks--;
+    }
+    [self.lock unlock];
+
+    [task cancel];
+}
+
+- (void)didCompleteTask:(NSURLSessionTask *)task {
+    [self.lock lock];
+    AFScheduledTask *scheduledTask = [self.scheduledTasks objectForKey:task];
+    if (scheduledTask) {
+        if (scheduledTask.running) {
+            [self.runningHosts removeObject:scheduledTask.host];
+            self.numberOfRunningTasks--;
+        } else {
+            // Cancelled directly while queued
+            [self.queues[scheduledTask.priority] removeObject:scheduledTask];
+            self.numberOfQueuedTasks--;
+        }
+        [self.scheduledTasks removeObjectForKey:task];
+    }
+    [self.lock unlock];
+
+    if (scheduledTask) {
+        [self resumeQueuedTasks];
+    }
+}
+
+- (void)resumeQueuedTasks {
+    NSUInteger maximumNumberOfConcurrentRequests = self.maximumNumberOfConcurrentRequests;
+    NSUInteger maximumNumberOfConcurrentRequestsPerHost = self.maximumNumberOfConcurrentRequestsPerHost;
+    NSMutableArray <NSURLSessionTask *> *tasksToResume = [NSMutableArray array];
+
+    [self.lock lock];
+    for (NSInteger priority = AFRequestPriorityHigh; priority >= AFRequestPriorityBackground && self.numberOfRunningTasks < maximumNumberOfConcurrentRequests; priority--) {
+        NSMutableOrderedSet <AFScheduledTask *> *queue = self.queues[(NSUInteger)priority];
+        NSMutableIndexSet *startedIndexes = [NSMutableIndexSet indexSet];
+        [queue enumerateObjectsUsingBlock:^(AFScheduledTask *scheduledTask, NSUInteger idx, BOOL *stop) {
+            if (self.numberOfRunningTasks >= maximumNumberOfConcurrentRequests) {
+                *stop = YES;
+                return;
+            }
+
+            if ([self.runningHosts countForObject:scheduledTask.host] >= maximumNumberOfConcurrentRequestsPerHost) {
+                return;
+            }
+
+            scheduledTask.running = YES;
+            [self.runningHosts addObject:scheduledTask.host];
+            self.numberOfRunningTasks++;
+            self.numberOfQueuedTasks--;
+            [startedIndexes addIndex:idx];
+            [tasksToResume addObject:scheduledTask.task];
+        }];
+        [queue removeObjectsAtIndexes:startedIndexes];
+    }
+    [self.lock unlock];
+
+    for (NSURLSessionTask *task in tasksToResume) {
+        [task resume];
+    }
+}
+
+@end
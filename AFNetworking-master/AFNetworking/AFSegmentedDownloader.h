@@ -0,0 +1,126 @@
+// AFSegmentedDownloader.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#import <Foundation/Foundation.h>
+
+#import "AFURLSessionManager.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AFSegmentedDownloadTask;
+
+/**
+ `AFSegmentedDownloader` downloads large resources as several byte ranges at once, using the data tasks of an `AFURLSessionManager`. On links where a single connection is held back by latency or by a per-connection rate limit, the segments together use more of the available bandwidth.
+
+ ## Download Protocol
+
+ A download starts with a `HEAD` request for the resource. If the server responds with a `Content-Length` and `Accept-Ranges: bytes`, and the resource is at least twice `minimumSegmentSize` bytes long, the resource is split into up to `maximumNumberOfSegments` segments of equal length. Each segment is requested with a `Range` header, and an `If-Range` header with the `ETag` or `Last-Modified` date of the `HEAD` response, so that every segment comes from the same version of the resource. The segments are written straight to their offsets in a single file, allocated at its final size before the first segment is requested.
+
+ Resources that cannot be downloaded in segments are downloaded with a single download task of the session manager.
+ */
+@interface AFSegmentedDownloader : NSObject
+
+/**
+ The session manager whose tasks download the segments.
+ */
+@property (readonly, nonatomic, strong) AFURLSessionManager *sessionManager;
+
+/**
+ The maximum number of segments a resource is split into, which are all downloaded at the same time. `4` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfSegments;
+
+/**
+ The minimum length of a segment, in bytes. Smaller resources are split into fewer segments, or downloaded with a single task. `1 MB` by default.
+ */
+@property (nonatomic, assign) unsigned long long minimumSegmentSize;
+
+/**
+ The number of times a segment is retried after it fails, before the download fails. A retried segment continues from the last byte it received. `3` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfRetriesPerSegment;
+
+/**
+ The delay before the first retry of a failed segment, which is doubled for each further retry of the same segment. `1` second by default.
+ */
+@property (nonatomic, assign) NSTimeInterval retryInterval;
+
+/**
+ Initializes a downloader transferring segments with the specified session manager.
+
+ @param sessionManager The session manager. This parameter must not be `nil`.
+ */
+- (instancetype)initWithSessionManager:(AFURLSessionManager *)sessionManager NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Creates a download of the resource of the specified request. The download starts when it is resumed.
+
+ @param request The `GET` request for the resource.
+ @param downloadProgressBlock A block object to be executed as segments are received. Note this block is called on a private queue, not the main queue.
+ @param destination A block object to be executed once the download is complete, which takes the temporary location of the downloaded file and the response to the `HEAD` request, and returns the URL to which the file is moved.
+ @param completionHandler A block object to be executed when the download has completed, or has failed. It is called on the `completionQueue` of the session manager, or the main queue.
+ */
+- (AFSegmentedDownloadTask *)downloadTaskWithRequest:(NSURLRequest *)request
+                                            progress:(nullable void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                                         destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                                   completionHandler:(nullable void (^)(NSURLResponse * _Nullable response, NSURL * _Nullable filePath, NSError * _Nullable error))completionHandler;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFSegmentedDownloadTask` is a single download created by an `AFSegmentedDownloader`.
+ */
+@interface AFSegmentedDownloadTask : NSObject
+
+/**
+ The request for the resource being downloaded.
+ */
+@property (readonly, nonatomic, copy) NSURLRequest *request;
+
+/**
+ The number of segments the resource is downloaded in, known once the `HEAD` request has completed. `1` if the resource is downloaded with a single task.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfSegments;
+
+/**
+ The progress of the download, in bytes. Cancelling the progress cancels the download.
+ */
+@property (readonly, nonatomic, strong) NSProgress *progress;
+
+/**
+ Starts the download.
+ */
+- (void)resume;
+
+/**
+ Cancels the download, and removes the bytes received so far.
+ */
+- (void)cancel;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,520 @@
+// AFSegmentedDownloader.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#import "AFSegmentedDownloader.h"
+#import "AFRangeRequests.h"
+
+#import <fcntl.h>
+
+static NSError * AFSegmentedDownloadErrorWithPOSIXCode(int code, NSURL *fileURL) {
+    return [NSError errorWithDomain:NSPOSIXErrorDomain code:code userInfo:@{NSURLErrorKey: fileURL}];
+}
+
+#pragma mark -
+
+@interface AFSegmentedDownloadSegment : NSObject
+@property (readwrite, nonatomic, assign) unsigned long long offset;
+@property (readwrite, nonatomic, assign) unsigned long long length;
+@property (readwrite, atomic, assign) unsigned long long numberOfBytesWritten;
+@property (readwrite, atomic, assign) unsigned long long requestedOffset;
+@property (readwrite, atomic, assign, getter = isResponseAccepted) BOOL responseAccepted;
+@property (readwrite, atomic, strong) NSError *error;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfFailures;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *task;
+@end
+
+@implementation AFSegmentedDownloadSegment
+@end
+
+#pragma mark -
+
+@interface AFSegmentedDownloadTask ()
+@property (readwrite, nonatomic, copy) NSURLRequest *request;
+@property (readwrite, atomic, assign) NSUInteger numberOfSegments;
+@property (readwrite, nonatomic, strong) NSProgress *progress;
+
+@property (readwrite, nonatomic, strong) AFSegmentedDownloader *downloader;
+@property (readwrite, nonatomic, strong) dispatch_queue_t queue;
+@property (readwrite, nonatomic, copy) void (^downloadProgressBlock)(NSProgress *downloadProgress);
+@property (readwrite, nonatomic, copy) NSURL * (^destination)(NSURL *targetPath, NSURLResponse *response);
+@property (readwrite, nonatomic, copy) void (^completionHandler)(NSURLResponse *response, NSURL *filePath, NSError *error);
+
+@property (readwrite, nonatomic, strong) NSHTTPURLResponse *response;
+@property (readwrite, nonatomic, copy) NSString *validator;
+@property (readwrite, nonatomic, copy) NSURL *temporaryFileURL;
+@property (readwrite, nonatomic, assign) int fileDescriptor;
+@property (readwrite, nonatomic, strong) NSArray <AFSegmentedDownloadSegment *> *segments;
+@property (readwrite, nonatomic, strong) NSURLSessionTask *headTask;
+@property (readwrite, nonatomic, strong) NSURLSessionDownloadTask *downloadTask;
+@property (readwrite, nonatomic, assign, getter = isResumed) BOOL resumed;
+@property (readwrite, nonatomic, assign, getter = isFinished) BOOL finished;
+
+- (instancetype)initWithDownloader:(AFSegmentedDownloader *)downloader
+                           request:(NSURLRequest *)request;
+@end
+
+#pragma mark -
+
+@interface AFSegmentedDownloader ()
+@property (readwrite, nonatomic, strong) AFURLSessionManager *sessionManager;
+@end
+
+@implementation AFSegmentedDownloader
+
+- (instancetype)initWithSessionManager:(AFURLSessionManager *)sessionManager {
+    NSParameterAssert(sessionManager);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.sessionManager = sessionManager;
+    self.maximumNumberOfSegments = 4;
+    self.minimumSegmentSize = 1024 * 1024;
+    self.maximumNumberOfRetriesPerSegment = 3;
+    self.retryInterval = 1.0;
+
+    return self;
+}
+
+- (AFSegmentedDownloadTask *)downloadTaskWithRequest:(NSURLRequest *)request
+                                            progress:(void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                                         destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                                   completionHandler:(void (^)(NSURLResponse *response, NSURL *filePath, NSError *error))completionHandler
+{
+    NSParameterAssert(request);
+    NSParameterAssert(destination);
+
+    AFSegmentedDownloadTask *task = [[AFSegmentedDownloadTask alloc] initWithDownloader:self request:request];
+    task.downloadProgressBlock = downloadProgressBlock;
+    task.destination = destination;
+    task.completionHandler = completionHandler;
+
+    return task;
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFSegmentedDownloadTask
+
+- (instancetype)initWithDownloader:(AFSegmentedDownloader *)downloader
+                           request:(NSURLRequest *)request
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.downloader = downloader;
+    self.request = request;
+    self.fileDescriptor = -1;
+    self.queue = dispatch_queue_create("com.alamofire.networking.segmented-download", DISPATCH_QUEUE_SERIAL);
+
+    self.progress = [[NSProgress alloc] initWithParent:nil userInfo:nil];
+    self.progress.totalUnitCount = NSURLSessionTransferSizeUnknown;
+    self.progress.cancellable = YES;
+    __weak __typeof__(self) weakSelf = self;
+    self.progress.cancellationHandler = ^{
+        [weakSelf cancel];
+    };
+
+    return self;
+}
+
+- (void)dealloc {
+    if (_fileDescriptor >= 0) {
+        close(_fileDescriptor);
+    }
+}
+
+- (void)resume {
+    dispatch_async(self.queue, ^{
+        if ([self isResumed] || [self isFinished]) {
+            return;
+        }
+        self.resumed = YES;
+
+        NSMutableURLRequest *request = [self.request mutableCopy];
+        request.HTTPMethod = @"HEAD";
+
+        // The session manager holds on to these blocks until the task completes, which keeps the download alive while it is running
+        self.headTask = [self.downloader.sessionManager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+            dispatch_async(self.queue, ^{
+                [self didReceiveHeadResponse:response error:error];
+            });
+        }];
+        [self.headTask resume];
+    });
+}
+
+- (void)cancel {
+    dispatch_async(self.queue, ^{
+        if ([self isFinished]) {
+            return;
+        }
+
+        [self.headTask cancel];
+        [self.downloadTask cancel];
+        for (AFSegmentedDownloadSegment *segment in self.segments) {
+            [segment.task cancel];
+        }
+
+        [self finishWithFileURL:nil error:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:nil]];
+    });
+}
+
+#pragma mark -
+
+- (void)didReceiveHeadResponse:(NSURLResponse *)response
+                         error:(NSError *)error
+{
+    self.headTask = nil;
+
+    if ([self isFinished]) {
+        return;
+    }
+
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        [self finishWithFileURL:nil error:error];
+        return;
+    }
+
+    // Servers that do not support `HEAD`, or report an error for it, are left to answer the download itself
+    NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+    NSDictionary *headers = [HTTPResponse allHeaderFields];
+    NSString *contentLength = headers[@"Content-Length"];
+    BOOL acceptsRanges = [[headers[@"Accept-Ranges"] lowercaseString] rangeOfString:@"bytes"].location != NSNotFound;
+    unsigned long long minimumSegmentSize = MAX(self.downloader.minimumSegmentSize, 1ULL);
+    if (error || !acceptsRanges || !contentLength || [contentLength longLongValue] < (long long)(minimumSegmentSize * 2) || self.downloader.maximumNumberOfSegments < 2) {
+        [self startSingleDownload];
+        return;
+    }
+
+    self.validator = AFRangeValidatorForRepresentation(headers[@"ETag"], headers[@"Last-Modified"]);
+    self.response = HTTPResponse;
+
+    unsigned long long length = (unsigned long long)[contentLength longLongValue];
+    NSError *fileError = nil;
+    if (![self allocateFileOfLength:length error:&fileError]) {
+        [self finishWithFileURL:nil error:fileError];
+        return;
+    }
+
+    NSUInteger numberOfSegments = (NSUInteger)MIN((unsigned long long)self.downloader.maximumNumberOfSegments, length / minimumSegmentSize);
+    unsigned long long segmentLength = (length + numberOfSegments - 1) / numberOfSegments;
+    NSMutableArray *segments = [NSMutableArray arrayWithCapacity:numberOfSegments];
+    for (unsigned long long offset = 0; offset < length; offset += segmentLength) {
+        AFSegmentedDownloadSegment *segment = [[AFSegmentedDownloadSegment alloc] init];
+        segment.offset = offset;
+        segment.length = MIN(segmentLength, length - offset);
+        [segments addObject:segment];
+    }
+
+    self.segments = segments;
+    self.numberOfSegments = [segments count];
+    self.progress.totalUnitCount = (int64_t)length;
+    [self updateProgress];
+
+    for (AFSegmentedDownloadSegment *segment in self.segments) {
+        [self startSegment:segment];
+    }
+}
+
+- (BOOL)allocateFileOfLength:(unsigned long long)length
+                       error:(NSError * __autoreleasing *)error
+{
+    self.temporaryFileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[NSString stringWithFormat:@"AFSegmentedDownload-%@", [[NSUUID UUID] UUIDString]]]];
+
+    int fileDescriptor = open([[self.temporaryFileURL path] fileSystemRepresentation], O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0) {
+        if (error) {
+            *error = AFSegmentedDownloadErrorWithPOSIXCode(errno, self.temporaryFileURL);
+        }
+
+        return NO;
+    }
+
+#ifdef F_PREALLOCATE
+    // Reserving the blocks up front fails early when the disk is full, and keeps the segments from fragmenting the file
+    fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)length, 0};
+    if (fcntl(fileDescriptor, F_PREALLOCATE, &store) == -1) {
+        store.fst_flags = F_ALLOCATEALL;
+        fcntl(fileDescriptor, F_PREALLOCATE, &store);
+    }
+#endif
+
+    if (ftruncate(fileDescriptor, (off_t)length) != 0) {
+        if (error) {
+            *error = AFSegmentedDownloadErrorWithPOSIXCode(errno, self.temporaryFileURL);
+        }
+        close(fileDescriptor);
+
+        return NO;
+    }
+
+    self.fileDescriptor = fileDescriptor;
+
+    return YES;
+}
+
+#pragma mark - Segments
+
+- (void)startSegment:(AFSegmentedDownloadSegment *)segment {
+    unsigned long long offset = segment.offset + segment.numberOfBytesWritten;
+    segment.requestedOffset = offset;
+    segment.responseAccepted = NO;
+
+    NSMutableURLRequest *request = [self.request mutableCopy];
+    [request setValue:[NSString stringWithFormat:@"bytes=%llu-%llu", offset, segment.offset + segment.length - 1] forHTTPHeaderField:@"Range"];
+    if (self.validator) {
+        [request setValue:self.validator forHTTPHeaderField:@"If-Range"];
+    }
+
+    // Data is written on the delegate queue of the session manager as it arrives, each segment at its own offset in the file. The file descriptor stays open until every segment task has completed, see `-closeFileDescriptorIfIdle`
+    int fileDescriptor = self.fileDescriptor;
+    segment.task = [self.downloader.sessionManager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil didReceiveData:^(NSURLSessionDataTask * _Nonnull dataTask, NSData * _Nonnull data) {
+        if (![segment isResponseAccepted]) {
+            if (![self response:dataTask.response isValidForSegment:segment]) {
+                segment.error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"The server did not respond with the requested range of the resource", @"AFNetworking", nil), NSURLErrorFailingURLErrorKey: request.URL}];
+                [dataTask cancel];
+                return;
+            }
+            segment.responseAccepted = YES;
+        }
+
+        __block int errorCode = 0;
+        [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+            NSUInteger numberOfBytesWritten = 0;
+            NSUInteger length = (NSUInteger)MIN((unsigned long long)byteRange.length, segment.length - segment.numberOfBytesWritten);
+            while (numberOfBytesWritten < length) {
+                ssize_t result = pwrite(fileDescriptor, (const uint8_t *)bytes + numberOfBytesWritten, length - numberOfBytesWritten, (off_t)(segment.offset + segment.numberOfBytesWritten));
+                if (result < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    errorCode = errno;
+                    *stop = YES;
+                    return;
+                }
+
+                numberOfBytesWritten += (NSUInteger)result;
+                segment.numberOfBytesWritten += (unsigned long long)result;
+            }
+        }];
+
+        if (errorCode != 0) {
+            segment.error = AFSegmentedDownloadErrorWithPOSIXCode(errorCode, self.temporaryFileURL);
+            [dataTask cancel];
+            return;
+        }
+
+        dispatch_async(self.queue, ^{
+            [self updateProgress];
+        });
+    } completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            [self segment:segment didCompleteWithError:error];
+        });
+    }];
+    [segment.task resume];
+}
+
+- (BOOL)response:(NSURLResponse *)response
+isValidForSegment:(AFSegmentedDownloadSegment *)segment
+{
+    if (![response isKindOfClass:[NSHTTPURLResponse class]] || [(NSHTTPURLResponse *)response statusCode] != 206) {
+        return NO;
+    }
+
+    return AFContentRangeStartOfResponse((NSHTTPURLResponse *)response) == (int64_t)segment.requestedOffset;
+}
+
+- (void)segment:(AFSegmentedDownloadSegment *)segment
+didCompleteWithError:(NSError *)error
+{
+    segment.task = nil;
+
+    if ([self isFinished]) {
+        [self closeFileDescriptorIfIdle];
+        return;
+    }
+
+    // A response for another version of the resource, or a failure to write, cannot be helped by retrying
+    if (segment.error) {
+        [self failWithError:segment.error];
+        return;
+    }
+
+    // A connection lost after the last byte of the segment was written leaves nothing to request again
+    if (segment.numberOfBytesWritten >= segment.length) {
+        error = nil;
+    } else if (!error) {
+        error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+    }
+
+    if (error) {
+        segment.numberOfFailures++;
+        if (segment.numberOfFailures > self.downloader.maximumNumberOfRetriesPerSegment) {
+            [self failWithError:error];
+            return;
+        }
+
+        NSTimeInterval delay = self.downloader.retryInterval * pow(2.0, (double)(segment.numberOfFailures - 1));
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.queue, ^{
+            if (![self isFinished]) {
+                [self startSegment:segment];
+            }
+        });
+
+        return;
+    }
+
+    for (AFSegmentedDownloadSegment *otherSegment in self.segments) {
+        if (otherSegment.numberOfBytesWritten < otherSegment.length) {
+            return;
+        }
+    }
+
+    [self updateProgress];
+    [self finishWithFileURL:self.temporaryFileURL error:nil];
+}
+
+- (void)failWithError:(NSError *)error {
+    for (AFSegmentedDownloadSegment *segment in self.segments) {
+        [segment.task cancel];
+    }
+
+    [self finishWithFileURL:nil error:error];
+}
+
+// Segment tasks still running write to the file descriptor until they report completion, and closing it earlier would let the number be reused for another file
+- (void)closeFileDescriptorIfIdle {
+    if (self.fileDescriptor < 0) {
+        return;
+    }
+
+    for (AFSegmentedDownloadSegment *segment in self.segments) {
+        if (segment.task) {
+            return;
+        }
+    }
+
+    close(self.fileDescriptor);
+    self.fileDescriptor = -1;
+}
+
+- (void)updateProgress {
+    unsigned long long completedUnitCount = 0;
+    for (AFSegmentedDownloadSegment *segment in self.segments) {
+        completedUnitCount += segment.numberOfBytesWritten;
+    }
+
+    self.progress.completedUnitCount = (int64_t)completedUnitCount;
+
+    if (self.downloadProgressBlock) {
+        self.downloadProgressBlock(self.progress);
+    }
+}
+
+#pragma mark - Single Download
+
+- (void)startSingleDownload {
+    self.numberOfSegments = 1;
+
+    self.downloadTask = [self.downloader.sessionManager downloadTaskWithRequest:self.request progress:^(NSProgress * _Nonnull downloadProgress) {
+        int64_t totalUnitCount = downloadProgress.totalUnitCount;
+        int64_t completedUnitCount = downloadProgress.completedUnitCount;
+        dispatch_async(self.queue, ^{
+            if ([self isFinished]) {
+                return;
+            }
+
+            self.progress.totalUnitCount = totalUnitCount;
+            self.progress.completedUnitCount = completedUnitCount;
+            if (self.downloadProgressBlock) {
+                self.downloadProgressBlock(self.progress);
+            }
+        });
+    } destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        return self.destination(targetPath, response);
+    } completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        dispatch_async(self.queue, ^{
+            self.downloadTask = nil;
+
+            if ([self isFinished]) {
+                return;
+            }
+
+            self.response = [response isKindOfClass:[NSHTTPURLResponse class]] ? (NSHTTPURLResponse *)response : nil;
+            [self finishWithResponse:response filePath:filePath error:error];
+        });
+    }];
+    [self.downloadTask resume];
+}
+
+#pragma mark -
+
+- (void)finishWithFileURL:(NSURL *)fileURL
+                    error:(NSError *)error
+{
+    [self closeFileDescriptorIfIdle];
+
+    NSURL *destinationURL = nil;
+    if (fileURL) {
+        destinationURL = self.destination(fileURL, self.response);
+
+        NSError *fileManagerError = nil;
+        if (destinationURL && ![[NSFileManager defaultManager] moveItemAtURL:fileURL toURL:destinationURL error:&fileManagerError]) {
+            [[NSNotificationCenter defaultCenter] postNotificationName:AFURLSessionDownloadTaskDidFailToMoveFileNotification object:self userInfo:fileManagerError.userInfo];
+        }
+    }
+
+    if (self.temporaryFileURL) {
+        [[NSFileManager defaultManager] removeItemAtURL:self.temporaryFileURL error:nil];
+    }
+
+    [self finishWithResponse:self.response filePath:destinationURL error:error];
+}
+
+- (void)finishWithResponse:(NSURLResponse *)response
+                  filePath:(NSURL *)filePath
+                     error:(NSError *)error
+{
+    self.finished = YES;
+
+    void (^completionHandler)(NSURLResponse *, NSURL *, NSError *) = self.completionHandler;
+    self.completionHandler = nil;
+    self.downloadProgressBlock = nil;
+
+    if (completionHandler) {
+        dispatch_async(self.downloader.sessionManager.completionQueue ?: dispatch_get_main_queue(), ^{
+            completionHandler(response, filePath, error);
+        });
+    }
+}
+
+@end
@@ -55,6 +55,17 @@ FOUNDATION_EXPORT NSString * AFPercentEscapedStringFromString(NSString *string);
  */
 FOUNDATION_EXPORT NSString * AFQueryStringFromParameters(NSDictionary *parameters);
 
+/**
+ Returns the delimiter line of a multipart body with the specified boundary, as defined by RFC 2046: two hyphens followed by the boundary. The delimiter of each part but the first is preceded by a CRLF, and the close delimiter is followed by two more hyphens.
+
+ The delimiter is shared by the multipart bodies of requests, written by `AFStreamingMultipartFormData`, and of responses, read by `AFMultipartResponseSerializer`.
+
+ @param boundary The boundary of the multipart body.
+
+ @return The delimiter line.
+ */
+FOUNDATION_EXPORT NSString * AFMultipartDelimiter(NSString *boundary);
+
 /**
  The `AFURLRequestSerialization` protocol is adopted by an object that encodes parameters for a specified HTTP requests. Request serializers may encode parameters as query strings, HTTP bodies, setting the appropriate HTTP header fields as necessary.
 
@@ -86,7 +97,21 @@ typedef NS_ENUM(NSUInteger, AFHTTPRequestQueryStringSerializationStyle) {
     AFHTTPRequestQueryStringDefaultStyle = 0,
 };
 
+/**
+ The content codings that may be applied to a serialized request body.
+
+ - `AFHTTPRequestBodyCompressionNone`: The body is sent as-is.
+ - `AFHTTPRequestBodyCompressionGZip`: The body is gzip encoded, and `Content-Encoding: gzip` is set.
+ - `AFHTTPRequestBodyCompressionDeflate`: The body is zlib encoded, and `Content-Encoding: deflate` is set.
+ */
+typedef NS_ENUM(NSUInteger, AFHTTPRequestBodyCompression) {
+    AFHTTPRequestBodyCompressionNone = 0,
+    AFHTTPRequestBodyCompressionGZip,
+    AFHTTPRequestBodyCompressionDeflate,
+};
+
 @protocol AFMultipartFormData;
+@class AFBandwidthThrottle;
 
 /**
  `AFHTTPRequestSerializer` conforms to the `AFURLRequestSerialization` & `AFURLResponseSerialization` protocols, offering a concrete base implementation of query string / URL form-encoded parameter serialization and default request headers, as well as response status code and content type validation.
@@ -218,6 +243,22 @@ forHTTPHeaderField:(NSString *)field;
  */
 - (void)setQueryStringSerializationWithBlock:(nullable NSString * (^)(NSURLRequest *request, id parameters, NSError * __autoreleasing *error))block;
 
+///----------------------------------
+/// @name Compressing Request Bodies
+///----------------------------------
+
+/**
+ The content coding applied to the bodies of requests created by `requestWithMethod:URLString:parameters:error:` and `multipartFormRequestWithMethod:URLString:parameters:constructingBodyWithBlock:error:`. `AFHTTPRequestBodyCompressionNone` by default.
+
+ @discussion In-memory bodies are compressed up front, and are left untouched if the encoded form would not be smaller. Streamed bodies, including multipart form bodies, are wrapped in a stream that compresses in chunks as the body is read, so the request loses its `Content-Length` and is sent using chunked transfer encoding. Requests that already specify a `Content-Encoding` are never compressed. Only enable this for servers known to accept encoded request bodies.
+ */
+@property (nonatomic, assign) AFHTTPRequestBodyCompression bodyCompression;
+
+/**
+ The minimum body length, in bytes, for which `bodyCompression` is applied. Streamed bodies of unknown length are always compressed. `1024` by default.
+ */
+@property (nonatomic, assign) NSUInteger bodyCompressionThreshold;
+
 ///-------------------------------
 /// @name Creating Request Objects
 ///-------------------------------
@@ -258,6 +299,25 @@ forHTTPHeaderField:(NSString *)field;
                               constructingBodyWithBlock:(nullable void (^)(id <AFMultipartFormData> formData))block
                                                   error:(NSError * _Nullable __autoreleasing *)error;
 
+/**
+ Creates an `NSMutableURLRequest` object with the specified HTTP method and URLString, whose body is read from the specified input stream as-is.
+
+ @param method The HTTP method for the request. This parameter must not be `GET` or `HEAD`, or `nil`.
+ @param URLString The URL string used to create the request URL.
+ @param bodyStream The input stream from which the request body is read. This parameter must not be `nil`.
+ @param length The length of the body in bytes, or `NSURLSessionTransferSizeUnknown` if it is not known in advance, in which case the request has no `Content-Length` and is sent using chunked transfer encoding as the stream produces data.
+ @param mimeType The MIME type of the body, set as the `Content-Type` of the request, or `nil`.
+ @param error The error that occurred while constructing the request.
+
+ @return An `NSMutableURLRequest` object.
+ */
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method
+                                 URLString:(NSString *)URLString
+                                bodyStream:(NSInputStream *)bodyStream
+                                    length:(int64_t)length
+                                  mimeType:(nullable NSString *)mimeType
+                                     error:(NSError * _Nullable __autoreleasing *)error;
+
 /**
  Creates an `NSMutableURLRequest` by removing the `HTTPBodyStream` from a request, and asynchronously writing its contents into the specified file, invoking the completion handler when finished.
 
@@ -273,6 +333,21 @@ forHTTPHeaderField:(NSString *)field;
                              writingStreamContentsToFile:(NSURL *)fileURL
                                        completionHandler:(nullable void (^)(NSError * _Nullable error))handler;
 
+/**
+ Creates an `NSMutableURLRequest` by removing the `HTTPBodyStream` from a request, and asynchronously writing its contents into the specified file, reporting progress as the file is written and invoking the completion handler when finished.
+
+ @param request The multipart form request. The `HTTPBodyStream` property of `request` must not be `nil`.
+ @param fileURL The file URL to write multipart form contents to.
+ @param progressBlock A block object to be executed on the main queue as the file is written. The total unit count of the progress is the `Content-Length` of the request, or `-1` if it has none.
+ @param handler A handler block to execute.
+
+ @discussion The body is copied through large page-aligned buffers. Parts of a multipart form whose contents are in memory or in a mappable file are written straight from that memory into the file, without being copied through a buffer at all. Bandwidth throttles attached to the body stream are not applied while writing to the file.
+ */
+- (NSMutableURLRequest *)requestWithMultipartFormRequest:(NSURLRequest *)request
+                             writingStreamContentsToFile:(NSURL *)fileURL
+                                                progress:(nullable void (^)(NSProgress *progress))progressBlock
+                                       completionHandler:(nullable void (^)(NSError * _Nullable error))handler;
+
 @end
 
 #pragma mark -
@@ -320,8 +395,10 @@ forHTTPHeaderField:(NSString *)field;
  @param inputStream The input stream to be appended to the form data
  @param name The name to be associated with the specified input stream. This parameter must not be `nil`.
  @param fileName The filename to be associated with the specified input stream. This parameter must not be `nil`.
- @param length The length of the specified input stream in bytes.
+ @param length The length of the specified input stream in bytes, or `NSURLSessionTransferSizeUnknown` if it is not known in advance.
  @param mimeType The MIME type of the specified data. (For example, the MIME type for a JPEG image is image/jpeg.) For a list of valid MIME types, see http://www.iana.org/assignments/media-types/. This parameter must not be `nil`.
+
+ @discussion If any part has an unknown length, the finalized request has no `Content-Length`, and the form is sent using chunked transfer encoding. Bytes are sent as soon as the input stream produces them, and no part is buffered, so data generated on the fly can be uploaded without first being written to memory or disk.
  */
 - (void)appendPartWithInputStream:(nullable NSInputStream *)inputStream
                              name:(NSString *)name
@@ -369,10 +446,19 @@ forHTTPHeaderField:(NSString *)field;
 
  @param numberOfBytes Maximum packet size, in number of bytes. The default packet size for an input stream is 16kb.
  @param delay Duration of delay each time a packet is read. By default, no delay is set.
+
+ @discussion The delay is no longer applied by sleeping the thread reading the body. Instead, a non-zero delay attaches an `AFBandwidthThrottle` limited to `numberOfBytes / delay` bytes per second, as if by calling `throttleBandwidthWithThrottle:`.
  */
 - (void)throttleBandwidthWithPacketSize:(NSUInteger)numberOfBytes
                                   delay:(NSTimeInterval)delay;
 
+/**
+ Limits the rate at which the multipart form body is read to the rate of the specified bandwidth throttle. Throttles may be shared, in which case all streams attached to a throttle share its rate.
+
+ @param throttle The bandwidth throttle, or `nil` to remove throttling.
+ */
+- (void)throttleBandwidthWithThrottle:(nullable AFBandwidthThrottle *)throttle;
+
 @end
 
 #pragma mark -
@@ -398,6 +484,17 @@ forHTTPHeaderField:(NSString *)field;
 
 #pragma mark -
 
+/**
+ `AFMessagePackRequestSerializer` is a subclass of `AFHTTPRequestSerializer` that encodes parameters as MessagePack using `AFMessagePackSerialization`, setting the `Content-Type` of the encoded request to `application/msgpack`.
+
+ MessagePack is usually much shorter than the equivalent JSON, and faster to encode and decode. Requests also ask for a MessagePack response, or else JSON, with an `Accept` header of `application/msgpack, application/json;q=0.5`. To decode either, use a response serializer created by `+[AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:]` with an `AFMessagePackResponseSerializer` and an `AFJSONResponseSerializer`.
+ */
+@interface AFMessagePackRequestSerializer : AFHTTPRequestSerializer
+
+@end
+
+#pragma mark -
+
 /**
  `AFPropertyListRequestSerializer` is a subclass of `AFHTTPRequestSerializer` that encodes parameters as JSON using `NSPropertyListSerializer`, setting the `Content-Type` of the encoded request to `application/x-plist`.
  */
@@ -428,6 +525,59 @@ forHTTPHeaderField:(NSString *)field;
 
 #pragma mark -
 
+/**
+ `AFBandwidthThrottle` is a token bucket that limits the rate at which one or more HTTP body streams are read.
+
+ Streams returned by `inputStreamByThrottlingInputStream:` never block the thread that reads them. A read always returns data when the wrapped stream has some, borrowing from the bucket if necessary. While the bucket is in debt, the stream reports that it has no bytes available, and it signals `NSStreamEventHasBytesAvailable` again once the bucket has refilled. Readers that wait for stream events or check `hasBytesAvailable`, such as `NSURLSession`, are therefore held to the rate of the throttle without any thread being put to sleep.
+
+ All streams created by the same throttle share its rate, so a single throttle can cap the total upload bandwidth of several requests.
+
+ @see `AFURLSessionManager -uploadBandwidthThrottle`
+ */
+@interface AFBandwidthThrottle : NSObject
+
+/**
+ The sustained rate, in bytes per second. `0` disables throttling.
+ */
+@property (atomic, assign) NSUInteger bytesPerSecond;
+
+/**
+ The capacity of the bucket, in bytes, which is also the largest number of bytes handed out by a single read.
+ */
+@property (readonly, atomic, assign) NSUInteger burstSize;
+
+/**
+ The total number of bytes read through streams created by the throttle.
+ */
+@property (readonly, atomic, assign) unsigned long long numberOfBytesRead;
+
+/**
+ Creates and returns a throttle with the specified rate, and a burst size of a quarter of a second of data, but no less than 4 KB.
+ */
++ (instancetype)throttleWithBytesPerSecond:(NSUInteger)bytesPerSecond;
+
+/**
+ Initializes a throttle with the specified rate and burst size.
+
+ @param bytesPerSecond The sustained rate, in bytes per second.
+ @param burstSize The capacity of the bucket, in bytes.
+ */
+- (instancetype)initWithBytesPerSecond:(NSUInteger)bytesPerSecond
+                             burstSize:(NSUInteger)burstSize NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns a stream that reads the specified stream at the rate of the throttle. Throttling a stream that was already throttled returns a stream subject to both throttles.
+
+ The returned stream conforms to `NSCopying` if the specified stream does, so that it can be handed out again from `URLSession:task:needNewBodyStream:`.
+
+ @param inputStream The stream to throttle.
+ */
+- (NSInputStream *)inputStreamByThrottlingInputStream:(NSInputStream *)inputStream;
+
+@end
+
+#pragma mark -
+
 ///----------------
 /// @name Constants
 ///----------------
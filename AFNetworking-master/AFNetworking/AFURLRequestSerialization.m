@@ -20,6 +20,7 @@
 // THE SOFTWARE.
 
 #import "AFURLRequestSerialization.h"
+#import "AFMessagePackSerialization.h"
 
 #if TARGET_OS_IOS || TARGET_OS_WATCH || TARGET_OS_TV
 #import <MobileCoreServices/MobileCoreServices.h>
@@ -27,6 +28,9 @@
 #import <CoreServices/CoreServices.h>
 #endif
 
+#import <zlib.h>
+#import <fcntl.h>
+
 NSString * const AFURLRequestSerializationErrorDomain = @"com.alamofire.error.serialization.request";
 NSString * const AFNetworkingOperationFailingURLRequestErrorKey = @"com.alamofire.serialization.request.error.response";
 
@@ -171,6 +175,206 @@ NSArray * AFQueryStringPairsFromKeyAndValue(NSString *key, id value) {
 
 #pragma mark -
 
+@interface AFCompressedBodyStream : NSInputStream
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream
+                        compression:(AFHTTPRequestBodyCompression)compression;
+@end
+
+@interface AFThrottledInputStream : NSInputStream
+@property (readonly, nonatomic, strong) NSInputStream *inputStream;
+@property (readonly, nonatomic, copy) NSArray <AFBandwidthThrottle *> *throttles;
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream
+                          throttles:(NSArray <AFBandwidthThrottle *> *)throttles;
+@end
+
+static NSString * AFContentCodingForBodyCompression(AFHTTPRequestBodyCompression compression) {
+    switch (compression) {
+        case AFHTTPRequestBodyCompressionGZip:
+            return @"gzip";
+        case AFHTTPRequestBodyCompressionDeflate:
+            return @"deflate";
+        case AFHTTPRequestBodyCompressionNone:
+        default:
+            return nil;
+    }
+}
+
+static int AFZlibWindowBitsForBodyCompression(AFHTTPRequestBodyCompression compression) {
+    // Adding 16 to the window bits makes zlib emit a gzip wrapper instead of a zlib one
+    return compression == AFHTTPRequestBodyCompressionGZip ? MAX_WBITS + 16 : MAX_WBITS;
+}
+
+static NSData * AFCompressedDataFromData(NSData *data, AFHTTPRequestBodyCompression compression) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, AFZlibWindowBitsForBodyCompression(compression), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *compressedData = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)[data length])];
+    const uint8_t *bytes = [data bytes];
+    NSUInteger remainingLength = [data length];
+    int status = Z_OK;
+
+    stream.next_out = [compressedData mutableBytes];
+    stream.avail_out = (uInt)[compressedData length];
+
+    while (status == Z_OK) {
+        if (stream.avail_in == 0 && remainingLength > 0) {
+            stream.next_in = (Bytef *)bytes;
+            stream.avail_in = (uInt)MIN(remainingLength, (NSUInteger)UINT_MAX);
+            bytes += stream.avail_in;
+            remainingLength -= stream.avail_in;
+        }
+
+        if (stream.avail_out == 0) {
+            [compressedData increaseLengthBy:[data length] / 2 + 1024];
+            stream.next_out = (Bytef *)[compressedData mutableBytes] + stream.total_out;
+            stream.avail_out = (uInt)([compressedData length] - stream.total_out);
+        }
+
+        status = deflate(&stream, remainingLength == 0 ? Z_FINISH : Z_NO_FLUSH);
+    }
+
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+
+    [compressedData setLength:stream.total_out];
+
+    return compressedData;
+}
+
+#pragma mark -
+
+static NSUInteger const AFSpoolBufferSize = 1024 * 1024;
+
+// `write(2)` fails with `EINVAL` for more than `INT_MAX` bytes on Darwin, which a mapped file part handed out by `getBuffer:length:` can exceed
+static NSUInteger const AFMaximumWriteLength = 1024 * 1024 * 1024;
+
+static BOOL AFWriteBytesToFileDescriptor(int fileDescriptor, const uint8_t *bytes, NSUInteger length, NSError * __autoreleasing *error) {
+    while (length > 0) {
+        ssize_t numberOfBytesWritten = write(fileDescriptor, bytes, MIN(length, AFMaximumWriteLength));
+        if (numberOfBytesWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (error) {
+                *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+            }
+
+            return NO;
+        }
+
+        bytes += numberOfBytesWritten;
+        length -= (NSUInteger)numberOfBytesWritten;
+    }
+
+    return YES;
+}
+
+// Copies a body stream into a file, writing buffers handed out by `getBuffer:length:` (such as the in-memory and mapped parts of a multipart form) directly, and reading everything else through a large page-aligned buffer
+static BOOL AFWriteInputStreamToFile(NSInputStream *inputStream, NSURL *fileURL, NSProgress *progress, void (^progressBlock)(NSProgress *), NSError * __autoreleasing *error) {
+    int fileDescriptor = open([fileURL fileSystemRepresentation], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fileDescriptor < 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSURLErrorKey: fileURL}];
+        }
+
+        return NO;
+    }
+
+    uint8_t *buffer = NULL;
+    if (posix_memalign((void **)&buffer, (size_t)getpagesize(), AFSpoolBufferSize) != 0) {
+        close(fileDescriptor);
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+        }
+
+        return NO;
+    }
+
+    BOOL success = YES;
+
+    // The count is shared with the main queue under the lock; `progress` is only touched on the main queue
+    NSLock *lock = [[NSLock alloc] init];
+    __block int64_t numberOfBytesWritten = 0;
+    __block BOOL hasPendingProgressUpdate = NO;
+    void (^updateProgress)(void) = ^{
+        [lock lock];
+        int64_t completedUnitCount = numberOfBytesWritten;
+        hasPendingProgressUpdate = NO;
+        [lock unlock];
+
+        progress.completedUnitCount = completedUnitCount;
+        progressBlock(progress);
+    };
+
+    [inputStream open];
+    while (success) {
+        uint8_t *bytes = NULL;
+        NSUInteger length = 0;
+
+        if (![inputStream getBuffer:&bytes length:&length]) {
+            NSInteger numberOfBytesRead = [inputStream read:buffer maxLength:AFSpoolBufferSize];
+            if (numberOfBytesRead < 0) {
+                if (error) {
+                    NSDictionary *userInfo = @{NSLocalizedFailureReasonErrorKey: NSLocalizedStringFromTable(@"The request body stream could not be read.", @"AFNetworking", nil)};
+                    *error = inputStream.streamError ?: [[NSError alloc] initWithDomain:AFURLRequestSerializationErrorDomain code:NSURLErrorCannotOpenFile userInfo:userInfo];
+                }
+                success = NO;
+                break;
+            } else if (numberOfBytesRead == 0) {
+                break;
+            }
+
+            bytes = buffer;
+            length = (NSUInteger)numberOfBytesRead;
+        }
+
+        success = AFWriteBytesToFileDescriptor(fileDescriptor, bytes, length, error);
+
+        // Coalesce progress updates, so that a fast copy doesn't flood the main queue
+        [lock lock];
+        numberOfBytesWritten += (int64_t)length;
+        BOOL shouldUpdateProgress = progressBlock && !hasPendingProgressUpdate;
+        hasPendingProgressUpdate = hasPendingProgressUpdate || shouldUpdateProgress;
+        [lock unlock];
+
+        if (shouldUpdateProgress) {
+            dispatch_async(dispatch_get_main_queue(), updateProgress);
+        }
+    }
+    [inputStream close];
+
+    free(buffer);
+
+    if (close(fileDescriptor) != 0 && success) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+        }
+        success = NO;
+    }
+
+    // A final update, so that the caller sees the whole body written even if the last coalesced update was skipped
+    if (progressBlock) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            if (success && progress.totalUnitCount < 0) {
+                progress.totalUnitCount = numberOfBytesWritten;
+            }
+            updateProgress();
+        });
+    }
+
+    return success;
+}
+
+#pragma mark -
+
 static NSArray * AFHTTPRequestSerializerObservedKeyPaths() {
     static NSArray *_AFHTTPRequestSerializerObservedKeyPaths = nil;
     static dispatch_once_t onceToken;
@@ -205,6 +409,9 @@ static void *AFHTTPRequestSerializerObserverContext = &AFHTTPRequestSerializerOb
 
     self.stringEncoding = NSUTF8StringEncoding;
 
+    self.bodyCompression = AFHTTPRequestBodyCompressionNone;
+    self.bodyCompressionThreshold = 1024;
+
     self.mutableHTTPRequestHeaders = [NSMutableDictionary dictionary];
     self.requestHeaderModificationQueue = dispatch_queue_create("requestHeaderModificationQueue", DISPATCH_QUEUE_CONCURRENT);
 
@@ -375,6 +582,7 @@ forHTTPHeaderField:(NSString *)field
     }
 
     mutableRequest = [[self requestBySerializingRequest:mutableRequest withParameters:parameters error:error] mutableCopy];
+    [self compressBodyOfRequest:mutableRequest];
 
 	return mutableRequest;
 }
@@ -413,49 +621,73 @@ forHTTPHeaderField:(NSString *)field
         block(formData);
     }
 
-    return [formData requestByFinalizingMultipartFormData];
+    mutableRequest = [formData requestByFinalizingMultipartFormData];
+    [self compressBodyOfRequest:mutableRequest];
+
+    return mutableRequest;
+}
+
+- (NSMutableURLRequest *)requestWithMethod:(NSString *)method
+                                 URLString:(NSString *)URLString
+                                bodyStream:(NSInputStream *)bodyStream
+                                    length:(int64_t)length
+                                  mimeType:(NSString *)mimeType
+                                     error:(NSError *__autoreleasing *)error
+{
+    NSParameterAssert(method);
+    NSParameterAssert(![method isEqualToString:@"GET"] && ![method isEqualToString:@"HEAD"]);
+    NSParameterAssert(bodyStream);
+
+    NSMutableURLRequest *mutableRequest = [self requestWithMethod:method URLString:URLString parameters:nil error:error];
+    if (!mutableRequest) {
+        return nil;
+    }
+
+    mutableRequest.HTTPBodyStream = bodyStream;
+    if (mimeType) {
+        [mutableRequest setValue:mimeType forHTTPHeaderField:@"Content-Type"];
+    }
+
+    // Without a `Content-Length`, `NSURLSession` sends a streamed body using chunked transfer encoding
+    if (length >= 0) {
+        [mutableRequest setValue:[NSString stringWithFormat:@"%lld", length] forHTTPHeaderField:@"Content-Length"];
+    } else {
+        [mutableRequest setValue:nil forHTTPHeaderField:@"Content-Length"];
+    }
+
+    [self compressBodyOfRequest:mutableRequest];
+
+    return mutableRequest;
+}
+
+- (NSMutableURLRequest *)requestWithMultipartFormRequest:(NSURLRequest *)request
+                             writingStreamContentsToFile:(NSURL *)fileURL
+                                       completionHandler:(void (^)(NSError *error))handler
+{
+    return [self requestWithMultipartFormRequest:request writingStreamContentsToFile:fileURL progress:nil completionHandler:handler];
 }
 
 - (NSMutableURLRequest *)requestWithMultipartFormRequest:(NSURLRequest *)request
                              writingStreamContentsToFile:(NSURL *)fileURL
+                                                progress:(void (^)(NSProgress *progress))progressBlock
                                        completionHandler:(void (^)(NSError *error))handler
 {
     NSParameterAssert(request.HTTPBodyStream);
     NSParameterAssert([fileURL isFileURL]);
 
     NSInputStream *inputStream = request.HTTPBodyStream;
-    NSOutputStream *outputStream = [[NSOutputStream alloc] initWithURL:fileURL append:NO];
-    __block NSError *error = nil;
-
-    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-        [inputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-        [outputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSDefaultRunLoopMode];
-
-        [inputStream open];
-        [outputStream open];
-
-        while ([inputStream hasBytesAvailable] && [outputStream hasSpaceAvailable]) {
-            uint8_t buffer[1024];
-
-            NSInteger bytesRead = [inputStream read:buffer maxLength:1024];
-            if (inputStream.streamError || bytesRead < 0) {
-                error = inputStream.streamError;
-                break;
-            }
-
-            NSInteger bytesWritten = [outputStream write:buffer maxLength:(NSUInteger)bytesRead];
-            if (outputStream.streamError || bytesWritten < 0) {
-                error = outputStream.streamError;
-                break;
-            }
+    // Throttles pace the body on the wire, not on its way to disk
+    if ([inputStream isKindOfClass:[AFThrottledInputStream class]]) {
+        inputStream = [(AFThrottledInputStream *)inputStream inputStream];
+    }
 
-            if (bytesRead == 0 && bytesWritten == 0) {
-                break;
-            }
-        }
+    NSString *contentLength = [request valueForHTTPHeaderField:@"Content-Length"];
+    NSProgress *progress = [[NSProgress alloc] initWithParent:nil userInfo:nil];
+    progress.totalUnitCount = contentLength ? (int64_t)strtoull([contentLength UTF8String], NULL, 10) : NSURLSessionTransferSizeUnknown;
 
-        [outputStream close];
-        [inputStream close];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSError *error = nil;
+        AFWriteInputStreamToFile(inputStream, fileURL, progress, progressBlock, &error);
 
         if (handler) {
             dispatch_async(dispatch_get_main_queue(), ^{
@@ -470,6 +702,46 @@ forHTTPHeaderField:(NSString *)field
     return mutableRequest;
 }
 
+- (void)compressBodyOfRequest:(NSMutableURLRequest *)request {
+    NSString *contentCoding = AFContentCodingForBodyCompression(self.bodyCompression);
+    if (!request || !contentCoding || [request valueForHTTPHeaderField:@"Content-Encoding"]) {
+        return;
+    }
+
+    if (request.HTTPBody) {
+        if ([request.HTTPBody length] == 0 || [request.HTTPBody length] < self.bodyCompressionThreshold) {
+            return;
+        }
+
+        NSData *compressedData = AFCompressedDataFromData(request.HTTPBody, self.bodyCompression);
+        if (!compressedData || [compressedData length] >= [request.HTTPBody length]) {
+            return;
+        }
+
+        request.HTTPBody = compressedData;
+        [request setValue:contentCoding forHTTPHeaderField:@"Content-Encoding"];
+        if ([request valueForHTTPHeaderField:@"Content-Length"]) {
+            [request setValue:[NSString stringWithFormat:@"%llu", (unsigned long long)[compressedData length]] forHTTPHeaderField:@"Content-Length"];
+        }
+    } else if (request.HTTPBodyStream) {
+        NSString *contentLength = [request valueForHTTPHeaderField:@"Content-Length"];
+        if (contentLength && strtoull([contentLength UTF8String], NULL, 10) < self.bodyCompressionThreshold) {
+            return;
+        }
+
+        // Throttles apply to the bytes on the wire, so compress the stream being throttled rather than the throttled stream
+        if ([request.HTTPBodyStream isKindOfClass:[AFThrottledInputStream class]]) {
+            AFThrottledInputStream *throttledStream = (AFThrottledInputStream *)request.HTTPBodyStream;
+            NSInputStream *compressedStream = [[AFCompressedBodyStream alloc] initWithInputStream:throttledStream.inputStream compression:self.bodyCompression];
+            request.HTTPBodyStream = [[AFThrottledInputStream alloc] initWithInputStream:compressedStream throttles:throttledStream.throttles];
+        } else {
+            request.HTTPBodyStream = [[AFCompressedBodyStream alloc] initWithInputStream:request.HTTPBodyStream compression:self.bodyCompression];
+        }
+        [request setValue:contentCoding forHTTPHeaderField:@"Content-Encoding"];
+        [request setValue:nil forHTTPHeaderField:@"Content-Length"];
+    }
+}
+
 #pragma mark - AFURLRequestSerialization
 
 - (NSURLRequest *)requestBySerializingRequest:(NSURLRequest *)request
@@ -564,6 +836,12 @@ forHTTPHeaderField:(NSString *)field
 
     self.mutableHTTPRequestHeaders = [[decoder decodeObjectOfClass:[NSDictionary class] forKey:NSStringFromSelector(@selector(mutableHTTPRequestHeaders))] mutableCopy];
     self.queryStringSerializationStyle = (AFHTTPRequestQueryStringSerializationStyle)[[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(queryStringSerializationStyle))] unsignedIntegerValue];
+    self.bodyCompression = (AFHTTPRequestBodyCompression)[[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(bodyCompression))] unsignedIntegerValue];
+
+    NSNumber *bodyCompressionThreshold = [decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(bodyCompressionThreshold))];
+    if (bodyCompressionThreshold) {
+        self.bodyCompressionThreshold = [bodyCompressionThreshold unsignedIntegerValue];
+    }
 
     return self;
 }
@@ -573,6 +851,8 @@ forHTTPHeaderField:(NSString *)field
         [coder encodeObject:self.mutableHTTPRequestHeaders forKey:NSStringFromSelector(@selector(mutableHTTPRequestHeaders))];
     });
     [coder encodeObject:@(self.queryStringSerializationStyle) forKey:NSStringFromSelector(@selector(queryStringSerializationStyle))];
+    [coder encodeObject:@(self.bodyCompression) forKey:NSStringFromSelector(@selector(bodyCompression))];
+    [coder encodeObject:@(self.bodyCompressionThreshold) forKey:NSStringFromSelector(@selector(bodyCompressionThreshold))];
 }
 
 #pragma mark - NSCopying
@@ -584,6 +864,8 @@ forHTTPHeaderField:(NSString *)field
     });
     serializer.queryStringSerializationStyle = self.queryStringSerializationStyle;
     serializer.queryStringSerialization = self.queryStringSerialization;
+    serializer.bodyCompression = self.bodyCompression;
+    serializer.bodyCompressionThreshold = self.bodyCompressionThreshold;
 
     return serializer;
 }
@@ -598,16 +880,20 @@ static NSString * AFCreateMultipartFormBoundary() {
 
 static NSString * const kAFMultipartFormCRLF = @"\r\n";
 
+NSString * AFMultipartDelimiter(NSString *boundary) {
+    return [@"--" stringByAppendingString:boundary];
+}
+
 static inline NSString * AFMultipartFormInitialBoundary(NSString *boundary) {
-    return [NSString stringWithFormat:@"--%@%@", boundary, kAFMultipartFormCRLF];
+    return [NSString stringWithFormat:@"%@%@", AFMultipartDelimiter(boundary), kAFMultipartFormCRLF];
 }
 
 static inline NSString * AFMultipartFormEncapsulationBoundary(NSString *boundary) {
-    return [NSString stringWithFormat:@"%@--%@%@", kAFMultipartFormCRLF, boundary, kAFMultipartFormCRLF];
+    return [NSString stringWithFormat:@"%@%@%@", kAFMultipartFormCRLF, AFMultipartDelimiter(boundary), kAFMultipartFormCRLF];
 }
 
 static inline NSString * AFMultipartFormFinalBoundary(NSString *boundary) {
-    return [NSString stringWithFormat:@"%@--%@--%@", kAFMultipartFormCRLF, boundary, kAFMultipartFormCRLF];
+    return [NSString stringWithFormat:@"%@%@--%@", kAFMultipartFormCRLF, AFMultipartDelimiter(boundary), kAFMultipartFormCRLF];
 }
 
 static inline NSString * AFContentTypeForPathExtension(NSString *extension) {
@@ -623,7 +909,10 @@ static inline NSString * AFContentTypeForPathExtension(NSString *extension) {
 NSUInteger const kAFUploadStream3GSuggestedPacketSize = 1024 * 16;
 NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 
+@class AFMultipartBodyStream;
+
 @interface AFHTTPBodyPart : NSObject
+@property (nonatomic, weak) AFMultipartBodyStream *bodyStream;
 @property (nonatomic, assign) NSStringEncoding stringEncoding;
 @property (nonatomic, strong) NSDictionary *headers;
 @property (nonatomic, copy) NSString *boundary;
@@ -636,21 +925,27 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 
 @property (readonly, nonatomic, assign, getter = hasBytesAvailable) BOOL bytesAvailable;
 @property (readonly, nonatomic, assign) unsigned long long contentLength;
+@property (readonly, nonatomic, assign) BOOL hasKnownContentLength;
 
 - (NSInteger)read:(uint8_t *)buffer
         maxLength:(NSUInteger)length;
+- (BOOL)getBuffer:(uint8_t **)buffer
+           length:(NSUInteger *)len;
 @end
 
+static unsigned long long const AFHTTPBodyPartUnknownContentLength = ULLONG_MAX;
+
 @interface AFMultipartBodyStream : NSInputStream <NSStreamDelegate>
 @property (nonatomic, assign) NSUInteger numberOfBytesInPacket;
-@property (nonatomic, assign) NSTimeInterval delay;
 @property (nonatomic, strong) NSInputStream *inputStream;
 @property (readonly, nonatomic, assign) unsigned long long contentLength;
+@property (readonly, nonatomic, assign) BOOL hasKnownContentLength;
 @property (readonly, nonatomic, assign, getter = isEmpty) BOOL empty;
 
 - (instancetype)initWithStringEncoding:(NSStringEncoding)encoding;
 - (void)setInitialAndFinalBoundaries;
 - (void)appendHTTPBodyPart:(AFHTTPBodyPart *)bodyPart;
+- (void)invalidateContentLength;
 @end
 
 #pragma mark -
@@ -660,6 +955,7 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 @property (readwrite, nonatomic, assign) NSStringEncoding stringEncoding;
 @property (readwrite, nonatomic, copy) NSString *boundary;
 @property (readwrite, nonatomic, strong) AFMultipartBodyStream *bodyStream;
+@property (readwrite, nonatomic, strong) AFBandwidthThrottle *throttle;
 @end
 
 @implementation AFStreamingMultipartFormData
@@ -765,7 +1061,7 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
     bodyPart.boundary = self.boundary;
     bodyPart.body = inputStream;
 
-    bodyPart.bodyContentLength = (unsigned long long)length;
+    bodyPart.bodyContentLength = length < 0 ? AFHTTPBodyPartUnknownContentLength : (unsigned long long)length;
 
     [self.bodyStream appendHTTPBodyPart:bodyPart];
 }
@@ -816,7 +1112,18 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
                                   delay:(NSTimeInterval)delay
 {
     self.bodyStream.numberOfBytesInPacket = numberOfBytes;
-    self.bodyStream.delay = delay;
+
+    // Sending one packet per delay is equivalent to a sustained rate of one packet per delay, with bursts of at most one packet
+    if (delay > 0.0f) {
+        NSUInteger bytesPerSecond = (NSUInteger)MAX(1.0, (double)numberOfBytes / delay);
+        [self throttleBandwidthWithThrottle:[[AFBandwidthThrottle alloc] initWithBytesPerSecond:bytesPerSecond burstSize:numberOfBytes]];
+    } else {
+        [self throttleBandwidthWithThrottle:nil];
+    }
+}
+
+- (void)throttleBandwidthWithThrottle:(AFBandwidthThrottle *)throttle {
+    self.throttle = throttle;
 }
 
 - (NSMutableURLRequest *)requestByFinalizingMultipartFormData {
@@ -826,10 +1133,20 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 
     // Reset the initial and final boundaries to ensure correct Content-Length
     [self.bodyStream setInitialAndFinalBoundaries];
-    [self.request setHTTPBodyStream:self.bodyStream];
+    if (self.throttle) {
+        [self.request setHTTPBodyStream:[self.throttle inputStreamByThrottlingInputStream:self.bodyStream]];
+    } else {
+        [self.request setHTTPBodyStream:self.bodyStream];
+    }
 
     [self.request setValue:[NSString stringWithFormat:@"multipart/form-data; boundary=%@", self.boundary] forHTTPHeaderField:@"Content-Type"];
-    [self.request setValue:[NSString stringWithFormat:@"%llu", [self.bodyStream contentLength]] forHTTPHeaderField:@"Content-Length"];
+    unsigned long long contentLength = [self.bodyStream contentLength];
+    if (contentLength != AFHTTPBodyPartUnknownContentLength) {
+        [self.request setValue:[NSString stringWithFormat:@"%llu", contentLength] forHTTPHeaderField:@"Content-Length"];
+    } else {
+        // Without a `Content-Length`, `NSURLSession` sends the form using chunked transfer encoding as its parts produce data
+        [self.request setValue:nil forHTTPHeaderField:@"Content-Length"];
+    }
 
     return self.request;
 }
@@ -843,7 +1160,10 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 @property (readwrite, copy) NSError *streamError;
 @end
 
-@interface AFMultipartBodyStream () <NSCopying>
+@interface AFMultipartBodyStream () <NSCopying> {
+    unsigned long long _contentLength;
+    BOOL _hasCachedContentLength;
+}
 @property (readwrite, nonatomic, assign) NSStringEncoding stringEncoding;
 @property (readwrite, nonatomic, strong) NSMutableArray *HTTPBodyParts;
 @property (readwrite, nonatomic, strong) NSEnumerator *HTTPBodyPartEnumerator;
@@ -873,19 +1193,33 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 }
 
 - (void)setInitialAndFinalBoundaries {
-    if ([self.HTTPBodyParts count] > 0) {
-        for (AFHTTPBodyPart *bodyPart in self.HTTPBodyParts) {
-            bodyPart.hasInitialBoundary = NO;
-            bodyPart.hasFinalBoundary = NO;
+    AFHTTPBodyPart *firstBodyPart = [self.HTTPBodyParts firstObject];
+    AFHTTPBodyPart *lastBodyPart = [self.HTTPBodyParts lastObject];
+
+    // Only touch parts whose flags actually change, so that their serialized boundaries stay cached
+    for (AFHTTPBodyPart *bodyPart in self.HTTPBodyParts) {
+        BOOL hasInitialBoundary = bodyPart == firstBodyPart;
+        BOOL hasFinalBoundary = bodyPart == lastBodyPart;
+
+        if (bodyPart.hasInitialBoundary != hasInitialBoundary) {
+            bodyPart.hasInitialBoundary = hasInitialBoundary;
         }
 
-        [[self.HTTPBodyParts firstObject] setHasInitialBoundary:YES];
-        [[self.HTTPBodyParts lastObject] setHasFinalBoundary:YES];
+        if (bodyPart.hasFinalBoundary != hasFinalBoundary) {
+            bodyPart.hasFinalBoundary = hasFinalBoundary;
+        }
     }
 }
 
 - (void)appendHTTPBodyPart:(AFHTTPBodyPart *)bodyPart {
+    bodyPart.bodyStream = self;
     [self.HTTPBodyParts addObject:bodyPart];
+    [self invalidateContentLength];
+}
+
+// Called when a part is added, or one of the values the length of a part depends on changes, including the boundary flags reset by `setInitialAndFinalBoundaries`
+- (void)invalidateContentLength {
+    _hasCachedContentLength = NO;
 }
 
 - (BOOL)isEmpty {
@@ -917,8 +1251,9 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
             } else {
                 totalNumberOfBytesRead += numberOfBytesRead;
 
-                if (self.delay > 0.0f) {
-                    [NSThread sleepForTimeInterval:self.delay];
+                // A short read from a part that isn't finished means its stream has nothing more yet, so hand back what is already here rather than block the upload on the producer
+                if ((NSUInteger)numberOfBytesRead < maxLength && [self.currentHTTPBodyPart hasBytesAvailable] && totalNumberOfBytesRead > 0) {
+                    break;
                 }
             }
         }
@@ -927,10 +1262,36 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
     return totalNumberOfBytesRead;
 }
 
-- (BOOL)getBuffer:(__unused uint8_t **)buffer
-           length:(__unused NSUInteger *)len
+- (BOOL)getBuffer:(uint8_t **)buffer
+           length:(NSUInteger *)len
 {
-    return NO;
+    // Streams with a packet size must go through `read:maxLength:`, which enforces it
+    if ([self streamStatus] != NSStreamStatusOpen || self.numberOfBytesInPacket != NSIntegerMax) {
+        return NO;
+    }
+
+    while (YES) {
+        if (!self.currentHTTPBodyPart || ![self.currentHTTPBodyPart hasBytesAvailable]) {
+            if (!(self.currentHTTPBodyPart = [self.HTTPBodyPartEnumerator nextObject])) {
+                return NO;
+            }
+        } else {
+            uint8_t *partBuffer = NULL;
+            NSUInteger partLength = 0;
+
+            // Parts whose body is streamed rather than in memory can only be consumed by `read:maxLength:`
+            if (![self.currentHTTPBodyPart getBuffer:&partBuffer length:&partLength]) {
+                return NO;
+            }
+
+            if (partLength > 0) {
+                *buffer = partBuffer;
+                *len = partLength;
+
+                return YES;
+            }
+        }
+    }
 }
 
 - (BOOL)hasBytesAvailable {
@@ -972,13 +1333,27 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
                   forMode:(__unused NSString *)mode
 {}
 
+- (BOOL)hasKnownContentLength {
+    return [self contentLength] != AFHTTPBodyPartUnknownContentLength;
+}
+
 - (unsigned long long)contentLength {
-    unsigned long long length = 0;
-    for (AFHTTPBodyPart *bodyPart in self.HTTPBodyParts) {
-        length += [bodyPart contentLength];
+    if (!_hasCachedContentLength) {
+        unsigned long long length = 0;
+        for (AFHTTPBodyPart *bodyPart in self.HTTPBodyParts) {
+            if (![bodyPart hasKnownContentLength]) {
+                length = AFHTTPBodyPartUnknownContentLength;
+                break;
+            }
+
+            length += [bodyPart contentLength];
+        }
+
+        _contentLength = length;
+        _hasCachedContentLength = YES;
     }
 
-    return length;
+    return _contentLength;
 }
 
 #pragma mark - Undocumented CFReadStream Bridged Methods
@@ -1017,17 +1392,25 @@ NSTimeInterval const kAFUploadStream3GSuggestedDelay = 0.2;
 
 typedef enum {
     AFEncapsulationBoundaryPhase = 1,
-    AFHeaderPhase                = 2,
-    AFBodyPhase                  = 3,
-    AFFinalBoundaryPhase         = 4,
+    AFBodyPhase                  = 2,
+    AFFinalBoundaryPhase         = 3,
+    AFCompletedPhase             = 4,
 } AFHTTPBodyPartReadPhase;
 
 @interface AFHTTPBodyPart () <NSCopying> {
     AFHTTPBodyPartReadPhase _phase;
     NSInputStream *_inputStream;
     unsigned long long _phaseReadOffset;
+    NSData *_preambleData;
+    NSData *_epilogueData;
+    NSData *_bodyData;
+    BOOL _hasResolvedBodyData;
 }
 
+@property (readonly, nonatomic, strong) NSData *preambleData;
+@property (readonly, nonatomic, strong) NSData *epilogueData;
+@property (readonly, nonatomic, strong) NSData *bodyData;
+
 - (BOOL)transitionToNextPhase;
 - (NSInteger)readData:(NSData *)data
            intoBuffer:(uint8_t *)buffer
@@ -1070,6 +1453,27 @@ typedef enum {
     return _inputStream;
 }
 
+- (void)setBody:(id)body {
+    _body = body;
+    _bodyData = nil;
+    _hasResolvedBodyData = NO;
+}
+
+- (NSData *)bodyData {
+    if (!_hasResolvedBodyData) {
+        if ([self.body isKindOfClass:[NSData class]]) {
+            _bodyData = self.body;
+        } else if ([self.body isKindOfClass:[NSURL class]] && [self.body isFileURL]) {
+            // Mapping the file lets its pages be copied straight into the reader's buffer, or handed out by `getBuffer:length:`, without going through an intermediate stream buffer. If the file cannot be mapped, such as when it does not fit into the address space, it is streamed instead.
+            _bodyData = [NSData dataWithContentsOfURL:self.body options:NSDataReadingMappedAlways error:nil];
+        }
+
+        _hasResolvedBodyData = YES;
+    }
+
+    return _bodyData;
+}
+
 - (NSString *)stringForHeaders {
     NSMutableString *headerString = [NSMutableString string];
     for (NSString *field in [self.headers allKeys]) {
@@ -1080,21 +1484,75 @@ typedef enum {
     return [NSString stringWithString:headerString];
 }
 
-- (unsigned long long)contentLength {
-    unsigned long long length = 0;
+#pragma mark -
+
+// The boundary and headers are serialized once and reused by every `read:maxLength:` and `contentLength` call, until one of the values they depend on changes. The length cached by the body stream is invalidated along with them.
+
+- (void)setStringEncoding:(NSStringEncoding)stringEncoding {
+    _stringEncoding = stringEncoding;
+    _preambleData = nil;
+    _epilogueData = nil;
+    [self.bodyStream invalidateContentLength];
+}
+
+- (void)setHeaders:(NSDictionary *)headers {
+    _headers = headers;
+    _preambleData = nil;
+    [self.bodyStream invalidateContentLength];
+}
+
+- (void)setBoundary:(NSString *)boundary {
+    _boundary = [boundary copy];
+    _preambleData = nil;
+    _epilogueData = nil;
+    [self.bodyStream invalidateContentLength];
+}
+
+- (void)setHasInitialBoundary:(BOOL)hasInitialBoundary {
+    _hasInitialBoundary = hasInitialBoundary;
+    _preambleData = nil;
+    [self.bodyStream invalidateContentLength];
+}
+
+- (void)setHasFinalBoundary:(BOOL)hasFinalBoundary {
+    _hasFinalBoundary = hasFinalBoundary;
+    _epilogueData = nil;
+    [self.bodyStream invalidateContentLength];
+}
+
+- (void)setBodyContentLength:(unsigned long long)bodyContentLength {
+    _bodyContentLength = bodyContentLength;
+    [self.bodyStream invalidateContentLength];
+}
+
+- (NSData *)preambleData {
+    if (!_preambleData) {
+        NSMutableData *mutablePreambleData = [[([self hasInitialBoundary] ? AFMultipartFormInitialBoundary(self.boundary) : AFMultipartFormEncapsulationBoundary(self.boundary)) dataUsingEncoding:self.stringEncoding] mutableCopy];
+        [mutablePreambleData appendData:[[self stringForHeaders] dataUsingEncoding:self.stringEncoding]];
+        _preambleData = [mutablePreambleData copy];
+    }
+
+    return _preambleData;
+}
 
-    NSData *encapsulationBoundaryData = [([self hasInitialBoundary] ? AFMultipartFormInitialBoundary(self.boundary) : AFMultipartFormEncapsulationBoundary(self.boundary)) dataUsingEncoding:self.stringEncoding];
-    length += [encapsulationBoundaryData length];
+- (NSData *)epilogueData {
+    if (!_epilogueData) {
+        _epilogueData = ([self hasFinalBoundary] ? [AFMultipartFormFinalBoundary(self.boundary) dataUsingEncoding:self.stringEncoding] : [NSData data]);
+    }
 
-    NSData *headersData = [[self stringForHeaders] dataUsingEncoding:self.stringEncoding];
-    length += [headersData length];
+    return _epilogueData;
+}
 
-    length += _bodyContentLength;
+- (BOOL)hasKnownContentLength {
+    return _bodyContentLength != AFHTTPBodyPartUnknownContentLength;
+}
 
-    NSData *closingBoundaryData = ([self hasFinalBoundary] ? [AFMultipartFormFinalBoundary(self.boundary) dataUsingEncoding:self.stringEncoding] : [NSData data]);
-    length += [closingBoundaryData length];
+- (unsigned long long)contentLength {
+    if (![self hasKnownContentLength]) {
+        return AFHTTPBodyPartUnknownContentLength;
+    }
 
-    return length;
+    return [self.preambleData length] + _bodyContentLength + [self.epilogueData length];
 }
 
 - (BOOL)hasBytesAvailable {
@@ -1103,6 +1561,14 @@ typedef enum {
         return YES;
     }
 
+    if (_phase == AFCompletedPhase) {
+        return NO;
+    }
+
+    if (self.bodyData) {
+        return YES;
+    }
+
     switch (self.inputStream.streamStatus) {
         case NSStreamStatusNotOpen:
         case NSStreamStatusOpening:
@@ -1124,16 +1590,12 @@ typedef enum {
     NSInteger totalNumberOfBytesRead = 0;
 
     if (_phase == AFEncapsulationBoundaryPhase) {
-        NSData *encapsulationBoundaryData = [([self hasInitialBoundary] ? AFMultipartFormInitialBoundary(self.boundary) : AFMultipartFormEncapsulationBoundary(self.boundary)) dataUsingEncoding:self.stringEncoding];
-        totalNumberOfBytesRead += [self readData:encapsulationBoundaryData intoBuffer:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
-    }
-
-    if (_phase == AFHeaderPhase) {
-        NSData *headersData = [[self stringForHeaders] dataUsingEncoding:self.stringEncoding];
-        totalNumberOfBytesRead += [self readData:headersData intoBuffer:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
+        totalNumberOfBytesRead += [self readData:self.preambleData intoBuffer:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
     }
 
-    if (_phase == AFBodyPhase) {
+    if (_phase == AFBodyPhase && self.bodyData) {
+        totalNumberOfBytesRead += [self readData:self.bodyData intoBuffer:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
+    } else if (_phase == AFBodyPhase) {
         NSInteger numberOfBytesRead = 0;
 
         numberOfBytesRead = [self.inputStream read:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
@@ -1149,8 +1611,7 @@ typedef enum {
     }
 
     if (_phase == AFFinalBoundaryPhase) {
-        NSData *closingBoundaryData = ([self hasFinalBoundary] ? [AFMultipartFormFinalBoundary(self.boundary) dataUsingEncoding:self.stringEncoding] : [NSData data]);
-        totalNumberOfBytesRead += [self readData:closingBoundaryData intoBuffer:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
+        totalNumberOfBytesRead += [self readData:self.epilogueData intoBuffer:&buffer[totalNumberOfBytesRead] maxLength:(length - (NSUInteger)totalNumberOfBytesRead)];
     }
 
     return totalNumberOfBytesRead;
@@ -1172,38 +1633,76 @@ typedef enum {
     return (NSInteger)range.length;
 }
 
-- (BOOL)transitionToNextPhase {
-    if (![[NSThread currentThread] isMainThread]) {
-        dispatch_sync(dispatch_get_main_queue(), ^{
-            [self transitionToNextPhase];
-        });
-        return YES;
-    }
-
+- (BOOL)getBuffer:(uint8_t **)buffer
+           length:(NSUInteger *)len
+{
+    NSData *data = nil;
     switch (_phase) {
         case AFEncapsulationBoundaryPhase:
-            _phase = AFHeaderPhase;
-            break;
-        case AFHeaderPhase:
-            [self.inputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSRunLoopCommonModes];
-            [self.inputStream open];
-            _phase = AFBodyPhase;
+            data = self.preambleData;
             break;
         case AFBodyPhase:
-            [self.inputStream close];
-            _phase = AFFinalBoundaryPhase;
+            data = self.bodyData;
             break;
         case AFFinalBoundaryPhase:
+            data = self.epilogueData;
+            break;
+        case AFCompletedPhase:
         default:
-            _phase = AFEncapsulationBoundaryPhase;
             break;
     }
-    _phaseReadOffset = 0;
 
-    return YES;
-}
+    if (!data) {
+        return NO;
+    }
 
-#pragma mark - NSCopying
+    *buffer = (uint8_t *)[data bytes] + _phaseReadOffset;
+    *len = [data length] - (NSUInteger)_phaseReadOffset;
+
+    [self transitionToNextPhase];
+
+    return YES;
+}
+
+- (BOOL)transitionToNextPhase {
+    // Only streamed bodies need to be scheduled on, and closed from, the main run loop
+    BOOL transitionTouchesInputStream = (_phase == AFEncapsulationBoundaryPhase || _phase == AFBodyPhase) && !self.bodyData;
+    if (transitionTouchesInputStream && ![[NSThread currentThread] isMainThread]) {
+        dispatch_sync(dispatch_get_main_queue(), ^{
+            [self transitionToNextPhase];
+        });
+        return YES;
+    }
+
+    switch (_phase) {
+        case AFEncapsulationBoundaryPhase:
+            if (!self.bodyData) {
+                [self.inputStream scheduleInRunLoop:[NSRunLoop currentRunLoop] forMode:NSRunLoopCommonModes];
+                [self.inputStream open];
+            }
+            _phase = AFBodyPhase;
+            break;
+        case AFBodyPhase:
+            if (!self.bodyData) {
+                [self.inputStream close];
+            }
+            _phase = AFFinalBoundaryPhase;
+            break;
+        case AFFinalBoundaryPhase:
+            _phase = AFCompletedPhase;
+            break;
+        case AFCompletedPhase:
+            break;
+        default:
+            _phase = AFEncapsulationBoundaryPhase;
+            break;
+    }
+    _phaseReadOffset = 0;
+
+    return YES;
+}
+
+#pragma mark - NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone {
     AFHTTPBodyPart *bodyPart = [[[self class] allocWithZone:zone] init];
@@ -1221,6 +1720,576 @@ typedef enum {
 
 #pragma mark -
 
+static NSUInteger const AFCompressedBodyStreamBufferSize = 1024 * 64;
+
+@interface AFCompressedBodyStream () {
+    z_stream _zStream;
+    BOOL _zStreamInitialized;
+    uint8_t *_inputBuffer;
+    BOOL _inputStreamAtEnd;
+}
+@property (readwrite, nonatomic, strong) NSInputStream *inputStream;
+@property (readwrite, nonatomic, assign) AFHTTPRequestBodyCompression compression;
+@end
+
+@implementation AFCompressedBodyStream
+#if (defined(__IPHONE_OS_VERSION_MAX_ALLOWED) && __IPHONE_OS_VERSION_MAX_ALLOWED >= 80000) || (defined(__MAC_OS_X_VERSION_MAX_ALLOWED) && __MAC_OS_X_VERSION_MAX_ALLOWED >= 1100)
+@synthesize delegate;
+#endif
+@synthesize streamStatus;
+@synthesize streamError;
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream
+                        compression:(AFHTTPRequestBodyCompression)compression
+{
+    NSParameterAssert(inputStream);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.inputStream = inputStream;
+    self.compression = compression;
+
+    return self;
+}
+
+- (void)dealloc {
+    if (_zStreamInitialized) {
+        deflateEnd(&_zStream);
+    }
+
+    free(_inputBuffer);
+}
+
+- (void)failWithReason:(NSString *)reason {
+    NSDictionary *userInfo = @{NSLocalizedFailureReasonErrorKey: reason};
+    self.streamError = self.inputStream.streamError ?: [[NSError alloc] initWithDomain:AFURLRequestSerializationErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:userInfo];
+    self.streamStatus = NSStreamStatusError;
+}
+
+#pragma mark - NSInputStream
+
+- (NSInteger)read:(uint8_t *)buffer
+        maxLength:(NSUInteger)length
+{
+    if (self.streamStatus != NSStreamStatusOpen) {
+        return self.streamStatus == NSStreamStatusError ? -1 : 0;
+    }
+
+    uInt maxLength = (uInt)MIN(length, (NSUInteger)UINT_MAX);
+    _zStream.next_out = buffer;
+    _zStream.avail_out = maxLength;
+
+    while (_zStream.avail_out > 0) {
+        if (_zStream.avail_in == 0 && !_inputStreamAtEnd) {
+            // Hand back whatever has been produced so far rather than waiting on the underlying stream
+            if (_zStream.avail_out < maxLength) {
+                break;
+            }
+
+            NSInteger numberOfBytesRead = [self.inputStream read:_inputBuffer maxLength:AFCompressedBodyStreamBufferSize];
+            if (numberOfBytesRead < 0) {
+                [self failWithReason:NSLocalizedStringFromTable(@"The request body stream could not be read.", @"AFNetworking", nil)];
+                return -1;
+            }
+
+            _inputStreamAtEnd = numberOfBytesRead == 0 || [self.inputStream streamStatus] >= NSStreamStatusAtEnd;
+            _zStream.next_in = _inputBuffer;
+            _zStream.avail_in = (uInt)numberOfBytesRead;
+        }
+
+        int status = deflate(&_zStream, _inputStreamAtEnd ? Z_FINISH : Z_NO_FLUSH);
+        if (status == Z_STREAM_END) {
+            self.streamStatus = NSStreamStatusAtEnd;
+            break;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            [self failWithReason:NSLocalizedStringFromTable(@"The request body could not be compressed.", @"AFNetworking", nil)];
+            return -1;
+        }
+    }
+
+    return (NSInteger)(maxLength - _zStream.avail_out);
+}
+
+- (BOOL)getBuffer:(__unused uint8_t **)buffer
+           length:(__unused NSUInteger *)len
+{
+    return NO;
+}
+
+- (BOOL)hasBytesAvailable {
+    return [self streamStatus] == NSStreamStatusOpen;
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    if (self.streamStatus == NSStreamStatusOpen) {
+        return;
+    }
+
+    if (!_inputBuffer) {
+        _inputBuffer = malloc(AFCompressedBodyStreamBufferSize);
+    }
+
+    memset(&_zStream, 0, sizeof(_zStream));
+    if (deflateInit2(&_zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, AFZlibWindowBitsForBodyCompression(self.compression), 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        [self failWithReason:NSLocalizedStringFromTable(@"The request body could not be compressed.", @"AFNetworking", nil)];
+        return;
+    }
+    _zStreamInitialized = YES;
+
+    [self.inputStream open];
+    self.streamStatus = NSStreamStatusOpen;
+}
+
+- (void)close {
+    [self.inputStream close];
+
+    if (_zStreamInitialized) {
+        deflateEnd(&_zStream);
+        _zStreamInitialized = NO;
+    }
+
+    self.streamStatus = NSStreamStatusClosed;
+}
+
+- (id)propertyForKey:(__unused NSString *)key {
+    return nil;
+}
+
+- (BOOL)setProperty:(__unused id)property
+             forKey:(__unused NSString *)key
+{
+    return NO;
+}
+
+- (void)scheduleInRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+- (void)removeFromRunLoop:(__unused NSRunLoop *)aRunLoop
+                  forMode:(__unused NSString *)mode
+{}
+
+#pragma mark - Undocumented CFReadStream Bridged Methods
+
+- (void)_scheduleInCFRunLoop:(__unused CFRunLoopRef)aRunLoop
+                     forMode:(__unused CFStringRef)aMode
+{}
+
+- (void)_unscheduleFromCFRunLoop:(__unused CFRunLoopRef)aRunLoop
+                         forMode:(__unused CFStringRef)aMode
+{}
+
+- (BOOL)_setCFClientFlags:(__unused CFOptionFlags)inFlags
+                 callback:(__unused CFReadStreamClientCallBack)inCallback
+                  context:(__unused CFStreamClientContext *)inContext {
+    return NO;
+}
+
+#pragma mark - NSCopying
+
+// `AFURLSessionManager` re-sends a body stream by copying it, which is only possible if the wrapped stream can be copied too
+- (BOOL)conformsToProtocol:(Protocol *)aProtocol {
+    if (aProtocol == @protocol(NSCopying)) {
+        return [self.inputStream conformsToProtocol:aProtocol];
+    }
+
+    return [super conformsToProtocol:aProtocol];
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    NSInputStream *inputStreamCopy = [(id <NSCopying>)self.inputStream copyWithZone:zone];
+
+    return [[[self class] allocWithZone:zone] initWithInputStream:inputStreamCopy compression:self.compression];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFBandwidthThrottle () {
+    double _numberOfTokens;
+    NSTimeInterval _lastRefillTime;
+}
+@property (readwrite, atomic, assign) NSUInteger burstSize;
+@property (readwrite, atomic, assign) unsigned long long numberOfBytesRead;
+@property (readwrite, nonatomic, strong) NSLock *lock;
+
+- (NSUInteger)maximumNumberOfBytesForRead;
+- (void)didReadNumberOfBytes:(NSUInteger)numberOfBytes;
+- (NSTimeInterval)timeIntervalUntilBytesAvailable;
+@end
+
+@implementation AFBandwidthThrottle
+
++ (instancetype)throttleWithBytesPerSecond:(NSUInteger)bytesPerSecond {
+    return [[self alloc] initWithBytesPerSecond:bytesPerSecond burstSize:MAX(bytesPerSecond / 4, (NSUInteger)(1024 * 4))];
+}
+
+- (instancetype)init {
+    return [self initWithBytesPerSecond:0 burstSize:1024 * 16];
+}
+
+- (instancetype)initWithBytesPerSecond:(NSUInteger)bytesPerSecond
+                             burstSize:(NSUInteger)burstSize
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.bytesPerSecond = bytesPerSecond;
+    self.burstSize = MAX(burstSize, (NSUInteger)1);
+    self.lock = [[NSLock alloc] init];
+    self.lock.name = @"com.alamofire.networking.bandwidth-throttle.lock";
+
+    _numberOfTokens = self.burstSize;
+    _lastRefillTime = [[NSProcessInfo processInfo] systemUptime];
+
+    return self;
+}
+
+- (NSInputStream *)inputStreamByThrottlingInputStream:(NSInputStream *)inputStream {
+    NSParameterAssert(inputStream);
+
+    if ([inputStream isKindOfClass:[AFThrottledInputStream class]]) {
+        AFThrottledInputStream *throttledStream = (AFThrottledInputStream *)inputStream;
+        if ([throttledStream.throttles containsObject:self]) {
+            return throttledStream;
+        }
+
+        return [[AFThrottledInputStream alloc] initWithInputStream:throttledStream.inputStream throttles:[throttledStream.throttles arrayByAddingObject:self]];
+    }
+
+    return [[AFThrottledInputStream alloc] initWithInputStream:inputStream throttles:@[self]];
+}
+
+// Must be called with the lock held
+- (void)refill {
+    NSTimeInterval now = [[NSProcessInfo processInfo] systemUptime];
+    _numberOfTokens = MIN((double)self.burstSize, _numberOfTokens + (now - _lastRefillTime) * self.bytesPerSecond);
+    _lastRefillTime = now;
+}
+
+- (NSUInteger)maximumNumberOfBytesForRead {
+    return self.bytesPerSecond > 0 ? self.burstSize : NSUIntegerMax;
+}
+
+- (void)didReadNumberOfBytes:(NSUInteger)numberOfBytes {
+    [self.lock lock];
+    [self refill];
+    // Reads are never refused, so the bucket may go into debt, which is paid back before bytes are available again
+    if (self.bytesPerSecond > 0) {
+        _numberOfTokens -= numberOfBytes;
+    }
+    self.numberOfBytesRead += numberOfBytes;
+    [self.lock unlock];
+}
+
+- (NSTimeInterval)timeIntervalUntilBytesAvailable {
+    NSTimeInterval timeInterval = 0;
+
+    [self.lock lock];
+    [self refill];
+    if (self.bytesPerSecond > 0 && _numberOfTokens < 0) {
+        timeInterval = -_numberOfTokens / self.bytesPerSecond;
+    }
+    [self.lock unlock];
+
+    return timeInterval;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFThrottledInputStream () {
+    CFRunLoopRef _runLoop;
+    CFReadStreamClientCallBack _clientCallback;
+    CFStreamClientContext _clientContext;
+    CFOptionFlags _clientFlags;
+    BOOL _hasPendingBytesAvailableEvent;
+}
+@property (readwrite, nonatomic, strong) NSInputStream *inputStream;
+@property (readwrite, nonatomic, copy) NSArray <AFBandwidthThrottle *> *throttles;
+@property (readwrite, nonatomic, strong) NSMutableArray <NSString *> *runLoopModes;
+@end
+
+@implementation AFThrottledInputStream
+#if (defined(__IPHONE_OS_VERSION_MAX_ALLOWED) && __IPHONE_OS_VERSION_MAX_ALLOWED >= 80000) || (defined(__MAC_OS_X_VERSION_MAX_ALLOWED) && __MAC_OS_X_VERSION_MAX_ALLOWED >= 1100)
+@synthesize delegate;
+#endif
+@synthesize streamStatus;
+@synthesize streamError;
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream
+                          throttles:(NSArray <AFBandwidthThrottle *> *)throttles
+{
+    NSParameterAssert(inputStream);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.inputStream = inputStream;
+    self.throttles = throttles;
+    self.runLoopModes = [NSMutableArray array];
+
+    return self;
+}
+
+- (void)dealloc {
+    if (_clientContext.info && _clientContext.release) {
+        _clientContext.release(_clientContext.info);
+    }
+
+    if (_runLoop) {
+        CFRelease(_runLoop);
+    }
+}
+
+- (NSTimeInterval)timeIntervalUntilBytesAvailable {
+    NSTimeInterval timeInterval = 0;
+    for (AFBandwidthThrottle *throttle in self.throttles) {
+        timeInterval = MAX(timeInterval, [throttle timeIntervalUntilBytesAvailable]);
+    }
+
+    return timeInterval;
+}
+
+#pragma mark - Stream Events
+
+- (void)postStreamEvent:(NSStreamEvent)event {
+    __weak __typeof__(self) weakSelf = self;
+    @synchronized (self) {
+        if (!_runLoop || [self.runLoopModes count] == 0) {
+            return;
+        }
+
+        CFRunLoopPerformBlock(_runLoop, (__bridge CFArrayRef)[self.runLoopModes copy], ^{
+            [weakSelf deliverStreamEvent:event];
+        });
+        CFRunLoopWakeUp(_runLoop);
+    }
+}
+
+- (void)deliverStreamEvent:(NSStreamEvent)event {
+    if (event == NSStreamEventHasBytesAvailable) {
+        _hasPendingBytesAvailableEvent = NO;
+
+        if (self.streamStatus != NSStreamStatusOpen) {
+            return;
+        }
+    }
+
+    if (_clientCallback && (_clientFlags & (CFOptionFlags)event)) {
+        _clientCallback((__bridge CFReadStreamRef)self, (CFStreamEventType)event, _clientContext.info);
+    }
+
+    id <NSStreamDelegate> streamDelegate = self.delegate;
+    if (streamDelegate != self && [streamDelegate respondsToSelector:@selector(stream:handleEvent:)]) {
+        [streamDelegate stream:self handleEvent:event];
+    }
+}
+
+// Signals the reader once every throttle has refilled, instead of blocking it until then
+- (void)postBytesAvailableEventWhenThrottlesAllow {
+    if (!_runLoop || _hasPendingBytesAvailableEvent || self.streamStatus != NSStreamStatusOpen) {
+        return;
+    }
+
+    _hasPendingBytesAvailableEvent = YES;
+
+    NSTimeInterval timeInterval = [self timeIntervalUntilBytesAvailable];
+    if (timeInterval <= 0) {
+        [self postStreamEvent:NSStreamEventHasBytesAvailable];
+    } else {
+        __weak __typeof__(self) weakSelf = self;
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(timeInterval * NSEC_PER_SEC)), dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [weakSelf postStreamEvent:NSStreamEventHasBytesAvailable];
+        });
+    }
+}
+
+#pragma mark - NSInputStream
+
+- (NSInteger)read:(uint8_t *)buffer
+        maxLength:(NSUInteger)length
+{
+    if (self.streamStatus != NSStreamStatusOpen) {
+        return self.streamStatus == NSStreamStatusError ? -1 : 0;
+    }
+
+    NSUInteger maxLength = length;
+    for (AFBandwidthThrottle *throttle in self.throttles) {
+        maxLength = MIN(maxLength, [throttle maximumNumberOfBytesForRead]);
+    }
+
+    NSInteger numberOfBytesRead = [self.inputStream read:buffer maxLength:maxLength];
+    if (numberOfBytesRead < 0) {
+        self.streamError = self.inputStream.streamError;
+        self.streamStatus = NSStreamStatusError;
+        [self postStreamEvent:NSStreamEventErrorOccurred];
+
+        return -1;
+    }
+
+    for (AFBandwidthThrottle *throttle in self.throttles) {
+        [throttle didReadNumberOfBytes:(NSUInteger)numberOfBytesRead];
+    }
+
+    if (numberOfBytesRead == 0 || [self.inputStream streamStatus] >= NSStreamStatusAtEnd) {
+        self.streamStatus = NSStreamStatusAtEnd;
+        [self postStreamEvent:NSStreamEventEndEncountered];
+    } else {
+        [self postBytesAvailableEventWhenThrottlesAllow];
+    }
+
+    return numberOfBytesRead;
+}
+
+- (BOOL)getBuffer:(__unused uint8_t **)buffer
+           length:(__unused NSUInteger *)len
+{
+    return NO;
+}
+
+- (BOOL)hasBytesAvailable {
+    return self.streamStatus == NSStreamStatusOpen && [self timeIntervalUntilBytesAvailable] <= 0;
+}
+
+#pragma mark - NSStream
+
+- (void)open {
+    if (self.streamStatus == NSStreamStatusOpen) {
+        return;
+    }
+
+    [self.inputStream open];
+    if ([self.inputStream streamStatus] == NSStreamStatusError) {
+        self.streamError = self.inputStream.streamError;
+        self.streamStatus = NSStreamStatusError;
+        [self postStreamEvent:NSStreamEventErrorOccurred];
+
+        return;
+    }
+
+    self.streamStatus = NSStreamStatusOpen;
+    [self postStreamEvent:NSStreamEventOpenCompleted];
+    [self postBytesAvailableEventWhenThrottlesAllow];
+}
+
+- (void)close {
+    [self.inputStream close];
+    self.streamStatus = NSStreamStatusClosed;
+}
+
+- (id)propertyForKey:(NSString *)key {
+    return [self.inputStream propertyForKey:key];
+}
+
+- (BOOL)setProperty:(id)property
+             forKey:(NSString *)key
+{
+    return [self.inputStream setProperty:property forKey:key];
+}
+
+- (void)scheduleInRunLoop:(NSRunLoop *)aRunLoop
+                  forMode:(NSString *)mode
+{
+    [self _scheduleInCFRunLoop:[aRunLoop getCFRunLoop] forMode:(__bridge CFStringRef)mode];
+}
+
+- (void)removeFromRunLoop:(NSRunLoop *)aRunLoop
+                  forMode:(NSString *)mode
+{
+    [self _unscheduleFromCFRunLoop:[aRunLoop getCFRunLoop] forMode:(__bridge CFStringRef)mode];
+}
+
+#pragma mark - Undocumented CFReadStream Bridged Methods
+
+- (void)_scheduleInCFRunLoop:(CFRunLoopRef)aRunLoop
+                     forMode:(CFStringRef)aMode
+{
+    if (!aRunLoop || !aMode) {
+        return;
+    }
+
+    @synchronized (self) {
+        if (_runLoop != aRunLoop) {
+            if (_runLoop) {
+                CFRelease(_runLoop);
+            }
+            _runLoop = (CFRunLoopRef)CFRetain(aRunLoop);
+            [self.runLoopModes removeAllObjects];
+        }
+
+        if (![self.runLoopModes containsObject:(__bridge NSString *)aMode]) {
+            [self.runLoopModes addObject:(__bridge NSString *)aMode];
+        }
+    }
+}
+
+- (void)_unscheduleFromCFRunLoop:(CFRunLoopRef)aRunLoop
+                         forMode:(CFStringRef)aMode
+{
+    @synchronized (self) {
+        if (!aRunLoop || aRunLoop != _runLoop || !aMode) {
+            return;
+        }
+
+        [self.runLoopModes removeObject:(__bridge NSString *)aMode];
+    }
+}
+
+// Accepting a client lets the stream tell `NSURLSession` when a throttle has refilled, so it never has to poll or block
+- (BOOL)_setCFClientFlags:(CFOptionFlags)inFlags
+                 callback:(CFReadStreamClientCallBack)inCallback
+                  context:(CFStreamClientContext *)inContext
+{
+    if (_clientContext.info && _clientContext.release) {
+        _clientContext.release(_clientContext.info);
+    }
+    memset(&_clientContext, 0, sizeof(_clientContext));
+
+    _clientFlags = inFlags;
+    _clientCallback = inCallback;
+
+    if (inCallback && inContext) {
+        memcpy(&_clientContext, inContext, sizeof(_clientContext));
+        if (_clientContext.info && _clientContext.retain) {
+            _clientContext.retain(_clientContext.info);
+        }
+    }
+
+    return YES;
+}
+
+#pragma mark - NSCopying
+
+- (BOOL)conformsToProtocol:(Protocol *)aProtocol {
+    if (aProtocol == @protocol(NSCopying)) {
+        return [self.inputStream conformsToProtocol:aProtocol];
+    }
+
+    return [super conformsToProtocol:aProtocol];
+}
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    NSInputStream *inputStreamCopy = [(id <NSCopying>)self.inputStream copyWithZone:zone];
+
+    return [[[self class] allocWithZone:zone] initWithInputStream:inputStreamCopy throttles:self.throttles];
+}
+
+@end
+
+#pragma mark -
+
 @implementation AFJSONRequestSerializer
 
 + (instancetype)serializer {
@@ -1312,6 +2381,68 @@ typedef enum {
 
 #pragma mark -
 
+@implementation AFMessagePackRequestSerializer
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    [self setValue:@"application/msgpack, application/json;q=0.5" forHTTPHeaderField:@"Accept"];
+
+    return self;
+}
+
+#pragma mark - AFURLRequestSerialization
+
+- (NSURLRequest *)requestBySerializingRequest:(NSURLRequest *)request
+                               withParameters:(id)parameters
+                                        error:(NSError *__autoreleasing *)error
+{
+    NSParameterAssert(request);
+
+    if ([self.HTTPMethodsEncodingParametersInURI containsObject:[[request HTTPMethod] uppercaseString]]) {
+        return [super requestBySerializingRequest:request withParameters:parameters error:error];
+    }
+
+    NSMutableURLRequest *mutableRequest = [request mutableCopy];
+
+    [self.HTTPRequestHeaders enumerateKeysAndObjectsUsingBlock:^(id field, id value, BOOL * __unused stop) {
+        if (![request valueForHTTPHeaderField:field]) {
+            [mutableRequest setValue:value forHTTPHeaderField:field];
+        }
+    }];
+
+    if (parameters) {
+        if (![mutableRequest valueForHTTPHeaderField:@"Content-Type"]) {
+            [mutableRequest setValue:@"application/msgpack" forHTTPHeaderField:@"Content-Type"];
+        }
+
+        if (![AFMessagePackSerialization isValidMessagePackObject:parameters]) {
+            if (error) {
+                NSDictionary *userInfo = @{NSLocalizedFailureReasonErrorKey: NSLocalizedStringFromTable(@"The `parameters` argument is not valid MessagePack.", @"AFNetworking", nil)};
+                *error = [[NSError alloc] initWithDomain:AFURLRequestSerializationErrorDomain code:NSURLErrorCannotDecodeContentData userInfo:userInfo];
+            }
+            return nil;
+        }
+
+        NSData *messagePackData = [AFMessagePackSerialization dataWithMessagePackObject:parameters error:error];
+
+        if (!messagePackData) {
+            return nil;
+        }
+
+        [mutableRequest setHTTPBody:messagePackData];
+    }
+
+    return mutableRequest;
+}
+
+@end
+
+#pragma mark -
+
 @implementation AFPropertyListRequestSerializer
 
 + (instancetype)serializer {
@@ -22,10 +22,15 @@
 #import <Foundation/Foundation.h>
 #import <CoreGraphics/CoreGraphics.h>
 
+#import "AFMessagePackSerialization.h"
+#import "AFXMLPushParser.h"
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
  Recursively removes `NSNull` values from a JSON object.
+
+ With `NSJSONReadingMutableContainers`, the values are removed from mutable containers in place, and a mutable `JSONObject` is itself returned; immutable containers are copied as without the option. Otherwise, only the containers holding `NSNull` values, and those holding them in turn, are copied; any subtree without `NSNull` values is returned as is.
 */
 id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions readingOptions);
 
@@ -105,6 +110,199 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
 
 #pragma mark -
 
+/**
+ `AFURLResponseStream` is the abstract superclass of the streams decoding a single response as its data is received, rather than once it has been buffered, such as `AFJSONLinesStream`, `AFJSONElementStream`, `AFMessagePackStream`, `AFServerSentEventStream`, `AFMultipartResponseStream`, `AFXMLEventStream` and `AFXMLElementStream`. Streams are driven by `-[AFURLSessionManager dataTaskWithRequest:responseStream:completionHandler:]`.
+
+ Decoded objects are delivered in batches, one at a time and in order, on the queue of the stream. When too many batches are waiting to be delivered, or being handled, the data task is suspended until the handler catches up, so the memory used by a response is bounded by the size of its batches, however long it is.
+
+ The response is validated by the serializer that created the stream when its first data is received. A stream fails, and cancels its data task, if the response is not valid or cannot be decoded. The objects decoded before a stream fails are still delivered, but no data is decoded after.
+ */
+@interface AFURLResponseStream : NSObject
+
+/**
+ The number of times the data task was suspended because the handler of the stream fell behind.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfSuspensions;
+
+/**
+ The error the stream failed with, if any.
+ */
+@property (readonly, atomic, strong, nullable) NSError *error;
+
+/**
+ Decodes the specified data, keeping any trailing partial object until more data is received, and suspends the data task if too many batches are pending. Must be called serially, in the order data is received.
+
+ @param dataTask The data task receiving the response, or `nil` if the data is not received by a data task.
+ @param data The data received.
+ */
+- (void)dataTask:(nullable NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data;
+
+/**
+ Decodes the end of the response, delivers the last batch, and executes the completion handler on the queue of the stream once every batch has been handled. Must be called once, after all data is received.
+
+ @param completionHandler A block object to be executed once every batch has been handled. This block has no return value and takes a single argument: the error the stream failed with, if any.
+ */
+- (void)finishWithCompletionHandler:(nullable void (^)(NSError * _Nullable error))completionHandler;
+
+/**
+ Finishes a response whose data task may have failed. The trailing partial object of a response cut short is discarded rather than decoded, and unless the stream had failed first, the completion handler is passed the error of the data task rather than an error decoding the end of the response, which would hide the reason it was cut short. `error` is not changed by the error of the data task.
+
+ @param error The error the data task completed with, if any.
+ @param completionHandler A block object to be executed once every batch has been handled. This block has no return value and takes a single argument: the error the stream failed with, or else the error of the data task, if any.
+ */
+- (void)finishWithError:(nullable NSError *)error
+      completionHandler:(nullable void (^)(NSError * _Nullable error))completionHandler;
+
+@end
+
+#pragma mark -
+
+/**
+ The `AFContentDecoder` protocol is adopted by objects that undo a content coding of a single response body, such as one named by its `Content-Encoding` header, as the body is received. Decoders are created by an `AFContentDecoderRegistry`, and used by `AFURLSessionManager` between the data received by a task and its response serializer or response stream.
+ */
+@protocol AFContentDecoder <NSObject>
+
+/**
+ Decodes the next chunk of the encoded body. Must be called serially, in the order data is received.
+
+ @param data The encoded data received.
+ @param error The error that occurred while decoding the data.
+
+ @return The data decoded, which is empty if more data is needed, or `nil` if the data could not be decoded.
+ */
+- (nullable NSData *)decodedDataFromData:(NSData *)data
+                                   error:(NSError * _Nullable __autoreleasing *)error;
+
+/**
+ Finishes decoding once the whole body has been received.
+
+ @param error The error that occurred if the encoded body was truncated.
+
+ @return The remaining decoded data, or `nil` if the encoded body was not complete.
+ */
+- (nullable NSData *)finishDecoding:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+/**
+ The formats of zlib compressed data.
+
+ - `AFZlibContentFormatZlib`: The zlib format of RFC 1950, as used by the `deflate` content coding. Its streams name the preset dictionary they were compressed with by its Adler-32 checksum.
+ - `AFZlibContentFormatGZip`: The gzip format of RFC 1952, as used by the `gzip` content coding. The format has no preset dictionaries.
+ - `AFZlibContentFormatRawDeflate`: Raw deflate data of RFC 1951, without a header. The first dictionary is used as its preset dictionary, if any.
+ */
+typedef NS_ENUM(NSUInteger, AFZlibContentFormat) {
+    AFZlibContentFormatZlib = 0,
+    AFZlibContentFormatGZip,
+    AFZlibContentFormatRawDeflate,
+};
+
+/**
+ `AFZlibContentDecoder` is an `AFContentDecoder` that inflates zlib compressed data, optionally compressed with a shared preset dictionary, which improves the compression of small responses that repeat the keys and values of the dictionary.
+ */
+@interface AFZlibContentDecoder : NSObject <AFContentDecoder>
+
+/**
+ The format of the compressed data.
+ */
+@property (readonly, nonatomic, assign) AFZlibContentFormat format;
+
+/**
+ The preset dictionaries the data may have been compressed with.
+ */
+@property (readonly, nonatomic, copy) NSArray <NSData *> *dictionaries;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Creates and returns a decoder for data of the specified format.
+
+ @param format The format of the compressed data.
+ @param dictionaries The preset dictionaries the data may have been compressed with.
+ */
+- (instancetype)initWithFormat:(AFZlibContentFormat)format
+                  dictionaries:(nullable NSArray <NSData *> *)dictionaries NS_DESIGNATED_INITIALIZER;
+
+@end
+
+/**
+ A block creating the decoder of a response for a content coding, from the shared compression dictionaries of the registry. The block returns `nil` if the response cannot be decoded.
+ */
+typedef id <AFContentDecoder> _Nullable (^AFContentDecoderProvider)(NSURLResponse *response, NSArray <NSData *> *dictionaries);
+
+/**
+ `AFContentDecoderRegistry` chooses the decoders of a response from its `Content-Encoding` header, for the content codings `NSURLSession` does not decode itself, such as those of private compression schemes or shared dictionaries. Set as the `contentDecoderRegistry` of an `AFURLSessionManager`, responses are decoded chunk by chunk as they are received, before they reach the response serializer or response stream of their task.
+
+ Content codings are listed in the order they were applied, and are decoded from the last. Decoding stops at the first content coding without a decoder, leaving it and those before it to the platform or the response serializer, so a response none of whose codings are registered is passed through untouched. `identity` is ignored.
+
+ Registries are not thread safe, and should not be modified while in use by a session manager.
+
+ ## Compression Dictionaries
+
+ Small responses compress poorly, because the compressor has not seen enough of the data to find repetitions. A dictionary made of the keys and values such responses share, compressed against by the server and registered in `dictionaries` by the client, lets the first bytes of each response refer to it instead.
+ */
+@interface AFContentDecoderRegistry : NSObject <NSCopying>
+
+/**
+ The shared compression dictionaries passed to decoder providers. Empty by default.
+ */
+@property (nonatomic, copy) NSArray <NSData *> *dictionaries;
+
+/**
+ The content codings with a decoder, lowercased.
+ */
+@property (readonly, nonatomic, copy) NSSet <NSString *> *contentCodings;
+
+/**
+ Creates and returns a registry without any decoder.
+ */
++ (instancetype)registry;
+
+/**
+ Sets the block creating the decoders of the specified content coding, replacing any previous one.
+
+ @param provider The block creating the decoder of a response, or `nil` to remove the decoder of the content coding.
+ @param contentCoding The content coding, matched case-insensitively.
+ */
+- (void)setDecoderProvider:(nullable AFContentDecoderProvider)provider
+          forContentCoding:(NSString *)contentCoding;
+
+/**
+ Decodes the specified content coding with an `AFZlibContentDecoder` of the specified format, using the dictionaries of the registry.
+
+ @param format The format of the compressed data.
+ @param contentCoding The content coding, matched case-insensitively.
+ */
+- (void)setZlibDecoderWithFormat:(AFZlibContentFormat)format
+                forContentCoding:(NSString *)contentCoding;
+
+/**
+ Creates the decoder of the specified response.
+
+ @param response The response to be decoded.
+ @param error The error that occurred if the response has a registered content coding that cannot be decoded.
+
+ @return A decoder undoing the registered content codings of the response, or `nil` if it has none or an error occurred.
+ */
+- (nullable id <AFContentDecoder>)decoderForResponse:(NSURLResponse *)response
+                                                error:(NSError * _Nullable __autoreleasing *)error;
+
+@end
+
+#pragma mark -
+
+@class AFJSONElementStream;
+
+/**
+ The parsers `AFJSONResponseSerializer` can decode JSON responses with.
+
+ - `AFJSONParsingBackendFoundation`: `NSJSONSerialization`.
+ - `AFJSONParsingBackendStructuralIndex`: `AFJSONParser`, which finds the structural characters of the JSON text with vector instructions before creating any objects. See the `AFJSONParser` documentation for more details.
+ */
+typedef NS_ENUM(NSUInteger, AFJSONParsingBackend) {
+    AFJSONParsingBackendFoundation = 0,
+    AFJSONParsingBackendStructuralIndex,
+};
 
 /**
  `AFJSONResponseSerializer` is a subclass of `AFHTTPResponseSerializer` that validates and decodes JSON responses.
@@ -131,6 +329,16 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
  */
 @property (nonatomic, assign) BOOL removesKeysWithNullValues;
 
+/**
+ The parser JSON responses are decoded with. Both parsers create the same objects for the same `readingOptions`. `AFJSONParsingBackendFoundation` by default.
+ */
+@property (nonatomic, assign) AFJSONParsingBackend parsingBackend;
+
+/**
+ Whether to decode JSON responses lazily, as `AFJSONDocument` handles, whose values are created only when they are accessed by key path. Lazy decoding always finds the structural characters of the JSON text with `AFJSONParser`, whatever the `parsingBackend`. Defaults to `NO`.
+ */
+@property (nonatomic, assign) BOOL decodesLazily;
+
 /**
  Creates and returns a JSON serializer with specified reading and writing options.
 
@@ -138,13 +346,389 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
  */
 + (instancetype)serializerWithReadingOptions:(NSJSONReadingOptions)readingOptions;
 
+/**
+ Creates and returns a stream decoding the elements of a top-level JSON array, or of the array at the specified key path, one at a time as soon as each has been received, with the options of the serializer at the time the stream is created. `decodesLazily` does not apply to streams.
+
+ @param keyPath The dot-separated key path of the array in the response, such as `data.items`, or `nil` for a top-level array.
+ @param queue The queue elements are delivered on. If `NULL`, the main queue is used.
+ @param elementHandler A block object to be executed with each element decoded. This block has no return value and takes two arguments: the element, and its index in the array.
+ */
+- (AFJSONElementStream *)elementStreamWithKeyPath:(nullable NSString *)keyPath
+                                            queue:(nullable dispatch_queue_t)queue
+                                   elementHandler:(void (^)(id element, NSUInteger idx))elementHandler;
+
+@end
+
+/**
+ `AFJSONElementStream` is a subclass of `AFURLResponseStream` that decodes the elements of a JSON array as the response is received, so that the first elements can be handled while the rest is still being downloaded. Streams are created by `-[AFJSONResponseSerializer elementStreamWithKeyPath:queue:elementHandler:]`.
+
+ Elements completed by the same data are delivered together. Only the elements of the array are kept in memory until they are delivered, never the array or the rest of the response. A stream fails if the response has no array at its key path, or ends before the JSON text is complete.
+ */
+@interface AFJSONElementStream : AFURLResponseStream
+
+/**
+ The dot-separated key path of the array whose elements are decoded, or `nil` for a top-level array.
+ */
+@property (readonly, nonatomic, copy, nullable) NSString *keyPath;
+
+/**
+ The number of elements decoded so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfElements;
+
+@end
+
+#pragma mark -
+
+@class AFJSONModelSchema;
+
+/**
+ `AFJSONModelResponseSerializer` is a subclass of `AFJSONResponseSerializer` that decodes JSON responses straight into model objects, as described by an `AFJSONModelSchema`, with `-[AFJSONParser modelWithData:schema:error:]`. No dictionaries or arrays are created for the JSON objects and arrays decoded into models.
+
+ The response object is a model if the JSON text is an object, or an array of models if it is an array. Values not matching the schema fail with an error in `NSCocoaErrorDomain`, with the code `NSCoderReadCorruptError`, listing their key paths in its `AFJSONModelMismatchesErrorKey`.
+
+ `readingOptions`, `removesKeysWithNullValues`, `parsingBackend` and `decodesLazily` only apply when there is no `schema`, in which case responses are decoded as by `AFJSONResponseSerializer`.
+ */
+@interface AFJSONModelResponseSerializer : AFJSONResponseSerializer
+
+/**
+ The schema responses are decoded with. `nil` by default.
+ */
+@property (nonatomic, strong, nullable) AFJSONModelSchema *schema;
+
+/**
+ Creates and returns a serializer decoding responses with the specified schema.
+
+ @param schema The schema of the models.
+ */
++ (instancetype)serializerWithSchema:(AFJSONModelSchema *)schema;
+
 @end
 
 #pragma mark -
 
+@class AFMessagePackStream;
+
+/**
+ `AFMessagePackResponseSerializer` is a subclass of `AFHTTPResponseSerializer` that validates and decodes MessagePack responses using `AFMessagePackSerialization`.
+
+ Used as the response serializer of a session manager, the response must contain a single object. Responses made of a sequence of objects can be streamed with `-[AFURLSessionManager dataTaskWithRequest:responseStream:completionHandler:]`, passing a stream created by `-streamWithQueue:objectHandler:`, which decodes each object as soon as it has been received.
+
+ To accept either MessagePack or JSON, as requested by `AFMessagePackRequestSerializer`, use a response serializer created by `+[AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:]` with an `AFMessagePackResponseSerializer` and an `AFJSONResponseSerializer`.
+
+ By default, `AFMessagePackResponseSerializer` accepts the following MIME types:
+
+ - `application/msgpack`
+ - `application/x-msgpack`
+ - `application/vnd.msgpack`
+ */
+@interface AFMessagePackResponseSerializer : AFHTTPResponseSerializer
+
+- (instancetype)init;
+
+/**
+ Options for creating the Foundation objects. `0` by default.
+ */
+@property (nonatomic, assign) AFMessagePackReadingOptions readingOptions;
+
+/**
+ Creates and returns a MessagePack serializer with specified reading options.
+
+ @param readingOptions The specified reading options.
+ */
++ (instancetype)serializerWithReadingOptions:(AFMessagePackReadingOptions)readingOptions;
+
+/**
+ Creates and returns a stream decoding the sequence of objects of a single response as they are received.
+
+ @param queue The queue objects are delivered on. If `NULL`, the main queue is used.
+ @param objectHandler A block object to be executed with the objects decoded. This block has no return value and takes a single argument: the objects ended by the same data, in order.
+ */
+- (AFMessagePackStream *)streamWithQueue:(nullable dispatch_queue_t)queue
+                           objectHandler:(void (^)(NSArray *objects))objectHandler;
+
+@end
+
+/**
+ `AFMessagePackStream` is a subclass of `AFURLResponseStream` that decodes the sequence of MessagePack objects of a single response as its data is received, using an `AFMessagePackStreamDecoder`. Streams are created by `-[AFMessagePackResponseSerializer streamWithQueue:objectHandler:]`.
+
+ A stream fails if the response ends with a partial object.
+ */
+@interface AFMessagePackStream : AFURLResponseStream
+
+/**
+ The number of objects decoded so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfObjects;
+
+@end
+
+#pragma mark -
+
+@class AFJSONLinesStream;
+
+/**
+ `AFJSONLinesResponseSerializer` is a subclass of `AFHTTPResponseSerializer` that validates and decodes newline-delimited JSON responses, also known as JSON Lines or NDJSON, where each line is a JSON text of its own. Blank lines are skipped, and lines may end with `\r\n`.
+
+ By default, `AFJSONLinesResponseSerializer` accepts the following MIME types:
+
+ - `application/x-ndjson`
+ - `application/jsonl`
+ - `application/json-lines`
+ - `application/x-jsonlines`
+
+ ## Streaming Responses
+
+ Used as the response serializer of a session manager, the whole response is buffered and decoded into an array of records. Large responses should instead be streamed with `-[AFURLSessionManager dataTaskWithRequest:responseStream:completionHandler:]`, passing a stream created by `-streamWithBatchHandler:`. Records are then decoded as data is received, and delivered in batches of `batchSize` records. When `maximumNumberOfPendingBatches` batches are waiting to be delivered, or being handled, the data task is suspended until the batch handler catches up.
+ */
+@interface AFJSONLinesResponseSerializer : AFHTTPResponseSerializer
+
+- (instancetype)init;
+
+/**
+ Options for reading each record and creating the Foundation objects. For possible values, see the `NSJSONSerialization` documentation section "NSJSONReadingOptions". Fragments are always allowed. `0` by default.
+ */
+@property (nonatomic, assign) NSJSONReadingOptions readingOptions;
+
+/**
+ The number of records delivered to the batch handler of a stream at a time. The last batch of a response may be smaller. `256` by default.
+ */
+@property (nonatomic, assign) NSUInteger batchSize;
+
+/**
+ The number of batches of a stream that may be waiting to be delivered, or being handled, before its data task is suspended. `2` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumNumberOfPendingBatches;
+
+/**
+ The maximum length, in bytes, of a record. Longer records fail the stream with an error rather than being buffered without bound. `16 MB` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumRecordLength;
+
+/**
+ The queue batches of records are delivered on. Batches of a stream are delivered one at a time, in order, whatever the queue. If `NULL` (default), the main queue is used.
+ */
+@property (nonatomic, strong, nullable) dispatch_queue_t batchQueue;
+
+/**
+ Creates and returns a stream decoding a single response with the options of the serializer, at the time the stream is created.
+
+ @param batchHandler A block object to be executed with each batch of records decoded. This block has no return value and takes a single argument: the records of the batch, in order.
+ */
+- (AFJSONLinesStream *)streamWithBatchHandler:(void (^)(NSArray *records))batchHandler;
+
+@end
+
+/**
+ `AFJSONLinesStream` is a subclass of `AFURLResponseStream` that decodes the records of a single JSON Lines response as its data is received, delivering them in batches. Streams are created by `-[AFJSONLinesResponseSerializer streamWithBatchHandler:]`.
+
+ A stream also fails if a record is longer than `maximumRecordLength`. The last record of the response may lack a terminating newline.
+ */
+@interface AFJSONLinesStream : AFURLResponseStream
+
+/**
+ The number of records decoded so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfRecords;
+
+/**
+ The number of batches delivered so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfBatches;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFServerSentEvent` is an event of a `text/event-stream` response, as specified by the Server-Sent Events section of the HTML Living Standard.
+ */
+@interface AFServerSentEvent : NSObject
+
+/**
+ The type of the event, set by its `event` field. `message` if it has none.
+ */
+@property (readonly, nonatomic, copy) NSString *type;
+
+/**
+ The data of the event, the values of its `data` fields joined by line feeds.
+ */
+@property (readonly, nonatomic, copy) NSString *data;
+
+/**
+ The last event ID of the response when the event was dispatched, set by the `id` field of this event or of an earlier one.
+ */
+@property (readonly, nonatomic, copy, nullable) NSString *lastEventID;
+
+@end
+
+@class AFServerSentEventStream;
+
+/**
+ `AFServerSentEventResponseSerializer` is a subclass of `AFHTTPResponseSerializer` that validates and decodes `text/event-stream` responses into `AFServerSentEvent` objects.
+
+ Used as the response serializer of a session manager, the whole response is buffered and decoded into an array of events. Event streams are usually long-lived, and should instead be streamed with `-[AFHTTPSessionManager eventSourceWithURLString:parameters:headers:queue:eventHandler:completionHandler:]`, which reconnects when the connection is lost, or with a stream created by `-streamWithQueue:eventHandler:`.
+
+ By default, `AFServerSentEventResponseSerializer` accepts the `text/event-stream` MIME type.
+ */
+@interface AFServerSentEventResponseSerializer : AFHTTPResponseSerializer
+
+- (instancetype)init;
+
+/**
+ The maximum length, in bytes, of a line of the response. Longer lines fail the stream with an error rather than being buffered without bound. `16 MB` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumLineLength;
+
+/**
+ Creates and returns a stream decoding the events of a single response as they are received.
+
+ @param queue The queue events are delivered on. If `NULL`, the main queue is used.
+ @param eventHandler A block object to be executed with the events decoded. This block has no return value and takes a single argument: the events decoded from the same data, in order.
+ */
+- (AFServerSentEventStream *)streamWithQueue:(nullable dispatch_queue_t)queue
+                                eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler;
+
+@end
+
+/**
+ `AFServerSentEventStream` is a subclass of `AFURLResponseStream` that decodes the events of a single `text/event-stream` response as its data is received. Streams are created by `-[AFServerSentEventResponseSerializer streamWithQueue:eventHandler:]`.
+
+ Events are decoded straight from the data received, without creating a string for each line or field: each event creates no other objects than itself and its data, as its type and last event ID are shared with the previous event when unchanged. An event not terminated by a blank line before the response ends is discarded. A stream also fails if a line is longer than `maximumLineLength`.
+ */
+@interface AFServerSentEventStream : AFURLResponseStream
+
+/**
+ The last event ID of the response. Set it before any data is received to continue the event stream of an earlier response.
+ */
+@property (atomic, copy, nullable) NSString *lastEventID;
+
+/**
+ The reconnection time set by the last `retry` field of the response, or a negative value if there was none.
+ */
+@property (readonly, atomic, assign) NSTimeInterval reconnectionTime;
+
+/**
+ The number of events decoded so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfEvents;
+
+@end
+
+#pragma mark -
+
+/**
+ `AFMultipartResponsePart` is a part of a multipart response, decoded by the part response serializer of an `AFMultipartResponseSerializer`.
+ */
+@interface AFMultipartResponsePart : NSObject
+
+/**
+ The header fields of the part.
+ */
+@property (readonly, nonatomic, copy) NSDictionary <NSString *, NSString *> *headerFields;
+
+/**
+ The response the part was decoded as, with the URL and status code of the multipart response and the header fields of the part. For an unwrapped `application/http` part, the HTTP response it contains.
+ */
+@property (readonly, nonatomic, strong) NSHTTPURLResponse *response;
+
+/**
+ The body of the part. For an unwrapped `application/http` part, the body of the HTTP response it contains.
+ */
+@property (readonly, nonatomic, strong) NSData *data;
+
+/**
+ The response object decoded from the part, if any.
+ */
+@property (readonly, nonatomic, strong, nullable) id responseObject;
+
+/**
+ The error the part could not be decoded with, if any. A part failing to decode does not fail the multipart response.
+ */
+@property (readonly, nonatomic, strong, nullable) NSError *error;
+
+/**
+ The range of bytes set by the `Content-Range` header field of a `multipart/byteranges` part, or `{NSNotFound, 0}` if it has none.
+ */
+@property (readonly, nonatomic, assign) NSRange byteRange;
+
+@end
+
+@class AFMultipartResponseStream;
+
+/**
+ `AFMultipartResponseSerializer` is a subclass of `AFHTTPResponseSerializer` that validates and splits multipart responses, such as the responses of batch requests or of requests for several byte ranges, into `AFMultipartResponsePart` objects, decoding each part with a part response serializer.
+
+ Used as the response serializer of a session manager, the whole response is buffered and decoded into an array of parts. Large responses can instead be decoded as they are received by a stream created by `-streamWithQueue:partHandler:`.
+
+ The boundary of the parts is read from the `Content-Type` header field of the response.
+
+ By default, `AFMultipartResponseSerializer` accepts the following MIME types:
+
+ - `multipart/mixed`
+ - `multipart/byteranges`
+ - `multipart/related`
+ */
+@interface AFMultipartResponseSerializer : AFHTTPResponseSerializer
+
+- (instancetype)init;
+
+/**
+ The serializer each part is decoded with. `AFHTTPResponseSerializer` by default, which decodes each part as its data. Use an `AFCompoundResponseSerializer` to decode parts according to their content type.
+ */
+@property (nonatomic, strong) id <AFURLResponseSerialization> partResponseSerializer;
+
+/**
+ Whether `application/http` parts, such as the responses of the requests of a batch, are unwrapped into the HTTP response they contain before being decoded. `YES` by default.
+ */
+@property (nonatomic, assign) BOOL unwrapsHTTPResponseParts;
+
+/**
+ The maximum length of the body of a part, in bytes. A response with a longer part fails to decode. 16 MB by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumPartLength;
+
+/**
+ Creates and returns a serializer with the specified part response serializer.
+
+ @param partResponseSerializer The serializer each part is decoded with.
+ */
++ (instancetype)serializerWithPartResponseSerializer:(id <AFURLResponseSerialization>)partResponseSerializer;
+
+/**
+ Creates and returns a stream decoding the parts of a single response as they are received.
+
+ @param queue The queue parts are delivered on. If `NULL`, the main queue is used.
+ @param partHandler A block object to be executed with the parts decoded. This block has no return value and takes a single argument: the parts decoded from the same data, in order.
+ */
+- (AFMultipartResponseStream *)streamWithQueue:(nullable dispatch_queue_t)queue
+                                   partHandler:(void (^)(NSArray <AFMultipartResponsePart *> *parts))partHandler;
+
+@end
+
+/**
+ `AFMultipartResponseStream` is a subclass of `AFURLResponseStream` that decodes the parts of a single multipart response as its data is received. Streams are created by `-[AFMultipartResponseSerializer streamWithQueue:partHandler:]`.
+
+ The data received is searched for the next delimiter once, without scanning again the bytes of a part already searched, and each part is decoded as soon as its delimiter is found. A response not ended by a close delimiter fails to decode.
+ */
+@interface AFMultipartResponseStream : AFURLResponseStream
+
+/**
+ The number of parts decoded so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfParts;
+
+@end
+
+#pragma mark -
+
+@class AFXMLEventStream, AFXMLElementStream;
+
 /**
  `AFXMLParserResponseSerializer` is a subclass of `AFHTTPResponseSerializer` that validates and decodes XML responses as an `NSXMLParser` objects.
 
+ Used as the response serializer of a session manager, the whole response is buffered before it is parsed. Large documents can instead be parsed as they are received with `-[AFURLSessionManager dataTaskWithRequest:responseStream:completionHandler:]`, passing a stream created by `-eventStreamWithQueue:eventHandler:` or `-elementStreamWithPath:queue:elementHandler:`, which parse the response with an `AFXMLPushParser`.
+
  By default, `AFXMLParserResponseSerializer` accepts the following MIME types, which includes the official standard, `application/xml`, as well as other commonly-used types:
 
  - `application/xml`
@@ -152,6 +736,59 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
  */
 @interface AFXMLParserResponseSerializer : AFHTTPResponseSerializer
 
+/**
+ Creates and returns a stream reporting the start tags, end tags and character data of a single response as they are received.
+
+ @param queue The queue events are delivered on. If `NULL`, the main queue is used.
+ @param eventHandler A block object to be executed with the events parsed. This block has no return value and takes a single argument: the events found in the same data, in document order.
+ */
+- (AFXMLEventStream *)eventStreamWithQueue:(nullable dispatch_queue_t)queue
+                              eventHandler:(void (^)(NSArray <AFXMLEvent *> *events))eventHandler;
+
+/**
+ Creates and returns a stream building the elements at the specified path of a single response, one at a time as soon as each has been received.
+
+ @param path The slash-separated names of the elements from the root element, such as `feed/entry`, where `*` matches any name.
+ @param queue The queue elements are delivered on. If `NULL`, the main queue is used.
+ @param elementHandler A block object to be executed with each element built. This block has no return value and takes two arguments: the element, and the number of elements at the path before it.
+ */
+- (AFXMLElementStream *)elementStreamWithPath:(NSString *)path
+                                        queue:(nullable dispatch_queue_t)queue
+                               elementHandler:(void (^)(AFXMLElement *element, NSUInteger idx))elementHandler;
+
+@end
+
+/**
+ `AFXMLEventStream` is a subclass of `AFURLResponseStream` that parses a single XML response as its data is received, using an `AFXMLPushParser`. Streams are created by `-[AFXMLParserResponseSerializer eventStreamWithQueue:eventHandler:]`.
+
+ A stream fails if the response is not a well-formed document, or ends before the root element is closed.
+ */
+@interface AFXMLEventStream : AFURLResponseStream
+
+/**
+ The number of events parsed so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfEvents;
+
+@end
+
+/**
+ `AFXMLElementStream` is a subclass of `AFURLResponseStream` that builds the elements at a path of a single XML response as it is received, such as the entries of a feed, so that the first elements can be handled while the rest is still being downloaded. Streams are created by `-[AFXMLParserResponseSerializer elementStreamWithPath:queue:elementHandler:]`.
+
+ Only the element being built is kept in memory until it is delivered, never the rest of the document. Elements completed by the same data are delivered together. A stream fails if the response is not a well-formed document, or ends before the root element is closed.
+ */
+@interface AFXMLElementStream : AFURLResponseStream
+
+/**
+ The slash-separated names of the elements built, from the root element.
+ */
+@property (readonly, nonatomic, copy) NSString *path;
+
+/**
+ The number of elements built so far.
+ */
+@property (readonly, atomic, assign) NSUInteger numberOfElements;
+
 @end
 
 #pragma mark -
@@ -257,7 +894,13 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
 #pragma mark -
 
 /**
- `AFCompoundSerializer` is a subclass of `AFHTTPResponseSerializer` that delegates the response serialization to the first `AFHTTPResponseSerializer` object that returns an object for `responseObjectForResponse:data:error:`, falling back on the default behavior of `AFHTTPResponseSerializer`. This is useful for supporting multiple potential types and structures of server responses with a single serializer.
+ `AFCompoundSerializer` is a subclass of `AFHTTPResponseSerializer` that delegates the response serialization to the `AFHTTPResponseSerializer` object accepting the MIME type of the response, falling back on the default behavior of `AFHTTPResponseSerializer` if it returns no object. This is useful for supporting multiple potential types and structures of server responses with a single serializer.
+
+ ## Dispatching Responses
+
+ Each response is decoded by one component serializer at most, looked up by the MIME type of the response in a table built from the `acceptableContentTypes` of the component serializers. The table is rebuilt before the next response whenever the `acceptableContentTypes` of a component serializer have been set since, so changes made after the compound serializer is created take effect. The earliest component serializer accepting a MIME type decodes the responses of that type.
+
+ Responses without a MIME type, or with a MIME type no component serializer accepts, are dispatched by the type of their data, sniffed from its first bytes: JSON, XML and property lists, and PNG, JPEG, GIF, TIFF, BMP and ICO images. They are decoded as if they had been sent with the MIME type sniffed. Otherwise, they are decoded by the earliest component serializer with `nil` `acceptableContentTypes`, if any.
  */
 @interface AFCompoundResponseSerializer : AFHTTPResponseSerializer
 
@@ -266,6 +909,21 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
  */
 @property (readonly, nonatomic, copy) NSArray <id<AFURLResponseSerialization>> *responseSerializers;
 
+/**
+ The number of responses dispatched to a component serializer by their MIME type.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfResponsesDispatchedByContentType;
+
+/**
+ The number of responses dispatched to a component serializer by the type sniffed from their data, because their MIME type was missing or not accepted by any component serializer.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfResponsesDispatchedBySniffing;
+
+/**
+ The number of responses dispatched by neither their MIME type nor the type of their data.
+ */
+@property (readonly, nonatomic, assign) NSUInteger numberOfUndispatchedResponses;
+
 /**
  Creates and returns a compound serializer comprised of the specified response serializers.
 
@@ -20,8 +20,11 @@
 // THE SOFTWARE.
 
 #import "AFURLResponseSerialization.h"
+#import "AFURLRequestSerialization.h"
+#import "AFJSONParser.h"
 
 #import <TargetConditionals.h>
+#import <zlib.h>
 
 #if TARGET_OS_IOS
 #import <UIKit/UIKit.h>
@@ -60,33 +63,125 @@ static BOOL AFErrorOrUnderlyingErrorHasCodeInDomain(NSError *error, NSInteger co
     return NO;
 }
 
-id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions readingOptions) {
+static NSString * AFMultipartHeaderFieldValue(NSDictionary *headerFields, NSString *field) {
+    for (NSString *key in headerFields) {
+        if ([key caseInsensitiveCompare:field] == NSOrderedSame) {
+            return headerFields[key];
+        }
+    }
+
+    return nil;
+}
+
+// Only the containers along the path to a null value are copied; any other subtree is returned as is
+static id AFJSONObjectByRemovingKeysWithNullValuesCopyingOnWrite(id JSONObject) {
+    NSNull *null = [NSNull null];
+
     if ([JSONObject isKindOfClass:[NSArray class]]) {
-        NSMutableArray *mutableArray = [NSMutableArray arrayWithCapacity:[(NSArray *)JSONObject count]];
-        for (id value in (NSArray *)JSONObject) {
-            if (![value isEqual:[NSNull null]]) {
-                [mutableArray addObject:AFJSONObjectByRemovingKeysWithNullValues(value, readingOptions)];
+        NSArray *array = JSONObject;
+        NSMutableArray *mutableArray = nil;
+        NSUInteger idx = 0;
+        for (id value in array) {
+            id strippedValue = value == null ? nil : AFJSONObjectByRemovingKeysWithNullValuesCopyingOnWrite(value);
+            if (strippedValue != value && !mutableArray) {
+                mutableArray = [NSMutableArray arrayWithCapacity:[array count]];
+                [mutableArray addObjectsFromArray:[array subarrayWithRange:NSMakeRange(0, idx)]];
             }
+
+            if (mutableArray && strippedValue) {
+                [mutableArray addObject:strippedValue];
+            }
+            idx++;
         }
 
-        return (readingOptions & NSJSONReadingMutableContainers) ? mutableArray : [NSArray arrayWithArray:mutableArray];
+        return mutableArray ? [mutableArray copy] : array;
     } else if ([JSONObject isKindOfClass:[NSDictionary class]]) {
-        NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionaryWithDictionary:JSONObject];
-        for (id <NSCopying> key in [(NSDictionary *)JSONObject allKeys]) {
-            id value = (NSDictionary *)JSONObject[key];
-            if (!value || [value isEqual:[NSNull null]]) {
+        NSDictionary *dictionary = JSONObject;
+        NSMutableDictionary *mutableDictionary = nil;
+        for (id key in dictionary) {
+            id value = dictionary[key];
+            id strippedValue = value == null ? nil : AFJSONObjectByRemovingKeysWithNullValuesCopyingOnWrite(value);
+            if (strippedValue == value) {
+                continue;
+            }
+
+            if (!mutableDictionary) {
+                mutableDictionary = [dictionary mutableCopy];
+            }
+            if (strippedValue) {
+                mutableDictionary[key] = strippedValue;
+            } else {
                 [mutableDictionary removeObjectForKey:key];
-            } else if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) {
-                mutableDictionary[key] = AFJSONObjectByRemovingKeysWithNullValues(value, readingOptions);
             }
         }
 
-        return (readingOptions & NSJSONReadingMutableContainers) ? mutableDictionary : [NSDictionary dictionaryWithDictionary:mutableDictionary];
+        return mutableDictionary ? [mutableDictionary copy] : dictionary;
     }
 
     return JSONObject;
 }
 
+// Mutable containers are stripped in place; an immutable container found among them is copied on write, and replaced by its copy
+static id AFJSONObjectByRemovingKeysWithNullValuesInPlace(id JSONObject) {
+    NSNull *null = [NSNull null];
+
+    if ([JSONObject isKindOfClass:[NSMutableArray class]]) {
+        NSMutableArray *mutableArray = JSONObject;
+        [mutableArray removeObjectIdenticalTo:null];
+        for (NSUInteger idx = 0; idx < [mutableArray count]; idx++) {
+            id value = mutableArray[idx];
+            id strippedValue = AFJSONObjectByRemovingKeysWithNullValuesInPlace(value);
+            if (strippedValue != value) {
+                mutableArray[idx] = strippedValue;
+            }
+        }
+
+        return mutableArray;
+    } else if ([JSONObject isKindOfClass:[NSMutableDictionary class]]) {
+        NSMutableDictionary *mutableDictionary = JSONObject;
+        NSMutableArray *keysWithNullValues = nil;
+        NSMutableDictionary *strippedValues = nil;
+        for (id key in mutableDictionary) {
+            id value = mutableDictionary[key];
+            if (value == null) {
+                if (!keysWithNullValues) {
+                    keysWithNullValues = [NSMutableArray array];
+                }
+                [keysWithNullValues addObject:key];
+                continue;
+            }
+
+            id strippedValue = AFJSONObjectByRemovingKeysWithNullValuesInPlace(value);
+            if (strippedValue != value) {
+                if (!strippedValues) {
+                    strippedValues = [NSMutableDictionary dictionary];
+                }
+                strippedValues[key] = strippedValue;
+            }
+        }
+
+        if (keysWithNullValues) {
+            [mutableDictionary removeObjectsForKeys:keysWithNullValues];
+        }
+        if (strippedValues) {
+            [mutableDictionary addEntriesFromDictionary:strippedValues];
+        }
+
+        return mutableDictionary;
+    }
+
+    return AFJSONObjectByRemovingKeysWithNullValuesCopyingOnWrite(JSONObject);
+}
+
+id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions readingOptions) {
+    // Mutable containers are owned by the caller, so nulls are removed from them without copying anything
+    if (readingOptions & NSJSONReadingMutableContainers) {
+        return AFJSONObjectByRemovingKeysWithNullValuesInPlace(JSONObject);
+    }
+
+    return AFJSONObjectByRemovingKeysWithNullValuesCopyingOnWrite(JSONObject);
+}
+
 @implementation AFHTTPResponseSerializer
 
 + (instancetype)serializer {
@@ -158,63 +253,2106 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
     return responseIsValid;
 }
 
-#pragma mark - AFURLResponseSerialization
+#pragma mark - AFURLResponseSerialization
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    [self validateResponse:(NSHTTPURLResponse *)response data:data error:error];
+
+    return data;
+}
+
+#pragma mark - NSSecureCoding
+
++ (BOOL)supportsSecureCoding {
+    return YES;
+}
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    self = [self init];
+    if (!self) {
+        return nil;
+    }
+
+    self.acceptableStatusCodes = [decoder decodeObjectOfClass:[NSIndexSet class] forKey:NSStringFromSelector(@selector(acceptableStatusCodes))];
+    self.acceptableContentTypes = [decoder decodeObjectOfClass:[NSSet class] forKey:NSStringFromSelector(@selector(acceptableContentTypes))];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [coder encodeObject:self.acceptableStatusCodes forKey:NSStringFromSelector(@selector(acceptableStatusCodes))];
+    [coder encodeObject:self.acceptableContentTypes forKey:NSStringFromSelector(@selector(acceptableContentTypes))];
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFHTTPResponseSerializer *serializer = [[[self class] allocWithZone:zone] init];
+    serializer.acceptableStatusCodes = [self.acceptableStatusCodes copyWithZone:zone];
+    serializer.acceptableContentTypes = [self.acceptableContentTypes copyWithZone:zone];
+
+    return serializer;
+}
+
+@end
+
+#pragma mark -
+
+static NSError * AFResponseStreamErrorWithDescription(NSString *description, NSError *underlyingError) {
+    NSError *error = [NSError errorWithDomain:AFURLResponseSerializationErrorDomain code:NSURLErrorCannotParseResponse userInfo:@{NSLocalizedDescriptionKey: description}];
+
+    return AFErrorWithUnderlyingError(error, underlyingError);
+}
+
+@interface AFURLResponseStream ()
+@property (readwrite, nonatomic, strong) AFHTTPResponseSerializer *responseSerializer;
+@property (readwrite, nonatomic, assign) NSUInteger maximumNumberOfPendingBatches;
+@property (readwrite, nonatomic, strong) dispatch_queue_t deliveryQueue;
+@property (readwrite, nonatomic, strong) dispatch_group_t deliveryGroup;
+@property (readwrite, nonatomic, strong) NSLock *lock;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfPendingBatches;
+@property (readwrite, nonatomic, strong) NSURLSessionDataTask *suspendedDataTask;
+@property (readwrite, nonatomic, assign, getter=isValidated) BOOL validated;
+@property (readwrite, nonatomic, assign, getter=isFinished) BOOL finished;
+@property (readwrite, atomic, assign) NSUInteger numberOfSuspensions;
+@property (readwrite, atomic, strong) NSError *error;
+@property (readwrite, atomic, strong) NSError *dataTaskError;
+@property (readwrite, atomic, strong) NSError *completionError;
+
+- (instancetype)initWithResponseSerializer:(AFHTTPResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+             maximumNumberOfPendingBatches:(NSUInteger)maximumNumberOfPendingBatches;
+
+// Overridden by subclasses. `-decodeData:` sets `error` and returns `NO` if the data cannot be decoded; `-finishDecoding` is not called after an error. `dataTaskError` is set before `-finishDecoding` is called for a response cut short.
+- (BOOL)decodeData:(NSData *)data;
+- (void)finishDecoding;
+
+- (void)deliverBatch:(dispatch_block_t)block;
+@end
+
+@implementation AFURLResponseStream
+
+- (instancetype)initWithResponseSerializer:(AFHTTPResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+             maximumNumberOfPendingBatches:(NSUInteger)maximumNumberOfPendingBatches
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.responseSerializer = responseSerializer;
+    self.maximumNumberOfPendingBatches = MAX(maximumNumberOfPendingBatches, (NSUInteger)1);
+    self.deliveryGroup = dispatch_group_create();
+    self.lock = [[NSLock alloc] init];
+
+    // Batches are delivered on a private serial queue targeting the specified queue, so that they stay in order on a concurrent queue.
+    self.deliveryQueue = dispatch_queue_create("com.alamofire.networking.response-stream.delivery", DISPATCH_QUEUE_SERIAL);
+    dispatch_set_target_queue(self.deliveryQueue, queue ?: dispatch_get_main_queue());
+
+    return self;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    return YES;
+}
+
+- (void)finishDecoding {
+}
+
+- (void)deliverBatch:(dispatch_block_t)block {
+    [self.lock lock];
+    self.numberOfPendingBatches++;
+    [self.lock unlock];
+
+    dispatch_group_async(self.deliveryGroup, self.deliveryQueue, ^{
+        block();
+
+        NSURLSessionDataTask *dataTask = nil;
+        [self.lock lock];
+        self.numberOfPendingBatches--;
+        if (self.suspendedDataTask && self.numberOfPendingBatches < self.maximumNumberOfPendingBatches) {
+            dataTask = self.suspendedDataTask;
+            self.suspendedDataTask = nil;
+        }
+        [self.lock unlock];
+
+        [dataTask resume];
+    });
+}
+
+- (void)dataTask:(NSURLSessionDataTask *)dataTask
+  didReceiveData:(NSData *)data
+{
+    if (self.error || self.finished) {
+        return;
+    }
+
+    if (!self.validated) {
+        self.validated = YES;
+
+        NSError *validationError = nil;
+        if (![self.responseSerializer validateResponse:(NSHTTPURLResponse *)dataTask.response data:data error:&validationError]) {
+            self.error = validationError ?: AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The response could not be validated.", @"AFNetworking", nil), nil);
+            [dataTask cancel];
+            return;
+        }
+    }
+
+    if (![self decodeData:data]) {
+        [dataTask cancel];
+        return;
+    }
+
+    if (!dataTask) {
+        return;
+    }
+
+    [self.lock lock];
+    if (!self.suspendedDataTask && self.numberOfPendingBatches >= self.maximumNumberOfPendingBatches) {
+        self.suspendedDataTask = dataTask;
+        self.numberOfSuspensions++;
+        [dataTask suspend];
+    }
+    [self.lock unlock];
+}
+
+- (void)finishWithCompletionHandler:(void (^)(NSError *error))completionHandler {
+    [self finishWithError:nil completionHandler:completionHandler];
+}
+
+- (void)finishWithError:(NSError *)error
+      completionHandler:(void (^)(NSError *error))completionHandler
+{
+    if (!self.finished) {
+        self.finished = YES;
+        self.dataTaskError = error;
+
+        if (self.error) {
+            // The stream failed first, and cancelled its data task
+            self.completionError = self.error;
+        } else {
+            [self finishDecoding];
+
+            // Decoding the end of a response cut short may fail, which would hide the reason it was cut short
+            self.completionError = error ?: self.error;
+        }
+    }
+
+    if (completionHandler) {
+        dispatch_group_notify(self.deliveryGroup, self.deliveryQueue, ^{
+            completionHandler(self.completionError);
+        });
+    }
+}
+
+@end
+
+#pragma mark -
+
+static NSError * AFContentDecodingErrorWithDescription(NSString *description) {
+    return [NSError errorWithDomain:AFURLResponseSerializationErrorDomain code:NSURLErrorCannotDecodeRawData userInfo:@{NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"The response content could not be decoded.", @"AFNetworking", nil), @"NSDebugDescription": description}];
+}
+
+static NSUInteger const AFZlibContentDecoderMinimumOutputLength = 16 * 1024;
+
+@interface AFZlibContentDecoder () {
+    z_stream _stream;
+}
+@property (readwrite, nonatomic, assign) AFZlibContentFormat format;
+@property (readwrite, nonatomic, copy) NSArray <NSData *> *dictionaries;
+@property (readwrite, nonatomic, assign, getter=isStreamInitialized) BOOL streamInitialized;
+@property (readwrite, nonatomic, assign, getter=isFinished) BOOL finished;
+@end
+
+@implementation AFZlibContentDecoder
+
+- (instancetype)initWithFormat:(AFZlibContentFormat)format
+                  dictionaries:(NSArray <NSData *> *)dictionaries
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.format = format;
+    self.dictionaries = dictionaries ?: @[];
+
+    // Negative window bits make zlib read raw deflate data, and adding 16 makes it read a gzip wrapper instead of a zlib one
+    int windowBits = MAX_WBITS;
+    if (format == AFZlibContentFormatGZip) {
+        windowBits = MAX_WBITS + 16;
+    } else if (format == AFZlibContentFormatRawDeflate) {
+        windowBits = -MAX_WBITS;
+    }
+
+    memset(&_stream, 0, sizeof(_stream));
+    self.streamInitialized = inflateInit2(&_stream, windowBits) == Z_OK;
+
+    // Raw deflate data does not name its dictionary, which has to be set before any data is inflated
+    NSData *dictionary = [self.dictionaries firstObject];
+    if (self.streamInitialized && format == AFZlibContentFormatRawDeflate && dictionary) {
+        inflateSetDictionary(&_stream, [dictionary bytes], (uInt)[dictionary length]);
+    }
+
+    return self;
+}
+
+- (void)dealloc {
+    if (_streamInitialized) {
+        inflateEnd(&_stream);
+    }
+}
+
+- (NSData *)dictionaryWithAdler32Checksum:(uLong)checksum {
+    for (NSData *dictionary in self.dictionaries) {
+        if (adler32(adler32(0L, Z_NULL, 0), [dictionary bytes], (uInt)[dictionary length]) == checksum) {
+            return dictionary;
+        }
+    }
+
+    return nil;
+}
+
+- (BOOL)failWithDescription:(NSString *)description
+                      error:(NSError * __autoreleasing *)error
+{
+    if (self.streamInitialized) {
+        inflateEnd(&_stream);
+        self.streamInitialized = NO;
+    }
+
+    if (error) {
+        *error = AFContentDecodingErrorWithDescription(description);
+    }
+
+    return NO;
+}
+
+#pragma mark - AFContentDecoder
+
+- (NSData *)decodedDataFromData:(NSData *)data
+                          error:(NSError * __autoreleasing *)error
+{
+    if ([data length] == 0) {
+        return [NSData data];
+    }
+
+    if (self.isFinished) {
+        [self failWithDescription:@"Unexpected data after the end of the compressed stream" error:error];
+        return nil;
+    }
+
+    if (!self.streamInitialized) {
+        [self failWithDescription:@"The compressed stream could not be read" error:error];
+        return nil;
+    }
+
+    NSMutableData *decodedData = [NSMutableData dataWithLength:MAX([data length] * 4, AFZlibContentDecoderMinimumOutputLength)];
+    const uint8_t *bytes = [data bytes];
+    NSUInteger remainingLength = [data length];
+    NSUInteger decodedLength = 0;
+
+    _stream.avail_in = 0;
+    while (remainingLength > 0 || _stream.avail_in > 0) {
+        if (_stream.avail_in == 0) {
+            _stream.next_in = (Bytef *)bytes;
+            _stream.avail_in = (uInt)MIN(remainingLength, (NSUInteger)UINT_MAX);
+            bytes += _stream.avail_in;
+            remainingLength -= _stream.avail_in;
+        }
+
+        if (decodedLength == [decodedData length]) {
+            [decodedData increaseLengthBy:[decodedData length]];
+        }
+
+        _stream.next_out = (Bytef *)[decodedData mutableBytes] + decodedLength;
+        _stream.avail_out = (uInt)MIN([decodedData length] - decodedLength, (NSUInteger)UINT_MAX);
+        uInt availableLength = _stream.avail_out;
+
+        int status = inflate(&_stream, Z_NO_FLUSH);
+        decodedLength += availableLength - _stream.avail_out;
+
+        if (status == Z_NEED_DICT) {
+            NSData *dictionary = [self dictionaryWithAdler32Checksum:_stream.adler];
+            if (!dictionary || inflateSetDictionary(&_stream, [dictionary bytes], (uInt)[dictionary length]) != Z_OK) {
+                [self failWithDescription:[NSString stringWithFormat:@"No dictionary with Adler-32 checksum %08lx", (unsigned long)_stream.adler] error:error];
+                return nil;
+            }
+        } else if (status == Z_STREAM_END) {
+            self.finished = YES;
+            if (remainingLength > 0 || _stream.avail_in > 0) {
+                [self failWithDescription:@"Unexpected data after the end of the compressed stream" error:error];
+                return nil;
+            }
+
+            break;
+        } else if (status != Z_OK && !(status == Z_BUF_ERROR && _stream.avail_out == 0)) {
+            [self failWithDescription:[NSString stringWithFormat:@"%s", _stream.msg ?: "Invalid compressed data"] error:error];
+            return nil;
+        }
+    }
+
+    // Inflate whatever zlib holds back once the input is consumed, until it stops filling the output buffer
+    while (!self.isFinished && _stream.avail_out == 0) {
+        [decodedData increaseLengthBy:[decodedData length]];
+        _stream.next_out = (Bytef *)[decodedData mutableBytes] + decodedLength;
+        _stream.avail_out = (uInt)MIN([decodedData length] - decodedLength, (NSUInteger)UINT_MAX);
+        uInt availableLength = _stream.avail_out;
+
+        int status = inflate(&_stream, Z_NO_FLUSH);
+        decodedLength += availableLength - _stream.avail_out;
+
+        if (status == Z_STREAM_END) {
+            self.finished = YES;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            [self failWithDescription:[NSString stringWithFormat:@"%s", _stream.msg ?: "Invalid compressed data"] error:error];
+            return nil;
+        }
+    }
+
+    [decodedData setLength:decodedLength];
+
+    return decodedData;
+}
+
+- (NSData *)finishDecoding:(NSError * __autoreleasing *)error {
+    if (!self.isFinished) {
+        [self failWithDescription:@"Unexpected end of the compressed stream" error:error];
+        return nil;
+    }
+
+    return [NSData data];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFContentDecoderChain : NSObject <AFContentDecoder>
+@property (readwrite, nonatomic, copy) NSArray <id <AFContentDecoder>> *decoders;
+@end
+
+@implementation AFContentDecoderChain
+
+- (NSData *)decodedDataFromData:(NSData *)data
+                          error:(NSError * __autoreleasing *)error
+{
+    for (id <AFContentDecoder> decoder in self.decoders) {
+        data = [decoder decodedDataFromData:data error:error];
+        if ([data length] == 0) {
+            return data;
+        }
+    }
+
+    return data;
+}
+
+- (NSData *)finishDecoding:(NSError * __autoreleasing *)error {
+    // Each decoder is finished once the data left by the decoders before it has gone through it
+    NSData *data = [NSData data];
+    for (id <AFContentDecoder> decoder in self.decoders) {
+        NSMutableData *decodedData = [NSMutableData data];
+
+        NSData *decodedChunk = [decoder decodedDataFromData:data error:error];
+        NSData *remainingData = decodedChunk ? [decoder finishDecoding:error] : nil;
+        if (!remainingData) {
+            return nil;
+        }
+
+        [decodedData appendData:decodedChunk];
+        [decodedData appendData:remainingData];
+        data = decodedData;
+    }
+
+    return data;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFContentDecoderRegistry ()
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSString *, AFContentDecoderProvider> *mutableProvidersKeyedByContentCoding;
+@end
+
+@implementation AFContentDecoderRegistry
+
++ (instancetype)registry {
+    return [[self alloc] init];
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.dictionaries = @[];
+    self.mutableProvidersKeyedByContentCoding = [NSMutableDictionary dictionary];
+
+    return self;
+}
+
+- (NSSet <NSString *> *)contentCodings {
+    return [NSSet setWithArray:[self.mutableProvidersKeyedByContentCoding allKeys]];
+}
+
+- (void)setDecoderProvider:(AFContentDecoderProvider)provider
+          forContentCoding:(NSString *)contentCoding
+{
+    NSParameterAssert(contentCoding);
+
+    self.mutableProvidersKeyedByContentCoding[[contentCoding lowercaseString]] = [provider copy];
+}
+
+- (void)setZlibDecoderWithFormat:(AFZlibContentFormat)format
+                forContentCoding:(NSString *)contentCoding
+{
+    [self setDecoderProvider:^id <AFContentDecoder>(NSURLResponse * __unused response, NSArray <NSData *> *dictionaries) {
+        return [[AFZlibContentDecoder alloc] initWithFormat:format dictionaries:dictionaries];
+    } forContentCoding:contentCoding];
+}
+
+- (id <AFContentDecoder>)decoderForResponse:(NSURLResponse *)response
+                                      error:(NSError * __autoreleasing *)error
+{
+    if (![response isKindOfClass:[NSHTTPURLResponse class]] || [self.mutableProvidersKeyedByContentCoding count] == 0) {
+        return nil;
+    }
+
+    NSString *contentEncoding = AFMultipartHeaderFieldValue([(NSHTTPURLResponse *)response allHeaderFields], @"Content-Encoding");
+    if (!contentEncoding) {
+        return nil;
+    }
+
+    NSMutableArray <id <AFContentDecoder>> *mutableDecoders = [NSMutableArray array];
+    NSArray <NSString *> *contentCodings = [contentEncoding componentsSeparatedByString:@","];
+    for (NSString *component in [contentCodings reverseObjectEnumerator]) {
+        NSString *contentCoding = [[component stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]] lowercaseString];
+        if ([contentCoding length] == 0 || [contentCoding isEqualToString:@"identity"]) {
+            continue;
+        }
+
+        AFContentDecoderProvider provider = self.mutableProvidersKeyedByContentCoding[contentCoding];
+        if (!provider) {
+            break;
+        }
+
+        id <AFContentDecoder> decoder = provider(response, self.dictionaries);
+        if (!decoder) {
+            if (error) {
+                *error = AFContentDecodingErrorWithDescription([NSString stringWithFormat:@"No decoder for content coding %@", contentCoding]);
+            }
+
+            return nil;
+        }
+
+        [mutableDecoders addObject:decoder];
+    }
+
+    if ([mutableDecoders count] <= 1) {
+        return [mutableDecoders firstObject];
+    }
+
+    AFContentDecoderChain *chain = [[AFContentDecoderChain alloc] init];
+    chain.decoders = mutableDecoders;
+
+    return chain;
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFContentDecoderRegistry *registry = [[[self class] allocWithZone:zone] init];
+    registry.dictionaries = self.dictionaries;
+    registry.mutableProvidersKeyedByContentCoding = [self.mutableProvidersKeyedByContentCoding mutableCopyWithZone:zone];
+
+    return registry;
+}
+
+@end
+
+#pragma mark -
+
+static uint8_t const AFJSONElementContainerIsArray = 1 << 0;
+static uint8_t const AFJSONElementContainerExpectsKey = 1 << 1;
+
+@interface AFJSONElementStream ()
+@property (readwrite, nonatomic, copy) NSString *keyPath;
+@property (readwrite, nonatomic, copy) NSArray <NSData *> *keyPathComponents;
+@property (readwrite, nonatomic, copy) void (^elementHandler)(id element, NSUInteger idx);
+@property (readwrite, nonatomic, assign) NSJSONReadingOptions readingOptions;
+@property (readwrite, nonatomic, assign) BOOL removesKeysWithNullValues;
+@property (readwrite, nonatomic, assign) AFJSONParsingBackend parsingBackend;
+@property (readwrite, nonatomic, strong) NSMutableData *containers;
+@property (readwrite, nonatomic, assign) NSUInteger onPathDepth;
+@property (readwrite, nonatomic, assign) BOOL valueIsOnPath;
+@property (readwrite, nonatomic, assign) BOOL inString;
+@property (readwrite, nonatomic, assign) BOOL escaped;
+@property (readwrite, nonatomic, assign) BOOL readingKey;
+@property (readwrite, nonatomic, strong) NSMutableData *keyData;
+@property (readwrite, nonatomic, assign) BOOL inElement;
+@property (readwrite, nonatomic, assign) BOOL inScalarElement;
+@property (readwrite, nonatomic, strong) NSMutableData *partialElementData;
+@property (readwrite, nonatomic, assign) BOOL foundArray;
+@property (readwrite, nonatomic, strong) NSMutableArray *elements;
+@property (readwrite, atomic, assign) NSUInteger numberOfElements;
+
+- (instancetype)initWithResponseSerializer:(AFJSONResponseSerializer *)responseSerializer
+                                   keyPath:(NSString *)keyPath
+                                     queue:(dispatch_queue_t)queue
+                            elementHandler:(void (^)(id element, NSUInteger idx))elementHandler;
+@end
+
+@implementation AFJSONElementStream
+
+- (instancetype)initWithResponseSerializer:(AFJSONResponseSerializer *)responseSerializer
+                                   keyPath:(NSString *)keyPath
+                                     queue:(dispatch_queue_t)queue
+                            elementHandler:(void (^)(id element, NSUInteger idx))elementHandler
+{
+    self = [super initWithResponseSerializer:responseSerializer queue:queue maximumNumberOfPendingBatches:2];
+    if (!self) {
+        return nil;
+    }
+
+    self.keyPath = keyPath;
+    NSMutableArray *mutableKeyPathComponents = [NSMutableArray array];
+    for (NSString *component in [keyPath length] > 0 ? [keyPath componentsSeparatedByString:@"."] : @[]) {
+        [mutableKeyPathComponents addObject:[component dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    self.keyPathComponents = mutableKeyPathComponents;
+
+    self.elementHandler = elementHandler;
+    self.readingOptions = responseSerializer.readingOptions;
+    self.removesKeysWithNullValues = responseSerializer.removesKeysWithNullValues;
+    self.parsingBackend = responseSerializer.parsingBackend;
+
+    self.containers = [NSMutableData data];
+    self.keyData = [NSMutableData data];
+    self.partialElementData = [NSMutableData data];
+    self.elements = [NSMutableArray array];
+
+    return self;
+}
+
+- (BOOL)keyMatchesComponentAtIndex:(NSUInteger)idx {
+    NSData *component = self.keyPathComponents[idx];
+    if (!memchr([self.keyData bytes], '\\', [self.keyData length])) {
+        return [self.keyData isEqualToData:component];
+    }
+
+    // Keys with escape sequences are compared once unescaped
+    NSMutableData *quotedKeyData = [NSMutableData dataWithBytes:"\"" length:1];
+    [quotedKeyData appendData:self.keyData];
+    [quotedKeyData appendBytes:"\"" length:1];
+    NSString *key = [NSJSONSerialization JSONObjectWithData:quotedKeyData options:NSJSONReadingAllowFragments error:nil];
+
+    return [key isEqualToString:[[NSString alloc] initWithData:component encoding:NSUTF8StringEncoding]];
+}
+
+- (BOOL)decodeElementWithBytes:(const uint8_t *)bytes
+                        length:(NSUInteger)length
+{
+    NSData *data = nil;
+    if ([self.partialElementData length] > 0) {
+        [self.partialElementData appendBytes:bytes length:length];
+        data = self.partialElementData;
+    } else {
+        data = [NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+    }
+
+    NSError *serializationError = nil;
+    id element = nil;
+    switch (self.parsingBackend) {
+        case AFJSONParsingBackendStructuralIndex:
+            element = [[[AFJSONParser alloc] init] JSONObjectWithData:data options:self.readingOptions | NSJSONReadingAllowFragments error:&serializationError];
+            break;
+        case AFJSONParsingBackendFoundation:
+        default:
+            element = [NSJSONSerialization JSONObjectWithData:data options:self.readingOptions | NSJSONReadingAllowFragments error:&serializationError];
+            break;
+    }
+    [self.partialElementData setLength:0];
+
+    if (!element) {
+        self.error = AFResponseStreamErrorWithDescription([NSString stringWithFormat:NSLocalizedStringFromTable(@"The element at index %lu of the response could not be decoded.", @"AFNetworking", nil), (unsigned long)self.numberOfElements], serializationError);
+        return NO;
+    }
+
+    if (self.removesKeysWithNullValues) {
+        element = AFJSONObjectByRemovingKeysWithNullValues(element, self.readingOptions);
+    }
+
+    [self.elements addObject:element];
+    self.numberOfElements++;
+
+    return YES;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+
+    // The elements are the values directly inside the array at the key path, whose container is one level deeper than the key path.
+    NSUInteger arrayDepth = [self.keyPathComponents count] + 1;
+    NSUInteger depth = [self.containers length];
+    NSUInteger onPathDepth = self.onPathDepth;
+    BOOL valueIsOnPath = self.valueIsOnPath;
+    BOOL inString = self.inString;
+    BOOL escaped = self.escaped;
+    BOOL readingKey = self.readingKey;
+    BOOL inElement = self.inElement;
+    BOOL inScalarElement = self.inScalarElement;
+    NSUInteger elementStart = 0;
+    BOOL decoded = YES;
+
+    for (NSUInteger idx = 0; idx < length && decoded; idx++) {
+        uint8_t c = bytes[idx];
+
+        if (inString) {
+            if (escaped) {
+                escaped = NO;
+            } else if (c == '\\') {
+                escaped = YES;
+            } else if (c == '"') {
+                inString = NO;
+                if (readingKey) {
+                    readingKey = NO;
+                    valueIsOnPath = [self keyMatchesComponentAtIndex:depth - 1];
+                } else if (inElement && depth == arrayDepth) {
+                    inElement = NO;
+                    decoded = [self decodeElementWithBytes:bytes + elementStart length:idx + 1 - elementStart];
+                }
+                continue;
+            }
+
+            if (readingKey) {
+                [self.keyData appendBytes:&c length:1];
+            }
+            continue;
+        }
+
+        if (inScalarElement) {
+            if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != ',' && c != ']') {
+                continue;
+            }
+
+            inScalarElement = NO;
+            inElement = NO;
+            decoded = [self decodeElementWithBytes:bytes + elementStart length:idx - elementStart];
+            if (!decoded) {
+                break;
+            }
+        }
+
+        uint8_t *containers = [self.containers mutableBytes];
+        switch (c) {
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                break;
+            case ':':
+                if (depth > 0) {
+                    containers[depth - 1] &= (uint8_t)~AFJSONElementContainerExpectsKey;
+                }
+                break;
+            case ',':
+                if (depth > 0 && !(containers[depth - 1] & AFJSONElementContainerIsArray)) {
+                    containers[depth - 1] |= AFJSONElementContainerExpectsKey;
+                }
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The response is not valid JSON.", @"AFNetworking", nil), nil);
+                    decoded = NO;
+                    break;
+                }
+
+                if (onPathDepth == depth) {
+                    onPathDepth--;
+                }
+                [self.containers setLength:--depth];
+                valueIsOnPath = NO;
+
+                if (inElement && depth == arrayDepth) {
+                    inElement = NO;
+                    decoded = [self decodeElementWithBytes:bytes + elementStart length:idx + 1 - elementStart];
+                }
+                break;
+            default: {
+                if (c == '"' && depth > 0 && (containers[depth - 1] & AFJSONElementContainerExpectsKey)) {
+                    inString = YES;
+                    readingKey = depth <= [self.keyPathComponents count] && onPathDepth == depth;
+                    [self.keyData setLength:0];
+                    break;
+                }
+
+                BOOL isOnPath = depth == 0 || valueIsOnPath;
+                valueIsOnPath = NO;
+
+                if (!inElement && depth == arrayDepth && onPathDepth == arrayDepth && (containers[depth - 1] & AFJSONElementContainerIsArray)) {
+                    inElement = YES;
+                    elementStart = idx;
+                }
+
+                if (c == '{' || c == '[') {
+                    uint8_t container = c == '[' ? AFJSONElementContainerIsArray : AFJSONElementContainerExpectsKey;
+                    [self.containers appendBytes:&container length:1];
+                    depth++;
+
+                    if (isOnPath && onPathDepth == depth - 1) {
+                        onPathDepth = depth;
+                        if (depth == arrayDepth && c == '[') {
+                            self.foundArray = YES;
+                        }
+                    }
+                } else if (c == '"') {
+                    inString = YES;
+                } else if (inElement && depth == arrayDepth) {
+                    inScalarElement = YES;
+                }
+                break;
+            }
+        }
+    }
+
+    if (decoded && inElement) {
+        [self.partialElementData appendBytes:bytes + elementStart length:length - elementStart];
+    }
+
+    self.onPathDepth = onPathDepth;
+    self.valueIsOnPath = valueIsOnPath;
+    self.inString = inString;
+    self.escaped = escaped;
+    self.readingKey = readingKey;
+    self.inElement = inElement;
+    self.inScalarElement = inScalarElement;
+
+    [self deliverElements];
+
+    return decoded;
+}
+
+- (void)deliverElements {
+    if ([self.elements count] == 0 || !self.elementHandler) {
+        return;
+    }
+
+    NSArray *elements = [self.elements copy];
+    NSUInteger firstIndex = self.numberOfElements - [elements count];
+    [self.elements removeAllObjects];
+
+    [self deliverBatch:^{
+        [elements enumerateObjectsUsingBlock:^(id element, NSUInteger idx, __unused BOOL *stop) {
+            self.elementHandler(element, firstIndex + idx);
+        }];
+    }];
+}
+
+- (void)finishDecoding {
+    if (self.inScalarElement && [self.partialElementData length] > 0) {
+        self.inScalarElement = NO;
+        self.inElement = NO;
+        [self decodeElementWithBytes:NULL length:0];
+    }
+
+    if (!self.error && !self.foundArray) {
+        self.error = AFResponseStreamErrorWithDescription([self.keyPath length] > 0 ? [NSString stringWithFormat:NSLocalizedStringFromTable(@"The response has no array at key path \"%@\".", @"AFNetworking", nil), self.keyPath] : NSLocalizedStringFromTable(@"The response is not a JSON array.", @"AFNetworking", nil), nil);
+    } else if (!self.error && [self.containers length] > 0) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The response ended before the JSON text was complete.", @"AFNetworking", nil), nil);
+    }
+
+    [self deliverElements];
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFJSONResponseSerializer
+
++ (instancetype)serializer {
+    return [self serializerWithReadingOptions:(NSJSONReadingOptions)0];
+}
+
++ (instancetype)serializerWithReadingOptions:(NSJSONReadingOptions)readingOptions {
+    AFJSONResponseSerializer *serializer = [[self alloc] init];
+    serializer.readingOptions = readingOptions;
+
+    return serializer;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.acceptableContentTypes = [NSSet setWithObjects:@"application/json", @"text/json", @"text/javascript", nil];
+
+    return self;
+}
+
+- (AFJSONElementStream *)elementStreamWithKeyPath:(NSString *)keyPath
+                                            queue:(dispatch_queue_t)queue
+                                   elementHandler:(void (^)(id element, NSUInteger idx))elementHandler
+{
+    NSParameterAssert(elementHandler);
+
+    return [[AFJSONElementStream alloc] initWithResponseSerializer:[self copy] keyPath:keyPath queue:queue elementHandler:elementHandler];
+}
+
+#pragma mark - AFURLResponseSerialization
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    if (![self validateResponse:(NSHTTPURLResponse *)response data:data error:error]) {
+        if (!error || AFErrorOrUnderlyingErrorHasCodeInDomain(*error, NSURLErrorCannotDecodeContentData, AFURLResponseSerializationErrorDomain)) {
+            return nil;
+        }
+    }
+
+    // Workaround for behavior of Rails to return a single space for `head :ok` (a workaround for a bug in Safari), which is not interpreted as valid input by NSJSONSerialization.
+    // See https://github.com/rails/rails/issues/1742
+    BOOL isSpace = [data isEqualToData:[NSData dataWithBytes:" " length:1]];
+    
+    if (data.length == 0 || isSpace) {
+        return nil;
+    }
+    
+    NSError *serializationError = nil;
+    
+    id responseObject = nil;
+    if (self.decodesLazily) {
+        responseObject = [[[AFJSONParser alloc] init] documentWithData:data options:self.readingOptions error:&serializationError];
+    } else {
+        switch (self.parsingBackend) {
+            case AFJSONParsingBackendStructuralIndex:
+                responseObject = [[[AFJSONParser alloc] init] JSONObjectWithData:data options:self.readingOptions error:&serializationError];
+                break;
+            case AFJSONParsingBackendFoundation:
+            default:
+                responseObject = [NSJSONSerialization JSONObjectWithData:data options:self.readingOptions error:&serializationError];
+                break;
+        }
+    }
+
+    if (!responseObject)
+    {
+        if (error) {
+            *error = AFErrorWithUnderlyingError(serializationError, *error);
+        }
+        return nil;
+    }
+    
+    if (self.removesKeysWithNullValues) {
+        return self.decodesLazily ? [(AFJSONDocument *)responseObject documentByRemovingKeysWithNullValues] : AFJSONObjectByRemovingKeysWithNullValues(responseObject, self.readingOptions);
+    }
+
+    return responseObject;
+}
+
+#pragma mark - NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    self = [super initWithCoder:decoder];
+    if (!self) {
+        return nil;
+    }
+
+    self.readingOptions = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(readingOptions))] unsignedIntegerValue];
+    self.removesKeysWithNullValues = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(removesKeysWithNullValues))] boolValue];
+    self.parsingBackend = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(parsingBackend))] unsignedIntegerValue];
+    self.decodesLazily = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(decodesLazily))] boolValue];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [super encodeWithCoder:coder];
+
+    [coder encodeObject:@(self.readingOptions) forKey:NSStringFromSelector(@selector(readingOptions))];
+    [coder encodeObject:@(self.removesKeysWithNullValues) forKey:NSStringFromSelector(@selector(removesKeysWithNullValues))];
+    [coder encodeObject:@(self.parsingBackend) forKey:NSStringFromSelector(@selector(parsingBackend))];
+    [coder encodeObject:@(self.decodesLazily) forKey:NSStringFromSelector(@selector(decodesLazily))];
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFJSONResponseSerializer *serializer = [super copyWithZone:zone];
+    serializer.readingOptions = self.readingOptions;
+    serializer.removesKeysWithNullValues = self.removesKeysWithNullValues;
+    serializer.parsingBackend = self.parsingBackend;
+    serializer.decodesLazily = self.decodesLazily;
+
+    return serializer;
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFJSONModelResponseSerializer
+
++ (instancetype)serializerWithSchema:(AFJSONModelSchema *)schema {
+    AFJSONModelResponseSerializer *serializer = [self serializer];
+    serializer.schema = schema;
+
+    return serializer;
+}
+
+#pragma mark - AFURLResponseSerialization
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    if (!self.schema) {
+        return [super responseObjectForResponse:response data:data error:error];
+    }
+
+    if (![self validateResponse:(NSHTTPURLResponse *)response data:data error:error]) {
+        if (!error || AFErrorOrUnderlyingErrorHasCodeInDomain(*error, NSURLErrorCannotDecodeContentData, AFURLResponseSerializationErrorDomain)) {
+            return nil;
+        }
+    }
+
+    BOOL isSpace = [data isEqualToData:[NSData dataWithBytes:" " length:1]];
+    if (data.length == 0 || isSpace) {
+        return nil;
+    }
+
+    NSError *serializationError = nil;
+    id responseObject = [[[AFJSONParser alloc] init] modelWithData:data schema:self.schema error:&serializationError];
+    if (!responseObject) {
+        if (error) {
+            *error = AFErrorWithUnderlyingError(serializationError, *error);
+        }
+        return nil;
+    }
+
+    return responseObject;
+}
+
+#pragma mark - NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    self = [super initWithCoder:decoder];
+    if (!self) {
+        return nil;
+    }
+
+    self.schema = [decoder decodeObjectOfClass:[AFJSONModelSchema class] forKey:NSStringFromSelector(@selector(schema))];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [super encodeWithCoder:coder];
+
+    [coder encodeObject:self.schema forKey:NSStringFromSelector(@selector(schema))];
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFJSONModelResponseSerializer *serializer = [super copyWithZone:zone];
+    serializer.schema = self.schema;
+
+    return serializer;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFMessagePackStream ()
+@property (readwrite, nonatomic, copy) void (^objectHandler)(NSArray *objects);
+@property (readwrite, nonatomic, strong) AFMessagePackStreamDecoder *decoder;
+@property (readwrite, atomic, assign) NSUInteger numberOfObjects;
+
+- (instancetype)initWithResponseSerializer:(AFMessagePackResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                             objectHandler:(void (^)(NSArray *objects))objectHandler;
+@end
+
+@implementation AFMessagePackStream
+
+- (instancetype)initWithResponseSerializer:(AFMessagePackResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                             objectHandler:(void (^)(NSArray *objects))objectHandler
+{
+    self = [super initWithResponseSerializer:responseSerializer queue:queue maximumNumberOfPendingBatches:2];
+    if (!self) {
+        return nil;
+    }
+
+    self.objectHandler = objectHandler;
+    self.decoder = [[AFMessagePackStreamDecoder alloc] initWithReadingOptions:responseSerializer.readingOptions];
+
+    return self;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    NSError *decodingError = nil;
+    NSArray *objects = [self.decoder objectsByDecodingData:data error:&decodingError];
+    if (!objects) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The MessagePack response could not be decoded.", @"AFNetworking", nil), decodingError);
+        return NO;
+    }
+
+    if ([objects count] == 0) {
+        return YES;
+    }
+
+    self.numberOfObjects += [objects count];
+    [self deliverBatch:^{
+        self.objectHandler(objects);
+    }];
+
+    return YES;
+}
+
+- (void)finishDecoding {
+    if (self.decoder.hasPartialObject) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The MessagePack response ended with a partial object.", @"AFNetworking", nil), nil);
+    }
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFMessagePackResponseSerializer
+
++ (instancetype)serializer {
+    return [self serializerWithReadingOptions:(AFMessagePackReadingOptions)0];
+}
+
++ (instancetype)serializerWithReadingOptions:(AFMessagePackReadingOptions)readingOptions {
+    AFMessagePackResponseSerializer *serializer = [[self alloc] init];
+    serializer.readingOptions = readingOptions;
+
+    return serializer;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.acceptableContentTypes = [NSSet setWithObjects:@"application/msgpack", @"application/x-msgpack", @"application/vnd.msgpack", nil];
+
+    return self;
+}
+
+- (AFMessagePackStream *)streamWithQueue:(dispatch_queue_t)queue
+                           objectHandler:(void (^)(NSArray *objects))objectHandler
+{
+    NSParameterAssert(objectHandler);
+
+    return [[AFMessagePackStream alloc] initWithResponseSerializer:[self copy] queue:queue objectHandler:objectHandler];
+}
+
+#pragma mark - AFURLResponseSerialization
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    if (![self validateResponse:(NSHTTPURLResponse *)response data:data error:error]) {
+        if (!error || AFErrorOrUnderlyingErrorHasCodeInDomain(*error, NSURLErrorCannotDecodeContentData, AFURLResponseSerializationErrorDomain)) {
+            return nil;
+        }
+    }
+
+    if (data.length == 0) {
+        return nil;
+    }
+
+    NSError *serializationError = nil;
+    id responseObject = [AFMessagePackSerialization messagePackObjectWithData:data options:self.readingOptions error:&serializationError];
+
+    if (error) {
+        *error = AFErrorWithUnderlyingError(serializationError, *error);
+    }
+
+    return responseObject;
+}
+
+#pragma mark - NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    self = [super initWithCoder:decoder];
+    if (!self) {
+        return nil;
+    }
+
+    self.readingOptions = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(readingOptions))] unsignedIntegerValue];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [super encodeWithCoder:coder];
+
+    [coder encodeObject:@(self.readingOptions) forKey:NSStringFromSelector(@selector(readingOptions))];
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFMessagePackResponseSerializer *serializer = [super copyWithZone:zone];
+    serializer.readingOptions = self.readingOptions;
+
+    return serializer;
+}
+
+@end
+
+#pragma mark -
+
+@interface AFJSONLinesStream ()
+@property (readwrite, nonatomic, copy) void (^batchHandler)(NSArray *records);
+@property (readwrite, nonatomic, assign) NSJSONReadingOptions readingOptions;
+@property (readwrite, nonatomic, assign) NSUInteger batchSize;
+@property (readwrite, nonatomic, assign) NSUInteger maximumRecordLength;
+@property (readwrite, nonatomic, strong) NSMutableData *partialRecordData;
+@property (readwrite, nonatomic, strong) NSMutableArray *records;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfLines;
+@property (readwrite, atomic, assign) NSUInteger numberOfRecords;
+@property (readwrite, atomic, assign) NSUInteger numberOfBatches;
+
+- (instancetype)initWithResponseSerializer:(AFJSONLinesResponseSerializer *)responseSerializer
+                              batchHandler:(void (^)(NSArray *records))batchHandler;
+@end
+
+@implementation AFJSONLinesStream
+
+- (instancetype)initWithResponseSerializer:(AFJSONLinesResponseSerializer *)responseSerializer
+                              batchHandler:(void (^)(NSArray *records))batchHandler
+{
+    self = [super initWithResponseSerializer:responseSerializer queue:responseSerializer.batchQueue maximumNumberOfPendingBatches:responseSerializer.maximumNumberOfPendingBatches];
+    if (!self) {
+        return nil;
+    }
+
+    self.batchHandler = batchHandler;
+    self.readingOptions = responseSerializer.readingOptions;
+    self.batchSize = MAX(responseSerializer.batchSize, (NSUInteger)1);
+    self.maximumRecordLength = responseSerializer.maximumRecordLength;
+    self.partialRecordData = [NSMutableData data];
+    self.records = [NSMutableArray array];
+
+    return self;
+}
+
+- (BOOL)decodeRecordWithBytes:(const uint8_t *)bytes
+                       length:(NSUInteger)length
+{
+    self.numberOfLines++;
+
+    while (length > 0 && (bytes[0] == ' ' || bytes[0] == '\t' || bytes[0] == '\r')) {
+        bytes++;
+        length--;
+    }
+
+    while (length > 0 && (bytes[length - 1] == ' ' || bytes[length - 1] == '\t' || bytes[length - 1] == '\r')) {
+        length--;
+    }
+
+    if (length == 0) {
+        return YES;
+    }
+
+    NSError *serializationError = nil;
+    NSData *data = [NSData dataWithBytesNoCopy:(void *)bytes length:length freeWhenDone:NO];
+    id record = [NSJSONSerialization JSONObjectWithData:data options:self.readingOptions | NSJSONReadingAllowFragments error:&serializationError];
+    if (!record) {
+        self.error = AFResponseStreamErrorWithDescription([NSString stringWithFormat:NSLocalizedStringFromTable(@"The record on line %lu of the response could not be decoded.", @"AFNetworking", nil), (unsigned long)self.numberOfLines], serializationError);
+        return NO;
+    }
+
+    [self.records addObject:record];
+    self.numberOfRecords++;
+
+    if (self.batchHandler && [self.records count] >= self.batchSize) {
+        [self deliverRecords];
+    }
+
+    return YES;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSUInteger maximumRecordLength = self.maximumRecordLength;
+
+    NSUInteger offset = 0;
+    while (offset < length) {
+        const uint8_t *newline = memchr(bytes + offset, '\n', length - offset);
+        NSUInteger end = newline ? (NSUInteger)(newline - bytes) : length;
+
+        if ([self.partialRecordData length] + (end - offset) > maximumRecordLength) {
+            self.error = AFResponseStreamErrorWithDescription([NSString stringWithFormat:NSLocalizedStringFromTable(@"The record on line %lu of the response is longer than %lu bytes.", @"AFNetworking", nil), (unsigned long)self.numberOfLines + 1, (unsigned long)maximumRecordLength], nil);
+            return NO;
+        }
+
+        if (!newline) {
+            [self.partialRecordData appendBytes:bytes + offset length:end - offset];
+            break;
+        }
+
+        if ([self.partialRecordData length] > 0) {
+            [self.partialRecordData appendBytes:bytes + offset length:end - offset];
+            BOOL decoded = [self decodeRecordWithBytes:[self.partialRecordData bytes] length:[self.partialRecordData length]];
+            [self.partialRecordData setLength:0];
+            if (!decoded) {
+                return NO;
+            }
+        } else if (![self decodeRecordWithBytes:bytes + offset length:end - offset]) {
+            return NO;
+        }
+
+        offset = end + 1;
+    }
+
+    return YES;
+}
+
+- (void)deliverRecords {
+    NSArray *batch = [self.records copy];
+    [self.records removeAllObjects];
+
+    [self deliverBatch:^{
+        self.batchHandler(batch);
+        self.numberOfBatches++;
+    }];
+}
+
+- (void)finishDecoding {
+    // The last record of a response cut short is incomplete
+    if ([self.partialRecordData length] > 0 && !self.dataTaskError) {
+        [self decodeRecordWithBytes:[self.partialRecordData bytes] length:[self.partialRecordData length]];
+    }
+    [self.partialRecordData setLength:0];
+
+    if (!self.error && self.batchHandler && [self.records count] > 0) {
+        [self deliverRecords];
+    }
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFJSONLinesResponseSerializer
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.acceptableContentTypes = [NSSet setWithObjects:@"application/x-ndjson", @"application/jsonl", @"application/json-lines", @"application/x-jsonlines", nil];
+    self.batchSize = 256;
+    self.maximumNumberOfPendingBatches = 2;
+    self.maximumRecordLength = 16 * 1024 * 1024;
+
+    return self;
+}
+
+- (AFJSONLinesStream *)streamWithBatchHandler:(void (^)(NSArray *records))batchHandler {
+    NSParameterAssert(batchHandler);
+
+    return [[AFJSONLinesStream alloc] initWithResponseSerializer:[self copy] batchHandler:batchHandler];
+}
+
+#pragma mark - AFURLResponseSerialization
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    if (![self validateResponse:(NSHTTPURLResponse *)response data:data error:error]) {
+        if (!error || AFErrorOrUnderlyingErrorHasCodeInDomain(*error, NSURLErrorCannotDecodeContentData, AFURLResponseSerializationErrorDomain)) {
+            return nil;
+        }
+    }
+
+    if (data.length == 0) {
+        return nil;
+    }
+
+    // Without a batch handler, the stream keeps every record of the response.
+    AFJSONLinesStream *stream = [[AFJSONLinesStream alloc] initWithResponseSerializer:self batchHandler:nil];
+    if ([stream decodeData:data]) {
+        [stream finishWithCompletionHandler:nil];
+    }
+
+    if (stream.error) {
+        if (error) {
+            *error = AFErrorWithUnderlyingError(stream.error, *error);
+        }
+        return nil;
+    }
+
+    return [stream.records copy];
+}
+
+#pragma mark - NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    self = [super initWithCoder:decoder];
+    if (!self) {
+        return nil;
+    }
+
+    self.readingOptions = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(readingOptions))] unsignedIntegerValue];
+    self.batchSize = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(batchSize))] unsignedIntegerValue];
+    self.maximumNumberOfPendingBatches = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumNumberOfPendingBatches))] unsignedIntegerValue];
+    self.maximumRecordLength = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumRecordLength))] unsignedIntegerValue];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [super encodeWithCoder:coder];
+
+    [coder encodeObject:@(self.readingOptions) forKey:NSStringFromSelector(@selector(readingOptions))];
+    [coder encodeObject:@(self.batchSize) forKey:NSStringFromSelector(@selector(batchSize))];
+    [coder encodeObject:@(self.maximumNumberOfPendingBatches) forKey:NSStringFromSelector(@selector(maximumNumberOfPendingBatches))];
+    [coder encodeObject:@(self.maximumRecordLength) forKey:NSStringFromSelector(@selector(maximumRecordLength))];
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFJSONLinesResponseSerializer *serializer = [super copyWithZone:zone];
+    serializer.readingOptions = self.readingOptions;
+    serializer.batchSize = self.batchSize;
+    serializer.maximumNumberOfPendingBatches = self.maximumNumberOfPendingBatches;
+    serializer.maximumRecordLength = self.maximumRecordLength;
+    serializer.batchQueue = self.batchQueue;
+
+    return serializer;
+}
+
+@end
+
+#pragma mark -
+
+static NSString * AFServerSentEventStringWithBytes(const uint8_t *bytes, NSUInteger length) {
+    if (length == 0) {
+        return @"";
+    }
+
+    return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] ?: [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+}
+
+@interface AFServerSentEvent ()
+@property (readwrite, nonatomic, copy) NSString *type;
+@property (readwrite, nonatomic, copy) NSString *data;
+@property (readwrite, nonatomic, copy) NSString *lastEventID;
+
+- (instancetype)initWithType:(NSString *)type
+                        data:(NSString *)data
+                 lastEventID:(NSString *)lastEventID;
+@end
+
+@implementation AFServerSentEvent
+
+- (instancetype)initWithType:(NSString *)type
+                        data:(NSString *)data
+                 lastEventID:(NSString *)lastEventID
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.type = type;
+    self.data = data;
+    self.lastEventID = lastEventID;
+
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, type: %@, lastEventID: %@, data: %@>", NSStringFromClass([self class]), self, self.type, self.lastEventID, self.data];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFServerSentEventStream ()
+@property (readwrite, nonatomic, copy) void (^eventHandler)(NSArray <AFServerSentEvent *> *events);
+@property (readwrite, nonatomic, assign) NSUInteger maximumLineLength;
+@property (readwrite, nonatomic, strong) NSMutableData *partialLineData;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfLines;
+@property (readwrite, nonatomic, assign) BOOL skipsLineFeed;
+@property (readwrite, nonatomic, assign) BOOL receivedData;
+@property (readwrite, nonatomic, strong) NSMutableData *dataBuffer;
+@property (readwrite, nonatomic, strong) NSMutableData *eventTypeData;
+@property (readwrite, nonatomic, strong) NSData *lastEventTypeData;
+@property (readwrite, nonatomic, copy) NSString *lastEventType;
+@property (readwrite, nonatomic, strong) NSMutableData *eventIDData;
+@property (readwrite, nonatomic, assign) BOOL eventIDDataChanged;
+@property (readwrite, nonatomic, strong) NSMutableData *lastEventIDData;
+@property (readwrite, nonatomic, strong) NSMutableArray <AFServerSentEvent *> *events;
+@property (readwrite, atomic, assign) NSTimeInterval reconnectionTime;
+@property (readwrite, atomic, assign) NSUInteger numberOfEvents;
+
+- (instancetype)initWithResponseSerializer:(AFServerSentEventResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                              eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler;
+@end
+
+@implementation AFServerSentEventStream
+
+- (instancetype)initWithResponseSerializer:(AFServerSentEventResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                              eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler
+{
+    self = [super initWithResponseSerializer:responseSerializer queue:queue maximumNumberOfPendingBatches:2];
+    if (!self) {
+        return nil;
+    }
+
+    self.eventHandler = eventHandler;
+    self.maximumLineLength = responseSerializer.maximumLineLength;
+    self.partialLineData = [NSMutableData data];
+    self.dataBuffer = [NSMutableData data];
+    self.eventTypeData = [NSMutableData data];
+    self.eventIDData = [NSMutableData data];
+    self.lastEventIDData = [NSMutableData data];
+    self.events = [NSMutableArray array];
+    self.reconnectionTime = -1;
+
+    return self;
+}
+
+- (void)dispatchEvent {
+    // A string is only created for the last event ID when an `id` field changes it
+    if (self.eventIDDataChanged) {
+        self.eventIDDataChanged = NO;
+        if (![self.eventIDData isEqualToData:self.lastEventIDData]) {
+            [self.lastEventIDData setData:self.eventIDData];
+            self.lastEventID = AFServerSentEventStringWithBytes([self.eventIDData bytes], [self.eventIDData length]);
+        }
+    }
+    NSString *lastEventID = self.lastEventID;
+
+    if ([self.dataBuffer length] == 0) {
+        [self.eventTypeData setLength:0];
+        return;
+    }
+
+    NSString *type = @"message";
+    if ([self.eventTypeData length] > 0) {
+        if (![self.eventTypeData isEqualToData:self.lastEventTypeData]) {
+            self.lastEventTypeData = [self.eventTypeData copy];
+            self.lastEventType = AFServerSentEventStringWithBytes([self.eventTypeData bytes], [self.eventTypeData length]);
+        }
+        type = self.lastEventType;
+    }
+
+    // The data buffer always ends with the line feed appended after the last `data` field
+    NSString *data = AFServerSentEventStringWithBytes([self.dataBuffer bytes], [self.dataBuffer length] - 1);
+    [self.events addObject:[[AFServerSentEvent alloc] initWithType:type data:data lastEventID:lastEventID]];
+    self.numberOfEvents++;
+
+    [self.dataBuffer setLength:0];
+    [self.eventTypeData setLength:0];
+}
+
+- (void)processLineWithBytes:(const uint8_t *)bytes
+                      length:(NSUInteger)length
+{
+    if (length == 0) {
+        [self dispatchEvent];
+        return;
+    }
+
+    if (bytes[0] == ':') {
+        return;
+    }
+
+    const uint8_t *colon = memchr(bytes, ':', length);
+    NSUInteger fieldLength = colon ? (NSUInteger)(colon - bytes) : length;
+    const uint8_t *value = colon ? colon + 1 : bytes + length;
+    NSUInteger valueLength = length - (NSUInteger)(value - bytes);
+    if (valueLength > 0 && value[0] == ' ') {
+        value++;
+        valueLength--;
+    }
+
+    if (fieldLength == 4 && memcmp(bytes, "data", 4) == 0) {
+        [self.dataBuffer appendBytes:value length:valueLength];
+        [self.dataBuffer appendBytes:"\n" length:1];
+    } else if (fieldLength == 5 && memcmp(bytes, "event", 5) == 0) {
+        [self.eventTypeData setLength:0];
+        [self.eventTypeData appendBytes:value length:valueLength];
+    } else if (fieldLength == 2 && memcmp(bytes, "id", 2) == 0) {
+        if (!memchr(value, '\0', valueLength)) {
+            [self.eventIDData setLength:0];
+            [self.eventIDData appendBytes:value length:valueLength];
+            self.eventIDDataChanged = YES;
+        }
+    } else if (fieldLength == 5 && memcmp(bytes, "retry", 5) == 0) {
+        unsigned long long milliseconds = 0;
+        for (NSUInteger idx = 0; idx < valueLength; idx++) {
+            if (value[idx] < '0' || value[idx] > '9') {
+                return;
+            }
+            milliseconds = milliseconds * 10 + (value[idx] - '0');
+        }
+
+        if (valueLength > 0) {
+            self.reconnectionTime = milliseconds / 1000.0;
+        }
+    }
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = [data length];
+    NSUInteger offset = 0;
+
+    if (!self.receivedData && length > 0) {
+        self.receivedData = YES;
+        [self.lastEventIDData setData:[self.lastEventID dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data]];
+        if (length >= 3 && memcmp(bytes, "\xEF\xBB\xBF", 3) == 0) {
+            offset = 3;
+        }
+    }
+
+    // A carriage return ending the previous data may be followed by a line feed ending the same line
+    if (self.skipsLineFeed && offset < length) {
+        self.skipsLineFeed = NO;
+        if (bytes[offset] == '\n') {
+            offset++;
+        }
+    }
+
+    NSUInteger maximumLineLength = self.maximumLineLength;
+    while (offset < length) {
+        NSUInteger end = offset;
+        while (end < length && bytes[end] != '\n' && bytes[end] != '\r') {
+            end++;
+        }
+
+        if ([self.partialLineData length] + (end - offset) > maximumLineLength) {
+            self.error = AFResponseStreamErrorWithDescription([NSString stringWithFormat:NSLocalizedStringFromTable(@"Line %lu of the response is longer than %lu bytes.", @"AFNetworking", nil), (unsigned long)self.numberOfLines + 1, (unsigned long)maximumLineLength], nil);
+            [self deliverEvents];
+            return NO;
+        }
+
+        if (end == length) {
+            [self.partialLineData appendBytes:bytes + offset length:end - offset];
+            break;
+        }
+
+        self.numberOfLines++;
+
+        if ([self.partialLineData length] > 0) {
+            [self.partialLineData appendBytes:bytes + offset length:end - offset];
+            [self processLineWithBytes:[self.partialLineData bytes] length:[self.partialLineData length]];
+            [self.partialLineData setLength:0];
+        } else {
+            [self processLineWithBytes:bytes + offset length:end - offset];
+        }
+
+        if (bytes[end] == '\r') {
+            if (end + 1 < length) {
+                if (bytes[end + 1] == '\n') {
+                    end++;
+                }
+            } else {
+                self.skipsLineFeed = YES;
+            }
+        }
+
+        offset = end + 1;
+    }
+
+    [self deliverEvents];
+
+    return YES;
+}
+
+- (void)deliverEvents {
+    if ([self.events count] == 0 || !self.eventHandler) {
+        return;
+    }
+
+    NSArray *events = [self.events copy];
+    [self.events removeAllObjects];
+
+    [self deliverBatch:^{
+        self.eventHandler(events);
+    }];
+}
+
+- (void)finishDecoding {
+    [self.partialLineData setLength:0];
+    [self.dataBuffer setLength:0];
+    [self.eventTypeData setLength:0];
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFServerSentEventResponseSerializer
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.acceptableContentTypes = [NSSet setWithObject:@"text/event-stream"];
+    self.maximumLineLength = 16 * 1024 * 1024;
+
+    return self;
+}
+
+- (AFServerSentEventStream *)streamWithQueue:(dispatch_queue_t)queue
+                                eventHandler:(void (^)(NSArray <AFServerSentEvent *> *events))eventHandler
+{
+    NSParameterAssert(eventHandler);
+
+    return [[AFServerSentEventStream alloc] initWithResponseSerializer:[self copy] queue:queue eventHandler:eventHandler];
+}
+
+#pragma mark - AFURLResponseSerialization
+
+- (id)responseObjectForResponse:(NSURLResponse *)response
+                           data:(NSData *)data
+                          error:(NSError *__autoreleasing *)error
+{
+    if (![self validateResponse:(NSHTTPURLResponse *)response data:data error:error]) {
+        if (!error || AFErrorOrUnderlyingErrorHasCodeInDomain(*error, NSURLErrorCannotDecodeContentData, AFURLResponseSerializationErrorDomain)) {
+            return nil;
+        }
+    }
+
+    if (data.length == 0) {
+        return nil;
+    }
+
+    // Without an event handler, the stream keeps every event of the response.
+    AFServerSentEventStream *stream = [[AFServerSentEventStream alloc] initWithResponseSerializer:self queue:nil eventHandler:nil];
+    if ([stream decodeData:data]) {
+        [stream finishWithCompletionHandler:nil];
+    }
+
+    if (stream.error) {
+        if (error) {
+            *error = AFErrorWithUnderlyingError(stream.error, *error);
+        }
+        return nil;
+    }
+
+    return [stream.events copy];
+}
+
+#pragma mark - NSSecureCoding
+
+- (instancetype)initWithCoder:(NSCoder *)decoder {
+    self = [super initWithCoder:decoder];
+    if (!self) {
+        return nil;
+    }
+
+    self.maximumLineLength = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumLineLength))] unsignedIntegerValue];
+
+    return self;
+}
+
+- (void)encodeWithCoder:(NSCoder *)coder {
+    [super encodeWithCoder:coder];
+
+    [coder encodeObject:@(self.maximumLineLength) forKey:NSStringFromSelector(@selector(maximumLineLength))];
+}
+
+#pragma mark - NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone {
+    AFServerSentEventResponseSerializer *serializer = [super copyWithZone:zone];
+    serializer.maximumLineLength = self.maximumLineLength;
+
+    return serializer;
+}
+
+@end
+
+#pragma mark -
+
+static NSUInteger const AFMultipartMaximumHeaderLength = 64 * 1024;
+
+static NSString * AFMultipartBoundaryFromResponse(NSURLResponse *response) {
+    if (![response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return nil;
+    }
+
+    NSString *contentType = AFMultipartHeaderFieldValue([(NSHTTPURLResponse *)response allHeaderFields], @"Content-Type");
+    NSCharacterSet *whitespaceCharacterSet = [NSCharacterSet whitespaceCharacterSet];
+    for (NSString *parameter in [contentType componentsSeparatedByString:@";"]) {
+        NSRange separatorRange = [parameter rangeOfString:@"="];
+        if (separatorRange.location == NSNotFound) {
+            continue;
+        }
+
+        NSString *name = [[parameter substringToIndex:separatorRange.location] stringByTrimmingCharactersInSet:whitespaceCharacterSet];
+        if ([name caseInsensitiveCompare:@"boundary"] != NSOrderedSame) {
+            continue;
+        }
+
+        NSString *boundary = [[parameter substringFromIndex:NSMaxRange(separatorRange)] stringByTrimmingCharactersInSet:whitespaceCharacterSet];
+        if ([boundary length] >= 2 && [boundary hasPrefix:@"\""] && [boundary hasSuffix:@"\""]) {
+            boundary = [boundary substringWithRange:NSMakeRange(1, [boundary length] - 2)];
+        }
+
+        return [boundary length] > 0 ? boundary : nil;
+    }
+
+    return nil;
+}
+
+// Parses header lines, ended by CRLF or LF, up to an empty line or the end of the bytes, and sets `parsedLength` to the number of bytes parsed. Lines starting with whitespace continue the previous line.
+static NSArray <NSString *> * AFMultipartHeaderLinesWithBytes(const uint8_t *bytes, NSUInteger length, NSUInteger *parsedLength) {
+    NSMutableArray *lines = [NSMutableArray array];
+    NSUInteger offset = 0;
+    while (offset < length) {
+        const uint8_t *lineFeed = memchr(bytes + offset, '\n', length - offset);
+        NSUInteger end = lineFeed ? (NSUInteger)(lineFeed - bytes) : length;
+        NSUInteger next = lineFeed ? end + 1 : length;
+        if (end > offset && bytes[end - 1] == '\r') {
+            end--;
+        }
+
+        if (end == offset) {
+            offset = next;
+            break;
+        }
+
+        NSString *line = [[NSString alloc] initWithBytes:bytes + offset length:end - offset encoding:NSISOLatin1StringEncoding];
+        if ((bytes[offset] == ' ' || bytes[offset] == '\t') && [lines count] > 0) {
+            line = [[lines lastObject] stringByAppendingFormat:@" %@", [line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]];
+            [lines removeLastObject];
+        }
+        [lines addObject:line];
+
+        offset = next;
+    }
+
+    if (parsedLength) {
+        *parsedLength = offset;
+    }
+
+    return lines;
+}
+
+static NSDictionary <NSString *, NSString *> * AFMultipartHeaderFieldsFromLines(NSArray <NSString *> *lines) {
+    NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionaryWithCapacity:[lines count]];
+    for (NSString *line in lines) {
+        NSRange separatorRange = [line rangeOfString:@":"];
+        if (separatorRange.location == NSNotFound) {
+            continue;
+        }
+
+        NSString *field = [[line substringToIndex:separatorRange.location] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        NSString *value = [[line substringFromIndex:NSMaxRange(separatorRange)] stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        NSString *previousValue = AFMultipartHeaderFieldValue(mutableHeaderFields, field);
+        if (previousValue) {
+            [mutableHeaderFields removeObjectForKey:field];
+            value = [NSString stringWithFormat:@"%@, %@", previousValue, value];
+        }
+        mutableHeaderFields[field] = value;
+    }
+
+    return mutableHeaderFields;
+}
+
+static NSRange AFMultipartByteRangeFromHeaderFields(NSDictionary *headerFields) {
+    NSString *contentRange = AFMultipartHeaderFieldValue(headerFields, @"Content-Range");
+    if (!contentRange) {
+        return NSMakeRange(NSNotFound, 0);
+    }
+
+    NSScanner *scanner = [NSScanner scannerWithString:contentRange];
+    long long firstBytePosition = 0;
+    long long lastBytePosition = 0;
+    if ([scanner scanString:@"bytes" intoString:NULL] && [scanner scanLongLong:&firstBytePosition] && [scanner scanString:@"-" intoString:NULL] && [scanner scanLongLong:&lastBytePosition] && firstBytePosition >= 0 && lastBytePosition >= firstBytePosition) {
+        return NSMakeRange((NSUInteger)firstBytePosition, (NSUInteger)(lastBytePosition - firstBytePosition + 1));
+    }
+
+    return NSMakeRange(NSNotFound, 0);
+}
+
+@interface AFMultipartResponsePart ()
+@property (readwrite, nonatomic, copy) NSDictionary *headerFields;
+@property (readwrite, nonatomic, strong) NSHTTPURLResponse *response;
+@property (readwrite, nonatomic, strong) NSData *data;
+@property (readwrite, nonatomic, strong) id responseObject;
+@property (readwrite, nonatomic, strong) NSError *error;
+@property (readwrite, nonatomic, assign) NSRange byteRange;
+@end
+
+@implementation AFMultipartResponsePart
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, statusCode: %ld, headerFields: %@, length: %lu>", NSStringFromClass([self class]), self, (long)[self.response statusCode], self.headerFields, (unsigned long)[self.data length]];
+}
+
+@end
+
+#pragma mark -
+
+typedef NS_ENUM(NSUInteger, AFMultipartResponseStreamState) {
+    AFMultipartResponseStreamPreambleState,
+    AFMultipartResponseStreamDelimiterState,
+    AFMultipartResponseStreamHeaderState,
+    AFMultipartResponseStreamBodyState,
+    AFMultipartResponseStreamEpilogueState,
+};
+
+@interface AFMultipartResponseStream ()
+@property (readwrite, nonatomic, copy) void (^partHandler)(NSArray <AFMultipartResponsePart *> *parts);
+@property (readwrite, nonatomic, strong) NSURLResponse *response;
+@property (readwrite, nonatomic, strong) NSData *delimiterData;
+@property (readwrite, nonatomic, strong) NSMutableData *buffer;
+@property (readwrite, nonatomic, assign) AFMultipartResponseStreamState state;
+@property (readwrite, nonatomic, copy) NSDictionary *partHeaderFields;
+@property (readwrite, nonatomic, strong) NSMutableData *partData;
+@property (readwrite, nonatomic, strong) NSMutableArray <AFMultipartResponsePart *> *parts;
+@property (readwrite, atomic, assign) NSUInteger numberOfParts;
+
+- (instancetype)initWithResponseSerializer:(AFMultipartResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                               partHandler:(void (^)(NSArray <AFMultipartResponsePart *> *parts))partHandler;
+@end
+
+@implementation AFMultipartResponseStream
+
+- (instancetype)initWithResponseSerializer:(AFMultipartResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                               partHandler:(void (^)(NSArray <AFMultipartResponsePart *> *parts))partHandler
+{
+    self = [super initWithResponseSerializer:responseSerializer queue:queue maximumNumberOfPendingBatches:2];
+    if (!self) {
+        return nil;
+    }
+
+    self.partHandler = partHandler;
+    self.buffer = [NSMutableData data];
+    self.partData = [NSMutableData data];
+    self.parts = [NSMutableArray array];
+
+    return self;
+}
+
+- (void)dataTask:(NSURLSessionDataTask *)dataTask
+  didReceiveData:(NSData *)data
+{
+    if (!self.response) {
+        self.response = dataTask.response;
+    }
+
+    [super dataTask:dataTask didReceiveData:data];
+}
+
+- (void)decodePartWithHeaderFields:(NSDictionary *)headerFields
+                              data:(NSData *)data
+{
+    AFMultipartResponseSerializer *responseSerializer = (AFMultipartResponseSerializer *)self.responseSerializer;
+
+    NSInteger statusCode = [self.response isKindOfClass:[NSHTTPURLResponse class]] ? [(NSHTTPURLResponse *)self.response statusCode] : 200;
+    NSDictionary *responseHeaderFields = headerFields;
+    NSData *responseData = data;
+
+    // The body of an `application/http` part is an HTTP response message: a status line, header fields, an empty line and the body
+    NSString *contentType = [AFMultipartHeaderFieldValue(headerFields, @"Content-Type") lowercaseString];
+    if (responseSerializer.unwrapsHTTPResponseParts && [contentType hasPrefix:@"application/http"]) {
+        NSUInteger headerLength = 0;
+        NSMutableArray *lines = [AFMultipartHeaderLinesWithBytes([data bytes], [data length], &headerLength) mutableCopy];
+        NSArray *statusLineComponents = [[lines firstObject] componentsSeparatedByString:@" "];
+        if ([statusLineComponents count] >= 2 && [statusLineComponents[0] hasPrefix:@"HTTP/"]) {
+            [lines removeObjectAtIndex:0];
+            statusCode = [statusLineComponents[1] integerValue];
+            responseHeaderFields = AFMultipartHeaderFieldsFromLines(lines);
+            responseData = [data subdataWithRange:NSMakeRange(headerLength, [data length] - headerLength)];
+        }
+    }
+
+    AFMultipartResponsePart *part = [[AFMultipartResponsePart alloc] init];
+    part.headerFields = headerFields;
+    part.response = [[NSHTTPURLResponse alloc] initWithURL:[self.response URL] ?: [NSURL URLWithString:@"about:blank"] statusCode:statusCode HTTPVersion:@"HTTP/1.1" headerFields:responseHeaderFields];
+    part.data = responseData;
+    part.byteRange = AFMultipartByteRangeFromHeaderFields(headerFields);
+
+    NSError *serializationError = nil;
+    part.responseObject = [responseSerializer.partResponseSerializer responseObjectForResponse:part.response data:responseData error:&serializationError];
+    part.error = serializationError;
+
+    [self.parts addObject:part];
+    self.numberOfParts++;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    AFMultipartResponseSerializer *responseSerializer = (AFMultipartResponseSerializer *)self.responseSerializer;
+
+    if (!self.delimiterData) {
+        NSString *boundary = AFMultipartBoundaryFromResponse(self.response);
+        if (!boundary) {
+            self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The multipart response has no boundary.", @"AFNetworking", nil), nil);
+            return NO;
+        }
+
+        self.delimiterData = [[@"\r\n" stringByAppendingString:AFMultipartDelimiter(boundary)] dataUsingEncoding:NSUTF8StringEncoding];
+
+        // The delimiter of the first part is not preceded by a CRLF, unless the response has a preamble
+        [self.buffer appendBytes:"\r\n" length:2];
+    }
+
+    [self.buffer appendData:data];
+
+    const uint8_t *bytes = [self.buffer bytes];
+    NSUInteger length = [self.buffer length];
+    const uint8_t *delimiter = [self.delimiterData bytes];
+    NSUInteger delimiterLength = [self.delimiterData length];
+    NSUInteger offset = 0;
+    BOOL needsData = NO;
+
+    while (!needsData && offset < length) {
+        switch (self.state) {
+            case AFMultipartResponseStreamPreambleState:
+            case AFMultipartResponseStreamBodyState: {
+                // Only the bytes that may start a delimiter split across data are kept to be searched again
+                const uint8_t *match = memmem(bytes + offset, length - offset, delimiter, delimiterLength);
+                NSUInteger end = match ? (NSUInteger)(match - bytes) : (length - offset >= delimiterLength ? length - delimiterLength + 1 : offset);
+
+                if (self.state == AFMultipartResponseStreamBodyState) {
+                    if ([self.partData length] + (end - offset) > responseSerializer.maximumPartLength) {
+                        self.error = AFResponseStreamErrorWithDescription([NSString stringWithFormat:NSLocalizedStringFromTable(@"Part %lu of the response exceeds the maximum part length.", @"AFNetworking", nil), (unsigned long)self.numberOfParts + 1], nil);
+                        return NO;
+                    }
+
+                    [self.partData appendBytes:bytes + offset length:end - offset];
+                }
+
+                offset = end;
+                if (!match) {
+                    needsData = YES;
+                    break;
+                }
+
+                if (self.state == AFMultipartResponseStreamBodyState) {
+                    NSData *partData = self.partData;
+                    self.partData = [NSMutableData data];
+                    [self decodePartWithHeaderFields:self.partHeaderFields data:partData];
+                }
+
+                offset += delimiterLength;
+                self.state = AFMultipartResponseStreamDelimiterState;
+                break;
+            }
+            case AFMultipartResponseStreamDelimiterState: {
+                if (length - offset < 2) {
+                    needsData = YES;
+                    break;
+                }
+
+                if (bytes[offset] == '-' && bytes[offset + 1] == '-') {
+                    self.state = AFMultipartResponseStreamEpilogueState;
+                    break;
+                }
+
+                // The delimiter line may end with transport padding. Its CRLF is kept, so that a part without header fields is ended by the CRLF of an empty line.
+                const uint8_t *lineEnd = memmem(bytes + offset, length - offset, "\r\n", 2);
+                if (!lineEnd) {
+                    needsData = YES;
+                } else {
+                    offset = (NSUInteger)(lineEnd - bytes);
+                    self.state = AFMultipartResponseStreamHeaderState;
+                }
+                break;
+            }
+            case AFMultipartResponseStreamHeaderState: {
+                const uint8_t *headerEnd = memmem(bytes + offset, length - offset, "\r\n\r\n", 4);
+                if (!headerEnd) {
+                    needsData = YES;
+                    break;
+                }
 
-- (id)responseObjectForResponse:(NSURLResponse *)response
-                           data:(NSData *)data
-                          error:(NSError *__autoreleasing *)error
-{
-    [self validateResponse:(NSHTTPURLResponse *)response data:data error:error];
+                NSUInteger headerLength = (NSUInteger)(headerEnd - bytes) - offset;
+                self.partHeaderFields = AFMultipartHeaderFieldsFromLines(AFMultipartHeaderLinesWithBytes(bytes + offset + 2, headerLength, NULL));
+                offset += headerLength + 4;
+                self.state = AFMultipartResponseStreamBodyState;
+                break;
+            }
+            case AFMultipartResponseStreamEpilogueState:
+                offset = length;
+                break;
+        }
+    }
 
-    return data;
-}
+    if ((self.state == AFMultipartResponseStreamDelimiterState || self.state == AFMultipartResponseStreamHeaderState) && length - offset > AFMultipartMaximumHeaderLength) {
+        self.error = AFResponseStreamErrorWithDescription([NSString stringWithFormat:NSLocalizedStringFromTable(@"The header fields of part %lu of the response are too long.", @"AFNetworking", nil), (unsigned long)self.numberOfParts + 1], nil);
+        return NO;
+    }
 
-#pragma mark - NSSecureCoding
+    [self.buffer replaceBytesInRange:NSMakeRange(0, offset) withBytes:NULL length:0];
+    [self deliverParts];
 
-+ (BOOL)supportsSecureCoding {
     return YES;
 }
 
-- (instancetype)initWithCoder:(NSCoder *)decoder {
-    self = [self init];
-    if (!self) {
-        return nil;
+- (void)deliverParts {
+    if ([self.parts count] == 0 || !self.partHandler) {
+        return;
     }
 
-    self.acceptableStatusCodes = [decoder decodeObjectOfClass:[NSIndexSet class] forKey:NSStringFromSelector(@selector(acceptableStatusCodes))];
-    self.acceptableContentTypes = [decoder decodeObjectOfClass:[NSSet class] forKey:NSStringFromSelector(@selector(acceptableContentTypes))];
-
-    return self;
-}
+    NSArray *parts = [self.parts copy];
+    [self.parts removeAllObjects];
 
-- (void)encodeWithCoder:(NSCoder *)coder {
-    [coder encodeObject:self.acceptableStatusCodes forKey:NSStringFromSelector(@selector(acceptableStatusCodes))];
-    [coder encodeObject:self.acceptableContentTypes forKey:NSStringFromSelector(@selector(acceptableContentTypes))];
+    [self deliverBatch:^{
+        self.partHandler(parts);
+    }];
 }
 
-#pragma mark - NSCopying
-
-- (instancetype)copyWithZone:(NSZone *)zone {
-    AFHTTPResponseSerializer *serializer = [[[self class] allocWithZone:zone] init];
-    serializer.acceptableStatusCodes = [self.acceptableStatusCodes copyWithZone:zone];
-    serializer.acceptableContentTypes = [self.acceptableContentTypes copyWithZone:zone];
+- (void)finishDecoding {
+    if (self.state != AFMultipartResponseStreamEpilogueState) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The multipart response ended before its close delimiter.", @"AFNetworking", nil), nil);
+    }
 
-    return serializer;
+    [self.buffer setLength:0];
+    [self.partData setLength:0];
 }
 
 @end
 
 #pragma mark -
 
-@implementation AFJSONResponseSerializer
-
-+ (instancetype)serializer {
-    return [self serializerWithReadingOptions:(NSJSONReadingOptions)0];
-}
+@implementation AFMultipartResponseSerializer
 
-+ (instancetype)serializerWithReadingOptions:(NSJSONReadingOptions)readingOptions {
-    AFJSONResponseSerializer *serializer = [[self alloc] init];
-    serializer.readingOptions = readingOptions;
++ (instancetype)serializerWithPartResponseSerializer:(id <AFURLResponseSerialization>)partResponseSerializer {
+    AFMultipartResponseSerializer *serializer = [self serializer];
+    serializer.partResponseSerializer = partResponseSerializer;
 
     return serializer;
 }
@@ -225,11 +2363,22 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
         return nil;
     }
 
-    self.acceptableContentTypes = [NSSet setWithObjects:@"application/json", @"text/json", @"text/javascript", nil];
+    self.acceptableContentTypes = [NSSet setWithObjects:@"multipart/mixed", @"multipart/byteranges", @"multipart/related", nil];
+    self.partResponseSerializer = [AFHTTPResponseSerializer serializer];
+    self.unwrapsHTTPResponseParts = YES;
+    self.maximumPartLength = 16 * 1024 * 1024;
 
     return self;
 }
 
+- (AFMultipartResponseStream *)streamWithQueue:(dispatch_queue_t)queue
+                                   partHandler:(void (^)(NSArray <AFMultipartResponsePart *> *parts))partHandler
+{
+    NSParameterAssert(partHandler);
+
+    return [[AFMultipartResponseStream alloc] initWithResponseSerializer:[self copy] queue:queue partHandler:partHandler];
+}
+
 #pragma mark - AFURLResponseSerialization
 
 - (id)responseObjectForResponse:(NSURLResponse *)response
@@ -242,31 +2391,25 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
         }
     }
 
-    // Workaround for behavior of Rails to return a single space for `head :ok` (a workaround for a bug in Safari), which is not interpreted as valid input by NSJSONSerialization.
-    // See https://github.com/rails/rails/issues/1742
-    BOOL isSpace = [data isEqualToData:[NSData dataWithBytes:" " length:1]];
-    
-    if (data.length == 0 || isSpace) {
+    if (data.length == 0) {
         return nil;
     }
-    
-    NSError *serializationError = nil;
-    
-    id responseObject = [NSJSONSerialization JSONObjectWithData:data options:self.readingOptions error:&serializationError];
 
-    if (!responseObject)
-    {
+    // Without a part handler, the stream keeps every part of the response.
+    AFMultipartResponseStream *stream = [[AFMultipartResponseStream alloc] initWithResponseSerializer:self queue:nil partHandler:nil];
+    stream.response = response;
+    if ([stream decodeData:data]) {
+        [stream finishWithCompletionHandler:nil];
+    }
+
+    if (stream.error) {
         if (error) {
-            *error = AFErrorWithUnderlyingError(serializationError, *error);
+            *error = AFErrorWithUnderlyingError(stream.error, *error);
         }
         return nil;
     }
-    
-    if (self.removesKeysWithNullValues) {
-        return AFJSONObjectByRemovingKeysWithNullValues(responseObject, self.readingOptions);
-    }
 
-    return responseObject;
+    return [stream.parts copy];
 }
 
 #pragma mark - NSSecureCoding
@@ -277,8 +2420,9 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
         return nil;
     }
 
-    self.readingOptions = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(readingOptions))] unsignedIntegerValue];
-    self.removesKeysWithNullValues = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(removesKeysWithNullValues))] boolValue];
+    self.partResponseSerializer = [decoder decodeObjectOfClass:[AFHTTPResponseSerializer class] forKey:NSStringFromSelector(@selector(partResponseSerializer))] ?: [AFHTTPResponseSerializer serializer];
+    self.unwrapsHTTPResponseParts = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(unwrapsHTTPResponseParts))] boolValue];
+    self.maximumPartLength = [[decoder decodeObjectOfClass:[NSNumber class] forKey:NSStringFromSelector(@selector(maximumPartLength))] unsignedIntegerValue];
 
     return self;
 }
@@ -286,16 +2430,18 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
 - (void)encodeWithCoder:(NSCoder *)coder {
     [super encodeWithCoder:coder];
 
-    [coder encodeObject:@(self.readingOptions) forKey:NSStringFromSelector(@selector(readingOptions))];
-    [coder encodeObject:@(self.removesKeysWithNullValues) forKey:NSStringFromSelector(@selector(removesKeysWithNullValues))];
+    [coder encodeObject:self.partResponseSerializer forKey:NSStringFromSelector(@selector(partResponseSerializer))];
+    [coder encodeObject:@(self.unwrapsHTTPResponseParts) forKey:NSStringFromSelector(@selector(unwrapsHTTPResponseParts))];
+    [coder encodeObject:@(self.maximumPartLength) forKey:NSStringFromSelector(@selector(maximumPartLength))];
 }
 
 #pragma mark - NSCopying
 
 - (instancetype)copyWithZone:(NSZone *)zone {
-    AFJSONResponseSerializer *serializer = [super copyWithZone:zone];
-    serializer.readingOptions = self.readingOptions;
-    serializer.removesKeysWithNullValues = self.removesKeysWithNullValues;
+    AFMultipartResponseSerializer *serializer = [super copyWithZone:zone];
+    serializer.partResponseSerializer = [self.partResponseSerializer copyWithZone:zone];
+    serializer.unwrapsHTTPResponseParts = self.unwrapsHTTPResponseParts;
+    serializer.maximumPartLength = self.maximumPartLength;
 
     return serializer;
 }
@@ -304,6 +2450,252 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
 
 #pragma mark -
 
+@interface AFXMLEventStream () <AFXMLPushParserDelegate>
+@property (readwrite, nonatomic, copy) void (^eventHandler)(NSArray <AFXMLEvent *> *events);
+@property (readwrite, nonatomic, strong) AFXMLPushParser *parser;
+@property (readwrite, nonatomic, strong) NSMutableArray <AFXMLEvent *> *events;
+@property (readwrite, atomic, assign) NSUInteger numberOfEvents;
+
+- (instancetype)initWithResponseSerializer:(AFXMLParserResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                              eventHandler:(void (^)(NSArray <AFXMLEvent *> *events))eventHandler;
+@end
+
+@implementation AFXMLEventStream
+
+- (instancetype)initWithResponseSerializer:(AFXMLParserResponseSerializer *)responseSerializer
+                                     queue:(dispatch_queue_t)queue
+                              eventHandler:(void (^)(NSArray <AFXMLEvent *> *events))eventHandler
+{
+    self = [super initWithResponseSerializer:responseSerializer queue:queue maximumNumberOfPendingBatches:2];
+    if (!self) {
+        return nil;
+    }
+
+    self.eventHandler = eventHandler;
+    self.parser = [[AFXMLPushParser alloc] init];
+    self.parser.delegate = self;
+    self.events = [NSMutableArray array];
+
+    return self;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    NSError *parserError = nil;
+    BOOL parsed = [self.parser parseData:data error:&parserError];
+    [self deliverEvents];
+
+    if (!parsed) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The XML response could not be parsed.", @"AFNetworking", nil), parserError);
+    }
+
+    return parsed;
+}
+
+- (void)finishDecoding {
+    NSError *parserError = nil;
+    if (![self.parser finishParsing:&parserError]) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The XML response ended before the document was complete.", @"AFNetworking", nil), parserError);
+    }
+}
+
+- (void)deliverEvents {
+    if ([self.events count] == 0) {
+        return;
+    }
+
+    NSArray *events = [self.events copy];
+    [self.events removeAllObjects];
+
+    self.numberOfEvents += [events count];
+    [self deliverBatch:^{
+        self.eventHandler(events);
+    }];
+}
+
+#pragma mark - AFXMLPushParserDelegate
+
+- (void)parser:(AFXMLPushParser *)parser
+didStartElement:(NSString *)elementName
+    attributes:(NSDictionary <NSString *, NSString *> *)attributes
+{
+    [self.events addObject:[[AFXMLEvent alloc] initWithType:AFXMLEventTypeStartElement name:elementName attributes:attributes text:nil depth:parser.depth]];
+}
+
+- (void)parser:(AFXMLPushParser *)parser
+ didEndElement:(NSString *)elementName
+{
+    [self.events addObject:[[AFXMLEvent alloc] initWithType:AFXMLEventTypeEndElement name:elementName attributes:nil text:nil depth:parser.depth]];
+}
+
+- (void)parser:(AFXMLPushParser *)parser
+foundCharacters:(NSString *)string
+{
+    [self.events addObject:[[AFXMLEvent alloc] initWithType:AFXMLEventTypeText name:nil attributes:nil text:string depth:parser.depth]];
+}
+
+@end
+
+#pragma mark -
+
+@interface AFXMLElementBuilder : NSObject
+@property (readwrite, nonatomic, copy) NSString *name;
+@property (readwrite, nonatomic, copy) NSDictionary <NSString *, NSString *> *attributes;
+@property (readwrite, nonatomic, strong) NSMutableArray <AFXMLElement *> *children;
+@property (readwrite, nonatomic, strong) NSMutableString *text;
+
+- (AFXMLElement *)element;
+@end
+
+@implementation AFXMLElementBuilder
+
+- (AFXMLElement *)element {
+    return [[AFXMLElement alloc] initWithName:self.name attributes:self.attributes children:self.children text:self.text];
+}
+
+@end
+
+@interface AFXMLElementStream () <AFXMLPushParserDelegate>
+@property (readwrite, nonatomic, copy) NSString *path;
+@property (readwrite, nonatomic, copy) NSArray <NSString *> *pathComponents;
+@property (readwrite, nonatomic, copy) void (^elementHandler)(AFXMLElement *element, NSUInteger idx);
+@property (readwrite, nonatomic, strong) AFXMLPushParser *parser;
+@property (readwrite, nonatomic, assign) NSUInteger onPathDepth;
+@property (readwrite, nonatomic, strong) NSMutableArray <AFXMLElementBuilder *> *builders;
+@property (readwrite, nonatomic, strong) NSMutableArray <AFXMLElement *> *elements;
+@property (readwrite, atomic, assign) NSUInteger numberOfElements;
+
+- (instancetype)initWithResponseSerializer:(AFXMLParserResponseSerializer *)responseSerializer
+                                      path:(NSString *)path
+                                     queue:(dispatch_queue_t)queue
+                            elementHandler:(void (^)(AFXMLElement *element, NSUInteger idx))elementHandler;
+@end
+
+@implementation AFXMLElementStream
+
+- (instancetype)initWithResponseSerializer:(AFXMLParserResponseSerializer *)responseSerializer
+                                      path:(NSString *)path
+                                     queue:(dispatch_queue_t)queue
+                            elementHandler:(void (^)(AFXMLElement *element, NSUInteger idx))elementHandler
+{
+    NSParameterAssert([path length] > 0);
+
+    self = [super initWithResponseSerializer:responseSerializer queue:queue maximumNumberOfPendingBatches:2];
+    if (!self) {
+        return nil;
+    }
+
+    self.path = path;
+    self.pathComponents = [path componentsSeparatedByString:@"/"];
+    self.elementHandler = elementHandler;
+    self.parser = [[AFXMLPushParser alloc] init];
+    self.parser.delegate = self;
+    self.builders = [NSMutableArray array];
+    self.elements = [NSMutableArray array];
+
+    return self;
+}
+
+- (BOOL)decodeData:(NSData *)data {
+    NSError *parserError = nil;
+    BOOL parsed = [self.parser parseData:data error:&parserError];
+    [self deliverElements];
+
+    if (!parsed) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The XML response could not be parsed.", @"AFNetworking", nil), parserError);
+    }
+
+    return parsed;
+}
+
+- (void)finishDecoding {
+    NSError *parserError = nil;
+    if (![self.parser finishParsing:&parserError]) {
+        self.error = AFResponseStreamErrorWithDescription(NSLocalizedStringFromTable(@"The XML response ended before the document was complete.", @"AFNetworking", nil), parserError);
+    }
+}
+
+- (void)deliverElements {
+    if ([self.elements count] == 0 || !self.elementHandler) {
+        return;
+    }
+
+    NSArray *elements = [self.elements copy];
+    NSUInteger firstIndex = self.numberOfElements - [elements count];
+    [self.elements removeAllObjects];
+
+    [self deliverBatch:^{
+        [elements enumerateObjectsUsingBlock:^(AFXMLElement *element, NSUInteger idx, __unused BOOL *stop) {
+            self.elementHandler(element, firstIndex + idx);
+        }];
+    }];
+}
+
+#pragma mark - AFXMLPushParserDelegate
+
+- (void)parser:(AFXMLPushParser *)parser
+didStartElement:(NSString *)elementName
+    attributes:(NSDictionary <NSString *, NSString *> *)attributes
+{
+    NSUInteger depth = parser.depth;
+    if ([self.builders count] == 0) {
+        // Only the elements on the path are followed, until one at the end of the path starts a subtree to build
+        if (depth != self.onPathDepth || depth >= [self.pathComponents count]) {
+            return;
+        }
+
+        NSString *component = self.pathComponents[depth];
+        if (![component isEqualToString:@"*"] && ![component isEqualToString:elementName]) {
+            return;
+        }
+
+        if (depth + 1 < [self.pathComponents count]) {
+            self.onPathDepth++;
+            return;
+        }
+    }
+
+    AFXMLElementBuilder *builder = [[AFXMLElementBuilder alloc] init];
+    builder.name = elementName;
+    builder.attributes = attributes;
+    builder.children = [NSMutableArray array];
+    builder.text = [NSMutableString string];
+    [self.builders addObject:builder];
+}
+
+- (void)parser:(AFXMLPushParser *)parser
+ didEndElement:(NSString *)elementName
+{
+    if ([self.builders count] == 0) {
+        if (parser.depth + 1 == self.onPathDepth) {
+            self.onPathDepth--;
+        }
+
+        return;
+    }
+
+    AFXMLElement *element = [[self.builders lastObject] element];
+    [self.builders removeLastObject];
+
+    AFXMLElementBuilder *parent = [self.builders lastObject];
+    if (parent) {
+        [parent.children addObject:element];
+    } else {
+        [self.elements addObject:element];
+        self.numberOfElements++;
+    }
+}
+
+- (void)parser:(__unused AFXMLPushParser *)parser
+foundCharacters:(NSString *)string
+{
+    [[self.builders lastObject].text appendString:string];
+}
+
+@end
+
+#pragma mark -
+
 @implementation AFXMLParserResponseSerializer
 
 + (instancetype)serializer {
@@ -323,6 +2715,23 @@ id AFJSONObjectByRemovingKeysWithNullValues(id JSONObject, NSJSONReadingOptions
     return self;
 }
 
+- (AFXMLEventStream *)eventStreamWithQueue:(dispatch_queue_t)queue
+                              eventHandler:(void (^)(NSArray <AFXMLEvent *> *events))eventHandler
+{
+    NSParameterAssert(eventHandler);
+
+    return [[AFXMLEventStream alloc] initWithResponseSerializer:[self copy] queue:queue eventHandler:eventHandler];
+}
+
+- (AFXMLElementStream *)elementStreamWithPath:(NSString *)path
+                                        queue:(dispatch_queue_t)queue
+                               elementHandler:(void (^)(AFXMLElement *element, NSUInteger idx))elementHandler
+{
+    NSParameterAssert(elementHandler);
+
+    return [[AFXMLElementStream alloc] initWithResponseSerializer:[self copy] path:path queue:queue elementHandler:elementHandler];
+}
+
 #pragma mark - AFURLResponseSerialization
 
 - (id)responseObjectForResponse:(NSHTTPURLResponse *)response
@@ -750,8 +3159,82 @@ static UIImage * AFInflatedImageFromResponseWithDataAtScale(NSHTTPURLResponse *r
 
 #pragma mark -
 
+// Returns the MIME types of the data, sniffed from its first bytes, from the most to the least specific
+static NSArray <NSString *> * AFContentTypesSniffedFromData(NSData *data) {
+    const uint8_t *bytes = [data bytes];
+    NSUInteger length = MIN([data length], (NSUInteger)512);
+
+    if (length >= 8 && memcmp(bytes, "\x89PNG\r\n\x1a\n", 8) == 0) {
+        return @[@"image/png"];
+    } else if (length >= 3 && memcmp(bytes, "\xff\xd8\xff", 3) == 0) {
+        return @[@"image/jpeg"];
+    } else if (length >= 6 && (memcmp(bytes, "GIF87a", 6) == 0 || memcmp(bytes, "GIF89a", 6) == 0)) {
+        return @[@"image/gif"];
+    } else if (length >= 4 && (memcmp(bytes, "II*\0", 4) == 0 || memcmp(bytes, "MM\0*", 4) == 0)) {
+        return @[@"image/tiff"];
+    } else if (length >= 4 && memcmp(bytes, "\0\0\1\0", 4) == 0) {
+        return @[@"image/x-icon", @"image/ico"];
+    } else if (length >= 2 && memcmp(bytes, "BM", 2) == 0) {
+        return @[@"image/bmp", @"image/x-bmp", @"image/x-win-bitmap", @"image/x-xbitmap"];
+    } else if (length >= 8 && memcmp(bytes, "bplist00", 8) == 0) {
+        return @[@"application/x-plist"];
+    }
+
+    NSUInteger idx = length >= 3 && memcmp(bytes, "\xef\xbb\xbf", 3) == 0 ? 3 : 0;
+    while (idx < length && (bytes[idx] == ' ' || bytes[idx] == '\t' || bytes[idx] == '\r' || bytes[idx] == '\n')) {
+        idx++;
+    }
+    if (idx == length) {
+        return @[];
+    }
+
+    switch (bytes[idx]) {
+        case '{': case '[':
+            return @[@"application/json", @"text/json", @"text/javascript"];
+        case '<': {
+            NSData *head = [NSData dataWithBytesNoCopy:(void *)(bytes + idx) length:length - idx freeWhenDone:NO];
+            if ([head rangeOfData:[@"<!DOCTYPE plist" dataUsingEncoding:NSASCIIStringEncoding] options:0 range:NSMakeRange(0, [head length])].location != NSNotFound || [head rangeOfData:[@"<plist" dataUsingEncoding:NSASCIIStringEncoding] options:0 range:NSMakeRange(0, [head length])].location != NSNotFound) {
+                return @[@"application/x-plist", @"application/xml", @"text/xml"];
+            }
+            return @[@"application/xml", @"text/xml"];
+        }
+        default:
+            return @[];
+    }
+}
+
+// Returns a copy of the response with the specified MIME type, keeping its text encoding
+static NSURLResponse * AFResponseWithMIMEType(NSURLResponse *response, NSString *MIMEType) {
+    if (![response URL]) {
+        return response;
+    }
+
+    NSString *contentType = [response textEncodingName] ? [NSString stringWithFormat:@"%@; charset=%@", MIMEType, [response textEncodingName]] : MIMEType;
+    if ([response isKindOfClass:[NSHTTPURLResponse class]]) {
+        NSHTTPURLResponse *HTTPResponse = (NSHTTPURLResponse *)response;
+        NSMutableDictionary *mutableHeaderFields = [NSMutableDictionary dictionaryWithCapacity:[[HTTPResponse allHeaderFields] count] + 1];
+        [[HTTPResponse allHeaderFields] enumerateKeysAndObjectsUsingBlock:^(id field, id value, __unused BOOL *stop) {
+            if ([field caseInsensitiveCompare:@"Content-Type"] != NSOrderedSame) {
+                mutableHeaderFields[field] = value;
+            }
+        }];
+        mutableHeaderFields[@"Content-Type"] = contentType;
+
+        return [[NSHTTPURLResponse alloc] initWithURL:[HTTPResponse URL] statusCode:[HTTPResponse statusCode] HTTPVersion:@"HTTP/1.1" headerFields:mutableHeaderFields];
+    }
+
+    return [[NSURLResponse alloc] initWithURL:[response URL] MIMEType:MIMEType expectedContentLength:(NSInteger)[response expectedContentLength] textEncodingName:[response textEncodingName]];
+}
+
 @interface AFCompoundResponseSerializer ()
 @property (readwrite, nonatomic, copy) NSArray *responseSerializers;
+@property (readwrite, nonatomic, strong) NSLock *lock;
+@property (readwrite, nonatomic, copy) NSArray *indexedAcceptableContentTypes;
+@property (readwrite, nonatomic, copy) NSDictionary <NSString *, AFHTTPResponseSerializer *> *responseSerializersByContentType;
+@property (readwrite, nonatomic, strong) AFHTTPResponseSerializer *defaultResponseSerializer;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfResponsesDispatchedByContentType;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfResponsesDispatchedBySniffing;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfUndispatchedResponses;
 @end
 
 @implementation AFCompoundResponseSerializer
@@ -763,19 +3246,139 @@ static UIImage * AFInflatedImageFromResponseWithDataAtScale(NSHTTPURLResponse *r
     return serializer;
 }
 
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.lock = [[NSLock alloc] init];
+
+    return self;
+}
+
+- (void)setResponseSerializers:(NSArray *)responseSerializers {
+    [self.lock lock];
+    _responseSerializers = [responseSerializers copy];
+    self.indexedAcceptableContentTypes = nil;
+    [self.lock unlock];
+}
+
+- (NSUInteger)numberOfResponsesDispatchedByContentType {
+    [self.lock lock];
+    NSUInteger numberOfResponses = _numberOfResponsesDispatchedByContentType;
+    [self.lock unlock];
+
+    return numberOfResponses;
+}
+
+- (NSUInteger)numberOfResponsesDispatchedBySniffing {
+    [self.lock lock];
+    NSUInteger numberOfResponses = _numberOfResponsesDispatchedBySniffing;
+    [self.lock unlock];
+
+    return numberOfResponses;
+}
+
+- (NSUInteger)numberOfUndispatchedResponses {
+    [self.lock lock];
+    NSUInteger numberOfResponses = _numberOfUndispatchedResponses;
+    [self.lock unlock];
+
+    return numberOfResponses;
+}
+
+// `acceptableContentTypes` is a copy property, so any change replaces the set. The indexed sets are kept alive, so comparing them by identity is enough to notice one
+- (void)indexResponseSerializersIfNeeded {
+    NSMutableArray *acceptableContentTypes = [NSMutableArray arrayWithCapacity:[self.responseSerializers count]];
+    for (id <AFURLResponseSerialization> serializer in self.responseSerializers) {
+        if ([serializer isKindOfClass:[AFHTTPResponseSerializer class]]) {
+            [acceptableContentTypes addObject:((AFHTTPResponseSerializer *)serializer).acceptableContentTypes ?: (id)[NSNull null]];
+        }
+    }
+
+    NSArray *indexedAcceptableContentTypes = self.indexedAcceptableContentTypes;
+    if (indexedAcceptableContentTypes && [indexedAcceptableContentTypes count] == [acceptableContentTypes count]) {
+        BOOL isIndexed = YES;
+        for (NSUInteger idx = 0; idx < [acceptableContentTypes count]; idx++) {
+            if (indexedAcceptableContentTypes[idx] != acceptableContentTypes[idx]) {
+                isIndexed = NO;
+                break;
+            }
+        }
+
+        if (isIndexed) {
+            return;
+        }
+    }
+
+    NSMutableDictionary *mutableResponseSerializersByContentType = [NSMutableDictionary dictionary];
+    AFHTTPResponseSerializer *defaultResponseSerializer = nil;
+    NSUInteger idx = 0;
+    for (id <AFURLResponseSerialization> serializer in self.responseSerializers) {
+        if (![serializer isKindOfClass:[AFHTTPResponseSerializer class]]) {
+            continue;
+        }
+
+        AFHTTPResponseSerializer *HTTPSerializer = (AFHTTPResponseSerializer *)serializer;
+        id serializerContentTypes = acceptableContentTypes[idx++];
+        if (serializerContentTypes == [NSNull null]) {
+            defaultResponseSerializer = defaultResponseSerializer ?: HTTPSerializer;
+            continue;
+        }
+
+        for (NSString *contentType in serializerContentTypes) {
+            if (!mutableResponseSerializersByContentType[contentType]) {
+                mutableResponseSerializersByContentType[contentType] = HTTPSerializer;
+            }
+        }
+    }
+
+    self.indexedAcceptableContentTypes = acceptableContentTypes;
+    self.responseSerializersByContentType = mutableResponseSerializersByContentType;
+    self.defaultResponseSerializer = defaultResponseSerializer;
+}
+
 #pragma mark - AFURLResponseSerialization
 
 - (id)responseObjectForResponse:(NSURLResponse *)response
                            data:(NSData *)data
                           error:(NSError *__autoreleasing *)error
 {
-    for (id <AFURLResponseSerialization> serializer in self.responseSerializers) {
-        if (![serializer isKindOfClass:[AFHTTPResponseSerializer class]]) {
-            continue;
+    [self.lock lock];
+    [self indexResponseSerializersIfNeeded];
+    NSDictionary <NSString *, AFHTTPResponseSerializer *> *responseSerializersByContentType = self.responseSerializersByContentType;
+    AFHTTPResponseSerializer *defaultResponseSerializer = self.defaultResponseSerializer;
+    [self.lock unlock];
+
+    NSURLResponse *dispatchedResponse = response;
+    AFHTTPResponseSerializer *serializer = [response MIMEType] ? responseSerializersByContentType[[response MIMEType]] : nil;
+    if (serializer) {
+        [self.lock lock];
+        _numberOfResponsesDispatchedByContentType++;
+        [self.lock unlock];
+    } else {
+        for (NSString *contentType in AFContentTypesSniffedFromData(data)) {
+            serializer = responseSerializersByContentType[contentType];
+            if (serializer) {
+                dispatchedResponse = AFResponseWithMIMEType(response, contentType);
+                break;
+            }
+        }
+
+        [self.lock lock];
+        if (serializer) {
+            _numberOfResponsesDispatchedBySniffing++;
+        } else {
+            _numberOfUndispatchedResponses++;
         }
+        [self.lock unlock];
+        serializer = serializer ?: defaultResponseSerializer;
+    }
 
+    if (serializer) {
         NSError *serializerError = nil;
-        id responseObject = [serializer responseObjectForResponse:response data:data error:&serializerError];
+        id responseObject = [serializer responseObjectForResponse:dispatchedResponse data:data error:&serializerError];
         if (responseObject) {
             if (error) {
                 *error = AFErrorWithUnderlyingError(serializerError, *error);
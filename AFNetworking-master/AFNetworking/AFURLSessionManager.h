@@ -25,6 +25,7 @@
 #import "AFURLResponseSerialization.h"
 #import "AFURLRequestSerialization.h"
 #import "AFSecurityPolicy.h"
+#import "AFCompletionCoalescer.h"
 #import "AFCompatibilityMacros.h"
 #if !TARGET_OS_WATCH
 #import "AFNetworkReachabilityManager.h"
@@ -163,6 +164,52 @@ session创建的正在执行的所有下载任务
  */
 @property (nonatomic, strong, nullable) dispatch_group_t completionGroup;
 
+/**
+ 合并回调的执行器，默认为nil。
+
+ 设置后，任务完成的‘completionBlock’和`AFNetworkingTaskDidCompleteNotification`通知不再各自派发到‘completionQueue’和主队列，而是交给这个执行器，与同时完成的其他任务一起，在它的队列上分批执行，此时‘completionQueue’被忽略。执行器的队列为主队列时，通知在同一批中直接发出。大量小请求同时完成时，可以减少主线程被唤醒的次数。
+
+ @see AFCompletionCoalescer
+ */
+@property (nonatomic, strong, nullable) AFCompletionCoalescer *completionCoalescer;
+
+///-------------------------------
+/// @name 限制上传带宽
+///-------------------------------
+
+/**
+所有上传任务共享的带宽限制，默认为nil，即不限制。
+
+ 设置后，流式上传和带有`HTTPBodyStream`的数据任务的请求体会通过这个限制读取；非后台session中从`NSData`或文件上传的任务会被转换为流式上传。多个manager可以共享同一个限制，以限制它们的总上传速率。读取请求体的线程不会被阻塞。
+
+ @see AFBandwidthThrottle
+ */
+@property (nonatomic, strong, nullable) AFBandwidthThrottle *uploadBandwidthThrottle;
+
+///-------------------------------
+/// @name 可恢复下载
+///-------------------------------
+
+/**
+可恢复下载任务保存未完成文件及其校验信息的目录，默认为缓存目录下的`com.alamofire.networking.resumable-downloads`。
+
+ @see -resumableDownloadTaskWithRequest:progress:destination:completionHandler:
+ */
+@property (nonatomic, strong) NSURL *resumableDownloadsDirectoryURL;
+
+///-------------------------------
+/// @name 响应内容解码
+///-------------------------------
+
+/**
+解码响应内容编码的注册表，默认为nil，即不解码`NSURLSession`自身不支持的内容编码。
+
+ 设置后，数据任务的响应会根据`Content-Encoding`选择解码器，每块数据在接收时即被解压，再交给响应序列化或响应流，无需等待整个响应缓存完毕。无法解码的响应会取消任务，并以`NSURLErrorCannotDecodeRawData`错误结束。下载进度仍按接收到的编码数据计算；可恢复下载任务不会被解码。
+
+ @see AFContentDecoderRegistry
+ */
+@property (nonatomic, strong, nullable) AFContentDecoderRegistry *contentDecoderRegistry;
+
 ///---------------------------------
 /// @name 解决系统错误
 ///---------------------------------
@@ -228,6 +275,34 @@ session创建的正在执行的所有下载任务
                              downloadProgress:(nullable void (^)(NSProgress *downloadProgress))downloadProgressBlock
                             completionHandler:(nullable void (^)(NSURLResponse *response, id _Nullable responseObject,  NSError * _Nullable error))completionHandler;
 
+/**
+ 通过特定的请求创建一个‘NSURLSessionDataTask’，接收到的数据逐块交给`didReceiveDataBlock`处理，而不是缓存在内存中。
+
+ 响应序列化收到的是空数据，因此完成回调中只会报告服务器响应和状态码校验的结果。
+
+ @param request 网络请求的request.
+ @param uploadProgressBlock 上传进度更新时进行的一个block回调。这个block是在session的队列进行响应的，而不是在主队列.
+ @param downloadProgressBlock 下载进度更新时进行的一个block回调。这个block是在session的队列进行响应的，而不是在主队列.
+ @param didReceiveDataBlock 每接收到一块数据时的block回调，回调中有两个参数: 数据任务和接收到的数据。这个block是在session的队列进行响应的，而不是在主队列.
+ @param completionHandler 任务完成时的一个block回调  回调中有三个参数: 服务器响应, 序列化处理后的响应，如果有错误发生将返回的错误.
+ */
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                               uploadProgress:(nullable void (^)(NSProgress *uploadProgress))uploadProgressBlock
+                             downloadProgress:(nullable void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                               didReceiveData:(void (^)(NSURLSessionDataTask *dataTask, NSData *data))didReceiveDataBlock
+                            completionHandler:(nullable void (^)(NSURLResponse *response, id _Nullable responseObject,  NSError * _Nullable error))completionHandler;
+
+/**
+ 通过特定的请求创建一个‘NSURLSessionDataTask’，接收到的数据由`stream`逐块解析，并按批次交给它的回调，而不是缓存整个响应。批次回调跟不上时任务会被挂起，直到待处理的批次减少。
+
+ @param request 网络请求的request.
+ @param stream 解析响应的流，例如由`-[AFJSONLinesResponseSerializer streamWithBatchHandler:]`或`-[AFJSONResponseSerializer elementStreamWithKeyPath:queue:elementHandler:]`创建的流，每个流只能用于一个任务.
+ @param completionHandler 所有批次处理完之后的block回调，在流的队列上执行，回调中有两个参数: 服务器响应，如果有错误发生将返回的错误（解析流的错误优先）.
+ */
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                               responseStream:(AFURLResponseStream *)stream
+                            completionHandler:(nullable void (^)(NSURLResponse *response, NSError * _Nullable error))completionHandler;
+
 ///---------------------------
 /// @name 上传任务
 ///---------------------------
@@ -303,6 +378,34 @@ session创建的正在执行的所有下载任务
                                              destination:(nullable NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
                                        completionHandler:(nullable void (^)(NSURLResponse *response, NSURL * _Nullable filePath, NSError * _Nullable error))completionHandler;
 
+/**
+ 通过特定请求创建一个可恢复的下载任务。
+
+ 接收到的数据会直接写入`resumableDownloadsDirectoryURL`中以请求URL命名的未完成文件，同时记录响应的`ETag`或`Last-Modified`校验信息。因此无论任务是被取消、失败，还是进程被终止，已下载的数据都会保留。之后为同一URL创建的任务会带上`Range`和`If-Range`请求头，只请求剩余的部分；如果服务器上的资源已经改变，服务器会返回完整的资源，下载从头开始。如果未完成文件已经包含完整的资源，服务器返回`416`并在`Content-Range`中给出与文件长度相同的资源长度，下载直接以该文件完成。
+
+ 如果服务器返回的`206`响应的`Content-Range`与未完成文件不衔接，未完成文件会被删除，任务以`NSURLErrorDomain`中的`NSURLErrorBadServerResponse`错误结束，而不是`NSURLErrorCancelled`。此时为同一请求重新创建任务即可从头下载。
+
+ 通过恢复而节省的字节数包含在`AFNetworkingTaskDidCompleteNotification`的userInfo中，键为`AFNetworkingTaskDidCompleteResumedByteCountKey`，下载进度也从这些字节开始计算。
+
+ @param request 网络请求的request..
+ @param downloadProgressBlock 下载进度更新时进行的一个block回调。这个block是在session的队列进行响应的，而不是在主队列.
+ @param destination 下载完成后返回文件最终存储路径的block回调，这个block有两个参数，未完成文件的路径和服务响应。
+ @param completionHandler 任务完成时的一个block回调  回调中有三个参数: 服务器响应, 下载的存储路径，如果有错误发生将返回的错误.
+
+ @warning 后台session不支持数据任务，因此不能使用这个方法。
+ */
+- (NSURLSessionDataTask *)resumableDownloadTaskWithRequest:(NSURLRequest *)request
+                                                  progress:(nullable void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                                               destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                                         completionHandler:(nullable void (^)(NSURLResponse *response, NSURL * _Nullable filePath, NSError * _Nullable error))completionHandler;
+
+/**
+ 删除为特定请求保存的未完成下载文件，之后的下载将从头开始。
+
+ @param request 网络请求的request..
+ */
+- (void)removeResumableDownloadForRequest:(NSURLRequest *)request;
+
 ///---------------------------------
 /// @name 获取任务进度
 ///---------------------------------
@@ -515,4 +618,9 @@ FOUNDATION_EXPORT NSString * const AFNetworkingTaskDidCompleteErrorKey;
  */
 FOUNDATION_EXPORT NSString * const AFNetworkingTaskDidCompleteSessionTaskMetrics;
 
+/**
+ The number of bytes a resumable download did not have to download again, because they were kept from an earlier attempt. Included in the userInfo dictionary of the `AFNetworkingTaskDidCompleteNotification` for tasks created with `resumableDownloadTaskWithRequest:progress:destination:completionHandler:`.
+ */
+FOUNDATION_EXPORT NSString * const AFNetworkingTaskDidCompleteResumedByteCountKey;
+
 NS_ASSUME_NONNULL_END
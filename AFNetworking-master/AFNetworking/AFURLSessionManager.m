@@ -20,7 +20,10 @@
 // THE SOFTWARE.
 
 #import "AFURLSessionManager.h"
+#import "AFRangeRequests.h"
 #import <objc/runtime.h>
+#import <fcntl.h>
+#import <CommonCrypto/CommonDigest.h>
 
 #ifndef NSFoundationVersionNumber_iOS_8_0
 #define NSFoundationVersionNumber_With_Fixed_5871104061079552_bug 1140.11
@@ -83,11 +86,30 @@ NSString * const AFNetworkingTaskDidCompleteResponseDataKey = @"com.alamofire.ne
 NSString * const AFNetworkingTaskDidCompleteErrorKey = @"com.alamofire.networking.task.complete.error";
 NSString * const AFNetworkingTaskDidCompleteAssetPathKey = @"com.alamofire.networking.task.complete.assetpath";
 NSString * const AFNetworkingTaskDidCompleteSessionTaskMetrics = @"com.alamofire.networking.complete.sessiontaskmetrics";
+NSString * const AFNetworkingTaskDidCompleteResumedByteCountKey = @"com.alamofire.networking.task.complete.resumedbytecount";
 
 static NSString * const AFURLSessionManagerLockName = @"com.alamofire.networking.session.manager.lock";
 
 static NSUInteger const AFMaximumNumberOfAttemptsToRecreateBackgroundSessionUploadTask = 3;
 
+static NSString * const AFResumableDownloadStateURLKey = @"URL";
+static NSString * const AFResumableDownloadStateETagKey = @"ETag";
+static NSString * const AFResumableDownloadStateLastModifiedKey = @"Last-Modified";
+
+//未完成下载文件以请求URL的SHA-256命名
+static NSString * AFResumableDownloadNameForURL(NSURL *URL) {
+    NSData *data = [[URL absoluteString] dataUsingEncoding:NSUTF8StringEncoding];
+    unsigned char digest[CC_SHA256_DIGEST_LENGTH];
+    CC_SHA256([data bytes], (CC_LONG)[data length], digest);
+
+    NSMutableString *name = [NSMutableString stringWithCapacity:CC_SHA256_DIGEST_LENGTH * 2];
+    for (NSUInteger idx = 0; idx < CC_SHA256_DIGEST_LENGTH; idx++) {
+        [name appendFormat:@"%02x", digest[idx]];
+    }
+
+    return name;
+}
+
 typedef void (^AFURLSessionDidBecomeInvalidBlock)(NSURLSession *session, NSError *error);
 typedef NSURLSessionAuthChallengeDisposition (^AFURLSessionDidReceiveAuthenticationChallengeBlock)(NSURLSession *session, NSURLAuthenticationChallenge *challenge, NSURLCredential * __autoreleasing *credential);
 
@@ -128,9 +150,23 @@ typedef void (^AFURLSessionTaskCompletionHandler)(NSURLResponse *response, id re
 @property (nonatomic, strong) NSURLSessionTaskMetrics *sessionTaskMetrics AF_API_AVAILABLE(ios(10), macosx(10.12), watchos(3), tvos(10));
 #endif
 @property (nonatomic, copy) AFURLSessionDownloadTaskDidFinishDownloadingBlock downloadTaskDidFinishDownloading;
+@property (nonatomic, copy) AFURLSessionDataTaskDidReceiveDataBlock dataTaskDidReceiveData;
 @property (nonatomic, copy) AFURLSessionTaskProgressBlock uploadProgressBlock;
 @property (nonatomic, copy) AFURLSessionTaskProgressBlock downloadProgressBlock;
 @property (nonatomic, copy) AFURLSessionTaskCompletionHandler completionHandler;
+@property (nonatomic, copy) NSInputStream * (^bodyStreamProvider)(void);
+@property (nonatomic, copy) NSURL *partialDownloadFileURL;
+@property (nonatomic, copy) NSURL *partialDownloadStateURL;
+@property (nonatomic, assign) int64_t partialDownloadFileOffset;
+@property (nonatomic, assign) int partialDownloadFileDescriptor;
+@property (nonatomic, assign, getter = isPartialDownloadPrepared) BOOL partialDownloadPrepared;
+@property (nonatomic, assign, getter = isPartialDownloadComplete) BOOL partialDownloadComplete;
+@property (nonatomic, strong) NSError *partialDownloadError;
+@property (nonatomic, assign) int64_t numberOfResumedBytes;
+@property (nonatomic, copy) NSURL * (^partialDownloadDestination)(NSURL *targetPath, NSURLResponse *response);
+@property (nonatomic, strong) id <AFContentDecoder> contentDecoder;
+@property (nonatomic, assign, getter = isContentDecoderPrepared) BOOL contentDecoderPrepared;
+@property (nonatomic, strong) NSError *contentDecodingError;
 @end
 
 @implementation AFURLSessionManagerTaskDelegate
@@ -142,6 +178,7 @@ typedef void (^AFURLSessionTaskCompletionHandler)(NSURLResponse *response, id re
     }
     
     _mutableData = [NSMutableData data];
+    _partialDownloadFileDescriptor = -1;
     _uploadProgress = [[NSProgress alloc] initWithParent:nil userInfo:nil];
     _downloadProgress = [[NSProgress alloc] initWithParent:nil userInfo:nil];
     
@@ -177,6 +214,10 @@ typedef void (^AFURLSessionTaskCompletionHandler)(NSURLResponse *response, id re
 }
 
 - (void)dealloc {
+    if (_partialDownloadFileDescriptor >= 0) {
+        close(_partialDownloadFileDescriptor);
+    }
+
     [self.downloadProgress removeObserver:self forKeyPath:NSStringFromSelector(@selector(fractionCompleted))];
     [self.uploadProgress removeObserver:self forKeyPath:NSStringFromSelector(@selector(fractionCompleted))];
 }
@@ -198,7 +239,7 @@ typedef void (^AFURLSessionTaskCompletionHandler)(NSURLResponse *response, id re
 
 #pragma mark - NSURLSessionTaskDelegate
 
-- (void)URLSession:(__unused NSURLSession *)session
+- (void)URLSession:(NSURLSession *)session
               task:(NSURLSessionTask *)task
 didCompleteWithError:(NSError *)error
 {
@@ -209,6 +250,17 @@ didCompleteWithError:(NSError *)error
     __block NSMutableDictionary *userInfo = [NSMutableDictionary dictionary];
     userInfo[AFNetworkingTaskDidCompleteResponseSerializerKey] = manager.responseSerializer;
 
+    if (self.partialDownloadFileURL) {
+        error = [self finishPartialDownloadOfTask:task error:error];
+        userInfo[AFNetworkingTaskDidCompleteResumedByteCountKey] = @(self.numberOfResumedBytes);
+    }
+
+    if (self.contentDecodingError) {
+        error = self.contentDecodingError;
+    } else if (self.contentDecoder && !error) {
+        error = [self finishContentDecodingOfTask:(NSURLSessionDataTask *)task session:session];
+    }
+
     //Performance Improvement from #2672
     NSData *data = nil;
     if (self.mutableData) {
@@ -234,19 +286,14 @@ didCompleteWithError:(NSError *)error
     if (error) {
         userInfo[AFNetworkingTaskDidCompleteErrorKey] = error;
 
-        dispatch_group_async(manager.completionGroup ?: url_session_manager_completion_group(), manager.completionQueue ?: dispatch_get_main_queue(), ^{
-            if (self.completionHandler) {
-                self.completionHandler(task.response, responseObject, error);
-            }
-
-            dispatch_async(dispatch_get_main_queue(), ^{
-                [[NSNotificationCenter defaultCenter] postNotificationName:AFNetworkingTaskDidCompleteNotification object:task userInfo:userInfo];
-            });
-        });
+        [self deliverCompletionOfTask:task manager:manager responseObject:responseObject error:error userInfo:userInfo];
     } else {
         dispatch_async(url_session_manager_processing_queue(), ^{
             NSError *serializationError = nil;
-            responseObject = [manager.responseSerializer responseObjectForResponse:task.response data:data error:&serializationError];
+            // The `416` response to a partial download that is already complete is not validated, as the partial file is the response
+            if (![self isPartialDownloadComplete]) {
+                responseObject = [manager.responseSerializer responseObjectForResponse:task.response data:data error:&serializationError];
+            }
 
             if (self.downloadFileURL) {
                 responseObject = self.downloadFileURL;
@@ -260,15 +307,7 @@ didCompleteWithError:(NSError *)error
                 userInfo[AFNetworkingTaskDidCompleteErrorKey] = serializationError;
             }
 
-            dispatch_group_async(manager.completionGroup ?: url_session_manager_completion_group(), manager.completionQueue ?: dispatch_get_main_queue(), ^{
-                if (self.completionHandler) {
-                    self.completionHandler(task.response, responseObject, serializationError);
-                }
-
-                dispatch_async(dispatch_get_main_queue(), ^{
-                    [[NSNotificationCenter defaultCenter] postNotificationName:AFNetworkingTaskDidCompleteNotification object:task userInfo:userInfo];
-                });
-            });
+            [self deliverCompletionOfTask:task manager:manager responseObject:responseObject error:serializationError userInfo:userInfo];
         });
     }
 }
@@ -283,12 +322,65 @@ didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics AF_API_AVAILABLE(i
 
 #pragma mark - NSURLSessionDataDelegate
 
-- (void)URLSession:(__unused NSURLSession *)session
-          dataTask:(__unused NSURLSessionDataTask *)dataTask
+- (void)URLSession:(NSURLSession *)session
+          dataTask:(NSURLSessionDataTask *)dataTask
     didReceiveData:(NSData *)data
 {
-    self.downloadProgress.totalUnitCount = dataTask.countOfBytesExpectedToReceive;
-    self.downloadProgress.completedUnitCount = dataTask.countOfBytesReceived;
+    if (self.partialDownloadFileURL && ![self isPartialDownloadPrepared]) {
+        [self preparePartialDownloadForTask:dataTask];
+    }
+
+    if ([self isPartialDownloadComplete]) {
+        return;
+    }
+
+    int64_t numberOfResumedBytes = self.numberOfResumedBytes;
+    self.downloadProgress.totalUnitCount = dataTask.countOfBytesExpectedToReceive == NSURLSessionTransferSizeUnknown ? NSURLSessionTransferSizeUnknown : dataTask.countOfBytesExpectedToReceive + numberOfResumedBytes;
+    self.downloadProgress.completedUnitCount = dataTask.countOfBytesReceived + numberOfResumedBytes;
+
+    if (self.partialDownloadFileDescriptor >= 0) {
+        NSError *writeError = nil;
+        if (![self writePartialDownloadData:data error:&writeError]) {
+            [self closePartialDownloadFile];
+            self.partialDownloadError = writeError;
+            [dataTask cancel];
+        }
+
+        return;
+    }
+
+    if (![self isContentDecoderPrepared]) {
+        [self prepareContentDecoderForTask:dataTask];
+    }
+
+    if (self.contentDecoder) {
+        NSError *decodingError = nil;
+        data = [self.contentDecoder decodedDataFromData:data error:&decodingError];
+        if (!data) {
+            self.contentDecoder = nil;
+            self.contentDecodingError = decodingError;
+            [dataTask cancel];
+            return;
+        }
+    } else if (self.contentDecodingError) {
+        return;
+    }
+
+    [self didReceiveDecodedData:data dataTask:dataTask session:session];
+}
+
+- (void)didReceiveDecodedData:(NSData *)data
+                     dataTask:(NSURLSessionDataTask *)dataTask
+                      session:(NSURLSession *)session
+{
+    if ([data length] == 0) {
+        return;
+    }
+
+    if (self.dataTaskDidReceiveData) {
+        self.dataTaskDidReceiveData(session, dataTask, data);
+        return;
+    }
 
     [self.mutableData appendData:data];
 }
@@ -302,6 +394,224 @@ totalBytesExpectedToSend:(int64_t)totalBytesExpectedToSend{
     self.uploadProgress.completedUnitCount = task.countOfBytesSent;
 }
 
+#pragma mark - Completion Delivery
+
+//在回调队列上执行completionHandler，然后在主队列上发出完成通知；设置了completionCoalescer时交给它分批执行
+- (void)deliverCompletionOfTask:(NSURLSessionTask *)task
+                        manager:(AFURLSessionManager *)manager
+                 responseObject:(id)responseObject
+                          error:(NSError *)error
+                       userInfo:(NSDictionary *)userInfo
+{
+    dispatch_group_t group = manager.completionGroup ?: url_session_manager_completion_group();
+    AFCompletionCoalescer *coalescer = manager.completionCoalescer;
+    dispatch_queue_t mainQueue = dispatch_get_main_queue();
+    BOOL postsNotificationInBatch = coalescer.queue == mainQueue;
+
+    dispatch_block_t completion = ^{
+        if (self.completionHandler) {
+            self.completionHandler(task.response, responseObject, error);
+        }
+
+        if (postsNotificationInBatch) {
+            [[NSNotificationCenter defaultCenter] postNotificationName:AFNetworkingTaskDidCompleteNotification object:task userInfo:userInfo];
+        } else {
+            dispatch_async(mainQueue, ^{
+                [[NSNotificationCenter defaultCenter] postNotificationName:AFNetworkingTaskDidCompleteNotification object:task userInfo:userInfo];
+            });
+        }
+    };
+
+    if (coalescer) {
+        [coalescer enqueueBlock:completion group:group];
+    } else {
+        dispatch_group_async(group, manager.completionQueue ?: mainQueue, completion);
+    }
+}
+
+#pragma mark - Content Decoding
+
+//收到第一块数据时根据响应选择解码器；可恢复下载写入文件的是原始数据，不解码
+- (void)prepareContentDecoderForTask:(NSURLSessionDataTask *)dataTask {
+    self.contentDecoderPrepared = YES;
+
+    AFContentDecoderRegistry *registry = self.manager.contentDecoderRegistry;
+    if (!registry || self.partialDownloadFileURL) {
+        return;
+    }
+
+    NSError *decodingError = nil;
+    self.contentDecoder = [registry decoderForResponse:dataTask.response error:&decodingError];
+    if (decodingError) {
+        self.contentDecodingError = decodingError;
+        [dataTask cancel];
+    }
+}
+
+//任务成功结束时取出解码器中剩余的数据，编码数据不完整时返回错误
+- (NSError *)finishContentDecodingOfTask:(NSURLSessionDataTask *)dataTask
+                                 session:(NSURLSession *)session
+{
+    NSError *decodingError = nil;
+    NSData *data = [self.contentDecoder finishDecoding:&decodingError];
+    self.contentDecoder = nil;
+    if (!data) {
+        return decodingError;
+    }
+
+    [self didReceiveDecodedData:data dataTask:dataTask session:session];
+
+    return nil;
+}
+
+#pragma mark - Resumable Downloads
+
+//根据响应决定接收到的数据如何写入未完成文件：206续写，其他成功响应从头写入，失败响应的数据留给响应序列化；416表示未完成文件已经是完整的资源时直接完成下载
+- (void)preparePartialDownloadForTask:(NSURLSessionTask *)task {
+    self.partialDownloadPrepared = YES;
+
+    if (![task.response isKindOfClass:[NSHTTPURLResponse class]]) {
+        return;
+    }
+
+    NSHTTPURLResponse *response = (NSHTTPURLResponse *)task.response;
+    int64_t offset = 0;
+    if (response.statusCode == 206) {
+        // Only a continuation of the partial file may be appended to it. Once the partial file is removed, a new task for the request downloads the resource from the start
+        if (self.partialDownloadFileOffset == 0 || AFContentRangeStartOfResponse(response) != self.partialDownloadFileOffset) {
+            [self removePartialDownload];
+            self.partialDownloadError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadServerResponse userInfo:@{NSLocalizedDescriptionKey: NSLocalizedStringFromTable(@"The partial content returned by the server does not continue the partial download.", @"AFNetworking", nil), NSURLErrorFailingURLErrorKey: task.originalRequest.URL}];
+            [task cancel];
+            return;
+        }
+
+        offset = self.partialDownloadFileOffset;
+    } else if (response.statusCode == 416) {
+        // The range starting at the end of the partial file is unsatisfiable when the partial file already holds the whole representation
+        if (self.partialDownloadFileOffset > 0 && AFContentRangeCompleteLengthOfResponse(response) == self.partialDownloadFileOffset) {
+            self.partialDownloadComplete = YES;
+            self.numberOfResumedBytes = self.partialDownloadFileOffset;
+            return;
+        }
+
+        [self removePartialDownload];
+        return;
+    } else if (response.statusCode < 200 || response.statusCode >= 300) {
+        return;
+    } else {
+        // The validators are recorded before any of the new representation is written, so the partial file always matches them
+        NSMutableDictionary *state = [NSMutableDictionary dictionary];
+        state[AFResumableDownloadStateURLKey] = [task.originalRequest.URL absoluteString];
+        state[AFResumableDownloadStateETagKey] = [response allHeaderFields][@"ETag"];
+        state[AFResumableDownloadStateLastModifiedKey] = [response allHeaderFields][@"Last-Modified"];
+
+        [[NSFileManager defaultManager] removeItemAtURL:self.partialDownloadStateURL error:nil];
+        if (state[AFResumableDownloadStateETagKey] || state[AFResumableDownloadStateLastModifiedKey]) {
+            [[NSFileManager defaultManager] createDirectoryAtURL:[self.partialDownloadStateURL URLByDeletingLastPathComponent] withIntermediateDirectories:YES attributes:nil error:nil];
+            NSData *data = [NSPropertyListSerialization dataWithPropertyList:state format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+            [data writeToURL:self.partialDownloadStateURL atomically:YES];
+        }
+    }
+
+    int fileDescriptor = open([[self.partialDownloadFileURL path] fileSystemRepresentation], O_WRONLY | O_CREAT, 0644);
+    if (fileDescriptor < 0 || ftruncate(fileDescriptor, offset) != 0 || lseek(fileDescriptor, offset, SEEK_SET) < 0) {
+        self.partialDownloadError = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:@{NSURLErrorKey: self.partialDownloadFileURL}];
+        if (fileDescriptor >= 0) {
+            close(fileDescriptor);
+        }
+        [task cancel];
+        return;
+    }
+
+    self.partialDownloadFileDescriptor = fileDescriptor;
+    self.numberOfResumedBytes = offset;
+}
+
+- (BOOL)writePartialDownloadData:(NSData *)data
+                           error:(NSError * __autoreleasing *)error
+{
+    __block int errorCode = 0;
+    [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+        NSUInteger numberOfBytesWritten = 0;
+        while (numberOfBytesWritten < byteRange.length) {
+            ssize_t result = write(self.partialDownloadFileDescriptor, (const uint8_t *)bytes + numberOfBytesWritten, byteRange.length - numberOfBytesWritten);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                errorCode = errno;
+                *stop = YES;
+                return;
+            }
+
+            numberOfBytesWritten += (NSUInteger)result;
+        }
+    }];
+
+    if (errorCode != 0) {
+        if (error) {
+            *error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errorCode userInfo:@{NSURLErrorKey: self.partialDownloadFileURL}];
+        }
+
+        return NO;
+    }
+
+    return YES;
+}
+
+- (void)closePartialDownloadFile {
+    if (self.partialDownloadFileDescriptor >= 0) {
+        close(self.partialDownloadFileDescriptor);
+        self.partialDownloadFileDescriptor = -1;
+    }
+}
+
+- (void)removePartialDownload {
+    [self closePartialDownloadFile];
+    [[NSFileManager defaultManager] removeItemAtURL:self.partialDownloadFileURL error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:self.partialDownloadStateURL error:nil];
+}
+
+//任务结束时关闭未完成文件；失败时文件保留用于下次恢复，成功时移动到目标路径
+- (NSError *)finishPartialDownloadOfTask:(NSURLSessionTask *)task
+                                   error:(NSError *)error
+{
+    if (!error && ![self isPartialDownloadPrepared]) {
+        [self preparePartialDownloadForTask:task];
+    }
+
+    if (self.partialDownloadError) {
+        [self closePartialDownloadFile];
+        return self.partialDownloadError;
+    }
+
+    if ((self.partialDownloadFileDescriptor < 0 && ![self isPartialDownloadComplete]) || error) {
+        [self closePartialDownloadFile];
+        return error;
+    }
+
+    [self closePartialDownloadFile];
+
+    NSURL *destinationURL = self.partialDownloadDestination ? self.partialDownloadDestination(self.partialDownloadFileURL, task.response) : nil;
+    if (!destinationURL) {
+        [self removePartialDownload];
+        return nil;
+    }
+
+    self.downloadFileURL = destinationURL;
+
+    NSError *fileManagerError = nil;
+    if (![[NSFileManager defaultManager] moveItemAtURL:self.partialDownloadFileURL toURL:destinationURL error:&fileManagerError]) {
+        [[NSNotificationCenter defaultCenter] postNotificationName:AFURLSessionDownloadTaskDidFailToMoveFileNotification object:task userInfo:fileManagerError.userInfo];
+        return nil;
+    }
+
+    [[NSFileManager defaultManager] removeItemAtURL:self.partialDownloadStateURL error:nil];
+
+    return nil;
+}
+
 #pragma mark - NSURLSessionDownloadDelegate
 
 - (void)URLSession:(NSURLSession *)session downloadTask:(NSURLSessionDownloadTask *)downloadTask
@@ -530,6 +840,9 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
     //创建锁
     self.lock = [[NSLock alloc] init];
     self.lock.name = AFURLSessionManagerLockName;
+
+    NSURL *cachesDirectoryURL = [[[NSFileManager defaultManager] URLsForDirectory:NSCachesDirectory inDomains:NSUserDomainMask] firstObject];
+    self.resumableDownloadsDirectoryURL = [cachesDirectoryURL URLByAppendingPathComponent:@"com.alamofire.networking.resumable-downloads" isDirectory:YES];
     //获取任务
     [self.session getTasksWithCompletionHandler:^(NSArray *dataTasks, NSArray *uploadTasks, NSArray *downloadTasks) {
         for (NSURLSessionDataTask *task in dataTasks) {
@@ -758,6 +1071,26 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
 
 #pragma mark -
 
+- (NSURLRequest *)requestByThrottlingRequest:(NSURLRequest *)request
+                                  bodyStream:(NSInputStream *)bodyStream
+                               contentLength:(unsigned long long)contentLength
+{
+    NSMutableURLRequest *mutableRequest = [request mutableCopy];
+    mutableRequest.HTTPBodyStream = [self.uploadBandwidthThrottle inputStreamByThrottlingInputStream:bodyStream];
+    if (contentLength > 0 && ![mutableRequest valueForHTTPHeaderField:@"Content-Length"]) {
+        [mutableRequest setValue:[NSString stringWithFormat:@"%llu", contentLength] forHTTPHeaderField:@"Content-Length"];
+    }
+
+    return mutableRequest;
+}
+
+- (BOOL)shouldThrottleUploadsByStreaming {
+    // Background sessions can only upload from files, which are read out of process
+    return self.uploadBandwidthThrottle && !self.session.configuration.identifier;
+}
+
+#pragma mark -
+
 - (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
                             completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
 {
@@ -769,6 +1102,10 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
                              downloadProgress:(nullable void (^)(NSProgress *downloadProgress)) downloadProgressBlock
                             completionHandler:(nullable void (^)(NSURLResponse *response, id _Nullable responseObject,  NSError * _Nullable error))completionHandler {
 
+    if (self.uploadBandwidthThrottle && request.HTTPBodyStream) {
+        request = [self requestByThrottlingRequest:request bodyStream:request.HTTPBodyStream contentLength:0];
+    }
+
     __block NSURLSessionDataTask *dataTask = nil;
     url_session_manager_create_task_safely(^{
         dataTask = [self.session dataTaskWithRequest:request];
@@ -779,6 +1116,39 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
     return dataTask;
 }
 
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                               uploadProgress:(void (^)(NSProgress *uploadProgress))uploadProgressBlock
+                             downloadProgress:(void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                               didReceiveData:(void (^)(NSURLSessionDataTask *dataTask, NSData *data))didReceiveDataBlock
+                            completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
+{
+    NSParameterAssert(didReceiveDataBlock);
+
+    NSURLSessionDataTask *dataTask = [self dataTaskWithRequest:request uploadProgress:uploadProgressBlock downloadProgress:downloadProgressBlock completionHandler:completionHandler];
+    [self delegateForTask:dataTask].dataTaskDidReceiveData = ^(NSURLSession * __unused session, NSURLSessionDataTask *task, NSData *data) {
+        didReceiveDataBlock(task, data);
+    };
+
+    return dataTask;
+}
+
+- (NSURLSessionDataTask *)dataTaskWithRequest:(NSURLRequest *)request
+                               responseStream:(AFURLResponseStream *)stream
+                            completionHandler:(void (^)(NSURLResponse *response, NSError *error))completionHandler
+{
+    NSParameterAssert(stream);
+
+    return [self dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil didReceiveData:^(NSURLSessionDataTask *dataTask, NSData *data) {
+        [stream dataTask:dataTask didReceiveData:data];
+    } completionHandler:^(NSURLResponse *response, id __unused responseObject, NSError *error) {
+        [stream finishWithError:error completionHandler:^(NSError *streamError) {
+            if (completionHandler) {
+                completionHandler(response, streamError);
+            }
+        }];
+    }];
+}
+
 #pragma mark -
 
 - (NSURLSessionUploadTask *)uploadTaskWithRequest:(NSURLRequest *)request
@@ -786,6 +1156,16 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
                                          progress:(void (^)(NSProgress *uploadProgress)) uploadProgressBlock
                                 completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
 {
+    if ([self shouldThrottleUploadsByStreaming]) {
+        NSNumber *fileSize = nil;
+        [fileURL getResourceValue:&fileSize forKey:NSURLFileSizeKey error:nil];
+        NSURLRequest *streamedRequest = [self requestByThrottlingRequest:request bodyStream:[NSInputStream inputStreamWithURL:fileURL] contentLength:[fileSize unsignedLongLongValue]];
+
+        return [self uploadTaskWithStreamedRequest:streamedRequest progress:uploadProgressBlock bodyStreamProvider:^NSInputStream *{
+            return [NSInputStream inputStreamWithURL:fileURL];
+        } completionHandler:completionHandler];
+    }
+
     __block NSURLSessionUploadTask *uploadTask = nil;
     url_session_manager_create_task_safely(^{
         uploadTask = [self.session uploadTaskWithRequest:request fromFile:fileURL];
@@ -812,6 +1192,14 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
                                          progress:(void (^)(NSProgress *uploadProgress)) uploadProgressBlock
                                 completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
 {
+    if ([self shouldThrottleUploadsByStreaming]) {
+        NSURLRequest *streamedRequest = [self requestByThrottlingRequest:request bodyStream:[NSInputStream inputStreamWithData:bodyData] contentLength:[bodyData length]];
+
+        return [self uploadTaskWithStreamedRequest:streamedRequest progress:uploadProgressBlock bodyStreamProvider:^NSInputStream *{
+            return [NSInputStream inputStreamWithData:bodyData];
+        } completionHandler:completionHandler];
+    }
+
     __block NSURLSessionUploadTask *uploadTask = nil;
     url_session_manager_create_task_safely(^{
         uploadTask = [self.session uploadTaskWithRequest:request fromData:bodyData];
@@ -826,12 +1214,26 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
                                                  progress:(void (^)(NSProgress *uploadProgress)) uploadProgressBlock
                                         completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
 {
+    return [self uploadTaskWithStreamedRequest:request progress:uploadProgressBlock bodyStreamProvider:nil completionHandler:completionHandler];
+}
+
+- (NSURLSessionUploadTask *)uploadTaskWithStreamedRequest:(NSURLRequest *)request
+                                                 progress:(void (^)(NSProgress *uploadProgress)) uploadProgressBlock
+                                       bodyStreamProvider:(NSInputStream * (^)(void))bodyStreamProvider
+                                        completionHandler:(void (^)(NSURLResponse *response, id responseObject, NSError *error))completionHandler
+{
+    if (self.uploadBandwidthThrottle && request.HTTPBodyStream) {
+        request = [self requestByThrottlingRequest:request bodyStream:request.HTTPBodyStream contentLength:0];
+    }
+
     __block NSURLSessionUploadTask *uploadTask = nil;
     url_session_manager_create_task_safely(^{
         uploadTask = [self.session uploadTaskWithStreamedRequest:request];
     });
 
     [self addDelegateForUploadTask:uploadTask progress:uploadProgressBlock completionHandler:completionHandler];
+    // File and data bodies streamed for throttling cannot be copied, so a new stream is opened when the body has to be sent again
+    [self delegateForTask:uploadTask].bodyStreamProvider = bodyStreamProvider;
 
     return uploadTask;
 }
@@ -868,6 +1270,68 @@ static NSString * const AFNSURLSessionTaskDidSuspendNotification = @"com.alamofi
     return downloadTask;
 }
 
+#pragma mark -
+
+- (NSURL *)partialDownloadFileURLForRequest:(NSURLRequest *)request {
+    return [self.resumableDownloadsDirectoryURL URLByAppendingPathComponent:[AFResumableDownloadNameForURL(request.URL) stringByAppendingPathExtension:@"partial"]];
+}
+
+- (NSURL *)partialDownloadStateURLForRequest:(NSURLRequest *)request {
+    return [self.resumableDownloadsDirectoryURL URLByAppendingPathComponent:[AFResumableDownloadNameForURL(request.URL) stringByAppendingPathExtension:@"plist"]];
+}
+
+- (NSURLSessionDataTask *)resumableDownloadTaskWithRequest:(NSURLRequest *)request
+                                                  progress:(void (^)(NSProgress *downloadProgress))downloadProgressBlock
+                                               destination:(NSURL * (^)(NSURL *targetPath, NSURLResponse *response))destination
+                                         completionHandler:(void (^)(NSURLResponse *response, NSURL *filePath, NSError *error))completionHandler
+{
+    NSURL *partialFileURL = [self partialDownloadFileURLForRequest:request];
+    NSURL *stateURL = [self partialDownloadStateURLForRequest:request];
+
+    NSData *stateData = [NSData dataWithContentsOfURL:stateURL];
+    NSDictionary *state = stateData ? [NSPropertyListSerialization propertyListWithData:stateData options:NSPropertyListImmutable format:NULL error:nil] : nil;
+    NSNumber *partialFileSize = nil;
+    [partialFileURL getResourceValue:&partialFileSize forKey:NSURLFileSizeKey error:nil];
+
+    NSString *validator = nil;
+    if ([state isKindOfClass:[NSDictionary class]] && [state[AFResumableDownloadStateURLKey] isEqual:[request.URL absoluteString]]) {
+        validator = AFRangeValidatorForRepresentation(state[AFResumableDownloadStateETagKey], state[AFResumableDownloadStateLastModifiedKey]);
+    }
+
+    int64_t offset = 0;
+    NSMutableURLRequest *mutableRequest = [request mutableCopy];
+    if ([validator isKindOfClass:[NSString class]] && [partialFileSize longLongValue] > 0) {
+        offset = [partialFileSize longLongValue];
+        [mutableRequest setValue:[NSString stringWithFormat:@"bytes=%lld-", offset] forHTTPHeaderField:@"Range"];
+        [mutableRequest setValue:validator forHTTPHeaderField:@"If-Range"];
+    }
+
+    __block NSURLSessionDataTask *dataTask = nil;
+    url_session_manager_create_task_safely(^{
+        dataTask = [self.session dataTaskWithRequest:mutableRequest];
+    });
+
+    AFURLSessionManagerTaskDelegate *delegate = [[AFURLSessionManagerTaskDelegate alloc] initWithTask:dataTask];
+    delegate.manager = self;
+    delegate.completionHandler = completionHandler;
+    delegate.partialDownloadFileURL = partialFileURL;
+    delegate.partialDownloadStateURL = stateURL;
+    delegate.partialDownloadFileOffset = offset;
+    delegate.partialDownloadDestination = destination;
+
+    dataTask.taskDescription = self.taskDescriptionForSessionTasks;
+    [self setDelegate:delegate forTask:dataTask];
+
+    delegate.downloadProgressBlock = downloadProgressBlock;
+
+    return dataTask;
+}
+
+- (void)removeResumableDownloadForRequest:(NSURLRequest *)request {
+    [[NSFileManager defaultManager] removeItemAtURL:[self partialDownloadFileURLForRequest:request] error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:[self partialDownloadStateURLForRequest:request] error:nil];
+}
+
 #pragma mark -
 - (NSProgress *)uploadProgressForTask:(NSURLSessionTask *)task {
     return [[self delegateForTask:task] uploadProgress];
@@ -1072,12 +1536,19 @@ didReceiveChallenge:(NSURLAuthenticationChallenge *)challenge
 {
     NSInputStream *inputStream = nil;
 
+    NSInputStream * (^bodyStreamProvider)(void) = [self delegateForTask:task].bodyStreamProvider;
     if (self.taskNeedNewBodyStream) {
         inputStream = self.taskNeedNewBodyStream(session, task);
+    } else if (bodyStreamProvider) {
+        inputStream = bodyStreamProvider();
     } else if (task.originalRequest.HTTPBodyStream && [task.originalRequest.HTTPBodyStream conformsToProtocol:@protocol(NSCopying)]) {
         inputStream = [task.originalRequest.HTTPBodyStream copy];
     }
 
+    if (inputStream && self.uploadBandwidthThrottle) {
+        inputStream = [self.uploadBandwidthThrottle inputStreamByThrottlingInputStream:inputStream];
+    }
+
     if (completionHandler) {
         completionHandler(inputStream);
     }
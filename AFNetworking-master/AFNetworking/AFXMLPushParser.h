@@ -0,0 +1,246 @@
+// AFXMLPushParser.h
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ `AFXMLElement` is an immutable XML element and its descendants, as built from a subtree of a document by an `AFXMLElementStream`.
+
+ Names are qualified names as they appear in the document; namespace prefixes are not resolved.
+ */
+@interface AFXMLElement : NSObject
+
+/**
+ The qualified name of the element.
+ */
+@property (readonly, nonatomic, copy) NSString *name;
+
+/**
+ The attributes of the element, keyed by qualified name, with references replaced.
+ */
+@property (readonly, nonatomic, copy) NSDictionary <NSString *, NSString *> *attributes;
+
+/**
+ The child elements of the element, in document order.
+ */
+@property (readonly, nonatomic, copy) NSArray <AFXMLElement *> *children;
+
+/**
+ The character data directly inside the element, including CDATA sections, with references replaced. The text of child elements is not included.
+ */
+@property (readonly, nonatomic, copy) NSString *text;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Creates and returns an element.
+
+ @param name The qualified name of the element.
+ @param attributes The attributes of the element.
+ @param children The child elements of the element.
+ @param text The character data directly inside the element.
+ */
+- (instancetype)initWithName:(NSString *)name
+                  attributes:(nullable NSDictionary <NSString *, NSString *> *)attributes
+                    children:(nullable NSArray <AFXMLElement *> *)children
+                        text:(nullable NSString *)text NS_DESIGNATED_INITIALIZER;
+
+/**
+ Returns the first child element with the specified name, if any.
+
+ @param name The qualified name of the child element.
+ */
+- (nullable AFXMLElement *)firstChildNamed:(NSString *)name;
+
+/**
+ Returns the child elements with the specified name, in document order.
+
+ @param name The qualified name of the child elements.
+ */
+- (NSArray <AFXMLElement *> *)childrenNamed:(NSString *)name;
+
+@end
+
+#pragma mark -
+
+/**
+ The types of events reported by an `AFXMLPushParser`.
+
+ - `AFXMLEventTypeStartElement`: The start tag of an element, or an empty element.
+ - `AFXMLEventTypeEndElement`: The end tag of an element, or the end of an empty element.
+ - `AFXMLEventTypeText`: Character data, including CDATA sections. The text of an element may be split across several events.
+ */
+typedef NS_ENUM(NSUInteger, AFXMLEventType) {
+    AFXMLEventTypeStartElement = 0,
+    AFXMLEventTypeEndElement,
+    AFXMLEventTypeText,
+};
+
+/**
+ `AFXMLEvent` is an event reported by an `AFXMLPushParser`, as delivered by an `AFXMLEventStream`.
+ */
+@interface AFXMLEvent : NSObject
+
+/**
+ The type of the event.
+ */
+@property (readonly, nonatomic, assign) AFXMLEventType type;
+
+/**
+ The qualified name of the element the event starts or ends, or `nil` for text.
+ */
+@property (readonly, nonatomic, copy, nullable) NSString *name;
+
+/**
+ The attributes of the element started by the event, or `nil` for other events.
+ */
+@property (readonly, nonatomic, copy, nullable) NSDictionary <NSString *, NSString *> *attributes;
+
+/**
+ The character data of a text event, or `nil` for other events.
+ */
+@property (readonly, nonatomic, copy, nullable) NSString *text;
+
+/**
+ The number of elements open when the event occurred, counting the element a start or end event is for. The root element has a depth of `1`.
+ */
+@property (readonly, nonatomic, assign) NSUInteger depth;
+
+- (instancetype)init NS_UNAVAILABLE;
+
+/**
+ Creates and returns an event.
+
+ @param type The type of the event.
+ @param name The qualified name of the element the event starts or ends.
+ @param attributes The attributes of the element started by the event.
+ @param text The character data of a text event.
+ @param depth The number of elements open when the event occurred.
+ */
+- (instancetype)initWithType:(AFXMLEventType)type
+                        name:(nullable NSString *)name
+                  attributes:(nullable NSDictionary <NSString *, NSString *> *)attributes
+                        text:(nullable NSString *)text
+                       depth:(NSUInteger)depth NS_DESIGNATED_INITIALIZER;
+
+@end
+
+#pragma mark -
+
+@class AFXMLPushParser;
+
+/**
+ The `AFXMLPushParserDelegate` protocol defines the methods an `AFXMLPushParser` calls as it parses the data pushed to it. Methods are called on the thread data is pushed from.
+ */
+@protocol AFXMLPushParserDelegate <NSObject>
+
+@optional
+
+/**
+ Called when the parser finds the start tag of an element, or an empty element.
+
+ @param parser The parser.
+ @param elementName The qualified name of the element.
+ @param attributes The attributes of the element, keyed by qualified name.
+ */
+- (void)parser:(AFXMLPushParser *)parser
+didStartElement:(NSString *)elementName
+    attributes:(NSDictionary <NSString *, NSString *> *)attributes;
+
+/**
+ Called when the parser finds the end tag of an element, or the end of an empty element.
+
+ @param parser The parser.
+ @param elementName The qualified name of the element.
+ */
+- (void)parser:(AFXMLPushParser *)parser
+ didEndElement:(NSString *)elementName;
+
+/**
+ Called with character data inside the root element, including CDATA sections and whitespace. The text between two tags may be reported in several calls, as it is received.
+
+ @param parser The parser.
+ @param string The character data, with references replaced.
+ */
+- (void)parser:(AFXMLPushParser *)parser
+foundCharacters:(NSString *)string;
+
+@end
+
+/**
+ `AFXMLPushParser` is an event-driven XML parser that parses data as it is pushed to it, chunk by chunk, rather than once the whole document has been received as `NSXMLParser` does. Only the bytes of a tag split across chunks are kept between calls, so the memory used by the parser does not grow with the size of the document; text and CDATA sections are reported as they are received.
+
+ The parser checks that the document is well formed: elements must be properly nested, with a single root element, and attribute values must be quoted. Documents must be encoded in UTF-8; the predefined entities and character references are replaced, document type declarations are skipped, and other entity references fail to parse. Comments and processing instructions are skipped.
+
+ Errors are in `NSXMLParserErrorDomain`, with an `NSXMLParserError` code, such as `NSXMLParserTagNameMismatchError` or `NSXMLParserPrematureDocumentEndError`.
+ */
+@interface AFXMLPushParser : NSObject
+
+/**
+ The delegate of the parser.
+ */
+@property (nonatomic, weak, nullable) id <AFXMLPushParserDelegate> delegate;
+
+/**
+ The longest tag or document type declaration the parser keeps while waiting for the rest of it, in bytes. Longer markup fails to parse, which bounds the memory used by malformed or hostile documents. `1 MB` by default.
+ */
+@property (nonatomic, assign) NSUInteger maximumTokenLength;
+
+/**
+ The number of elements currently open. In the delegate methods for an element, this is the number of its ancestors, `0` for the root element.
+ */
+@property (readonly, nonatomic, assign) NSUInteger depth;
+
+/**
+ The error the parser failed with, if any.
+ */
+@property (readonly, nonatomic, strong, nullable) NSError *parserError;
+
+/**
+ Parses the next chunk of the document. Must be called serially, in the order data is received.
+
+ @param data The data received.
+ @param error The error that occurred if the document is not well formed, or parsing was aborted.
+
+ @return `YES` if the data was parsed, `NO` if an error occurred, in which case the parser does not parse any more data.
+ */
+- (BOOL)parseData:(NSData *)data
+            error:(NSError * _Nullable __autoreleasing *)error;
+
+/**
+ Finishes parsing once the whole document has been received.
+
+ @param error The error that occurred if the document is empty or not complete.
+
+ @return `YES` if the document was complete and well formed.
+ */
+- (BOOL)finishParsing:(NSError * _Nullable __autoreleasing *)error;
+
+/**
+ Stops parsing. Can be called from a delegate method; the current call to `-parseData:error:` then fails with `NSXMLParserDelegateAbortedParseError`.
+ */
+- (void)abortParsing;
+
+@end
+
+NS_ASSUME_NONNULL_END
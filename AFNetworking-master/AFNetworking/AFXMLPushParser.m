@@ -0,0 +1,1046 @@
+// AFXMLPushParser.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFXMLPushParser.h"
+
+static NSUInteger const AFXMLPushParserDefaultMaximumTokenLength = 1024 * 1024;
+static NSUInteger const AFXMLNameCacheSize = 256;
+static NSUInteger const AFXMLMaximumCachedNameLength = 32;
+
+#pragma mark - Scanning
+
+static NSUInteger const AFXMLScannerMaximumDepth = 1024;
+
+typedef NS_ENUM(NSUInteger, AFXMLScannerMode) {
+    AFXMLScannerModeContent = 0,
+    AFXMLScannerModeComment,
+    AFXMLScannerModeCDATA,
+    AFXMLScannerModeProcessingInstruction,
+};
+
+typedef struct {
+    const uint8_t *name;
+    NSUInteger nameLength;
+    NSUInteger valueOffset;
+    NSUInteger valueLength;
+} AFXMLScannerAttribute;
+
+typedef struct AFXMLScanner AFXMLScanner;
+
+// Each handler returns `NO` to stop the scanner, after setting its error
+typedef struct {
+    BOOL (*startElement)(AFXMLScanner *scanner, const uint8_t *name, NSUInteger nameLength, const AFXMLScannerAttribute *attributes, NSUInteger numberOfAttributes, const uint8_t *values);
+    BOOL (*endElement)(AFXMLScanner *scanner, const uint8_t *name, NSUInteger nameLength);
+    BOOL (*text)(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length);
+} AFXMLScannerHandlers;
+
+struct AFXMLScanner {
+    void *context;
+    AFXMLScannerHandlers handlers;
+    NSUInteger maximumTokenLength;
+
+    AFXMLScannerMode mode;
+    BOOL startedDocument;
+    BOOL foundRoot;
+
+    // The bytes of a token split across chunks
+    uint8_t *pending;
+    NSUInteger pendingLength;
+    NSUInteger pendingCapacity;
+
+    // Decoded text and attribute values
+    uint8_t *scratch;
+    NSUInteger scratchLength;
+    NSUInteger scratchCapacity;
+
+    AFXMLScannerAttribute *attributes;
+    NSUInteger attributesCapacity;
+
+    // The names of the open elements, one after the other, and where each starts
+    uint8_t *names;
+    NSUInteger namesLength;
+    NSUInteger namesCapacity;
+    NSUInteger *nameOffsets;
+    NSUInteger depth;
+    NSUInteger nameOffsetsCapacity;
+
+    // The offset in the document of the first byte being scanned
+    unsigned long long offset;
+
+    NSInteger errorCode;
+    const char *errorReason;
+    unsigned long long errorOffset;
+};
+
+static BOOL AFXMLScannerFail(AFXMLScanner *scanner, NSInteger code, const char *reason, unsigned long long offset) {
+    if (!scanner->errorReason) {
+        scanner->errorCode = code;
+        scanner->errorReason = reason;
+        scanner->errorOffset = offset;
+    }
+
+    return NO;
+}
+
+static NSInteger AFXMLScannerFailToken(AFXMLScanner *scanner, NSInteger code, const char *reason, unsigned long long offset) {
+    AFXMLScannerFail(scanner, code, reason, offset);
+
+    return -1;
+}
+
+static void AFXMLScannerReserve(uint8_t **buffer, NSUInteger *capacity, NSUInteger length) {
+    if (length > *capacity) {
+        NSUInteger newCapacity = MAX(MAX(*capacity * 2, length), (NSUInteger)256);
+        *buffer = realloc(*buffer, newCapacity);
+        *capacity = newCapacity;
+    }
+}
+
+static void AFXMLScannerInitialize(AFXMLScanner *scanner, AFXMLScannerHandlers handlers, void *context, NSUInteger maximumTokenLength) {
+    memset(scanner, 0, sizeof(AFXMLScanner));
+    scanner->handlers = handlers;
+    scanner->context = context;
+    scanner->maximumTokenLength = maximumTokenLength;
+}
+
+static void AFXMLScannerDestroy(AFXMLScanner *scanner) {
+    free(scanner->pending);
+    free(scanner->scratch);
+    free(scanner->attributes);
+    free(scanner->names);
+    free(scanner->nameOffsets);
+}
+
+static inline BOOL AFXMLIsWhitespace(uint8_t c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline BOOL AFXMLIsNameDelimiter(uint8_t c) {
+    return AFXMLIsWhitespace(c) || c == '/' || c == '>' || c == '=' || c == '<' || c == '"' || c == '\'' || c == '&';
+}
+
+static const uint8_t * AFXMLFind(const uint8_t *bytes, const uint8_t *end, const char *needle, NSUInteger needleLength) {
+    while (bytes + needleLength <= end) {
+        const uint8_t *candidate = memchr(bytes, needle[0], (size_t)(end - bytes) - needleLength + 1);
+        if (!candidate) {
+            return NULL;
+        }
+
+        if (memcmp(candidate, needle, needleLength) == 0) {
+            return candidate;
+        }
+
+        bytes = candidate + 1;
+    }
+
+    return NULL;
+}
+
+static BOOL AFXMLHasPrefix(const uint8_t *bytes, const uint8_t *end, const char *prefix, NSUInteger prefixLength, BOOL *isPartial) {
+    NSUInteger length = MIN((NSUInteger)(end - bytes), prefixLength);
+    if (memcmp(bytes, prefix, length) != 0) {
+        return NO;
+    }
+
+    *isPartial = length < prefixLength;
+
+    return YES;
+}
+
+// The length of the longest prefix of the bytes not ending in the middle of a UTF-8 sequence
+static NSUInteger AFXMLCompleteUTF8Length(const uint8_t *bytes, NSUInteger length) {
+    for (NSUInteger idx = 1; idx <= MIN(length, (NSUInteger)3); idx++) {
+        uint8_t c = bytes[length - idx];
+        if ((c & 0xC0) == 0x80) {
+            continue;
+        }
+
+        NSUInteger sequenceLength = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+
+        return sequenceLength > idx ? length - idx : length;
+    }
+
+    return length;
+}
+
+static void AFXMLScannerAppendScratch(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length) {
+    AFXMLScannerReserve(&scanner->scratch, &scanner->scratchCapacity, scanner->scratchLength + length);
+    memcpy(scanner->scratch + scanner->scratchLength, bytes, length);
+    scanner->scratchLength += length;
+}
+
+static void AFXMLScannerAppendCodePoint(AFXMLScanner *scanner, uint32_t codePoint) {
+    uint8_t bytes[4];
+    NSUInteger length = 0;
+    if (codePoint < 0x80) {
+        bytes[length++] = (uint8_t)codePoint;
+    } else if (codePoint < 0x800) {
+        bytes[length++] = (uint8_t)(0xC0 | (codePoint >> 6));
+        bytes[length++] = (uint8_t)(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        bytes[length++] = (uint8_t)(0xE0 | (codePoint >> 12));
+        bytes[length++] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+        bytes[length++] = (uint8_t)(0x80 | (codePoint & 0x3F));
+    } else {
+        bytes[length++] = (uint8_t)(0xF0 | (codePoint >> 18));
+        bytes[length++] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+        bytes[length++] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+        bytes[length++] = (uint8_t)(0x80 | (codePoint & 0x3F));
+    }
+
+    AFXMLScannerAppendScratch(scanner, bytes, length);
+}
+
+// Appends the bytes to the scratch buffer, replacing references and normalizing line breaks, and whitespace too in attribute values
+static BOOL AFXMLScannerDecode(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length, BOOL isAttributeValue, unsigned long long offset) {
+    const uint8_t *end = bytes + length;
+    const uint8_t *runStart = bytes;
+    for (const uint8_t *p = bytes; p < end; p++) {
+        uint8_t c = *p;
+        if (c != '&' && c != '\r' && !(isAttributeValue && (c == '\t' || c == '\n'))) {
+            continue;
+        }
+
+        AFXMLScannerAppendScratch(scanner, runStart, (NSUInteger)(p - runStart));
+
+        if (c == '\r') {
+            AFXMLScannerAppendScratch(scanner, isAttributeValue ? (const uint8_t *)" " : (const uint8_t *)"\n", 1);
+            if (p + 1 < end && p[1] == '\n') {
+                p++;
+            }
+            runStart = p + 1;
+            continue;
+        } else if (c != '&') {
+            AFXMLScannerAppendScratch(scanner, (const uint8_t *)" ", 1);
+            runStart = p + 1;
+            continue;
+        }
+
+        const uint8_t *semicolon = memchr(p, ';', (size_t)(end - p));
+        unsigned long long referenceOffset = offset + (unsigned long long)(p - bytes);
+        if (!semicolon || semicolon - p < 2) {
+            return AFXMLScannerFail(scanner, NSXMLParserEntityNotFinishedError, "Unterminated reference", referenceOffset);
+        }
+
+        const uint8_t *name = p + 1;
+        NSUInteger nameLength = (NSUInteger)(semicolon - name);
+        if (name[0] == '#') {
+            BOOL isHexadecimal = nameLength > 1 && name[1] == 'x';
+            NSUInteger digitsStart = isHexadecimal ? 2 : 1;
+            if (nameLength <= digitsStart || nameLength - digitsStart > 8) {
+                return AFXMLScannerFail(scanner, NSXMLParserInvalidCharacterRefError, "Invalid character reference", referenceOffset);
+            }
+
+            uint32_t codePoint = 0;
+            for (NSUInteger idx = digitsStart; idx < nameLength; idx++) {
+                uint8_t digit = name[idx];
+                uint32_t value;
+                if (digit >= '0' && digit <= '9') {
+                    value = digit - '0';
+                } else if (isHexadecimal && (digit | 0x20) >= 'a' && (digit | 0x20) <= 'f') {
+                    value = (digit | 0x20) - 'a' + 10;
+                } else {
+                    return AFXMLScannerFail(scanner, NSXMLParserInvalidCharacterRefError, "Invalid character reference", referenceOffset);
+                }
+                codePoint = codePoint * (isHexadecimal ? 16 : 10) + value;
+            }
+
+            if (codePoint == 0 || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+                return AFXMLScannerFail(scanner, NSXMLParserInvalidCharacterRefError, "Invalid character reference", referenceOffset);
+            }
+
+            AFXMLScannerAppendCodePoint(scanner, codePoint);
+        } else if (nameLength == 2 && memcmp(name, "lt", 2) == 0) {
+            AFXMLScannerAppendScratch(scanner, (const uint8_t *)"<", 1);
+        } else if (nameLength == 2 && memcmp(name, "gt", 2) == 0) {
+            AFXMLScannerAppendScratch(scanner, (const uint8_t *)">", 1);
+        } else if (nameLength == 3 && memcmp(name, "amp", 3) == 0) {
+            AFXMLScannerAppendScratch(scanner, (const uint8_t *)"&", 1);
+        } else if (nameLength == 4 && memcmp(name, "quot", 4) == 0) {
+            AFXMLScannerAppendScratch(scanner, (const uint8_t *)"\"", 1);
+        } else if (nameLength == 4 && memcmp(name, "apos", 4) == 0) {
+            AFXMLScannerAppendScratch(scanner, (const uint8_t *)"'", 1);
+        } else {
+            return AFXMLScannerFail(scanner, NSXMLParserUndeclaredEntityError, "Undeclared entity", referenceOffset);
+        }
+
+        p = semicolon;
+        runStart = p + 1;
+    }
+
+    AFXMLScannerAppendScratch(scanner, runStart, (NSUInteger)(end - runStart));
+
+    return YES;
+}
+
+static BOOL AFXMLScannerEmitText(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length, BOOL isDecoded, unsigned long long offset) {
+    if (length == 0) {
+        return YES;
+    }
+
+    if (scanner->depth == 0) {
+        for (NSUInteger idx = 0; idx < length; idx++) {
+            if (!AFXMLIsWhitespace(bytes[idx])) {
+                return AFXMLScannerFail(scanner, scanner->foundRoot ? NSXMLParserExtraContentError : NSXMLParserLTRequiredError, scanner->foundRoot ? "Extra content at the end of the document" : "Text before the root element", offset + idx);
+            }
+        }
+
+        return YES;
+    }
+
+    if (isDecoded) {
+        scanner->scratchLength = 0;
+        if (!AFXMLScannerDecode(scanner, bytes, length, NO, offset)) {
+            return NO;
+        }
+        bytes = scanner->scratch;
+        length = scanner->scratchLength;
+    }
+
+    return !scanner->handlers.text || scanner->handlers.text(scanner, bytes, length);
+}
+
+// Scans a start tag, returning the length of the tag, `0` if it is not complete yet, or `-1` if it is not valid
+static NSInteger AFXMLScannerScanStartTag(AFXMLScanner *scanner, const uint8_t *bytes, const uint8_t *end) {
+    unsigned long long offset = scanner->offset;
+    const uint8_t *p = bytes + 1;
+    const uint8_t *name = p;
+    while (p < end && !AFXMLIsNameDelimiter(*p)) {
+        p++;
+    }
+
+    if (p == end) {
+        return 0;
+    }
+
+    NSUInteger nameLength = (NSUInteger)(p - name);
+    if (nameLength == 0) {
+        return AFXMLScannerFailToken(scanner, NSXMLParserNameRequiredError, "Element name expected", offset);
+    }
+
+    if (scanner->foundRoot && scanner->depth == 0) {
+        return AFXMLScannerFailToken(scanner, NSXMLParserExtraContentError, "Extra content at the end of the document", offset);
+    }
+
+    scanner->scratchLength = 0;
+    NSUInteger numberOfAttributes = 0;
+    BOOL isEmpty = NO;
+    while (YES) {
+        const uint8_t *whitespaceStart = p;
+        while (p < end && AFXMLIsWhitespace(*p)) {
+            p++;
+        }
+
+        if (p == end) {
+            return 0;
+        }
+
+        if (*p == '>') {
+            p++;
+            break;
+        }
+
+        if (*p == '/') {
+            if (p + 1 == end) {
+                return 0;
+            }
+
+            if (p[1] != '>') {
+                return AFXMLScannerFailToken(scanner, NSXMLParserGTRequiredError, "'>' expected", offset + (unsigned long long)(p - bytes));
+            }
+
+            isEmpty = YES;
+            p += 2;
+            break;
+        }
+
+        if (p == whitespaceStart || AFXMLIsNameDelimiter(*p)) {
+            return AFXMLScannerFailToken(scanner, NSXMLParserAttributeNotStartedError, "Attribute expected", offset + (unsigned long long)(p - bytes));
+        }
+
+        const uint8_t *attributeName = p;
+        while (p < end && !AFXMLIsNameDelimiter(*p)) {
+            p++;
+        }
+        NSUInteger attributeNameLength = (NSUInteger)(p - attributeName);
+
+        while (p < end && AFXMLIsWhitespace(*p)) {
+            p++;
+        }
+
+        if (p == end) {
+            return 0;
+        }
+
+        if (*p != '=') {
+            return AFXMLScannerFailToken(scanner, NSXMLParserAttributeHasNoValueError, "Attribute without a value", offset + (unsigned long long)(p - bytes));
+        }
+        p++;
+
+        while (p < end && AFXMLIsWhitespace(*p)) {
+            p++;
+        }
+
+        if (p == end) {
+            return 0;
+        }
+
+        uint8_t quote = *p;
+        if (quote != '"' && quote != '\'') {
+            return AFXMLScannerFailToken(scanner, NSXMLParserAttributeNotStartedError, "Quoted attribute value expected", offset + (unsigned long long)(p - bytes));
+        }
+
+        const uint8_t *value = p + 1;
+        const uint8_t *valueEnd = memchr(value, quote, (size_t)(end - value));
+        if (!valueEnd) {
+            return 0;
+        }
+
+        if (memchr(value, '<', (size_t)(valueEnd - value))) {
+            return AFXMLScannerFailToken(scanner, NSXMLParserLessThanSymbolInAttributeError, "'<' in attribute value", offset + (unsigned long long)(value - bytes));
+        }
+
+        if (numberOfAttributes == scanner->attributesCapacity) {
+            scanner->attributesCapacity = MAX(scanner->attributesCapacity * 2, (NSUInteger)8);
+            scanner->attributes = realloc(scanner->attributes, scanner->attributesCapacity * sizeof(AFXMLScannerAttribute));
+        }
+
+        AFXMLScannerAttribute *attribute = &scanner->attributes[numberOfAttributes++];
+        attribute->name = attributeName;
+        attribute->nameLength = attributeNameLength;
+        attribute->valueOffset = scanner->scratchLength;
+        if (!AFXMLScannerDecode(scanner, value, (NSUInteger)(valueEnd - value), YES, offset + (unsigned long long)(value - bytes))) {
+            return -1;
+        }
+        attribute->valueLength = scanner->scratchLength - attribute->valueOffset;
+
+        p = valueEnd + 1;
+    }
+
+    if (scanner->depth == AFXMLScannerMaximumDepth) {
+        return AFXMLScannerFailToken(scanner, NSXMLParserInternalError, "Too many nested elements", offset);
+    }
+
+    scanner->foundRoot = YES;
+
+    if (scanner->handlers.startElement && !scanner->handlers.startElement(scanner, name, nameLength, scanner->attributes, numberOfAttributes, scanner->scratch)) {
+        return -1;
+    }
+
+    if (isEmpty) {
+        if (scanner->handlers.endElement && !scanner->handlers.endElement(scanner, name, nameLength)) {
+            return -1;
+        }
+    } else {
+        if (scanner->depth == scanner->nameOffsetsCapacity) {
+            scanner->nameOffsetsCapacity = MAX(scanner->nameOffsetsCapacity * 2, (NSUInteger)16);
+            scanner->nameOffsets = realloc(scanner->nameOffsets, scanner->nameOffsetsCapacity * sizeof(NSUInteger));
+        }
+
+        AFXMLScannerReserve(&scanner->names, &scanner->namesCapacity, scanner->namesLength + nameLength);
+        memcpy(scanner->names + scanner->namesLength, name, nameLength);
+        scanner->nameOffsets[scanner->depth++] = scanner->namesLength;
+        scanner->namesLength += nameLength;
+    }
+
+    return p - bytes;
+}
+
+static NSInteger AFXMLScannerScanEndTag(AFXMLScanner *scanner, const uint8_t *bytes, const uint8_t *end) {
+    const uint8_t *closing = memchr(bytes, '>', (size_t)(end - bytes));
+    if (!closing) {
+        return 0;
+    }
+
+    const uint8_t *name = bytes + 2;
+    const uint8_t *nameEnd = name;
+    while (nameEnd < closing && !AFXMLIsNameDelimiter(*nameEnd)) {
+        nameEnd++;
+    }
+
+    for (const uint8_t *p = nameEnd; p < closing; p++) {
+        if (!AFXMLIsWhitespace(*p)) {
+            return AFXMLScannerFailToken(scanner, NSXMLParserGTRequiredError, "'>' expected", scanner->offset + (unsigned long long)(p - bytes));
+        }
+    }
+
+    NSUInteger nameLength = (NSUInteger)(nameEnd - name);
+    if (scanner->depth == 0) {
+        return AFXMLScannerFailToken(scanner, NSXMLParserNotWellBalancedError, "End tag without a start tag", scanner->offset);
+    }
+
+    NSUInteger openNameOffset = scanner->nameOffsets[scanner->depth - 1];
+    NSUInteger openNameLength = scanner->namesLength - openNameOffset;
+    if (nameLength != openNameLength || memcmp(name, scanner->names + openNameOffset, nameLength) != 0) {
+        return AFXMLScannerFailToken(scanner, NSXMLParserTagNameMismatchError, "End tag does not match the open element", scanner->offset);
+    }
+
+    scanner->depth--;
+    scanner->namesLength = openNameOffset;
+
+    if (scanner->handlers.endElement && !scanner->handlers.endElement(scanner, name, nameLength)) {
+        return -1;
+    }
+
+    return closing + 1 - bytes;
+}
+
+// Document type declarations are skipped, along with any internal subset, whose declarations are not applied
+static NSInteger AFXMLScannerScanDocumentType(AFXMLScanner *scanner, const uint8_t *bytes, const uint8_t *end) {
+    if (scanner->foundRoot) {
+        return AFXMLScannerFailToken(scanner, NSXMLParserExtraContentError, "Document type declaration after the root element", scanner->offset);
+    }
+
+    uint8_t quote = 0;
+    NSUInteger subsetDepth = 0;
+    for (const uint8_t *p = bytes + 2; p < end; p++) {
+        uint8_t c = *p;
+        if (quote) {
+            if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '[') {
+            subsetDepth++;
+        } else if (c == ']' && subsetDepth > 0) {
+            subsetDepth--;
+        } else if (c == '>' && subsetDepth == 0) {
+            return p + 1 - bytes;
+        }
+    }
+
+    return 0;
+}
+
+static NSInteger AFXMLScannerScanDeclaration(AFXMLScanner *scanner, const uint8_t *bytes, const uint8_t *end) {
+    const uint8_t *closing = AFXMLFind(bytes, end, "?>", 2);
+    if (!closing) {
+        return 0;
+    }
+
+    const uint8_t *encoding = AFXMLFind(bytes, closing, "encoding", 8);
+    if (encoding) {
+        const uint8_t *p = encoding + 8;
+        while (p < closing && (AFXMLIsWhitespace(*p) || *p == '=' || *p == '"' || *p == '\'')) {
+            p++;
+        }
+
+        const uint8_t *name = p;
+        while (p < closing && *p != '"' && *p != '\'') {
+            p++;
+        }
+
+        NSUInteger nameLength = (NSUInteger)(p - name);
+        BOOL isUTF8 = nameLength == 5 && strncasecmp((const char *)name, "utf-8", 5) == 0;
+        BOOL isASCII = nameLength == 8 && strncasecmp((const char *)name, "us-ascii", 8) == 0;
+        if (!isUTF8 && !isASCII) {
+            return AFXMLScannerFailToken(scanner, NSXMLParserEncodingNotSupportedError, "Unsupported encoding", scanner->offset + (unsigned long long)(name - bytes));
+        }
+    }
+
+    return closing + 2 - bytes;
+}
+
+// Scans as much of the bytes as possible, returning the number of bytes consumed, or `-1` if the bytes are not valid
+static NSInteger AFXMLScannerScan(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length, BOOL isFinal) {
+    const uint8_t *p = bytes;
+    const uint8_t *end = bytes + length;
+
+    if (!scanner->startedDocument) {
+        if (length < 3 && !isFinal) {
+            return 0;
+        }
+
+        if (length >= 2 && ((bytes[0] == 0xFE && bytes[1] == 0xFF) || (bytes[0] == 0xFF && bytes[1] == 0xFE))) {
+            return AFXMLScannerFailToken(scanner, NSXMLParserEncodingNotSupportedError, "Unsupported encoding", 0);
+        }
+
+        BOOL isPartial = NO;
+        NSUInteger byteOrderMarkLength = (length >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF) ? 3 : 0;
+        const uint8_t *declaration = bytes + byteOrderMarkLength;
+        NSInteger declarationLength = 0;
+        if (AFXMLHasPrefix(declaration, end, "<?xml", 5, &isPartial) && (isPartial || declaration + 5 == end || AFXMLIsWhitespace(declaration[5]))) {
+            declarationLength = isPartial ? 0 : AFXMLScannerScanDeclaration(scanner, declaration, end);
+            if (declarationLength < 0) {
+                return -1;
+            } else if (declarationLength == 0) {
+                // The whole declaration is needed to check its encoding
+                return 0;
+            }
+        }
+
+        scanner->startedDocument = YES;
+        p = declaration + declarationLength;
+        scanner->offset += (unsigned long long)(p - bytes);
+    }
+
+    while (p < end) {
+        switch (scanner->mode) {
+            case AFXMLScannerModeComment:
+            case AFXMLScannerModeProcessingInstruction: {
+                BOOL isComment = scanner->mode == AFXMLScannerModeComment;
+                NSUInteger terminatorLength = isComment ? 3 : 2;
+                const uint8_t *terminator = AFXMLFind(p, end, isComment ? "-->" : "?>", terminatorLength);
+                const uint8_t *next = terminator ? terminator + terminatorLength : MAX(p, end - (terminatorLength - 1));
+                scanner->offset += (unsigned long long)(next - p);
+                p = next;
+                if (!terminator) {
+                    return p - bytes;
+                }
+
+                scanner->mode = AFXMLScannerModeContent;
+                break;
+            }
+            case AFXMLScannerModeCDATA: {
+                const uint8_t *terminator = AFXMLFind(p, end, "]]>", 3);
+                const uint8_t *textEnd = terminator;
+                if (!terminator) {
+                    textEnd = MAX(p, end - 2);
+                    textEnd = p + AFXMLCompleteUTF8Length(p, (NSUInteger)(textEnd - p));
+                }
+
+                if (!AFXMLScannerEmitText(scanner, p, (NSUInteger)(textEnd - p), NO, scanner->offset)) {
+                    return -1;
+                }
+
+                const uint8_t *next = terminator ? terminator + 3 : textEnd;
+                scanner->offset += (unsigned long long)(next - p);
+                p = next;
+                if (!terminator) {
+                    return p - bytes;
+                }
+
+                scanner->mode = AFXMLScannerModeContent;
+                break;
+            }
+            case AFXMLScannerModeContent: {
+                if (*p != '<') {
+                    const uint8_t *textEnd = memchr(p, '<', (size_t)(end - p));
+                    BOOL isComplete = textEnd != NULL;
+                    if (!textEnd) {
+                        textEnd = end;
+                        if (!isFinal) {
+                            // Text is delivered as it is received, short of a reference, line break or character it ends in the middle of
+                            const uint8_t *ampersand = NULL;
+                            for (const uint8_t *q = end; q > p && end - q < 32; q--) {
+                                if (q[-1] == ';') {
+                                    break;
+                                } else if (q[-1] == '&') {
+                                    ampersand = q - 1;
+                                    break;
+                                }
+                            }
+
+                            if (ampersand) {
+                                textEnd = ampersand;
+                            } else if (textEnd[-1] == '\r') {
+                                textEnd--;
+                            }
+
+                            textEnd = p + AFXMLCompleteUTF8Length(p, (NSUInteger)(textEnd - p));
+                        }
+                    }
+
+                    if (!AFXMLScannerEmitText(scanner, p, (NSUInteger)(textEnd - p), YES, scanner->offset)) {
+                        return -1;
+                    }
+
+                    scanner->offset += (unsigned long long)(textEnd - p);
+                    p = textEnd;
+                    if (!isComplete) {
+                        return p - bytes;
+                    }
+
+                    break;
+                }
+
+                NSInteger tokenLength = 0;
+                BOOL isPartial = NO;
+                if (p + 1 == end) {
+                    tokenLength = 0;
+                } else if (p[1] == '/') {
+                    tokenLength = AFXMLScannerScanEndTag(scanner, p, end);
+                } else if (p[1] == '?') {
+                    scanner->mode = AFXMLScannerModeProcessingInstruction;
+                    tokenLength = 2;
+                } else if (p[1] != '!') {
+                    tokenLength = AFXMLScannerScanStartTag(scanner, p, end);
+                } else if (AFXMLHasPrefix(p, end, "<!--", 4, &isPartial)) {
+                    scanner->mode = isPartial ? AFXMLScannerModeContent : AFXMLScannerModeComment;
+                    tokenLength = isPartial ? 0 : 4;
+                } else if (AFXMLHasPrefix(p, end, "<![CDATA[", 9, &isPartial)) {
+                    if (scanner->depth == 0) {
+                        return AFXMLScannerFailToken(scanner, NSXMLParserExtraContentError, "CDATA section outside the root element", scanner->offset);
+                    }
+
+                    scanner->mode = isPartial ? AFXMLScannerModeContent : AFXMLScannerModeCDATA;
+                    tokenLength = isPartial ? 0 : 9;
+                } else if (AFXMLHasPrefix(p, end, "<!DOCTYPE", 9, &isPartial)) {
+                    tokenLength = isPartial ? 0 : AFXMLScannerScanDocumentType(scanner, p, end);
+                } else {
+                    return AFXMLScannerFailToken(scanner, NSXMLParserNameRequiredError, "Invalid markup", scanner->offset);
+                }
+
+                if (tokenLength < 0) {
+                    return -1;
+                } else if (tokenLength == 0) {
+                    if ((NSUInteger)(end - p) > scanner->maximumTokenLength) {
+                        return AFXMLScannerFailToken(scanner, NSXMLParserGTRequiredError, "Markup longer than the maximum token length", scanner->offset);
+                    }
+
+                    return p - bytes;
+                }
+
+                scanner->offset += (unsigned long long)tokenLength;
+                p += tokenLength;
+                break;
+            }
+        }
+    }
+
+    return p - bytes;
+}
+
+// Scans the data, keeping the bytes of a split token until more data is received
+static BOOL AFXMLScannerParse(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length, BOOL isFinal) {
+    if (scanner->errorReason) {
+        return NO;
+    }
+
+    if (scanner->pendingLength > 0) {
+        AFXMLScannerReserve(&scanner->pending, &scanner->pendingCapacity, scanner->pendingLength + length);
+        memcpy(scanner->pending + scanner->pendingLength, bytes, length);
+        scanner->pendingLength += length;
+        bytes = scanner->pending;
+        length = scanner->pendingLength;
+    }
+
+    NSInteger scannedLength = AFXMLScannerScan(scanner, bytes, length, isFinal);
+    if (scannedLength < 0) {
+        return NO;
+    }
+
+    NSUInteger remainingLength = length - (NSUInteger)scannedLength;
+    if (remainingLength > 0) {
+        if (bytes != scanner->pending) {
+            AFXMLScannerReserve(&scanner->pending, &scanner->pendingCapacity, remainingLength);
+        }
+        memmove(scanner->pending, bytes + scannedLength, remainingLength);
+    }
+    scanner->pendingLength = remainingLength;
+
+    if (isFinal) {
+        if (!scanner->foundRoot) {
+            return AFXMLScannerFail(scanner, NSXMLParserEmptyDocumentError, "Document is empty", scanner->offset);
+        }
+
+        if (scanner->depth > 0 || scanner->pendingLength > 0 || scanner->mode != AFXMLScannerModeContent) {
+            return AFXMLScannerFail(scanner, NSXMLParserPrematureDocumentEndError, "Premature end of document", scanner->offset + scanner->pendingLength);
+        }
+    }
+
+    return YES;
+}
+
+#pragma mark -
+
+@implementation AFXMLElement
+
+- (instancetype)initWithName:(NSString *)name
+                  attributes:(NSDictionary <NSString *, NSString *> *)attributes
+                    children:(NSArray <AFXMLElement *> *)children
+                        text:(NSString *)text
+{
+    NSParameterAssert(name);
+
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    _name = [name copy];
+    _attributes = [attributes copy] ?: @{};
+    _children = [children copy] ?: @[];
+    _text = [text copy] ?: @"";
+
+    return self;
+}
+
+- (AFXMLElement *)firstChildNamed:(NSString *)name {
+    for (AFXMLElement *child in self.children) {
+        if ([child.name isEqualToString:name]) {
+            return child;
+        }
+    }
+
+    return nil;
+}
+
+- (NSArray <AFXMLElement *> *)childrenNamed:(NSString *)name {
+    NSMutableArray *mutableChildren = [NSMutableArray array];
+    for (AFXMLElement *child in self.children) {
+        if ([child.name isEqualToString:name]) {
+            [mutableChildren addObject:child];
+        }
+    }
+
+    return mutableChildren;
+}
+
+#pragma mark - NSObject
+
+- (BOOL)isEqual:(id)object {
+    if (self == object) {
+        return YES;
+    }
+
+    if (![object isKindOfClass:[AFXMLElement class]]) {
+        return NO;
+    }
+
+    AFXMLElement *element = object;
+
+    return [self.name isEqualToString:element.name] && [self.attributes isEqualToDictionary:element.attributes] && [self.text isEqualToString:element.text] && [self.children isEqualToArray:element.children];
+}
+
+- (NSUInteger)hash {
+    return [self.name hash] ^ [self.children count];
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, name: %@, attributes: %@, children: %lu>", NSStringFromClass([self class]), self, self.name, self.attributes, (unsigned long)[self.children count]];
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFXMLEvent
+
+- (instancetype)initWithType:(AFXMLEventType)type
+                        name:(NSString *)name
+                  attributes:(NSDictionary <NSString *, NSString *> *)attributes
+                        text:(NSString *)text
+                       depth:(NSUInteger)depth
+{
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    _type = type;
+    _name = [name copy];
+    _attributes = [attributes copy];
+    _text = [text copy];
+    _depth = depth;
+
+    return self;
+}
+
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@: %p, type: %lu, name: %@, text: %@, depth: %lu>", NSStringFromClass([self class]), self, (unsigned long)self.type, self.name, self.text, (unsigned long)self.depth];
+}
+
+@end
+
+#pragma mark -
+
+typedef struct {
+    uint8_t bytes[32];
+    NSUInteger length;
+} AFXMLNameCacheEntry;
+
+@interface AFXMLPushParser () {
+    AFXMLScanner _scanner;
+
+    // Element and attribute names, by a hash of their bytes
+    __strong NSString **_cachedNames;
+    AFXMLNameCacheEntry *_nameCacheEntries;
+}
+@property (readwrite, nonatomic, strong) NSError *parserError;
+@property (readwrite, nonatomic, assign, getter=isAborted) BOOL aborted;
+@property (readwrite, nonatomic, assign) BOOL delegateHandlesStartElement;
+@property (readwrite, nonatomic, assign) BOOL delegateHandlesEndElement;
+@property (readwrite, nonatomic, assign) BOOL delegateHandlesCharacters;
+
+- (NSString *)nameWithBytes:(const uint8_t *)bytes length:(NSUInteger)length;
+@end
+
+static BOOL AFXMLPushParserStartElement(AFXMLScanner *scanner, const uint8_t *name, NSUInteger nameLength, const AFXMLScannerAttribute *attributes, NSUInteger numberOfAttributes, const uint8_t *values) {
+    AFXMLPushParser *parser = (__bridge AFXMLPushParser *)scanner->context;
+    if (!parser.delegateHandlesStartElement) {
+        return YES;
+    }
+
+    NSMutableDictionary *mutableAttributes = [NSMutableDictionary dictionaryWithCapacity:numberOfAttributes];
+    for (NSUInteger idx = 0; idx < numberOfAttributes; idx++) {
+        NSString *value = [[NSString alloc] initWithBytes:values + attributes[idx].valueOffset length:attributes[idx].valueLength encoding:NSUTF8StringEncoding];
+        if (!value) {
+            return AFXMLScannerFail(scanner, NSXMLParserInvalidCharacterError, "Invalid UTF-8 in attribute value", scanner->offset);
+        }
+
+        mutableAttributes[[parser nameWithBytes:attributes[idx].name length:attributes[idx].nameLength]] = value;
+    }
+
+    [parser.delegate parser:parser didStartElement:[parser nameWithBytes:name length:nameLength] attributes:mutableAttributes];
+
+    return !parser.isAborted || AFXMLScannerFail(scanner, NSXMLParserDelegateAbortedParseError, "Parsing aborted", scanner->offset);
+}
+
+static BOOL AFXMLPushParserEndElement(AFXMLScanner *scanner, const uint8_t *name, NSUInteger nameLength) {
+    AFXMLPushParser *parser = (__bridge AFXMLPushParser *)scanner->context;
+    if (!parser.delegateHandlesEndElement) {
+        return YES;
+    }
+
+    [parser.delegate parser:parser didEndElement:[parser nameWithBytes:name length:nameLength]];
+
+    return !parser.isAborted || AFXMLScannerFail(scanner, NSXMLParserDelegateAbortedParseError, "Parsing aborted", scanner->offset);
+}
+
+static BOOL AFXMLPushParserText(AFXMLScanner *scanner, const uint8_t *bytes, NSUInteger length) {
+    AFXMLPushParser *parser = (__bridge AFXMLPushParser *)scanner->context;
+    if (!parser.delegateHandlesCharacters) {
+        return YES;
+    }
+
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    if (!string) {
+        return AFXMLScannerFail(scanner, NSXMLParserInvalidCharacterError, "Invalid UTF-8 in text", scanner->offset);
+    }
+
+    [parser.delegate parser:parser foundCharacters:string];
+
+    return !parser.isAborted || AFXMLScannerFail(scanner, NSXMLParserDelegateAbortedParseError, "Parsing aborted", scanner->offset);
+}
+
+@implementation AFXMLPushParser
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    AFXMLScannerHandlers handlers = {
+        .startElement = AFXMLPushParserStartElement,
+        .endElement = AFXMLPushParserEndElement,
+        .text = AFXMLPushParserText,
+    };
+    AFXMLScannerInitialize(&_scanner, handlers, (__bridge void *)self, AFXMLPushParserDefaultMaximumTokenLength);
+
+    _cachedNames = (__strong NSString **)calloc(AFXMLNameCacheSize, sizeof(NSString *));
+    _nameCacheEntries = calloc(AFXMLNameCacheSize, sizeof(AFXMLNameCacheEntry));
+
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger idx = 0; idx < AFXMLNameCacheSize; idx++) {
+        _cachedNames[idx] = nil;
+    }
+    free(_cachedNames);
+    free(_nameCacheEntries);
+
+    AFXMLScannerDestroy(&_scanner);
+}
+
+- (void)setDelegate:(id <AFXMLPushParserDelegate>)delegate {
+    _delegate = delegate;
+
+    self.delegateHandlesStartElement = [delegate respondsToSelector:@selector(parser:didStartElement:attributes:)];
+    self.delegateHandlesEndElement = [delegate respondsToSelector:@selector(parser:didEndElement:)];
+    self.delegateHandlesCharacters = [delegate respondsToSelector:@selector(parser:foundCharacters:)];
+}
+
+- (NSUInteger)maximumTokenLength {
+    return _scanner.maximumTokenLength;
+}
+
+- (void)setMaximumTokenLength:(NSUInteger)maximumTokenLength {
+    _scanner.maximumTokenLength = maximumTokenLength;
+}
+
+- (NSUInteger)depth {
+    return _scanner.depth;
+}
+
+- (NSString *)nameWithBytes:(const uint8_t *)bytes
+                     length:(NSUInteger)length
+{
+    AFXMLNameCacheEntry *entry = NULL;
+    NSUInteger hash = 0;
+    if (length <= AFXMLMaximumCachedNameLength) {
+        // FNV-1a
+        uint32_t fnv = 2166136261U;
+        for (NSUInteger idx = 0; idx < length; idx++) {
+            fnv = (fnv ^ bytes[idx]) * 16777619U;
+        }
+        hash = fnv & (AFXMLNameCacheSize - 1);
+        entry = &_nameCacheEntries[hash];
+        if (_cachedNames[hash] && entry->length == length && memcmp(entry->bytes, bytes, length) == 0) {
+            return _cachedNames[hash];
+        }
+    }
+
+    NSString *name = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding] ?: @"";
+    if (entry) {
+        memcpy(entry->bytes, bytes, length);
+        entry->length = length;
+        _cachedNames[hash] = name;
+    }
+
+    return name;
+}
+
+- (BOOL)scanBytes:(const uint8_t *)bytes
+           length:(NSUInteger)length
+          isFinal:(BOOL)isFinal
+            error:(NSError * __autoreleasing *)error
+{
+    if (!self.parserError && !AFXMLScannerParse(&_scanner, bytes, length, isFinal)) {
+        NSString *description = [NSString stringWithFormat:@"%s around byte %llu.", _scanner.errorReason, _scanner.errorOffset];
+        self.parserError = [NSError errorWithDomain:NSXMLParserErrorDomain code:_scanner.errorCode userInfo:@{@"NSDebugDescription": description}];
+    }
+
+    if (self.parserError && error) {
+        *error = self.parserError;
+    }
+
+    return !self.parserError;
+}
+
+- (BOOL)parseData:(NSData *)data
+            error:(NSError * __autoreleasing *)error
+{
+    return [self scanBytes:[data bytes] length:[data length] isFinal:NO error:error];
+}
+
+- (BOOL)finishParsing:(NSError * __autoreleasing *)error {
+    return [self scanBytes:(const uint8_t *)"" length:0 isFinal:YES error:error];
+}
+
+- (void)abortParsing {
+    self.aborted = YES;
+}
+
+@end
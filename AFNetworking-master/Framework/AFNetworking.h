@@ -37,6 +37,9 @@ FOUNDATION_EXPORT const unsigned char AFNetworkingVersionString[];
 
 #import <AFNetworking/AFURLRequestSerialization.h>
 #import <AFNetworking/AFURLResponseSerialization.h>
+#import <AFNetworking/AFJSONParser.h>
+#import <AFNetworking/AFMessagePackSerialization.h>
+#import <AFNetworking/AFXMLPushParser.h>
 #import <AFNetworking/AFSecurityPolicy.h>
 #import <AFNetworking/AFCompatibilityMacros.h>
 
@@ -46,6 +49,11 @@ FOUNDATION_EXPORT const unsigned char AFNetworkingVersionString[];
 
 #import <AFNetworking/AFURLSessionManager.h>
 #import <AFNetworking/AFHTTPSessionManager.h>
+#import <AFNetworking/AFChunkedUploader.h>
+#import <AFNetworking/AFSegmentedDownloader.h>
+#import <AFNetworking/AFCompletionCoalescer.h>
+#import <AFNetworking/AFRequestScheduler.h>
+#import <AFNetworking/AFHedgingPolicy.h>
 
 #if TARGET_OS_IOS || TARGET_OS_TV
 #import <AFNetworking/AFAutoPurgingImageCache.h>
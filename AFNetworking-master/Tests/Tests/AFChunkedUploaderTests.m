@@ -0,0 +1,369 @@
+// AFChunkedUploaderTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "AFTestCase.h"
+
+#import "AFChunkedUploader.h"
+
+static NSString * AFTestQueryValue(NSURL *URL, NSString *name) {
+    for (NSURLQueryItem *queryItem in [[NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO] queryItems]) {
+        if ([queryItem.name isEqualToString:name]) {
+            return queryItem.value;
+        }
+    }
+
+    return nil;
+}
+
+static BOOL AFTestQueryContainsItem(NSURL *URL, NSString *name) {
+    for (NSURLQueryItem *queryItem in [[NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO] queryItems]) {
+        if ([queryItem.name isEqualToString:name]) {
+            return YES;
+        }
+    }
+
+    return NO;
+}
+
+@interface AFChunkedUploaderTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@property (readwrite, nonatomic, strong) AFChunkedUploader *uploader;
+@property (readwrite, nonatomic, strong) NSURL *fileURL;
+@property (readwrite, nonatomic, strong) NSData *fileData;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSNumber *, NSData *> *receivedParts;
+@property (readwrite, nonatomic, strong) NSMutableDictionary <NSString *, NSData *> *receivedPartsByHash;
+@property (readwrite, nonatomic, strong) NSData *committedData;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfPartRequests;
+@property (readwrite, nonatomic, assign) NSUInteger numberOfPartBytesReceived;
+@property (readwrite, nonatomic, assign) BOOL failsMissingPartsRequests;
+@end
+
+@implementation AFChunkedUploaderTests
+
+- (void)setUp {
+    [super setUp];
+
+    NSMutableData *fileData = [NSMutableData dataWithLength:1024 * 64 * 5 + 1024 * 17];
+    SecRandomCopyBytes(kSecRandomDefault, [fileData length], [fileData mutableBytes]);
+    self.fileData = fileData;
+    self.fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    [self.fileData writeToURL:self.fileURL atomically:YES];
+
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    self.receivedParts = [NSMutableDictionary dictionary];
+    self.receivedPartsByHash = [NSMutableDictionary dictionary];
+
+    [self serveUploadsFailingRequestsPassingTest:nil];
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:self.fileURL error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:self.uploader.stateDirectoryURL error:nil];
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (AFChunkedUploader *)uploader {
+    if (_uploader) {
+        return _uploader;
+    }
+
+    AFChunkedUploader *uploader = [[AFChunkedUploader alloc] initWithSessionManager:self.manager];
+    uploader.partSize = 1024 * 64;
+    uploader.retryInterval = 0.01;
+    uploader.stateDirectoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"AFChunkedUploaderTests"] isDirectory:YES];
+    _uploader = uploader;
+
+    return _uploader;
+}
+
+// A reference server storing parts by number, or by hash when they have one, and reassembling them in the order listed by the commit request
+- (void)serveUploadsFailingRequestsPassingTest:(BOOL (^)(NSUInteger partNumber, NSUInteger attempt))failureTest {
+    NSMutableDictionary <NSNumber *, NSNumber *> *attempts = [NSMutableDictionary dictionary];
+
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        @synchronized (self) {
+            if (AFTestQueryContainsItem(request.URL, @"missing")) {
+                if (self.failsMissingPartsRequests) {
+                    return [AFTestServerResponse responseWithStatusCode:503 headers:nil body:nil];
+                }
+
+                NSDictionary *query = [NSJSONSerialization JSONObjectWithData:body options:(NSJSONReadingOptions)0 error:nil];
+                NSMutableArray *missingHashes = [NSMutableArray array];
+                for (NSString *hash in query[@"hashes"]) {
+                    if (!self.receivedPartsByHash[hash]) {
+                        [missingHashes addObject:hash];
+                    }
+                }
+
+                NSData *responseData = [NSJSONSerialization dataWithJSONObject:@{@"missing": missingHashes} options:(NSJSONWritingOptions)0 error:nil];
+                return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/json"} body:responseData];
+            }
+
+            if ([request.HTTPMethod isEqualToString:@"PUT"]) {
+                NSUInteger partNumber = (NSUInteger)[AFTestQueryValue(request.URL, @"partNumber") integerValue];
+                NSUInteger attempt = [attempts[@(partNumber)] unsignedIntegerValue] + 1;
+                attempts[@(partNumber)] = @(attempt);
+                self.numberOfPartRequests++;
+
+                if (failureTest && failureTest(partNumber, attempt)) {
+                    return [AFTestServerResponse responseWithStatusCode:500 headers:nil body:nil];
+                }
+
+                self.numberOfPartBytesReceived += [body length];
+                self.receivedParts[@(partNumber)] = body;
+
+                NSString *hash = AFTestQueryValue(request.URL, @"hash");
+                if (hash) {
+                    self.receivedPartsByHash[hash] = body;
+                }
+
+                return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"ETag": [NSString stringWithFormat:@"\"part-%lu\"", (unsigned long)partNumber]} body:nil];
+            }
+
+            NSDictionary *commit = [NSJSONSerialization JSONObjectWithData:body options:(NSJSONReadingOptions)0 error:nil];
+            NSMutableData *committedData = [NSMutableData data];
+            for (NSDictionary *part in commit[@"parts"]) {
+                NSNumber *partNumber = part[@"partNumber"];
+                if (part[@"hash"]) {
+                    if (!self.receivedPartsByHash[part[@"hash"]]) {
+                        return [AFTestServerResponse responseWithStatusCode:400 headers:nil body:nil];
+                    }
+                    [committedData appendData:self.receivedPartsByHash[part[@"hash"]]];
+                    continue;
+                }
+
+                if (![part[@"etag"] isEqualToString:[NSString stringWithFormat:@"\"part-%@\"", partNumber]] || !self.receivedParts[partNumber]) {
+                    return [AFTestServerResponse responseWithStatusCode:400 headers:nil body:nil];
+                }
+                [committedData appendData:self.receivedParts[partNumber]];
+            }
+            self.committedData = committedData;
+
+            NSData *responseData = [NSJSONSerialization dataWithJSONObject:@{@"size": @([committedData length])} options:(NSJSONWritingOptions)0 error:nil];
+            return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/json"} body:responseData];
+        }
+    }];
+}
+
+- (AFChunkedUploadTask *)uploadWithCompletionHandler:(void (^)(id responseObject, NSError *error))completionHandler {
+    return [self uploadWithIdentifier:@"upload-1" completionHandler:completionHandler];
+}
+
+- (AFChunkedUploadTask *)uploadWithIdentifier:(NSString *)uploadIdentifier
+                            completionHandler:(void (^)(id responseObject, NSError *error))completionHandler
+{
+    NSURL *URL = [[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"uploads"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Upload should complete"];
+    AFChunkedUploadTask *task = [self.uploader uploadTaskWithFileURL:self.fileURL toURL:URL uploadIdentifier:uploadIdentifier progress:nil completionHandler:^(NSURLResponse * _Nullable response, id  _Nullable responseObject, NSError * _Nullable error) {
+        completionHandler(responseObject, error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    return task;
+}
+
+#pragma mark -
+
+- (void)testThatFileIsUploadedInPartsAndReassembled {
+    __block NSUInteger numberOfProgressUpdates = 0;
+    NSURL *URL = [[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"uploads"];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Upload should complete"];
+    AFChunkedUploadTask *task = [self.uploader uploadTaskWithFileURL:self.fileURL toURL:URL uploadIdentifier:@"upload-1" progress:^(NSProgress * _Nonnull uploadProgress) {
+        numberOfProgressUpdates++;
+    } completionHandler:^(NSURLResponse * _Nullable response, id  _Nullable responseObject, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(responseObject[@"size"], @([self.fileData length]));
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(task.numberOfParts, (NSUInteger)6);
+    XCTAssertEqual(self.numberOfPartRequests, (NSUInteger)6);
+    XCTAssertEqual(task.progress.completedUnitCount, (int64_t)[self.fileData length]);
+    XCTAssertTrue(numberOfProgressUpdates >= 6);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+    XCTAssertEqual([[[NSFileManager defaultManager] contentsOfDirectoryAtPath:[self.uploader.stateDirectoryURL path] error:nil] count], (NSUInteger)0);
+}
+
+- (void)testThatFailedPartIsRetriedOnItsOwn {
+    [self serveUploadsFailingRequestsPassingTest:^BOOL(NSUInteger partNumber, NSUInteger attempt) {
+        return partNumber == 2 && attempt <= 2;
+    }];
+
+    [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+
+    XCTAssertEqual(self.numberOfPartRequests, (NSUInteger)8);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+}
+
+- (void)testThatInterruptedUploadResumesWithoutResendingParts {
+    self.uploader.maximumNumberOfConcurrentParts = 1;
+    self.uploader.maximumNumberOfRetriesPerPart = 0;
+    [self serveUploadsFailingRequestsPassingTest:^BOOL(NSUInteger partNumber, NSUInteger attempt) {
+        return partNumber == 3;
+    }];
+
+    [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNotNil(error);
+    }];
+    XCTAssertNil(self.committedData);
+
+    // A new uploader, as in a restarted process, picks the upload up from the recorded parts
+    self.uploader = nil;
+    self.numberOfPartRequests = 0;
+    [self serveUploadsFailingRequestsPassingTest:nil];
+
+    AFChunkedUploadTask *task = [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+
+    XCTAssertEqual(task.numberOfResumedParts, (NSUInteger)2);
+    XCTAssertEqual(self.numberOfPartRequests, (NSUInteger)4);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+}
+
+- (void)testThatModifiedFileIsUploadedFromTheStart {
+    self.uploader.maximumNumberOfConcurrentParts = 1;
+    self.uploader.maximumNumberOfRetriesPerPart = 0;
+    [self serveUploadsFailingRequestsPassingTest:^BOOL(NSUInteger partNumber, NSUInteger attempt) {
+        return partNumber == 3;
+    }];
+
+    [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNotNil(error);
+    }];
+
+    NSMutableData *modifiedData = [self.fileData mutableCopy];
+    [modifiedData appendData:[@"appended" dataUsingEncoding:NSUTF8StringEncoding]];
+    self.fileData = modifiedData;
+    [self.fileData writeToURL:self.fileURL atomically:YES];
+
+    self.numberOfPartRequests = 0;
+    [self serveUploadsFailingRequestsPassingTest:nil];
+
+    AFChunkedUploadTask *task = [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+
+    XCTAssertEqual(task.numberOfResumedParts, (NSUInteger)0);
+    XCTAssertEqual(self.numberOfPartRequests, (NSUInteger)6);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+}
+
+#pragma mark - Content-Defined Chunking
+
+- (void)testThatEditedFileOnlyUploadsChangedParts {
+    NSMutableData *fileData = [NSMutableData dataWithLength:1024 * 1024];
+    SecRandomCopyBytes(kSecRandomDefault, [fileData length], [fileData mutableBytes]);
+    self.fileData = fileData;
+    [self.fileData writeToURL:self.fileURL atomically:YES];
+
+    self.uploader.chunking = AFChunkedUploadContentDefinedChunking;
+    self.uploader.partSize = 1024 * 16;
+
+    AFChunkedUploadTask *task = [self uploadWithIdentifier:@"upload-1" completionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+    XCTAssertEqual(task.numberOfDeduplicatedParts, (NSUInteger)0);
+    XCTAssertEqual(self.numberOfPartBytesReceived, [self.fileData length]);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+
+    // Inserting bytes in the middle shifts every fixed-size part after them, but only moves the content-defined boundaries around the edit
+    NSMutableData *editedData = [self.fileData mutableCopy];
+    NSMutableData *insertedData = [NSMutableData dataWithLength:100];
+    SecRandomCopyBytes(kSecRandomDefault, [insertedData length], [insertedData mutableBytes]);
+    [editedData replaceBytesInRange:NSMakeRange([editedData length] / 2, 0) withBytes:[insertedData bytes] length:[insertedData length]];
+    self.fileData = editedData;
+    [self.fileData writeToURL:self.fileURL atomically:YES];
+
+    self.numberOfPartBytesReceived = 0;
+    self.committedData = nil;
+
+    task = [self uploadWithIdentifier:@"upload-2" completionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+
+    XCTAssertTrue(task.numberOfDeduplicatedParts > 0);
+    XCTAssertEqual(task.numberOfDeduplicatedBytes + self.numberOfPartBytesReceived, [self.fileData length]);
+    XCTAssertTrue(self.numberOfPartBytesReceived < [self.fileData length] / 10);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+}
+
+- (void)testThatFailedMissingPartsRequestUploadsEveryPart {
+    self.uploader.chunking = AFChunkedUploadContentDefinedChunking;
+    self.uploader.partSize = 1024 * 16;
+    self.failsMissingPartsRequests = YES;
+
+    AFChunkedUploadTask *task = [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+
+    XCTAssertEqual(task.numberOfDeduplicatedParts, (NSUInteger)0);
+    XCTAssertEqual(self.numberOfPartRequests, task.numberOfParts);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+}
+
+- (void)testThatRequestBlocksReceivePartHashes {
+    self.uploader.chunking = AFChunkedUploadContentDefinedChunking;
+    self.uploader.partSize = 1024 * 16;
+
+    NSMutableSet <NSString *> *queriedHashes = [NSMutableSet set];
+    NSMutableSet <NSString *> *uploadedHashes = [NSMutableSet set];
+    self.uploader.missingPartsRequestBlock = ^NSURLRequest *(NSURL *URL, NSString *uploadIdentifier, NSArray <NSString *> *hashes) {
+        [queriedHashes addObjectsFromArray:hashes];
+
+        NSURLComponents *components = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+        components.queryItems = @[[NSURLQueryItem queryItemWithName:@"uploadId" value:uploadIdentifier], [NSURLQueryItem queryItemWithName:@"missing" value:nil]];
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:components.URL];
+        request.HTTPMethod = @"POST";
+        request.HTTPBody = [NSJSONSerialization dataWithJSONObject:@{@"hashes": hashes} options:(NSJSONWritingOptions)0 error:nil];
+        return request;
+    };
+    self.uploader.partRequestBlock = ^NSURLRequest *(NSURL *URL, NSString *uploadIdentifier, NSUInteger partNumber, unsigned long long offset, unsigned long long length, unsigned long long totalLength, NSString *hash) {
+        @synchronized (uploadedHashes) {
+            [uploadedHashes addObject:hash];
+        }
+
+        NSURLComponents *components = [NSURLComponents componentsWithURL:URL resolvingAgainstBaseURL:NO];
+        components.queryItems = @[[NSURLQueryItem queryItemWithName:@"uploadId" value:uploadIdentifier], [NSURLQueryItem queryItemWithName:@"partNumber" value:[@(partNumber) stringValue]], [NSURLQueryItem queryItemWithName:@"hash" value:hash]];
+        NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:components.URL];
+        request.HTTPMethod = @"PUT";
+        return request;
+    };
+
+    AFChunkedUploadTask *task = [self uploadWithCompletionHandler:^(id responseObject, NSError *error) {
+        XCTAssertNil(error);
+    }];
+
+    XCTAssertEqual([queriedHashes count], task.numberOfParts);
+    XCTAssertEqualObjects(uploadedHashes, queriedHashes);
+    XCTAssertEqualObjects(self.committedData, self.fileData);
+}
+
+@end
@@ -0,0 +1,152 @@
+// AFCompletionCoalescerTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFCompletionCoalescer.h"
+#import "AFURLSessionManager.h"
+
+@interface AFCompletionCoalescerTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@end
+
+@implementation AFCompletionCoalescerTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+#pragma mark -
+
+- (void)testThatBlocksEnqueuedTogetherAreDeliveredInOrderByFewDrains {
+    AFCompletionCoalescer *coalescer = [[AFCompletionCoalescer alloc] init];
+    coalescer.maximumNumberOfBlocksPerDrain = 64;
+
+    NSMutableArray *indexes = [NSMutableArray array];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Blocks should be delivered"];
+    for (NSUInteger idx = 0; idx < 100; idx++) {
+        [coalescer enqueueBlock:^{
+            XCTAssertTrue([NSThread isMainThread]);
+            [indexes addObject:@(idx)];
+            if (idx == 99) {
+                [expectation fulfill];
+            }
+        }];
+    }
+    XCTAssertEqual(coalescer.numberOfPendingBlocks, (NSUInteger)100);
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([indexes count], (NSUInteger)100);
+    XCTAssertEqualObjects([indexes firstObject], @0);
+    XCTAssertEqualObjects([indexes lastObject], @99);
+    XCTAssertEqual(coalescer.numberOfDrains, (NSUInteger)2);
+    XCTAssertEqual(coalescer.numberOfPendingBlocks, (NSUInteger)0);
+}
+
+- (void)testThatGroupIsLeftOnceBlocksHaveRun {
+    dispatch_queue_t queue = dispatch_queue_create("com.alamofire.networking.test.coalescer", DISPATCH_QUEUE_SERIAL);
+    AFCompletionCoalescer *coalescer = [[AFCompletionCoalescer alloc] initWithQueue:queue];
+    coalescer.maximumNumberOfBlocksPerDrain = 0;
+    dispatch_group_t group = dispatch_group_create();
+
+    __block NSUInteger numberOfBlocks = 0;
+    dispatch_apply(50, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t idx) {
+        [coalescer enqueueBlock:^{
+            numberOfBlocks++;
+        } group:group];
+    });
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Group should be notified"];
+    dispatch_group_notify(group, queue, ^{
+        XCTAssertEqual(numberOfBlocks, (NSUInteger)50);
+        [expectation fulfill];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertTrue(coalescer.numberOfDrains <= 50);
+}
+
+- (void)testThatDrainsAreSpacedByDrainInterval {
+    AFCompletionCoalescer *coalescer = [[AFCompletionCoalescer alloc] init];
+    coalescer.drainInterval = 0.2;
+
+    __block CFAbsoluteTime firstDrainTime = 0;
+    __block CFAbsoluteTime secondDrainTime = 0;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Both blocks should be delivered"];
+    [coalescer enqueueBlock:^{
+        firstDrainTime = CFAbsoluteTimeGetCurrent();
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+            [coalescer enqueueBlock:^{
+                secondDrainTime = CFAbsoluteTimeGetCurrent();
+                [expectation fulfill];
+            }];
+        });
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(coalescer.numberOfDrains, (NSUInteger)2);
+    XCTAssertGreaterThanOrEqual(secondDrainTime - firstDrainTime, 0.15);
+}
+
+- (void)testThatManagerDeliversCompletionsThroughCoalescer {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/json"} body:[@"{}" dataUsingEncoding:NSUTF8StringEncoding]];
+    }];
+
+    AFCompletionCoalescer *coalescer = [[AFCompletionCoalescer alloc] init];
+    self.manager.completionCoalescer = coalescer;
+
+    NSUInteger numberOfTasks = 200;
+    __block NSUInteger numberOfCompletions = 0;
+    __block NSUInteger numberOfNotifications = 0;
+    id observer = [[NSNotificationCenter defaultCenter] addObserverForName:AFNetworkingTaskDidCompleteNotification object:nil queue:nil usingBlock:^(NSNotification *notification) {
+        XCTAssertTrue([NSThread isMainThread]);
+        numberOfNotifications++;
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"All tasks should complete"];
+    for (NSUInteger idx = 0; idx < numberOfTasks; idx++) {
+        NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:[NSString stringWithFormat:@"items/%lu", (unsigned long)idx]]];
+        [[self.manager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+            XCTAssertNil(error);
+            XCTAssertTrue([NSThread isMainThread]);
+            if (++numberOfCompletions == numberOfTasks) {
+                [expectation fulfill];
+            }
+        }] resume];
+    }
+    [self waitForExpectationsWithCommonTimeout];
+    [[NSNotificationCenter defaultCenter] removeObserver:observer];
+
+    XCTAssertEqual(numberOfCompletions, numberOfTasks);
+    XCTAssertEqual(numberOfNotifications, numberOfTasks);
+    XCTAssertTrue(coalescer.numberOfDrains <= numberOfTasks);
+}
+
+@end
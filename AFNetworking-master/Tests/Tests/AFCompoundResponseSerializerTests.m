@@ -23,6 +23,32 @@
 #import "AFTestCase.h"
 #import "AFURLResponseSerialization.h"
 
+@interface AFCountingJSONResponseSerializer : AFJSONResponseSerializer
+@property (atomic, assign) NSUInteger numberOfResponses;
+@end
+
+@implementation AFCountingJSONResponseSerializer
+
+- (id)responseObjectForResponse:(NSURLResponse *)response data:(NSData *)data error:(NSError *__autoreleasing *)error {
+    self.numberOfResponses++;
+    return [super responseObjectForResponse:response data:data error:error];
+}
+
+@end
+
+@interface AFCountingPropertyListResponseSerializer : AFPropertyListResponseSerializer
+@property (atomic, assign) NSUInteger numberOfResponses;
+@end
+
+@implementation AFCountingPropertyListResponseSerializer
+
+- (id)responseObjectForResponse:(NSURLResponse *)response data:(NSData *)data error:(NSError *__autoreleasing *)error {
+    self.numberOfResponses++;
+    return [super responseObjectForResponse:response data:data error:error];
+}
+
+@end
+
 @interface AFCompoundResponseSerializerTests : AFTestCase
 
 @end
@@ -91,4 +117,92 @@
     XCTAssertTrue([NSStringFromClass([unarchivedSerializer.responseSerializers[1] class]) isEqualToString:NSStringFromClass([AFJSONResponseSerializer class])]);
 }
 
+#pragma mark - Dispatching
+
+- (NSHTTPURLResponse *)responseWithHeaderFields:(NSDictionary *)headerFields {
+    return [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"http://test.com"] statusCode:200 HTTPVersion:@"1.1" headerFields:headerFields];
+}
+
+- (void)testCompoundSerializerDecodesEachResponseWithOneSerializer {
+    AFCountingPropertyListResponseSerializer *propertyListSerializer = [AFCountingPropertyListResponseSerializer serializer];
+    AFCountingJSONResponseSerializer *jsonSerializer = [AFCountingJSONResponseSerializer serializer];
+    AFCompoundResponseSerializer *compoundSerializer = [AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[[AFImageResponseSerializer serializer], [AFXMLParserResponseSerializer serializer], propertyListSerializer, jsonSerializer]];
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@{@"key":@"value"} options:(NSJSONWritingOptions)0 error:nil];
+    for (NSUInteger idx = 0; idx < 10; idx++) {
+        NSError *error = nil;
+        id responseObject = [compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"text/json"}] data:data error:&error];
+        XCTAssertEqualObjects(responseObject, @{@"key":@"value"});
+        XCTAssertNil(error);
+    }
+
+    XCTAssertEqual(jsonSerializer.numberOfResponses, (NSUInteger)10);
+    XCTAssertEqual(propertyListSerializer.numberOfResponses, (NSUInteger)0);
+    XCTAssertEqual(compoundSerializer.numberOfResponsesDispatchedByContentType, (NSUInteger)10);
+    XCTAssertEqual(compoundSerializer.numberOfResponsesDispatchedBySniffing, (NSUInteger)0);
+    XCTAssertEqual(compoundSerializer.numberOfUndispatchedResponses, (NSUInteger)0);
+}
+
+- (void)testCompoundSerializerSniffsResponsesWithMissingOrUnacceptedContentTypes {
+    AFCountingPropertyListResponseSerializer *propertyListSerializer = [AFCountingPropertyListResponseSerializer serializer];
+    AFCountingJSONResponseSerializer *jsonSerializer = [AFCountingJSONResponseSerializer serializer];
+    AFCompoundResponseSerializer *compoundSerializer = [AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[[AFImageResponseSerializer serializer], propertyListSerializer, jsonSerializer]];
+
+    NSError *error = nil;
+    NSData *jsonData = [@"\n  [1, 2, 3]" dataUsingEncoding:NSUTF8StringEncoding];
+    XCTAssertEqualObjects([compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"text/plain; charset=utf-8"}] data:jsonData error:&error], (@[@1, @2, @3]));
+    XCTAssertNil(error);
+
+    NSData *propertyListData = [NSPropertyListSerialization dataWithPropertyList:@{@"key":@"value"} format:NSPropertyListBinaryFormat_v1_0 options:0 error:nil];
+    XCTAssertEqualObjects([compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{}] data:propertyListData error:&error], @{@"key":@"value"});
+    XCTAssertNil(error);
+
+    XCTAssertEqual(jsonSerializer.numberOfResponses, (NSUInteger)1);
+    XCTAssertEqual(propertyListSerializer.numberOfResponses, (NSUInteger)1);
+    XCTAssertEqual(compoundSerializer.numberOfResponsesDispatchedByContentType, (NSUInteger)0);
+    XCTAssertEqual(compoundSerializer.numberOfResponsesDispatchedBySniffing, (NSUInteger)2);
+}
+
+- (void)testCompoundSerializerFallsBackForUnrecognizedResponses {
+    AFCountingJSONResponseSerializer *jsonSerializer = [AFCountingJSONResponseSerializer serializer];
+    AFCompoundResponseSerializer *compoundSerializer = [AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[jsonSerializer]];
+
+    NSData *data = [@"Hello, world" dataUsingEncoding:NSUTF8StringEncoding];
+    NSError *error = nil;
+    id responseObject = [compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"text/plain"}] data:data error:&error];
+    XCTAssertEqualObjects(responseObject, data);
+    XCTAssertNil(error);
+    XCTAssertEqual(jsonSerializer.numberOfResponses, (NSUInteger)0);
+    XCTAssertEqual(compoundSerializer.numberOfUndispatchedResponses, (NSUInteger)1);
+}
+
+- (void)testCompoundSerializerDispatchesToEarliestSerializerAcceptingContentType {
+    AFCountingJSONResponseSerializer *firstSerializer = [AFCountingJSONResponseSerializer serializer];
+    AFCountingJSONResponseSerializer *secondSerializer = [AFCountingJSONResponseSerializer serializer];
+    AFCompoundResponseSerializer *compoundSerializer = [AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[firstSerializer, secondSerializer]];
+    AFCompoundResponseSerializer *unarchivedSerializer = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:compoundSerializer]];
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@{@"key":@"value"} options:(NSJSONWritingOptions)0 error:nil];
+    [compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"application/json"}] data:data error:nil];
+    XCTAssertEqual(firstSerializer.numberOfResponses, (NSUInteger)1);
+    XCTAssertEqual(secondSerializer.numberOfResponses, (NSUInteger)0);
+
+    XCTAssertEqualObjects([unarchivedSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"application/json"}] data:data error:nil], @{@"key":@"value"});
+    XCTAssertEqual(unarchivedSerializer.numberOfResponsesDispatchedByContentType, (NSUInteger)1);
+}
+
+- (void)testCompoundSerializerDispatchesContentTypesAcceptedAfterCreation {
+    AFCountingJSONResponseSerializer *jsonSerializer = [AFCountingJSONResponseSerializer serializer];
+    AFCompoundResponseSerializer *compoundSerializer = [AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[jsonSerializer]];
+
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@{@"key":@"value"} options:(NSJSONWritingOptions)0 error:nil];
+    [compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"application/vnd.api+json"}] data:data error:nil];
+    XCTAssertEqual(compoundSerializer.numberOfResponsesDispatchedBySniffing, (NSUInteger)1);
+
+    jsonSerializer.acceptableContentTypes = [jsonSerializer.acceptableContentTypes setByAddingObject:@"application/vnd.api+json"];
+    XCTAssertEqualObjects([compoundSerializer responseObjectForResponse:[self responseWithHeaderFields:@{@"Content-Type":@"application/vnd.api+json"}] data:data error:nil], @{@"key":@"value"});
+    XCTAssertEqual(compoundSerializer.numberOfResponsesDispatchedByContentType, (NSUInteger)1);
+    XCTAssertEqual(jsonSerializer.numberOfResponses, (NSUInteger)2);
+}
+
 @end
@@ -0,0 +1,337 @@
+// AFContentDecoderTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import <zlib.h>
+
+#import "AFURLSessionManager.h"
+
+static NSData * AFTestCompressedData(NSData *data, int windowBits, NSData *dictionary) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+
+    if (dictionary) {
+        deflateSetDictionary(&stream, [dictionary bytes], (uInt)[dictionary length]);
+    }
+
+    NSMutableData *compressedData = [NSMutableData dataWithLength:deflateBound(&stream, (uLong)[data length])];
+    stream.next_in = (Bytef *)[data bytes];
+    stream.avail_in = (uInt)[data length];
+    stream.next_out = [compressedData mutableBytes];
+    stream.avail_out = (uInt)[compressedData length];
+
+    int status = deflate(&stream, Z_FINISH);
+    deflateEnd(&stream);
+
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+
+    [compressedData setLength:stream.total_out];
+
+    return compressedData;
+}
+
+static NSData * AFTestDecodedDataInChunks(id <AFContentDecoder> decoder, NSData *data, NSUInteger chunkLength, NSError * __autoreleasing *error) {
+    NSMutableData *decodedData = [NSMutableData data];
+    for (NSUInteger offset = 0; offset < [data length]; offset += chunkLength) {
+        NSData *chunk = [decoder decodedDataFromData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, [data length] - offset))] error:error];
+        if (!chunk) {
+            return nil;
+        }
+
+        [decodedData appendData:chunk];
+    }
+
+    NSData *remainingData = [decoder finishDecoding:error];
+    if (!remainingData) {
+        return nil;
+    }
+
+    [decodedData appendData:remainingData];
+
+    return decodedData;
+}
+
+@interface AFContentDecoderTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@property (readwrite, nonatomic, strong) NSData *dictionary;
+@end
+
+@implementation AFContentDecoderTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    self.dictionary = [@"{\"id\":,\"login\":\"\",\"type\":\"User\",\"site_admin\":false,\"avatar_url\":\"https://avatars.example.com/u/\",\"followers\":,\"following\":}" dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *)responseWithContentEncoding:(NSString *)contentEncoding {
+    return [[NSHTTPURLResponse alloc] initWithURL:[AFTestURLProtocol baseURL] statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type": @"application/json", @"Content-Encoding": contentEncoding}];
+}
+
+- (NSData *)userDataWithIdentifier:(NSUInteger)identifier {
+    NSString *string = [NSString stringWithFormat:@"{\"id\":%lu,\"login\":\"user%lu\",\"type\":\"User\",\"site_admin\":false,\"avatar_url\":\"https://avatars.example.com/u/%lu\",\"followers\":%lu,\"following\":%lu}", (unsigned long)identifier, (unsigned long)identifier, (unsigned long)identifier, (unsigned long)(identifier * 3 % 1000), (unsigned long)(identifier % 17)];
+
+    return [string dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (NSData *)usersDataWithNumberOfUsers:(NSUInteger)numberOfUsers {
+    NSMutableData *data = [NSMutableData dataWithBytes:"[" length:1];
+    for (NSUInteger idx = 0; idx < numberOfUsers; idx++) {
+        if (idx > 0) {
+            [data appendBytes:"," length:1];
+        }
+        [data appendData:[self userDataWithIdentifier:idx]];
+    }
+    [data appendBytes:"]" length:1];
+
+    return data;
+}
+
+#pragma mark -
+
+- (void)testThatZlibFormatsAreDecodedInChunksOfEverySize {
+    NSData *data = [self usersDataWithNumberOfUsers:200];
+    NSDictionary <NSNumber *, NSNumber *> *windowBitsKeyedByFormat = @{@(AFZlibContentFormatZlib): @(MAX_WBITS), @(AFZlibContentFormatGZip): @(MAX_WBITS + 16), @(AFZlibContentFormatRawDeflate): @(-MAX_WBITS)};
+
+    [windowBitsKeyedByFormat enumerateKeysAndObjectsUsingBlock:^(NSNumber *format, NSNumber *windowBits, BOOL * __unused stop) {
+        NSData *compressedData = AFTestCompressedData(data, [windowBits intValue], nil);
+        for (NSUInteger chunkLength = 1; chunkLength <= [compressedData length]; chunkLength += (chunkLength < 64 ? 1 : 257)) {
+            AFZlibContentDecoder *decoder = [[AFZlibContentDecoder alloc] initWithFormat:[format unsignedIntegerValue] dictionaries:nil];
+
+            NSError *error = nil;
+            XCTAssertEqualObjects(AFTestDecodedDataInChunks(decoder, compressedData, chunkLength, &error), data, @"Format %@ in chunks of %lu bytes", format, (unsigned long)chunkLength);
+            XCTAssertNil(error);
+        }
+    }];
+}
+
+- (void)testThatPresetDictionaryIsChosenByItsChecksum {
+    NSData *data = [self userDataWithIdentifier:42];
+    NSData *otherDictionary = [@"<html><head></head><body></body></html>" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *compressedData = AFTestCompressedData(data, MAX_WBITS, self.dictionary);
+
+    AFZlibContentDecoder *decoder = [[AFZlibContentDecoder alloc] initWithFormat:AFZlibContentFormatZlib dictionaries:@[otherDictionary, self.dictionary]];
+    XCTAssertEqualObjects(AFTestDecodedDataInChunks(decoder, compressedData, 7, nil), data);
+
+    NSError *error = nil;
+    decoder = [[AFZlibContentDecoder alloc] initWithFormat:AFZlibContentFormatZlib dictionaries:@[otherDictionary]];
+    XCTAssertNil(AFTestDecodedDataInChunks(decoder, compressedData, 7, &error));
+    XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+    XCTAssertEqual(error.code, NSURLErrorCannotDecodeRawData);
+
+    decoder = [[AFZlibContentDecoder alloc] initWithFormat:AFZlibContentFormatRawDeflate dictionaries:@[self.dictionary]];
+    XCTAssertEqualObjects(AFTestDecodedDataInChunks(decoder, AFTestCompressedData(data, -MAX_WBITS, self.dictionary), 7, nil), data);
+}
+
+- (void)testThatTruncatedAndCorruptDataFail {
+    NSData *compressedData = AFTestCompressedData([self usersDataWithNumberOfUsers:10], MAX_WBITS + 16, nil);
+
+    NSError *error = nil;
+    AFZlibContentDecoder *decoder = [[AFZlibContentDecoder alloc] initWithFormat:AFZlibContentFormatGZip dictionaries:nil];
+    XCTAssertNil(AFTestDecodedDataInChunks(decoder, [compressedData subdataWithRange:NSMakeRange(0, [compressedData length] - 4)], 100, &error));
+    XCTAssertEqual(error.code, NSURLErrorCannotDecodeRawData);
+
+    error = nil;
+    NSMutableData *corruptData = [compressedData mutableCopy];
+    ((uint8_t *)[corruptData mutableBytes])[20] ^= 0xFF;
+    decoder = [[AFZlibContentDecoder alloc] initWithFormat:AFZlibContentFormatGZip dictionaries:nil];
+    XCTAssertNil(AFTestDecodedDataInChunks(decoder, corruptData, 100, &error));
+    XCTAssertEqual(error.code, NSURLErrorCannotDecodeRawData);
+
+    error = nil;
+    NSMutableData *trailingData = [compressedData mutableCopy];
+    [trailingData appendBytes:"garbage" length:7];
+    decoder = [[AFZlibContentDecoder alloc] initWithFormat:AFZlibContentFormatGZip dictionaries:nil];
+    XCTAssertNil(AFTestDecodedDataInChunks(decoder, trailingData, 100, &error));
+    XCTAssertEqual(error.code, NSURLErrorCannotDecodeRawData);
+}
+
+- (void)testThatRegistryDecodesRegisteredContentCodingsFromTheLast {
+    NSData *data = [self usersDataWithNumberOfUsers:20];
+    AFContentDecoderRegistry *registry = [AFContentDecoderRegistry registry];
+    registry.dictionaries = @[self.dictionary];
+    [registry setZlibDecoderWithFormat:AFZlibContentFormatZlib forContentCoding:@"X-Dictionary-Deflate"];
+    [registry setZlibDecoderWithFormat:AFZlibContentFormatRawDeflate forContentCoding:@"x-raw-deflate"];
+
+    XCTAssertEqualObjects(registry.contentCodings, ([NSSet setWithObjects:@"x-dictionary-deflate", @"x-raw-deflate", nil]));
+
+    NSData *encodedData = AFTestCompressedData(AFTestCompressedData(data, MAX_WBITS, self.dictionary), -MAX_WBITS, nil);
+    id <AFContentDecoder> decoder = [registry decoderForResponse:[self responseWithContentEncoding:@"x-dictionary-deflate, identity, X-RAW-DEFLATE"] error:nil];
+    XCTAssertEqualObjects(AFTestDecodedDataInChunks(decoder, encodedData, 13, nil), data);
+
+    // The platform decodes gzip itself, so a response whose last coding is not registered is passed through
+    NSError *error = nil;
+    XCTAssertNil([registry decoderForResponse:[self responseWithContentEncoding:@"x-dictionary-deflate, gzip"] error:&error]);
+    XCTAssertNil([registry decoderForResponse:[self responseWithContentEncoding:@"identity"] error:&error]);
+    XCTAssertNil(error);
+
+    [registry setDecoderProvider:^id <AFContentDecoder>(NSURLResponse *response, NSArray <NSData *> *dictionaries) {
+        return nil;
+    } forContentCoding:@"x-unavailable"];
+    XCTAssertNil([registry decoderForResponse:[self responseWithContentEncoding:@"x-unavailable"] error:&error]);
+    XCTAssertEqual(error.code, NSURLErrorCannotDecodeRawData);
+
+    AFContentDecoderRegistry *copiedRegistry = [registry copy];
+    [copiedRegistry setDecoderProvider:nil forContentCoding:@"x-raw-deflate"];
+    XCTAssertEqual([copiedRegistry.contentCodings count], (NSUInteger)2);
+    XCTAssertEqual([registry.contentCodings count], (NSUInteger)3);
+}
+
+- (void)testThatRegistryFindsContentEncodingHeaderOfAnyCase {
+    NSData *data = [self usersDataWithNumberOfUsers:20];
+    AFContentDecoderRegistry *registry = [AFContentDecoderRegistry registry];
+    [registry setZlibDecoderWithFormat:AFZlibContentFormatRawDeflate forContentCoding:@"x-raw-deflate"];
+
+    // HTTP/2 sends header field names in lower case
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:[AFTestURLProtocol baseURL] statusCode:200 HTTPVersion:@"2.0" headerFields:@{@"content-type": @"application/json", @"content-encoding": @"x-raw-deflate"}];
+    id <AFContentDecoder> decoder = [registry decoderForResponse:response error:nil];
+    XCTAssertEqualObjects(AFTestDecodedDataInChunks(decoder, AFTestCompressedData(data, -MAX_WBITS, nil), 13, nil), data);
+}
+
+- (void)testThatSessionManagerDecodesResponsesAsTheyAreReceived {
+    NSData *data = [self usersDataWithNumberOfUsers:2000];
+    NSData *compressedData = AFTestCompressedData(data, MAX_WBITS, self.dictionary);
+
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/json", @"Content-Encoding": @"x-dictionary-deflate"} body:compressedData];
+        response.chunkSize = 1000;
+        return response;
+    }];
+
+    self.manager.contentDecoderRegistry = [AFContentDecoderRegistry registry];
+    self.manager.contentDecoderRegistry.dictionaries = @[self.dictionary];
+    [self.manager.contentDecoderRegistry setZlibDecoderWithFormat:AFZlibContentFormatZlib forContentCoding:@"x-dictionary-deflate"];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Task should complete"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"users"]];
+    [[self.manager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+        XCTAssertNil(error);
+        XCTAssertEqual([responseObject count], (NSUInteger)2000);
+        XCTAssertEqualObjects([responseObject lastObject][@"login"], @"user1999");
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    NSMutableData *lines = [NSMutableData data];
+    for (NSUInteger idx = 0; idx < 500; idx++) {
+        [lines appendData:[self userDataWithIdentifier:idx]];
+        [lines appendBytes:"\n" length:1];
+    }
+
+    NSData *compressedLines = AFTestCompressedData(lines, MAX_WBITS, self.dictionary);
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/x-ndjson", @"Content-Encoding": @"x-dictionary-deflate"} body:compressedLines];
+        response.chunkSize = 100;
+        return response;
+    }];
+
+    __block NSUInteger numberOfRecords = 0;
+    AFJSONLinesStream *stream = [[AFJSONLinesResponseSerializer serializer] streamWithBatchHandler:^(NSArray *records) {
+        numberOfRecords += [records count];
+    }];
+
+    expectation = [self expectationWithDescription:@"Stream should complete"];
+    [[self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(numberOfRecords, (NSUInteger)500);
+}
+
+- (void)testThatUndecodableResponseFailsTask {
+    NSData *compressedData = AFTestCompressedData([self usersDataWithNumberOfUsers:10], MAX_WBITS, self.dictionary);
+
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/json", @"Content-Encoding": @"x-dictionary-deflate"} body:compressedData];
+    }];
+
+    // No dictionaries are registered
+    self.manager.contentDecoderRegistry = [AFContentDecoderRegistry registry];
+    [self.manager.contentDecoderRegistry setZlibDecoderWithFormat:AFZlibContentFormatZlib forContentCoding:@"x-dictionary-deflate"];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Task should fail"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"users"]];
+    [[self.manager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+        XCTAssertNil(responseObject);
+        XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorCannotDecodeRawData);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectationsWithCommonTimeout];
+}
+
+- (void)testThatDictionaryHalvesCompressedLengthOfSmallResponses {
+    NSUInteger numberOfResponses = 1000;
+    NSUInteger compressedLength = 0;
+    NSUInteger dictionaryCompressedLength = 0;
+
+    AFContentDecoderRegistry *registry = [AFContentDecoderRegistry registry];
+    registry.dictionaries = @[self.dictionary];
+    [registry setZlibDecoderWithFormat:AFZlibContentFormatZlib forContentCoding:@"x-dictionary-deflate"];
+    NSHTTPURLResponse *response = [self responseWithContentEncoding:@"x-dictionary-deflate"];
+
+    for (NSUInteger idx = 0; idx < numberOfResponses; idx++) {
+        NSData *data = [self userDataWithIdentifier:idx * 7919];
+        NSData *dictionaryCompressedData = AFTestCompressedData(data, MAX_WBITS, self.dictionary);
+        compressedLength += [AFTestCompressedData(data, MAX_WBITS, nil) length];
+        dictionaryCompressedLength += [dictionaryCompressedData length];
+
+        NSData *decodedData = AFTestDecodedDataInChunks([registry decoderForResponse:response error:nil], dictionaryCompressedData, [dictionaryCompressedData length], nil);
+        XCTAssertEqualObjects(decodedData, data);
+    }
+
+    XCTAssertLessThan(dictionaryCompressedLength * 2, compressedLength);
+}
+
+- (void)testPerformanceOfDecodingSmallResponsesWithDictionary {
+    AFContentDecoderRegistry *registry = [AFContentDecoderRegistry registry];
+    registry.dictionaries = @[self.dictionary];
+    [registry setZlibDecoderWithFormat:AFZlibContentFormatZlib forContentCoding:@"x-dictionary-deflate"];
+    NSHTTPURLResponse *response = [self responseWithContentEncoding:@"x-dictionary-deflate"];
+
+    NSMutableArray <NSData *> *compressedResponses = [NSMutableArray array];
+    for (NSUInteger idx = 0; idx < 1000; idx++) {
+        [compressedResponses addObject:AFTestCompressedData([self userDataWithIdentifier:idx * 7919], MAX_WBITS, self.dictionary)];
+    }
+
+    [self measureBlock:^{
+        for (NSData *compressedData in compressedResponses) {
+            XCTAssertNotNil(AFTestDecodedDataInChunks([registry decoderForResponse:response error:nil], compressedData, [compressedData length], nil));
+        }
+    }];
+}
+
+@end
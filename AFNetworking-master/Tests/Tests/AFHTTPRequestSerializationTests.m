@@ -23,8 +23,11 @@
 
 #import "AFURLRequestSerialization.h"
 
+#import <zlib.h>
+
 @interface AFMultipartBodyStream : NSInputStream <NSStreamDelegate>
 @property (readwrite, nonatomic, strong) NSMutableArray *HTTPBodyParts;
+@property (readonly, nonatomic, assign) unsigned long long contentLength;
 @end
 
 @protocol AFMultipartFormDataTest <AFMultipartFormData>
@@ -50,6 +53,67 @@
         maxLength:(NSUInteger)length;
 @end
 
+static NSData * AFTestInflatedDataFromData(NSData *data) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // Automatically detect gzip or zlib headers
+    if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *inflatedData = [NSMutableData dataWithLength:[data length] * 4 + 1024];
+    stream.next_in = (Bytef *)[data bytes];
+    stream.avail_in = (uInt)[data length];
+
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out >= [inflatedData length]) {
+            [inflatedData increaseLengthBy:[inflatedData length]];
+        }
+        stream.next_out = (Bytef *)[inflatedData mutableBytes] + stream.total_out;
+        stream.avail_out = (uInt)([inflatedData length] - stream.total_out);
+        status = inflate(&stream, Z_SYNC_FLUSH);
+    }
+
+    inflateEnd(&stream);
+
+    if (status != Z_STREAM_END) {
+        return nil;
+    }
+
+    [inflatedData setLength:stream.total_out];
+
+    return inflatedData;
+}
+
+static NSData * AFTestDataByReadingInputStream(NSInputStream *inputStream, NSUInteger bufferLength) {
+    NSMutableData *data = [NSMutableData data];
+    uint8_t *buffer = malloc(bufferLength);
+
+    [inputStream open];
+    while ([inputStream hasBytesAvailable]) {
+        NSInteger numberOfBytesRead = [inputStream read:buffer maxLength:bufferLength];
+        if (numberOfBytesRead <= 0) {
+            break;
+        }
+        [data appendBytes:buffer length:(NSUInteger)numberOfBytesRead];
+    }
+    [inputStream close];
+
+    free(buffer);
+
+    return data;
+}
+
+static NSDictionary * AFTestCompressibleParameters(NSUInteger count) {
+    NSMutableArray *items = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger idx = 0; idx < count; idx++) {
+        [items addObject:@{@"id": @(idx), @"name": [NSString stringWithFormat:@"Item %lu", (unsigned long)idx], @"tags": @[@"alpha", @"beta", @"gamma"], @"active": @(idx % 2 == 0)}];
+    }
+
+    return @{@"items": items};
+}
+
 #pragma mark -
 
 @interface AFHTTPRequestSerializationTests : AFTestCase
@@ -213,6 +277,418 @@
     } // Test succeeds if it does not EXC_BAD_ACCESS when cleaning up the @autoreleasepool
 }
 
+#pragma mark - Multipart Body Stream
+
+- (void)testThatMultipartContentLengthMatchesBytesRead {
+    NSMutableURLRequest *originalRequest = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"http://example.com"]];
+    Class streamClass = NSClassFromString(@"AFStreamingMultipartFormData");
+    id <AFMultipartFormDataTest> formData = [[streamClass alloc] initWithURLRequest:originalRequest stringEncoding:NSUTF8StringEncoding];
+
+    NSURL *fileURL = [NSURL fileURLWithPath:[[NSBundle bundleForClass:[self class]] pathForResource:@"ADNNetServerTrustChain/adn_0" ofType:@"cer"]];
+    [formData appendPartWithFileURL:fileURL name:@"file" error:NULL];
+    [formData appendPartWithFormData:[@"value" dataUsingEncoding:NSUTF8StringEncoding] name:@"key"];
+
+    unsigned long long contentLength = [formData.bodyStream contentLength];
+
+    [formData appendPartWithFileData:[@"{}" dataUsingEncoding:NSUTF8StringEncoding] name:@"json" fileName:@"empty.json" mimeType:@"application/json"];
+    XCTAssertGreaterThan([formData.bodyStream contentLength], contentLength, @"Content length should be recalculated after appending a part");
+
+    NSData *body = AFTestDataByReadingInputStream(formData.bodyStream, 7);
+    XCTAssertEqual((unsigned long long)[body length], [formData.bodyStream contentLength]);
+
+    NSString *bodyString = [[NSString alloc] initWithData:body encoding:NSISOLatin1StringEncoding];
+    XCTAssertEqual([[bodyString componentsSeparatedByString:@"Content-Disposition"] count], (NSUInteger)4);
+    XCTAssertTrue([bodyString hasSuffix:@"--\r\n"]);
+}
+
+- (void)testThatMultipartBodyStreamHandsOutBuffersForInMemoryAndMappedParts {
+    NSMutableURLRequest *originalRequest = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"http://example.com"]];
+    Class streamClass = NSClassFromString(@"AFStreamingMultipartFormData");
+    id <AFMultipartFormDataTest> formData = [[streamClass alloc] initWithURLRequest:originalRequest stringEncoding:NSUTF8StringEncoding];
+
+    NSURL *fileURL = [NSURL fileURLWithPath:[[NSBundle bundleForClass:[self class]] pathForResource:@"ADNNetServerTrustChain/adn_0" ofType:@"cer"]];
+    [formData appendPartWithFileURL:fileURL name:@"file" error:NULL];
+    [formData appendPartWithFormData:[@"value" dataUsingEncoding:NSUTF8StringEncoding] name:@"key"];
+
+    NSInputStream *bodyStream = [(id <NSCopying>)formData.bodyStream copyWithZone:nil];
+    NSData *expectedBody = AFTestDataByReadingInputStream([(id <NSCopying>)formData.bodyStream copyWithZone:nil], 1024);
+
+    NSMutableData *body = [NSMutableData data];
+    uint8_t *buffer = NULL;
+    NSUInteger length = 0;
+    NSUInteger numberOfBuffers = 0;
+
+    [bodyStream open];
+    while ([bodyStream getBuffer:&buffer length:&length]) {
+        [body appendBytes:buffer length:length];
+        numberOfBuffers++;
+    }
+    [bodyStream close];
+
+    XCTAssertEqualObjects(body, expectedBody);
+    XCTAssertEqual(numberOfBuffers, (NSUInteger)5, @"Every part should be handed out as its preamble, body and, for the last part, epilogue");
+}
+
+- (void)testThatMultipartBodyStreamFallsBackToReadingForStreamedParts {
+    NSMutableURLRequest *originalRequest = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"http://example.com"]];
+    Class streamClass = NSClassFromString(@"AFStreamingMultipartFormData");
+    id <AFMultipartFormDataTest> formData = [[streamClass alloc] initWithURLRequest:originalRequest stringEncoding:NSUTF8StringEncoding];
+
+    NSData *streamedData = [@"streamed value" dataUsingEncoding:NSUTF8StringEncoding];
+    [formData appendPartWithFormData:[@"value" dataUsingEncoding:NSUTF8StringEncoding] name:@"key"];
+    [formData appendPartWithInputStream:[NSInputStream inputStreamWithData:streamedData] name:@"stream" fileName:@"stream.txt" length:(int64_t)[streamedData length] mimeType:@"text/plain"];
+
+    NSMutableData *body = [NSMutableData data];
+    uint8_t *buffer = NULL;
+    NSUInteger length = 0;
+
+    [formData.bodyStream open];
+    while ([formData.bodyStream getBuffer:&buffer length:&length]) {
+        [body appendBytes:buffer length:length];
+    }
+    [body appendData:AFTestDataByReadingInputStream(formData.bodyStream, 3)];
+
+    XCTAssertEqual((unsigned long long)[body length], [formData.bodyStream contentLength]);
+    XCTAssertTrue([body rangeOfData:streamedData options:0 range:NSMakeRange(0, [body length])].location != NSNotFound);
+}
+
+- (void)testMultipartBodyStreamThroughputWithManySmallParts {
+    NSData *value = [@"value" dataUsingEncoding:NSUTF8StringEncoding];
+    NSUInteger numberOfParts = 10000;
+
+    [self measureBlock:^{
+        NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:@"http://example.com" parameters:nil constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+            for (NSUInteger idx = 0; idx < numberOfParts; idx++) {
+                [formData appendPartWithFormData:value name:@"key"];
+            }
+        } error:nil];
+
+        NSData *body = AFTestDataByReadingInputStream(request.HTTPBodyStream, 1024 * 16);
+
+        XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Length"], ([NSString stringWithFormat:@"%lu", (unsigned long)[body length]]));
+    }];
+}
+
+- (void)testThatMultipartFormWithPartOfUnknownLengthIsStreamedAsItIsProduced {
+    CFReadStreamRef readStream = NULL;
+    CFWriteStreamRef writeStream = NULL;
+    CFStreamCreateBoundPair(kCFAllocatorDefault, &readStream, &writeStream, 1024 * 16);
+    NSInputStream *inputStream = (__bridge_transfer NSInputStream *)readStream;
+    NSOutputStream *outputStream = (__bridge_transfer NSOutputStream *)writeStream;
+
+    NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:self.baseURL.absoluteString parameters:@{@"key": @"value"} constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+        [formData appendPartWithInputStream:inputStream name:@"log" fileName:@"log.txt" length:NSURLSessionTransferSizeUnknown mimeType:@"text/plain"];
+    } error:nil];
+
+    XCTAssertNil([request valueForHTTPHeaderField:@"Content-Length"]);
+
+    NSData *firstLine = [@"first line\n" dataUsingEncoding:NSUTF8StringEncoding];
+    NSData *secondLine = [@"second line\n" dataUsingEncoding:NSUTF8StringEncoding];
+    [outputStream open];
+    [outputStream write:[firstLine bytes] maxLength:[firstLine length]];
+
+    // The bytes written so far are handed out right away, even though the part hasn't ended
+    NSInputStream *bodyStream = request.HTTPBodyStream;
+    uint8_t buffer[1024 * 64];
+    [bodyStream open];
+    NSInteger numberOfBytesRead = [bodyStream read:buffer maxLength:sizeof(buffer)];
+    XCTAssertTrue(numberOfBytesRead > 0);
+    NSMutableData *body = [NSMutableData dataWithBytes:buffer length:(NSUInteger)numberOfBytesRead];
+    XCTAssertTrue([[[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding] hasSuffix:@"first line\n"]);
+
+    [outputStream write:[secondLine bytes] maxLength:[secondLine length]];
+    [outputStream close];
+
+    while ((numberOfBytesRead = [bodyStream read:buffer maxLength:sizeof(buffer)]) > 0) {
+        [body appendBytes:buffer length:(NSUInteger)numberOfBytesRead];
+    }
+    [bodyStream close];
+
+    NSString *bodyString = [[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding];
+    XCTAssertTrue([bodyString containsString:@"first line\nsecond line\n"]);
+    XCTAssertTrue([bodyString hasSuffix:@"--\r\n"]);
+}
+
+- (void)testThatRawBodyStreamRequestOfUnknownLengthHasNoContentLength {
+    NSData *data = [@"payload" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSMutableURLRequest *unknownLengthRequest = [self.requestSerializer requestWithMethod:@"PUT" URLString:self.baseURL.absoluteString bodyStream:[NSInputStream inputStreamWithData:data] length:NSURLSessionTransferSizeUnknown mimeType:@"application/octet-stream" error:nil];
+    XCTAssertNotNil(unknownLengthRequest.HTTPBodyStream);
+    XCTAssertNil([unknownLengthRequest valueForHTTPHeaderField:@"Content-Length"]);
+    XCTAssertEqualObjects([unknownLengthRequest valueForHTTPHeaderField:@"Content-Type"], @"application/octet-stream");
+
+    NSMutableURLRequest *knownLengthRequest = [self.requestSerializer requestWithMethod:@"PUT" URLString:self.baseURL.absoluteString bodyStream:[NSInputStream inputStreamWithData:data] length:(int64_t)[data length] mimeType:nil error:nil];
+    XCTAssertEqualObjects([knownLengthRequest valueForHTTPHeaderField:@"Content-Length"], @"7");
+    XCTAssertNil([knownLengthRequest valueForHTTPHeaderField:@"Content-Type"]);
+}
+
+#pragma mark - Spooling Multipart Forms To Files
+
+- (void)testThatMultipartFormIsSpooledToFileWithProgress {
+    NSURL *partFileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSURL *spoolFileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSData *fileData = [[@"" stringByPaddingToLength:1024 * 1024 * 3 withString:@"file contents " startingAtIndex:0] dataUsingEncoding:NSUTF8StringEncoding];
+    [fileData writeToURL:partFileURL atomically:YES];
+
+    NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:self.baseURL.absoluteString parameters:@{@"key": @"value"} constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+        [formData appendPartWithFileURL:partFileURL name:@"file" fileName:@"file.txt" mimeType:@"text/plain" error:nil];
+        [formData appendPartWithFileData:fileData name:@"data" fileName:@"data.txt" mimeType:@"text/plain"];
+    } error:nil];
+    NSData *expectedBody = AFTestDataByReadingInputStream([request.HTTPBodyStream copy], 1024 * 64);
+
+    __block int64_t lastCompletedUnitCount = 0;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Spooling should complete"];
+    NSMutableURLRequest *spooledRequest = [self.requestSerializer requestWithMultipartFormRequest:request writingStreamContentsToFile:spoolFileURL progress:^(NSProgress * _Nonnull progress) {
+        XCTAssertTrue([NSThread isMainThread]);
+        XCTAssertTrue(progress.completedUnitCount >= lastCompletedUnitCount);
+        XCTAssertEqual(progress.totalUnitCount, (int64_t)[expectedBody length]);
+        lastCompletedUnitCount = progress.completedUnitCount;
+    } completionHandler:^(NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertNil(spooledRequest.HTTPBodyStream);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:spoolFileURL], expectedBody);
+    XCTAssertEqual(lastCompletedUnitCount, (int64_t)[expectedBody length]);
+
+    [[NSFileManager defaultManager] removeItemAtURL:partFileURL error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:spoolFileURL error:nil];
+}
+
+- (void)testPerformanceOfSpoolingLargeMultipartForm {
+    if (!self.benchmarksEnabled) {
+        return;
+    }
+
+    unsigned long long fileSize = [self benchmarkSizeFromEnvironmentVariable:@"AF_BENCHMARK_SPOOL_SIZE_MB" defaultMegabytes:64];
+
+    NSURL *partFileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSURL *spoolFileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    [[NSFileManager defaultManager] createFileAtPath:[partFileURL path] contents:nil attributes:nil];
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:partFileURL error:nil];
+    [fileHandle truncateFileAtOffset:fileSize];
+    [fileHandle closeFile];
+
+    [self measureBlock:^{
+        NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:self.baseURL.absoluteString parameters:@{@"key": @"value"} constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+            [formData appendPartWithFileURL:partFileURL name:@"file" fileName:@"large.bin" mimeType:@"application/octet-stream" error:nil];
+        } error:nil];
+        unsigned long long contentLength = strtoull([[request valueForHTTPHeaderField:@"Content-Length"] UTF8String], NULL, 10);
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Spooling should complete"];
+        [self.requestSerializer requestWithMultipartFormRequest:request writingStreamContentsToFile:spoolFileURL progress:nil completionHandler:^(NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        [self waitForExpectationsWithCommonTimeout];
+
+        NSDictionary *attributes = [[NSFileManager defaultManager] attributesOfItemAtPath:[spoolFileURL path] error:nil];
+        XCTAssertEqual([attributes[NSFileSize] unsignedLongLongValue], contentLength);
+    }];
+
+    [[NSFileManager defaultManager] removeItemAtURL:partFileURL error:nil];
+    [[NSFileManager defaultManager] removeItemAtURL:spoolFileURL error:nil];
+}
+
+#pragma mark - Body Compression
+
+- (void)testThatBodyCompressionIsDisabledByDefault {
+    NSURLRequest *request = [self.requestSerializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:AFTestCompressibleParameters(100) error:nil];
+
+    XCTAssertNil([request valueForHTTPHeaderField:@"Content-Encoding"]);
+    XCTAssertEqualObjects(request.HTTPBody, [AFQueryStringFromParameters(AFTestCompressibleParameters(100)) dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+- (void)testThatJSONBodyIsGZipCompressedAboveThreshold {
+    AFJSONRequestSerializer *serializer = [AFJSONRequestSerializer serializer];
+    serializer.bodyCompression = AFHTTPRequestBodyCompressionGZip;
+
+    NSDictionary *parameters = AFTestCompressibleParameters(100);
+    NSURLRequest *request = [serializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:parameters error:nil];
+    NSData *expectedBody = [NSJSONSerialization dataWithJSONObject:parameters options:(NSJSONWritingOptions)0 error:nil];
+
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Encoding"], @"gzip");
+    XCTAssertLessThan([request.HTTPBody length], [expectedBody length]);
+    XCTAssertEqual(((const uint8_t *)[request.HTTPBody bytes])[0], (uint8_t)0x1f);
+    XCTAssertEqualObjects(AFTestInflatedDataFromData(request.HTTPBody), expectedBody);
+}
+
+- (void)testThatFormBodyIsDeflateCompressedAboveThreshold {
+    self.requestSerializer.bodyCompression = AFHTTPRequestBodyCompressionDeflate;
+
+    NSDictionary *parameters = AFTestCompressibleParameters(100);
+    NSURLRequest *request = [self.requestSerializer requestWithMethod:@"PUT" URLString:@"http://example.com" parameters:parameters error:nil];
+
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Encoding"], @"deflate");
+    XCTAssertEqualObjects(AFTestInflatedDataFromData(request.HTTPBody), [AFQueryStringFromParameters(parameters) dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+- (void)testThatBodyBelowThresholdIsNotCompressed {
+    self.requestSerializer.bodyCompression = AFHTTPRequestBodyCompressionGZip;
+    self.requestSerializer.bodyCompressionThreshold = 1024 * 1024;
+
+    NSURLRequest *request = [self.requestSerializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:AFTestCompressibleParameters(100) error:nil];
+
+    XCTAssertNil([request valueForHTTPHeaderField:@"Content-Encoding"]);
+}
+
+- (void)testThatRequestsWithExistingContentEncodingAreNotCompressedAgain {
+    self.requestSerializer.bodyCompression = AFHTTPRequestBodyCompressionGZip;
+    [self.requestSerializer setValue:@"br" forHTTPHeaderField:@"Content-Encoding"];
+
+    NSDictionary *parameters = AFTestCompressibleParameters(100);
+    NSURLRequest *request = [self.requestSerializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:parameters error:nil];
+
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Encoding"], @"br");
+    XCTAssertEqualObjects(request.HTTPBody, [AFQueryStringFromParameters(parameters) dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+- (void)testThatMultipartBodyStreamIsCompressedInChunks {
+    self.requestSerializer.bodyCompression = AFHTTPRequestBodyCompressionGZip;
+
+    NSData *partData = [NSJSONSerialization dataWithJSONObject:AFTestCompressibleParameters(1000) options:(NSJSONWritingOptions)0 error:nil];
+    NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:@"http://example.com" parameters:@{@"key": @"value"} constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+        [formData appendPartWithFileData:partData name:@"file" fileName:@"items.json" mimeType:@"application/json"];
+    } error:nil];
+
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Encoding"], @"gzip");
+    XCTAssertNil([request valueForHTTPHeaderField:@"Content-Length"]);
+    XCTAssertTrue([request.HTTPBodyStream conformsToProtocol:@protocol(NSCopying)]);
+
+    NSData *compressedBody = AFTestDataByReadingInputStream(request.HTTPBodyStream, 512);
+    NSData *body = AFTestInflatedDataFromData(compressedBody);
+
+    XCTAssertNotNil(body);
+    XCTAssertLessThan([compressedBody length], [body length]);
+    XCTAssertTrue([body rangeOfData:partData options:0 range:NSMakeRange(0, [body length])].location != NSNotFound);
+    XCTAssertTrue([[[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding] hasSuffix:@"--\r\n"]);
+}
+
+- (void)testThatStreamedBodyWithKnownLengthBelowThresholdIsNotCompressed {
+    self.requestSerializer.bodyCompression = AFHTTPRequestBodyCompressionGZip;
+
+    NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:@"http://example.com" parameters:@{@"key": @"value"} constructingBodyWithBlock:nil error:nil];
+
+    XCTAssertNil([request valueForHTTPHeaderField:@"Content-Encoding"]);
+    XCTAssertNotNil([request valueForHTTPHeaderField:@"Content-Length"]);
+}
+
+- (void)testThatBodyCompressionIsPreservedWhenCopyingAndArchiving {
+    self.requestSerializer.bodyCompression = AFHTTPRequestBodyCompressionDeflate;
+    self.requestSerializer.bodyCompressionThreshold = 42;
+
+    AFHTTPRequestSerializer *copiedSerializer = [self.requestSerializer copy];
+    XCTAssertEqual(copiedSerializer.bodyCompression, AFHTTPRequestBodyCompressionDeflate);
+    XCTAssertEqual(copiedSerializer.bodyCompressionThreshold, (NSUInteger)42);
+
+    AFHTTPRequestSerializer *unarchivedSerializer = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:self.requestSerializer]];
+    XCTAssertEqual(unarchivedSerializer.bodyCompression, AFHTTPRequestBodyCompressionDeflate);
+    XCTAssertEqual(unarchivedSerializer.bodyCompressionThreshold, (NSUInteger)42);
+}
+
+- (void)testThatBodyCompressionReducesBodyLength {
+    NSDictionary *parameters = AFTestCompressibleParameters(20000);
+    NSUInteger uncompressedLength = [[[AFJSONRequestSerializer serializer] requestWithMethod:@"POST" URLString:@"http://example.com" parameters:parameters error:nil].HTTPBody length];
+
+    for (NSNumber *compression in @[@(AFHTTPRequestBodyCompressionGZip), @(AFHTTPRequestBodyCompressionDeflate)]) {
+        AFJSONRequestSerializer *serializer = [AFJSONRequestSerializer serializer];
+        serializer.bodyCompression = (AFHTTPRequestBodyCompression)[compression unsignedIntegerValue];
+
+        NSURLRequest *request = [serializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:parameters error:nil];
+        XCTAssertNotNil([request valueForHTTPHeaderField:@"Content-Encoding"]);
+        XCTAssertLessThan([request.HTTPBody length], uncompressedLength);
+    }
+}
+
+- (void)testPerformanceOfGZipCompressingJSONBody {
+    AFJSONRequestSerializer *serializer = [AFJSONRequestSerializer serializer];
+    serializer.bodyCompression = AFHTTPRequestBodyCompressionGZip;
+    NSDictionary *parameters = AFTestCompressibleParameters(5000);
+
+    [self measureBlock:^{
+        [serializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:parameters error:nil];
+    }];
+}
+
+- (void)testPerformanceOfDeflateCompressingJSONBody {
+    AFJSONRequestSerializer *serializer = [AFJSONRequestSerializer serializer];
+    serializer.bodyCompression = AFHTTPRequestBodyCompressionDeflate;
+    NSDictionary *parameters = AFTestCompressibleParameters(5000);
+
+    [self measureBlock:^{
+        [serializer requestWithMethod:@"POST" URLString:@"http://example.com" parameters:parameters error:nil];
+    }];
+}
+
+#pragma mark - Bandwidth Throttling
+
+- (void)testThatThrottledStreamReadsNeverBlock {
+    NSData *data = [[@"" stringByPaddingToLength:1024 * 256 withString:@"0123456789" startingAtIndex:0] dataUsingEncoding:NSUTF8StringEncoding];
+    AFBandwidthThrottle *throttle = [[AFBandwidthThrottle alloc] initWithBytesPerSecond:1024 * 64 burstSize:1024 * 16];
+    NSInputStream *inputStream = [throttle inputStreamByThrottlingInputStream:[NSInputStream inputStreamWithData:data]];
+
+    NSMutableData *readData = [NSMutableData data];
+    uint8_t buffer[1024 * 32];
+    BOOL wasThrottled = NO;
+
+    // Four seconds worth of data at the throttled rate must still be readable immediately by a reader ignoring `hasBytesAvailable`
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    [inputStream open];
+    while ([inputStream streamStatus] == NSStreamStatusOpen) {
+        wasThrottled = wasThrottled || ![inputStream hasBytesAvailable];
+        NSInteger numberOfBytesRead = [inputStream read:buffer maxLength:sizeof(buffer)];
+        XCTAssertTrue(numberOfBytesRead >= 0);
+        XCTAssertTrue(numberOfBytesRead <= 1024 * 16);
+        [readData appendBytes:buffer length:(NSUInteger)MAX(numberOfBytesRead, 0)];
+    }
+    [inputStream close];
+
+    XCTAssertTrue(CFAbsoluteTimeGetCurrent() - startTime < 1.0);
+    XCTAssertTrue(wasThrottled);
+    XCTAssertEqualObjects(readData, data);
+    XCTAssertEqual(throttle.numberOfBytesRead, (unsigned long long)[data length]);
+}
+
+- (void)testThatThrottledStreamsShareTheirThrottle {
+    AFBandwidthThrottle *throttle = [AFBandwidthThrottle throttleWithBytesPerSecond:1024 * 64];
+    AFBandwidthThrottle *otherThrottle = [AFBandwidthThrottle throttleWithBytesPerSecond:1024 * 128];
+
+    NSInputStream *inputStream = [throttle inputStreamByThrottlingInputStream:[NSInputStream inputStreamWithData:[NSData data]]];
+    XCTAssertEqual([throttle inputStreamByThrottlingInputStream:inputStream], inputStream);
+
+    NSInputStream *doublyThrottledStream = [otherThrottle inputStreamByThrottlingInputStream:inputStream];
+    XCTAssertNotEqual(doublyThrottledStream, inputStream);
+    XCTAssertEqual([otherThrottle inputStreamByThrottlingInputStream:doublyThrottledStream], doublyThrottledStream);
+    XCTAssertEqual([throttle inputStreamByThrottlingInputStream:doublyThrottledStream], doublyThrottledStream);
+}
+
+- (void)testThatMultipartPacketDelayThrottlesWithoutSleeping {
+    NSData *data = [[@"" stringByPaddingToLength:1024 * 64 withString:@"abc" startingAtIndex:0] dataUsingEncoding:NSUTF8StringEncoding];
+    NSMutableURLRequest *request = [self.requestSerializer multipartFormRequestWithMethod:@"POST" URLString:self.baseURL.absoluteString parameters:nil constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+        [formData appendPartWithFormData:data name:@"data"];
+        [formData throttleBandwidthWithPacketSize:1024 delay:0.5];
+    } error:nil];
+
+    XCTAssertFalse([request.HTTPBodyStream isKindOfClass:[AFMultipartBodyStream class]]);
+
+    // At one packet every half second, sleeping between packets would take over half a minute
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSMutableData *body = [NSMutableData data];
+    uint8_t buffer[1024 * 4];
+    [request.HTTPBodyStream open];
+    while ([request.HTTPBodyStream streamStatus] == NSStreamStatusOpen) {
+        NSInteger numberOfBytesRead = [request.HTTPBodyStream read:buffer maxLength:sizeof(buffer)];
+        XCTAssertTrue(numberOfBytesRead >= 0 && numberOfBytesRead <= 1024);
+        [body appendBytes:buffer length:(NSUInteger)MAX(numberOfBytesRead, 0)];
+    }
+    [request.HTTPBodyStream close];
+
+    XCTAssertTrue(CFAbsoluteTimeGetCurrent() - startTime < 1.0);
+    XCTAssertEqual((unsigned long long)[body length], strtoull([[request valueForHTTPHeaderField:@"Content-Length"] UTF8String], NULL, 10));
+}
+
 #pragma mark - Helper Methods
 
 - (void)testQueryStringFromParameters {
@@ -0,0 +1,244 @@
+// AFHedgingPolicyTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#import "AFTestCase.h"
+
+#import "AFHTTPSessionManager.h"
+#import "AFHedgingPolicy.h"
+
+@interface AFHedgingPolicyTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFHTTPSessionManager *manager;
+@property (readwrite, nonatomic, strong) AFHedgingPolicy *hedgingPolicy;
+@property (readwrite, nonatomic, strong) NSMutableArray <NSString *> *requestedPaths;
+@end
+
+@implementation AFHedgingPolicyTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.manager = [[AFHTTPSessionManager alloc] initWithBaseURL:[AFTestURLProtocol baseURL] sessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    self.manager.responseSerializer = [AFHTTPResponseSerializer serializer];
+    self.hedgingPolicy = [[AFHedgingPolicy alloc] init];
+    self.hedgingPolicy.initialHedgeDelay = 0.1;
+    self.hedgingPolicy.maximumHedgeRatio = 1.0;
+    self.manager.hedgingPolicy = self.hedgingPolicy;
+    self.requestedPaths = [NSMutableArray array];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (void)serveResponsesWithLatencies:(NSArray <NSNumber *> *)latencies {
+    NSMutableArray *requestedPaths = self.requestedPaths;
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSUInteger idx = 0;
+        @synchronized (requestedPaths) {
+            idx = [requestedPaths count];
+            [requestedPaths addObject:request.URL.path];
+        }
+
+        NSData *data = [[NSString stringWithFormat:@"%lu", (unsigned long)idx] dataUsingEncoding:NSUTF8StringEncoding];
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"text/plain"} body:data];
+        response.latency = [latencies[MIN(idx, [latencies count] - 1)] doubleValue];
+        return response;
+    }];
+}
+
+#pragma mark -
+
+- (void)testThatHedgeDelayIsLatencyPercentileOfRecentLatencies {
+    AFHedgingPolicy *hedgingPolicy = [[AFHedgingPolicy alloc] init];
+    for (NSUInteger idx = 1; idx <= 19; idx++) {
+        [hedgingPolicy recordLatency:idx / 1000.0];
+    }
+    XCTAssertEqualWithAccuracy([hedgingPolicy hedgeDelay], hedgingPolicy.initialHedgeDelay, 0.0001);
+
+    for (NSUInteger idx = 20; idx <= 100; idx++) {
+        [hedgingPolicy recordLatency:idx / 1000.0];
+    }
+    XCTAssertEqualWithAccuracy([hedgingPolicy hedgeDelay], 0.095, 0.0001);
+
+    hedgingPolicy.latencyPercentile = 0.5;
+    XCTAssertEqualWithAccuracy([hedgingPolicy hedgeDelay], 0.05, 0.0001);
+
+    hedgingPolicy.minimumHedgeDelay = 0.2;
+    XCTAssertEqualWithAccuracy([hedgingPolicy hedgeDelay], 0.2, 0.0001);
+}
+
+- (void)testThatOldestLatenciesAreReplaced {
+    AFHedgingPolicy *hedgingPolicy = [[AFHedgingPolicy alloc] initWithMaximumNumberOfLatencySamples:10];
+    hedgingPolicy.minimumNumberOfLatencySamples = 10;
+    for (NSUInteger idx = 0; idx < 10; idx++) {
+        [hedgingPolicy recordLatency:1.0];
+    }
+    XCTAssertEqualWithAccuracy([hedgingPolicy hedgeDelay], 1.0, 0.0001);
+
+    for (NSUInteger idx = 0; idx < 10; idx++) {
+        [hedgingPolicy recordLatency:0.1];
+    }
+    XCTAssertEqualWithAccuracy([hedgingPolicy hedgeDelay], 0.1, 0.0001);
+}
+
+- (void)testThatHedgesAreCappedByBudget {
+    AFHedgingPolicy *hedgingPolicy = [[AFHedgingPolicy alloc] init];
+    hedgingPolicy.maximumHedgeRatio = 0.5;
+
+    XCTAssertFalse([hedgingPolicy shouldSendHedge]);
+    [hedgingPolicy didStartRequest];
+    [hedgingPolicy didStartRequest];
+    XCTAssertTrue([hedgingPolicy shouldSendHedge]);
+    XCTAssertFalse([hedgingPolicy shouldSendHedge]);
+    XCTAssertEqual(hedgingPolicy.numberOfRequests, (NSUInteger)2);
+    XCTAssertEqual(hedgingPolicy.numberOfHedges, (NSUInteger)1);
+}
+
+- (void)testThatSlowRequestIsHedgedAndFirstResponseWins {
+    [self serveResponsesWithLatencies:@[@2.0, @0.0]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request should succeed"];
+    __block NSURLSessionDataTask *returnedTask = nil;
+    returnedTask = [self.manager GET:@"items" parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+        XCTAssertEqualObjects([[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding], @"1");
+        XCTAssertNotEqual(task, returnedTask);
+        [expectation fulfill];
+    } failure:^(NSURLSessionDataTask *task, NSError *error) {
+        XCTFail(@"Request should not fail: %@", error);
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    [self expectationForPredicate:[NSPredicate predicateWithFormat:@"state == %ld", (long)NSURLSessionTaskStateCompleted] evaluatedWithObject:returnedTask handler:nil];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([self.requestedPaths count], (NSUInteger)2);
+    XCTAssertEqual(self.hedgingPolicy.numberOfRequests, (NSUInteger)1);
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedges, (NSUInteger)1);
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedgesWon, (NSUInteger)1);
+}
+
+- (void)testThatHedgeWinRecordsLatencyOfOriginalRequest {
+    [self serveResponsesWithLatencies:@[@2.0, @0.0]];
+    self.hedgingPolicy.minimumNumberOfLatencySamples = 1;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request should succeed"];
+    [self.manager GET:@"items" parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+        [expectation fulfill];
+    } failure:nil];
+    [self waitForExpectationsWithCommonTimeout];
+
+    // The hedge responds at once, but the original request had been waiting for the hedge delay before it was sent
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedgesWon, (NSUInteger)1);
+    XCTAssertGreaterThanOrEqual([self.hedgingPolicy hedgeDelay], self.hedgingPolicy.initialHedgeDelay);
+}
+
+- (void)testThatFastRequestIsNotHedged {
+    [self serveResponsesWithLatencies:@[@0.0]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request should succeed"];
+    NSURLSessionDataTask *returnedTask = [self.manager GET:@"items" parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+        XCTAssertEqualObjects([[NSString alloc] initWithData:responseObject encoding:NSUTF8StringEncoding], @"0");
+        [expectation fulfill];
+    } failure:nil];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(returnedTask.state, NSURLSessionTaskStateCompleted);
+    XCTAssertEqual([self.requestedPaths count], (NSUInteger)1);
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedges, (NSUInteger)0);
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedgesWon, (NSUInteger)0);
+}
+
+- (void)testThatRequestIsNotHedgedBeyondBudget {
+    [self serveResponsesWithLatencies:@[@0.3]];
+    self.hedgingPolicy.maximumHedgeRatio = 0.5;
+
+    for (NSUInteger idx = 0; idx < 2; idx++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request should succeed"];
+        [self.manager GET:@"items" parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+            [expectation fulfill];
+        } failure:nil];
+    }
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(self.hedgingPolicy.numberOfRequests, (NSUInteger)2);
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedges, (NSUInteger)1);
+}
+
+- (void)testThatCancellingReturnedTaskCancelsHedge {
+    [self serveResponsesWithLatencies:@[@2.0]];
+    self.hedgingPolicy.initialHedgeDelay = 0.05;
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request should fail"];
+    NSURLSessionDataTask *returnedTask = [self.manager GET:@"items" parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+        XCTFail(@"Request should not succeed");
+    } failure:^(NSURLSessionDataTask *task, NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.3 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        XCTAssertEqual(self.hedgingPolicy.numberOfHedges, (NSUInteger)1);
+        [returnedTask cancel];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(self.hedgingPolicy.numberOfHedgesWon, (NSUInteger)0);
+}
+
+- (void)testThatCancellingReturnedTaskCancelsHedgeThatWon {
+    NSMutableArray *requestedPaths = self.requestedPaths;
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSUInteger idx = 0;
+        @synchronized (requestedPaths) {
+            idx = [requestedPaths count];
+            [requestedPaths addObject:request.URL.path];
+        }
+
+        // The hedge responds at once, and then takes a second to send its body
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"text/plain"} body:[NSMutableData dataWithLength:1024 * 160]];
+        response.latency = idx == 0 ? 2.0 : 0.0;
+        response.chunkDelay = 0.1;
+        return response;
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Request should fail"];
+    __block NSURLSessionDataTask *returnedTask = nil;
+    returnedTask = [self.manager GET:@"items" parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+        XCTFail(@"Request should not succeed");
+    } failure:^(NSURLSessionDataTask *task, NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        XCTAssertNotEqual(task, returnedTask);
+        [expectation fulfill];
+    }];
+
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(0.4 * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+        XCTAssertEqual(self.hedgingPolicy.numberOfHedgesWon, (NSUInteger)1);
+        [returnedTask cancel];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(returnedTask.state, NSURLSessionTaskStateCompleted);
+}
+
+@end
@@ -0,0 +1,218 @@
+// AFJSONLinesResponseSerializerTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFURLSessionManager.h"
+
+@interface AFJSONLinesResponseSerializerTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFJSONLinesResponseSerializer *responseSerializer;
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@end
+
+@implementation AFJSONLinesResponseSerializerTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.responseSerializer = [AFJSONLinesResponseSerializer serializer];
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *)responseWithStatusCode:(NSInteger)statusCode {
+    return [[NSHTTPURLResponse alloc] initWithURL:[NSURL URLWithString:@"http://test.com"] statusCode:statusCode HTTPVersion:@"1.1" headerFields:@{@"Content-Type": @"application/x-ndjson"}];
+}
+
+- (NSData *)dataWithNumberOfRecords:(NSUInteger)numberOfRecords {
+    NSMutableData *data = [NSMutableData data];
+    for (NSUInteger idx = 0; idx < numberOfRecords; idx++) {
+        [data appendData:[[NSString stringWithFormat:@"{\"id\":%lu,\"name\":\"record %lu\"}\n", (unsigned long)idx, (unsigned long)idx] dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+
+    return data;
+}
+
+#pragma mark -
+
+- (void)testThatRecordsAreDecodedFromBufferedResponse {
+    NSData *data = [@"{\"a\":1}\r\n\n[1,2]\n  \"text\"  \n42" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    NSArray *records = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:200] data:data error:&error];
+
+    XCTAssertNil(error);
+    NSArray *expectedRecords = @[@{@"a": @1}, @[@1, @2], @"text", @42];
+    XCTAssertEqualObjects(records, expectedRecords);
+}
+
+- (void)testThatMalformedRecordFailsWithItsLineNumber {
+    NSData *data = [@"{\"a\":1}\n\n{\"a\":\n{\"a\":3}\n" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    id records = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:200] data:data error:&error];
+
+    XCTAssertNil(records);
+    XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+    XCTAssertTrue([error.localizedDescription containsString:@"line 3"]);
+    XCTAssertNotNil(error.userInfo[NSUnderlyingErrorKey]);
+}
+
+- (void)testThatRecordsSplitAcrossChunksAreDeliveredInBatches {
+    self.responseSerializer.batchSize = 4;
+
+    NSMutableArray *batches = [NSMutableArray array];
+    AFJSONLinesStream *stream = [self.responseSerializer streamWithBatchHandler:^(NSArray *records) {
+        [batches addObject:records];
+    }];
+
+    // The last record has no terminating newline
+    NSMutableData *data = [[self dataWithNumberOfRecords:10] mutableCopy];
+    [data setLength:[data length] - 1];
+    for (NSUInteger offset = 0; offset < [data length]; offset += 7) {
+        [stream dataTask:nil didReceiveData:[data subdataWithRange:NSMakeRange(offset, MIN((NSUInteger)7, [data length] - offset))]];
+    }
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    [stream finishWithCompletionHandler:^(NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(stream.numberOfRecords, (NSUInteger)10);
+    XCTAssertEqual(stream.numberOfBatches, (NSUInteger)3);
+    XCTAssertEqualObjects([batches valueForKey:@"@count"], (@[@4, @4, @2]));
+    NSUInteger expectedIdentifier = 0;
+    for (NSArray *batch in batches) {
+        for (NSDictionary *record in batch) {
+            XCTAssertEqualObjects(record[@"id"], @(expectedIdentifier++));
+        }
+    }
+    XCTAssertEqualObjects([batches lastObject][1][@"name"], @"record 9");
+}
+
+- (void)testThatPartialRecordOfResponseCutShortIsNotDecoded {
+    NSMutableArray *records = [NSMutableArray array];
+    AFJSONLinesStream *stream = [self.responseSerializer streamWithBatchHandler:^(NSArray *batch) {
+        [records addObjectsFromArray:batch];
+    }];
+
+    [stream dataTask:nil didReceiveData:[@"{\"a\":1}\n{\"a\":" dataUsingEncoding:NSUTF8StringEncoding]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    NSError *connectionError = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorNetworkConnectionLost userInfo:nil];
+    [stream finishWithError:connectionError completionHandler:^(NSError *error) {
+        XCTAssertEqualObjects(error, connectionError);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertNil(stream.error);
+    XCTAssertEqual(stream.numberOfRecords, (NSUInteger)1);
+    XCTAssertEqualObjects(records, (@[@{@"a": @1}]));
+}
+
+- (void)testThatRecordLongerThanMaximumFailsStream {
+    self.responseSerializer.maximumRecordLength = 16;
+
+    __block NSUInteger numberOfRecordsHandled = 0;
+    AFJSONLinesStream *stream = [self.responseSerializer streamWithBatchHandler:^(NSArray *records) {
+        numberOfRecordsHandled += [records count];
+    }];
+
+    [stream dataTask:nil didReceiveData:[@"{\"a\":1}\n{\"a\":\"0123456789abcdef" dataUsingEncoding:NSUTF8StringEncoding]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    [stream finishWithCompletionHandler:^(NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+        XCTAssertTrue([error.localizedDescription containsString:@"line 2"]);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(stream.numberOfRecords, (NSUInteger)1);
+    XCTAssertEqual(numberOfRecordsHandled, (NSUInteger)0);
+}
+
+- (void)testThatSlowBatchHandlerSuspendsDataTask {
+    NSData *data = [self dataWithNumberOfRecords:2000];
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/x-ndjson"} body:data];
+        response.chunkSize = 1024;
+        return response;
+    }];
+
+    self.responseSerializer.batchSize = 50;
+    self.responseSerializer.batchQueue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    NSMutableArray *records = [NSMutableArray array];
+    AFJSONLinesStream *stream = [self.responseSerializer streamWithBatchHandler:^(NSArray *batch) {
+        [NSThread sleepForTimeInterval:0.01];
+        [records addObjectsFromArray:batch];
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Task should complete"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"events"]];
+    NSURLSessionDataTask *task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([records count], (NSUInteger)2000);
+    XCTAssertEqualObjects([records lastObject][@"id"], @1999);
+    XCTAssertEqual(stream.numberOfBatches, (NSUInteger)40);
+    XCTAssertGreaterThan(stream.numberOfSuspensions, (NSUInteger)0);
+}
+
+- (void)testThatUnacceptableStatusCodeFailsStreamWithoutDeliveringRecords {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:500 headers:@{@"Content-Type": @"application/x-ndjson"} body:[@"{\"error\":\"internal\"}\n" dataUsingEncoding:NSUTF8StringEncoding]];
+    }];
+
+    __block NSUInteger numberOfBatches = 0;
+    AFJSONLinesStream *stream = [self.responseSerializer streamWithBatchHandler:^(NSArray *batch) {
+        numberOfBatches++;
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Task should complete"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"events"]];
+    NSURLSessionDataTask *task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorBadServerResponse);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(numberOfBatches, (NSUInteger)0);
+    XCTAssertEqual(stream.numberOfRecords, (NSUInteger)0);
+}
+
+@end
@@ -0,0 +1,686 @@
+// AFJSONParserTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+
+#import "AFTestCase.h"
+
+#import "AFJSONParser.h"
+
+static NSString * AFJSONTestNameOfInstructionSet(AFJSONParserInstructionSet instructionSet) {
+    switch (instructionSet) {
+        case AFJSONParserInstructionSetScalar:
+            return @"scalar";
+        case AFJSONParserInstructionSetSSE2:
+            return @"SSE2";
+        case AFJSONParserInstructionSetAVX2:
+            return @"AVX2";
+        case AFJSONParserInstructionSetNEON:
+            return @"NEON";
+        default:
+            return @"automatic";
+    }
+}
+
+// `NSJSONSerialization` may decode numbers as `NSDecimalNumber`, which is not equal to the closest double
+static BOOL AFJSONTestObjectsAreEqual(id object, id otherObject) {
+    if ([object isKindOfClass:[NSNumber class]] && [otherObject isKindOfClass:[NSNumber class]]) {
+        return [object isEqualToNumber:otherObject] || [object doubleValue] == [otherObject doubleValue];
+    } else if ([object isKindOfClass:[NSArray class]] && [otherObject isKindOfClass:[NSArray class]]) {
+        if ([object count] != [otherObject count]) {
+            return NO;
+        }
+        for (NSUInteger idx = 0; idx < [object count]; idx++) {
+            if (!AFJSONTestObjectsAreEqual(object[idx], otherObject[idx])) {
+                return NO;
+            }
+        }
+        return YES;
+    } else if ([object isKindOfClass:[NSDictionary class]] && [otherObject isKindOfClass:[NSDictionary class]]) {
+        if ([object count] != [otherObject count]) {
+            return NO;
+        }
+        for (id key in object) {
+            if (!AFJSONTestObjectsAreEqual(object[key], otherObject[key])) {
+                return NO;
+            }
+        }
+        return YES;
+    }
+
+    return [object isEqual:otherObject];
+}
+
+// Repository search results, in the shape of the GitHub API
+static NSData * AFJSONTestRepositoriesPayload(NSUInteger numberOfRepositories) {
+    NSMutableArray *repositories = [NSMutableArray arrayWithCapacity:numberOfRepositories];
+    for (NSUInteger idx = 0; idx < numberOfRepositories; idx++) {
+        NSString *login = [NSString stringWithFormat:@"organization-%lu", (unsigned long)(idx % 97)];
+        NSString *name = [NSString stringWithFormat:@"repository-%lu", (unsigned long)idx];
+        [repositories addObject:@{
+            @"id": @(3637124 + idx * 7919),
+            @"node_id": [[[NSString stringWithFormat:@"Repository:%lu", (unsigned long)idx] dataUsingEncoding:NSUTF8StringEncoding] base64EncodedStringWithOptions:0],
+            @"name": name,
+            @"full_name": [NSString stringWithFormat:@"%@/%@", login, name],
+            @"private": @NO,
+            @"owner": @{
+                @"login": login,
+                @"id": @(1000 + idx % 97),
+                @"avatar_url": [NSString stringWithFormat:@"https://avatars.githubusercontent.com/u/%lu?v=4", (unsigned long)(1000 + idx % 97)],
+                @"type": @"Organization",
+                @"site_admin": @NO,
+            },
+            @"html_url": [NSString stringWithFormat:@"https://github.com/%@/%@", login, name],
+            @"description": idx % 4 == 0 ? [NSNull null] : [NSString stringWithFormat:@"A \"delightful\" networking library — release %lu\nSee https://example.com/docs?page=%lu&lang=en", (unsigned long)idx, (unsigned long)idx],
+            @"fork": @(idx % 3 == 0),
+            @"created_at": [NSString stringWithFormat:@"2011-%02lu-%02luT16:47:23Z", (unsigned long)(idx % 12 + 1), (unsigned long)(idx % 28 + 1)],
+            @"stargazers_count": @((idx * 37) % 50000),
+            @"watchers_count": @((idx * 37) % 50000),
+            @"language": idx % 5 == 0 ? [NSNull null] : @"Objective-C",
+            @"forks_count": @((idx * 11) % 10000),
+            @"score": @(1.0 / (idx + 1)),
+            @"topics": @[@"networking", @"http", @"ios", @"macos"],
+            @"license": @{@"key": @"mit", @"name": @"MIT License", @"spdx_id": @"MIT", @"url": @"https://api.github.com/licenses/mit"},
+        }];
+    }
+
+    return [NSJSONSerialization dataWithJSONObject:@{@"total_count": @(numberOfRepositories), @"incomplete_results": @NO, @"items": repositories} options:NSJSONWritingPrettyPrinted error:nil];
+}
+
+// A home timeline, in the shape of the Twitter API, with non-ASCII text and escape sequences
+static NSData * AFJSONTestTimelinePayload(NSUInteger numberOfStatuses) {
+    NSMutableArray *statuses = [NSMutableArray arrayWithCapacity:numberOfStatuses];
+    for (NSUInteger idx = 0; idx < numberOfStatuses; idx++) {
+        NSString *text = [NSString stringWithFormat:@"Café ☕️ at 9:%02lu — the \"best\" part of the day 😀\nhttps://t.co/%lu #coffee\t@barista_%lu", (unsigned long)(idx % 60), (unsigned long)idx, (unsigned long)(idx % 13)];
+        [statuses addObject:@{
+            @"created_at": @"Wed Oct 10 20:19:24 +0000 2018",
+            @"id": @(1050118621198921728ULL + idx),
+            @"id_str": [NSString stringWithFormat:@"%llu", 1050118621198921728ULL + idx],
+            @"text": text,
+            @"truncated": @NO,
+            @"entities": @{
+                @"hashtags": @[@{@"text": @"coffee", @"indices": @[@(58), @(65)]}],
+                @"urls": @[@{@"url": [NSString stringWithFormat:@"https://t.co/%lu", (unsigned long)idx], @"expanded_url": @"https://example.com/ünïcödé/path", @"indices": @[@(42), @(57)]}],
+            },
+            @"user": @{
+                @"id": @(6253282 + idx % 31),
+                @"screen_name": [NSString stringWithFormat:@"user_%lu", (unsigned long)(idx % 31)],
+                @"name": @"Zoë 日本語 Ελληνικά",
+                @"followers_count": @(idx * 13),
+                @"verified": @(idx % 7 == 0),
+                @"profile_image_url_https": @"https://pbs.twimg.com/profile_images/942858479592554497/BbazLO9L_normal.jpg",
+            },
+            @"coordinates": idx % 3 == 0 ? @{@"type": @"Point", @"coordinates": @[@(-122.4194155 + idx * 0.001), @(37.7749295 - idx * 0.001)]} : [NSNull null],
+            @"retweet_count": @(idx % 1000),
+            @"favorite_count": @((idx * 3) % 1000),
+            @"favorited": @(idx % 2 == 0),
+            @"lang": @"en",
+        }];
+    }
+
+    return [NSJSONSerialization dataWithJSONObject:statuses options:(NSJSONWritingOptions)0 error:nil];
+}
+
+// A GeoJSON feature collection, dominated by floating point numbers
+static NSData * AFJSONTestFeatureCollectionPayload(NSUInteger numberOfFeatures) {
+    NSMutableArray *features = [NSMutableArray arrayWithCapacity:numberOfFeatures];
+    for (NSUInteger idx = 0; idx < numberOfFeatures; idx++) {
+        NSMutableArray *ring = [NSMutableArray arrayWithCapacity:100];
+        for (NSUInteger point = 0; point < 100; point++) {
+            [ring addObject:@[@(-79.3832 + idx * 0.0137 + cos(point * 0.0628) * 0.01), @(43.6532 + idx * 0.0071 + sin(point * 0.0628) * 0.01)]];
+        }
+        [features addObject:@{
+            @"type": @"Feature",
+            @"properties": @{@"name": [NSString stringWithFormat:@"Ward %lu", (unsigned long)idx], @"area": @(idx * 1234.5678), @"population": @(idx * 1009)},
+            @"geometry": @{@"type": @"Polygon", @"coordinates": @[ring]},
+        }];
+    }
+
+    return [NSJSONSerialization dataWithJSONObject:@{@"type": @"FeatureCollection", @"features": features} options:(NSJSONWritingOptions)0 error:nil];
+}
+
+static NSArray <NSData *> * AFJSONTestCorpus() {
+    return @[AFJSONTestRepositoriesPayload(2000), AFJSONTestTimelinePayload(3000), AFJSONTestFeatureCollectionPayload(200)];
+}
+
+#pragma mark -
+
+@interface AFJSONTestOwner : NSObject
+@property (nonatomic, copy) NSString *login;
+@property (nonatomic, assign) long long identifier;
+@property (nonatomic, strong) NSURL *avatarURL;
+@property (nonatomic, assign, getter=isSiteAdmin) BOOL siteAdmin;
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject;
+@end
+
+@implementation AFJSONTestOwner
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject {
+    self = [self init];
+    self.login = JSONObject[@"login"];
+    self.identifier = [JSONObject[@"id"] longLongValue];
+    self.avatarURL = [NSURL URLWithString:JSONObject[@"avatar_url"]];
+    self.siteAdmin = [JSONObject[@"site_admin"] boolValue];
+
+    return self;
+}
+
+@end
+
+@interface AFJSONTestRepository : NSObject
+@property (nonatomic, assign) NSUInteger identifier;
+@property (nonatomic, copy) NSString *name;
+@property (nonatomic, copy) NSString *fullName;
+@property (nonatomic, copy) NSString *repositoryDescription;
+@property (nonatomic, assign, getter=isPrivateRepository) BOOL privateRepository;
+@property (nonatomic, strong) AFJSONTestOwner *owner;
+@property (nonatomic, strong) NSURL *HTMLURL;
+@property (nonatomic, assign) NSInteger stargazersCount;
+@property (nonatomic, assign) double score;
+@property (nonatomic, copy) NSArray <NSString *> *topics;
+@property (nonatomic, copy) NSString *language;
+@property (nonatomic, copy) NSDictionary *license;
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject;
+@end
+
+@implementation AFJSONTestRepository
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject {
+    self = [self init];
+    self.identifier = [JSONObject[@"id"] unsignedIntegerValue];
+    self.name = JSONObject[@"name"];
+    self.fullName = JSONObject[@"full_name"];
+    self.repositoryDescription = JSONObject[@"description"] != [NSNull null] ? JSONObject[@"description"] : nil;
+    self.privateRepository = [JSONObject[@"private"] boolValue];
+    self.owner = [[AFJSONTestOwner alloc] initWithJSONObject:JSONObject[@"owner"]];
+    self.HTMLURL = [NSURL URLWithString:JSONObject[@"html_url"]];
+    self.stargazersCount = [JSONObject[@"stargazers_count"] integerValue];
+    self.score = [JSONObject[@"score"] doubleValue];
+    self.topics = JSONObject[@"topics"];
+    self.language = JSONObject[@"language"] != [NSNull null] ? JSONObject[@"language"] : nil;
+    self.license = JSONObject[@"license"];
+
+    return self;
+}
+
+@end
+
+@interface AFJSONTestSearchResults : NSObject
+@property (nonatomic, assign) NSUInteger totalCount;
+@property (nonatomic, assign) BOOL incompleteResults;
+@property (nonatomic, copy) NSArray <AFJSONTestRepository *> *items;
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject;
+@end
+
+@implementation AFJSONTestSearchResults
+
+- (instancetype)initWithJSONObject:(NSDictionary *)JSONObject {
+    self = [self init];
+    self.totalCount = [JSONObject[@"total_count"] unsignedIntegerValue];
+    self.incompleteResults = [JSONObject[@"incomplete_results"] boolValue];
+    NSMutableArray *items = [NSMutableArray array];
+    for (NSDictionary *item in JSONObject[@"items"]) {
+        [items addObject:[[AFJSONTestRepository alloc] initWithJSONObject:item]];
+    }
+    self.items = items;
+
+    return self;
+}
+
+@end
+
+@interface AFJSONTestValues : NSObject
+@property (nonatomic, assign) short shortValue;
+@property (nonatomic, assign) unsigned int unsignedIntValue;
+@property (nonatomic, assign) float floatValue;
+@property (nonatomic, assign) BOOL boolValue;
+@property (nonatomic, strong) NSNumber *number;
+@property (nonatomic, strong) NSMutableString *mutableString;
+@property (nonatomic, strong) NSMutableArray *mutableArray;
+@property (nonatomic, copy) NSDictionary *dictionary;
+@property (nonatomic, strong) id anything;
+@property (nonatomic, strong) AFJSONTestValues *child;
+@property (nonatomic, readonly) NSString *readonlyValue;
+@end
+
+@implementation AFJSONTestValues
+@end
+
+static NSArray * AFJSONTestKeysOfRepository() {
+    return @[@"identifier", @"name", @"fullName", @"repositoryDescription", @"privateRepository", @"HTMLURL", @"stargazersCount", @"score", @"topics", @"language", @"license", @"owner.login", @"owner.identifier", @"owner.avatarURL", @"owner.siteAdmin"];
+}
+
+static AFJSONModelSchema * AFJSONTestSearchResultsSchema() {
+    AFJSONModelSchema *ownerSchema = [AFJSONModelSchema schemaWithModelClass:[AFJSONTestOwner class] propertyNamesByJSONKey:@{@"login": @"login", @"id": @"identifier", @"avatar_url": @"avatarURL", @"site_admin": @"siteAdmin"}];
+    AFJSONModelSchema *repositorySchema = [AFJSONModelSchema schemaWithModelClass:[AFJSONTestRepository class] propertyNamesByJSONKey:@{@"id": @"identifier", @"name": @"name", @"full_name": @"fullName", @"description": @"repositoryDescription", @"private": @"privateRepository", @"owner": @"owner", @"html_url": @"HTMLURL", @"stargazers_count": @"stargazersCount", @"score": @"score", @"topics": @"topics", @"language": @"language", @"license": @"license"}];
+    [repositorySchema setSchema:ownerSchema forPropertyName:@"owner"];
+    AFJSONModelSchema *searchResultsSchema = [AFJSONModelSchema schemaWithModelClass:[AFJSONTestSearchResults class] propertyNamesByJSONKey:@{@"total_count": @"totalCount", @"incomplete_results": @"incompleteResults", @"items": @"items"}];
+    [searchResultsSchema setSchema:repositorySchema forPropertyName:@"items"];
+
+    return searchResultsSchema;
+}
+
+@interface AFJSONParserTests : AFTestCase
+@property (readwrite, nonatomic, strong) NSArray <AFJSONParser *> *parsers;
+@end
+
+@implementation AFJSONParserTests
+
+- (void)setUp {
+    [super setUp];
+
+    NSMutableArray *parsers = [NSMutableArray array];
+    for (AFJSONParserInstructionSet instructionSet = AFJSONParserInstructionSetScalar; instructionSet <= AFJSONParserInstructionSetNEON; instructionSet++) {
+        if ([AFJSONParser isInstructionSetSupported:instructionSet]) {
+            [parsers addObject:[[AFJSONParser alloc] initWithInstructionSet:instructionSet]];
+        }
+    }
+    self.parsers = parsers;
+}
+
+#pragma mark -
+
+- (void)testThatParserMatchesFoundationForAPIPayloads {
+    XCTAssertNotEqual([[AFJSONParser alloc] init].instructionSet, AFJSONParserInstructionSetAutomatic);
+
+    for (NSData *data in AFJSONTestCorpus()) {
+        id expectedObject = [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+        for (AFJSONParser *parser in self.parsers) {
+            NSError *error = nil;
+            id object = [parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:&error];
+            XCTAssertNil(error);
+            XCTAssertTrue(AFJSONTestObjectsAreEqual(object, expectedObject), @"%@", AFJSONTestNameOfInstructionSet(parser.instructionSet));
+        }
+    }
+}
+
+- (void)testThatStringsAreDelimitedAcrossBlockBoundaries {
+    NSArray *strings = @[@"\\", @"\"", @"\\\"", @"\\\\\"\\", @"{\"[,]:}", [@"" stringByPaddingToLength:70 withString:@"\\" startingAtIndex:0], @"ü😀\n\t"];
+    NSData *data = [NSJSONSerialization dataWithJSONObject:@[@{@"key": strings}, @(-1.5e-3), @"", @{}] options:(NSJSONWritingOptions)0 error:nil];
+    id expectedObject = [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+
+    // Shifting the text by up to two blocks moves every escape sequence and quote across a block boundary
+    for (NSUInteger padding = 0; padding < 130; padding++) {
+        NSMutableData *paddedData = [NSMutableData dataWithLength:padding];
+        memset([paddedData mutableBytes], ' ', padding);
+        [paddedData appendData:data];
+
+        for (AFJSONParser *parser in self.parsers) {
+            id object = [parser JSONObjectWithData:paddedData options:(NSJSONReadingOptions)0 error:nil];
+            XCTAssertTrue(AFJSONTestObjectsAreEqual(object, expectedObject), @"%@ with %lu bytes of padding", AFJSONTestNameOfInstructionSet(parser.instructionSet), (unsigned long)padding);
+        }
+    }
+}
+
+- (void)testThatParserDecodesEscapeSequencesAndNumbers {
+    NSData *data = [@"[\"\\\"\\\\\\/\\b\\f\\n\\r\\t\", \"\\u00e9\\ud83d\\ude00\", 0, -0.5, 1e3, 9223372036854775807, -9223372036854775808, 18446744073709551615, 0.1, 1.7976931348623157e308, true, false, null]" dataUsingEncoding:NSUTF8StringEncoding];
+    NSArray *expectedObject = @[@"\"\\/\b\f\n\r\t", @"é😀", @0, @(-0.5), @1000, @(LLONG_MAX), @(LLONG_MIN), @(ULLONG_MAX), @0.1, @(DBL_MAX), @YES, @NO, [NSNull null]];
+
+    for (AFJSONParser *parser in self.parsers) {
+        XCTAssertEqualObjects([parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil], expectedObject);
+    }
+}
+
+- (void)testThatParserHonorsReadingOptions {
+    NSData *data = [@"{\"items\": [{\"name\": \"a\"}], \"count\": 1}" dataUsingEncoding:NSUTF8StringEncoding];
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    NSDictionary *immutableObject = [parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    XCTAssertFalse([immutableObject isKindOfClass:[NSMutableDictionary class]]);
+    XCTAssertFalse([immutableObject[@"items"] isKindOfClass:[NSMutableArray class]]);
+
+    NSDictionary *mutableObject = [parser JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+    XCTAssertTrue([mutableObject isKindOfClass:[NSMutableDictionary class]]);
+    XCTAssertTrue([mutableObject[@"items"] isKindOfClass:[NSMutableArray class]]);
+    XCTAssertTrue([mutableObject[@"items"][0] isKindOfClass:[NSMutableDictionary class]]);
+
+    NSDictionary *mutableLeavesObject = [parser JSONObjectWithData:data options:NSJSONReadingMutableLeaves error:nil];
+    NSMutableString *name = mutableLeavesObject[@"items"][0][@"name"];
+    XCTAssertNoThrow([name appendString:@"b"]);
+    XCTAssertEqualObjects(name, @"ab");
+
+    NSError *error = nil;
+    XCTAssertNil([parser JSONObjectWithData:[@"\"fragment\"" dataUsingEncoding:NSUTF8StringEncoding] options:(NSJSONReadingOptions)0 error:&error]);
+    XCTAssertEqual([error code], NSPropertyListReadCorruptError);
+    XCTAssertEqualObjects([parser JSONObjectWithData:[@"\"fragment\"" dataUsingEncoding:NSUTF8StringEncoding] options:NSJSONReadingAllowFragments error:nil], @"fragment");
+    XCTAssertEqualObjects([parser JSONObjectWithData:[@" 42 " dataUsingEncoding:NSUTF8StringEncoding] options:NSJSONReadingAllowFragments error:nil], @42);
+}
+
+- (void)testThatParserDecodesUTF16ThroughFoundation {
+    NSData *data = [@"{\"name\": \"Zoë\"}" dataUsingEncoding:NSUTF16LittleEndianStringEncoding];
+    XCTAssertEqualObjects([[[AFJSONParser alloc] init] JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil], @{@"name": @"Zoë"});
+}
+
+- (void)testThatMalformedJSONFails {
+    NSArray *malformedTexts = @[@"", @"   ", @"{", @"[1,]", @"[1 2]", @"{\"a\" 1}", @"{\"a\":}", @"{1:2}", @"{\"a\":1,}", @"[\"abc]", @"[tru]", @"[nul]", @"[truex]", @"[01]", @"[1.]", @"[.5]", @"[1e]", @"[-]", @"[+1]", @"[NaN]", @"[\"\\x\"]", @"[\"\\u12\"]", @"[\"\\ud800\"]", @"[\"a\tb\"]", @"[1]]", @"[1] x", @"[\\\"a\\\"]"];
+
+    for (NSString *malformedText in malformedTexts) {
+        NSData *data = [malformedText dataUsingEncoding:NSUTF8StringEncoding];
+        for (AFJSONParser *parser in self.parsers) {
+            NSError *error = nil;
+            XCTAssertNil([parser JSONObjectWithData:data options:NSJSONReadingAllowFragments error:&error], @"%@", malformedText);
+            XCTAssertEqualObjects([error domain], NSCocoaErrorDomain);
+            XCTAssertEqual([error code], NSPropertyListReadCorruptError);
+        }
+    }
+}
+
+- (void)testThatDeeplyNestedJSONFails {
+    NSString *(^nestedArrays)(NSUInteger) = ^(NSUInteger depth) {
+        return [[@"" stringByPaddingToLength:depth withString:@"[" startingAtIndex:0] stringByAppendingString:[@"" stringByPaddingToLength:depth withString:@"]" startingAtIndex:0]];
+    };
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    XCTAssertNotNil([parser JSONObjectWithData:[nestedArrays(100) dataUsingEncoding:NSUTF8StringEncoding] options:(NSJSONReadingOptions)0 error:nil]);
+    XCTAssertNil([parser JSONObjectWithData:[nestedArrays(10000) dataUsingEncoding:NSUTF8StringEncoding] options:(NSJSONReadingOptions)0 error:nil]);
+}
+
+#pragma mark - Documents
+
+- (void)testThatDocumentCreatesValuesAtKeyPaths {
+    NSData *data = AFJSONTestRepositoriesPayload(200);
+    NSDictionary *expectedObject = [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+
+    for (AFJSONParser *parser in self.parsers) {
+        NSError *error = nil;
+        AFJSONDocument *document = [parser documentWithData:data options:(NSJSONReadingOptions)0 error:&error];
+        XCTAssertNil(error);
+
+        XCTAssertEqualObjects(document[@"items.3.owner.login"], expectedObject[@"items"][3][@"owner"][@"login"]);
+        XCTAssertEqualObjects([document objectAtPath:@[@"items", @199, @"topics"]], expectedObject[@"items"][199][@"topics"]);
+        XCTAssertEqualObjects(document[@"items.42"], expectedObject[@"items"][42]);
+        XCTAssertEqualObjects(document[@"total_count"], @200);
+        XCTAssertEqual([document countForKeyPath:@"items"], (NSUInteger)200);
+        XCTAssertEqual([document countForKeyPath:@"items.0.owner"], [expectedObject[@"items"][0][@"owner"] count]);
+        XCTAssertEqual([document countForKeyPath:@"total_count"], (NSUInteger)NSNotFound);
+        XCTAssertNil(document[@"items.200"]);
+        XCTAssertNil(document[@"items.first"]);
+        XCTAssertNil(document[@"missing"]);
+        XCTAssertNil(document[@"total_count.value"]);
+        XCTAssertTrue(AFJSONTestObjectsAreEqual(document.JSONObject, expectedObject));
+    }
+}
+
+- (void)testThatDocumentFindsKeysWithEscapeSequencesAndPeriods {
+    NSData *data = [@"{\"a.b\": 1, \"caf\\u00e9\": 2, \"dup\": 1, \"nested\": {\"dup\": 0}, \"dup\": 3}" dataUsingEncoding:NSUTF8StringEncoding];
+    AFJSONDocument *document = [[[AFJSONParser alloc] init] documentWithData:data options:(NSJSONReadingOptions)0 error:nil];
+
+    XCTAssertEqualObjects([document objectAtPath:@[@"a.b"]], @1);
+    XCTAssertNil(document[@"a.b"]);
+    XCTAssertEqualObjects(document[@"café"], @2);
+    XCTAssertEqualObjects(document[@"dup"], @3);
+    XCTAssertEqualObjects(document[@"nested.dup"], @0);
+}
+
+- (void)testThatDocumentRemovesKeysWithNullValues {
+    NSData *data = [@"{\"a\": null, \"b\": [1, null, 2], \"c\": {\"d\": null}}" dataUsingEncoding:NSUTF8StringEncoding];
+    AFJSONDocument *document = [[[AFJSONParser alloc] init] documentWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    AFJSONDocument *strippedDocument = [document documentByRemovingKeysWithNullValues];
+
+    XCTAssertEqualObjects(document[@"a"], [NSNull null]);
+    XCTAssertEqualObjects(document[@"b.1"], [NSNull null]);
+    XCTAssertEqual([document countForKeyPath:@"b"], (NSUInteger)3);
+
+    XCTAssertTrue(strippedDocument.removesKeysWithNullValues);
+    XCTAssertEqualObjects(strippedDocument.data, document.data);
+    XCTAssertNil(strippedDocument[@"a"]);
+    XCTAssertEqualObjects(strippedDocument[@"b.1"], @2);
+    XCTAssertEqual([strippedDocument countForKeyPath:@"b"], (NSUInteger)2);
+    XCTAssertEqualObjects(strippedDocument[@"c"], @{});
+    XCTAssertEqualObjects(strippedDocument.JSONObject, (@{@"b": @[@1, @2], @"c": @{}}));
+}
+
+- (void)testThatMalformedDocumentFails {
+    NSMutableArray *malformedData = [NSMutableArray array];
+    for (NSString *malformedText in @[@"", @"{", @"[1,]", @"{\"a\" 1}", @"[\"abc]", @"[tru]", @"[01]", @"[\"\\x\"]", @"[1] x", @"\"fragment\""]) {
+        [malformedData addObject:[malformedText dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    const uint8_t invalidUTF8[] = {'[', '"', 0xC3, 0x28, '"', ']'};
+    [malformedData addObject:[NSData dataWithBytes:invalidUTF8 length:sizeof(invalidUTF8)]];
+
+    for (NSData *data in malformedData) {
+        NSError *error = nil;
+        XCTAssertNil([[[AFJSONParser alloc] init] documentWithData:data options:(NSJSONReadingOptions)0 error:&error]);
+        XCTAssertEqual([error code], NSPropertyListReadCorruptError);
+    }
+}
+
+- (void)testThatDocumentIsCreatedFromUTF16Text {
+    NSData *data = [@"{\"name\": \"Zoë\"}" dataUsingEncoding:NSUTF16StringEncoding];
+    AFJSONDocument *document = [[[AFJSONParser alloc] init] documentWithData:data options:(NSJSONReadingOptions)0 error:nil];
+
+    XCTAssertEqualObjects(document[@"name"], @"Zoë");
+}
+
+- (void)testThatDocumentReadsValueDeepInLargePayload {
+    NSData *data = AFJSONTestRepositoriesPayload(20000);
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    NSDictionary *object = [parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    AFJSONDocument *document = [parser documentWithData:data options:(NSJSONReadingOptions)0 error:nil];
+
+    XCTAssertEqualObjects(document[@"items.19999.owner.login"], object[@"items"][19999][@"owner"][@"login"]);
+}
+
+- (void)testPerformanceOfReadingOneValueEagerly {
+    NSData *data = AFJSONTestRepositoriesPayload(20000);
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    [self measureBlock:^{
+        @autoreleasepool {
+            NSDictionary *object = [parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+            XCTAssertNotNil(object[@"items"][19999][@"owner"][@"login"]);
+        }
+    }];
+}
+
+- (void)testPerformanceOfReadingOneValueLazily {
+    NSData *data = AFJSONTestRepositoriesPayload(20000);
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    [self measureBlock:^{
+        @autoreleasepool {
+            AFJSONDocument *document = [parser documentWithData:data options:(NSJSONReadingOptions)0 error:nil];
+            XCTAssertNotNil(document[@"items.19999.owner.login"]);
+        }
+    }];
+}
+
+// Measures parsing the corpus, and records the throughput of all the iterations together in GB/s
+- (void)measureParsingOfAPIPayloadsWithName:(NSString *)name
+                                      block:(id (^)(NSData *data))parse
+{
+    NSArray <NSData *> *corpus = AFJSONTestCorpus();
+    NSUInteger numberOfBytes = 0;
+    for (NSData *data in corpus) {
+        numberOfBytes += [data length];
+    }
+
+    __block NSUInteger numberOfIterations = 0;
+    __block CFAbsoluteTime elapsed = 0.0;
+    [self measureBlock:^{
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+        for (NSData *data in corpus) {
+            @autoreleasepool {
+                XCTAssertNotNil(parse(data));
+            }
+        }
+        elapsed += CFAbsoluteTimeGetCurrent() - startTime;
+        numberOfIterations++;
+    }];
+
+    [self recordBenchmarkValue:(double)numberOfBytes * numberOfIterations / elapsed / 1e9 unit:@"GB/s" name:name];
+}
+
+- (void)testPerformanceOfParsingAPIPayloadsWithFoundation {
+    [self measureParsingOfAPIPayloadsWithName:@"NSJSONSerialization" block:^id(NSData *data) {
+        return [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    }];
+}
+
+- (void)testPerformanceOfParsingAPIPayloadsWithScalarInstructions {
+    AFJSONParser *parser = [[AFJSONParser alloc] initWithInstructionSet:AFJSONParserInstructionSetScalar];
+
+    [self measureParsingOfAPIPayloadsWithName:@"Scalar instructions" block:^id(NSData *data) {
+        return [parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    }];
+}
+
+- (void)testPerformanceOfParsingAPIPayloadsWithFastestInstructionSet {
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    [self measureParsingOfAPIPayloadsWithName:@"Fastest instruction set" block:^id(NSData *data) {
+        return [parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    }];
+}
+
+#pragma mark - Models
+
+- (void)testThatModelsAreDecodedWithSchema {
+    NSData *data = AFJSONTestRepositoriesPayload(100);
+    AFJSONTestSearchResults *expectedResults = [[AFJSONTestSearchResults alloc] initWithJSONObject:[NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil]];
+
+    for (AFJSONParser *parser in self.parsers) {
+        NSError *error = nil;
+        AFJSONTestSearchResults *results = [parser modelWithData:data schema:AFJSONTestSearchResultsSchema() error:&error];
+        XCTAssertNil(error);
+        XCTAssertTrue([results isKindOfClass:[AFJSONTestSearchResults class]]);
+        XCTAssertEqual(results.totalCount, (NSUInteger)100);
+        XCTAssertFalse(results.incompleteResults);
+        XCTAssertEqual([results.items count], [expectedResults.items count]);
+        for (NSUInteger idx = 0; idx < [results.items count]; idx++) {
+            for (NSString *keyPath in AFJSONTestKeysOfRepository()) {
+                XCTAssertEqualObjects([results.items[idx] valueForKeyPath:keyPath], [expectedResults.items[idx] valueForKeyPath:keyPath], @"items.%lu.%@", (unsigned long)idx, keyPath);
+            }
+        }
+    }
+}
+
+- (void)testThatModelsAreDecodedFromArrays {
+    NSData *data = [@"[{\"login\": \"mattt\", \"id\": 1}, null, {\"login\": \"kylef\", \"id\": 2, \"site_admin\": true}]" dataUsingEncoding:NSUTF8StringEncoding];
+    AFJSONModelSchema *schema = AFJSONTestSearchResultsSchema().schemasByPropertyName[@"items"].schemasByPropertyName[@"owner"];
+
+    NSError *error = nil;
+    NSArray <AFJSONTestOwner *> *owners = [[[AFJSONParser alloc] init] modelWithData:data schema:schema error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual([owners count], (NSUInteger)2);
+    XCTAssertEqualObjects(owners[0].login, @"mattt");
+    XCTAssertEqual(owners[1].identifier, 2);
+    XCTAssertTrue(owners[1].siteAdmin);
+}
+
+- (void)testThatModelsAreDecodedIntoEveryPropertyType {
+    NSData *data = [@"{\"shortValue\": -1e3, \"unsignedIntValue\": 4294967295, \"floatValue\": 0.5, \"boolValue\": true, \"number\": 18446744073709551615, \"mutable\\u0053tring\": \"a\\nb\", \"mutableArray\": [1, \"a\"], \"dictionary\": {\"a\": null}, \"anything\": [true], \"unknown\": {\"deep\": [1, {}]}, \"child\": {\"shortValue\": 7, \"child\": {\"boolValue\": 1}}}" dataUsingEncoding:NSUTF8StringEncoding];
+    AFJSONModelSchema *schema = [AFJSONModelSchema schemaWithModelClass:[AFJSONTestValues class] propertyNamesByJSONKey:nil];
+    [schema setSchema:schema forPropertyName:@"child"];
+    XCTAssertNil(schema.propertyNamesByJSONKey[@"readonlyValue"]);
+    XCTAssertEqual(schema.schemasByPropertyName[@"child"], schema);
+
+    NSError *error = nil;
+    AFJSONTestValues *values = [[[AFJSONParser alloc] init] modelWithData:data schema:schema error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual(values.shortValue, -1000);
+    XCTAssertEqual(values.unsignedIntValue, UINT_MAX);
+    XCTAssertEqual(values.floatValue, 0.5f);
+    XCTAssertTrue(values.boolValue);
+    XCTAssertEqualObjects(values.number, @(ULLONG_MAX));
+    XCTAssertEqualObjects(values.mutableString, @"a\nb");
+    XCTAssertTrue([values.mutableString isKindOfClass:[NSMutableString class]]);
+    [values.mutableString appendString:@"c"];
+    XCTAssertEqualObjects(values.mutableArray, (@[@1, @"a"]));
+    [values.mutableArray addObject:@"b"];
+    XCTAssertEqualObjects(values.dictionary, @{@"a": [NSNull null]});
+    XCTAssertEqualObjects(values.anything, @[@YES]);
+    XCTAssertEqual(values.child.shortValue, 7);
+    XCTAssertTrue(values.child.child.boolValue);
+}
+
+- (void)testThatMismatchesAreReported {
+    NSData *data = [@"{\"total_count\": \"many\", \"items\": [{\"id\": 1.5, \"owner\": [], \"name\": 5, \"description\": null}, {\"id\": -1, \"html_url\": 3}, 3]}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    id model = [[[AFJSONParser alloc] init] modelWithData:data schema:AFJSONTestSearchResultsSchema() error:&error];
+    XCTAssertNil(model);
+    XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+    XCTAssertEqual(error.code, NSCoderReadCorruptError);
+
+    NSArray <NSString *> *mismatches = error.userInfo[AFJSONModelMismatchesErrorKey];
+    NSArray <NSString *> *expectedKeyPaths = @[@"total_count", @"items.0.id", @"items.0.owner", @"items.0.name", @"items.1.id", @"items.1.html_url", @"items.2"];
+    XCTAssertEqual([mismatches count], [expectedKeyPaths count], @"%@", mismatches);
+    for (NSUInteger idx = 0; idx < MIN([mismatches count], [expectedKeyPaths count]); idx++) {
+        XCTAssertTrue([mismatches[idx] hasPrefix:[expectedKeyPaths[idx] stringByAppendingString:@":"]], @"%@", mismatches[idx]);
+    }
+    XCTAssertEqualObjects(mismatches[0], @"total_count: expected an integer within the range of the property, found a string");
+}
+
+- (void)testThatMalformedJSONFailsToDecodeModels {
+    NSError *error = nil;
+    XCTAssertNil([[[AFJSONParser alloc] init] modelWithData:[@"{\"total_count\": 1," dataUsingEncoding:NSUTF8StringEncoding] schema:AFJSONTestSearchResultsSchema() error:&error]);
+    XCTAssertEqual(error.code, NSPropertyListReadCorruptError);
+}
+
+- (void)testThatSchemaCanBeArchived {
+    AFJSONModelSchema *schema = [AFJSONModelSchema schemaWithModelClass:[AFJSONTestValues class] propertyNamesByJSONKey:nil];
+    [schema setSchema:schema forPropertyName:@"child"];
+    AFJSONModelSchema *searchResultsSchema = AFJSONTestSearchResultsSchema();
+
+    for (AFJSONModelSchema *archivedSchema in @[schema, searchResultsSchema]) {
+        AFJSONModelSchema *unarchivedSchema = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:archivedSchema]];
+        XCTAssertEqual(unarchivedSchema.modelClass, archivedSchema.modelClass);
+        XCTAssertEqualObjects(unarchivedSchema.propertyNamesByJSONKey, archivedSchema.propertyNamesByJSONKey);
+        XCTAssertEqualObjects([unarchivedSchema.schemasByPropertyName allKeys], [archivedSchema.schemasByPropertyName allKeys]);
+    }
+}
+
+- (void)measureDecodingOfModelsWithBlock:(AFJSONTestSearchResults * (^)(NSData *data))decode {
+    NSData *data = AFJSONTestRepositoriesPayload(5000);
+
+    [self measureBlock:^{
+        @autoreleasepool {
+            XCTAssertEqual([decode(data).items count], (NSUInteger)5000);
+        }
+    }];
+}
+
+- (void)testPerformanceOfDecodingModelsByParsingWithFoundationThenMapping {
+    [self measureDecodingOfModelsWithBlock:^AFJSONTestSearchResults *(NSData *data) {
+        return [[AFJSONTestSearchResults alloc] initWithJSONObject:[NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil]];
+    }];
+}
+
+- (void)testPerformanceOfDecodingModelsByParsingThenMapping {
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+
+    [self measureDecodingOfModelsWithBlock:^AFJSONTestSearchResults *(NSData *data) {
+        return [[AFJSONTestSearchResults alloc] initWithJSONObject:[parser JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil]];
+    }];
+}
+
+- (void)testPerformanceOfDecodingModelsWithSchema {
+    AFJSONParser *parser = [[AFJSONParser alloc] init];
+    AFJSONModelSchema *schema = AFJSONTestSearchResultsSchema();
+
+    [self measureDecodingOfModelsWithBlock:^AFJSONTestSearchResults *(NSData *data) {
+        return [parser modelWithData:data schema:schema error:nil];
+    }];
+}
+
+@end
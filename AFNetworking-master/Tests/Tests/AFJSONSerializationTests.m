@@ -23,11 +23,61 @@
 
 #import "AFURLRequestSerialization.h"
 #import "AFURLResponseSerialization.h"
+#import "AFURLSessionManager.h"
+#import "AFJSONParser.h"
 
 static NSData * AFJSONTestData() {
     return [NSJSONSerialization dataWithJSONObject:@{@"foo": @"bar"} options:(NSJSONWritingOptions)0 error:nil];
 }
 
+// A list of user records in the shape of a typical API response, where every fifth record has optional fields set to `null`
+static NSData * AFJSONTestLargeDocumentData(NSUInteger numberOfRecords) {
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:numberOfRecords];
+    for (NSUInteger idx = 0; idx < numberOfRecords; idx++) {
+        BOOL hasNullValues = idx % 5 == 0;
+        [records addObject:@{
+            @"id": @(idx),
+            @"login": [NSString stringWithFormat:@"user%lu", (unsigned long)idx],
+            @"name": [NSString stringWithFormat:@"User Number %lu", (unsigned long)idx],
+            @"avatar_url": hasNullValues ? [NSNull null] : [NSString stringWithFormat:@"https://example.com/avatars/%lu.png", (unsigned long)idx],
+            @"score": @(idx * 0.25),
+            @"verified": @(idx % 2 == 0),
+            @"tags": @[@"alpha", @"beta", @"gamma"],
+            @"address": @{@"street": @"1 Infinite Loop", @"city": @"Cupertino", @"zip": hasNullValues ? [NSNull null] : @"95014"},
+        }];
+    }
+
+    return [NSJSONSerialization dataWithJSONObject:@{@"total_count": @(numberOfRecords), @"next_page": [NSNull null], @"items": records} options:(NSJSONWritingOptions)0 error:nil];
+}
+
+// The previous implementation of `AFJSONObjectByRemovingKeysWithNullValues`, which rebuilt every container
+static id AFJSONTestObjectByRebuildingWithoutNullValues(id JSONObject) {
+    if ([JSONObject isKindOfClass:[NSArray class]]) {
+        NSMutableArray *mutableArray = [NSMutableArray arrayWithCapacity:[(NSArray *)JSONObject count]];
+        for (id value in (NSArray *)JSONObject) {
+            if (![value isEqual:[NSNull null]]) {
+                [mutableArray addObject:AFJSONTestObjectByRebuildingWithoutNullValues(value)];
+            }
+        }
+
+        return [NSArray arrayWithArray:mutableArray];
+    } else if ([JSONObject isKindOfClass:[NSDictionary class]]) {
+        NSMutableDictionary *mutableDictionary = [NSMutableDictionary dictionaryWithDictionary:JSONObject];
+        for (id <NSCopying> key in [(NSDictionary *)JSONObject allKeys]) {
+            id value = (NSDictionary *)JSONObject[key];
+            if (!value || [value isEqual:[NSNull null]]) {
+                [mutableDictionary removeObjectForKey:key];
+            } else if ([value isKindOfClass:[NSArray class]] || [value isKindOfClass:[NSDictionary class]]) {
+                mutableDictionary[key] = AFJSONTestObjectByRebuildingWithoutNullValues(value);
+            }
+        }
+
+        return [NSDictionary dictionaryWithDictionary:mutableDictionary];
+    }
+
+    return JSONObject;
+}
+
 #pragma mark -
 
 @interface AFJSONRequestSerializationTests : AFTestCase
@@ -174,6 +224,38 @@ static NSData * AFJSONTestData() {
     XCTAssertNil(error);
 }
 
+- (void)testThatJSONResponseSerializerDecodesWithStructuralIndexBackend {
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"text/json"}];
+    NSData *data = AFJSONTestLargeDocumentData(100);
+    self.responseSerializer.readingOptions = NSJSONReadingMutableContainers;
+    self.responseSerializer.parsingBackend = AFJSONParsingBackendStructuralIndex;
+
+    NSError *error = nil;
+    id responseObject = [self.responseSerializer responseObjectForResponse:response data:data error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(responseObject, [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil]);
+    XCTAssertTrue([responseObject isKindOfClass:[NSMutableDictionary class]]);
+
+    [self.responseSerializer responseObjectForResponse:response data:[@"{invalid}" dataUsingEncoding:NSUTF8StringEncoding] error:&error];
+    XCTAssertEqualObjects([error domain], NSCocoaErrorDomain);
+}
+
+- (void)testThatJSONResponseSerializerDecodesLazily {
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"text/json"}];
+    NSData *data = AFJSONTestLargeDocumentData(100);
+    self.responseSerializer.decodesLazily = YES;
+    self.responseSerializer.removesKeysWithNullValues = YES;
+
+    NSError *error = nil;
+    AFJSONDocument *document = [self.responseSerializer responseObjectForResponse:response data:data error:&error];
+    XCTAssertNil(error);
+    XCTAssertTrue([document isKindOfClass:[AFJSONDocument class]]);
+    XCTAssertTrue(document.removesKeysWithNullValues);
+    XCTAssertEqualObjects(document[@"items.1.login"], @"user1");
+    XCTAssertNil(document[@"items.0.avatar_url"]);
+    XCTAssertNil(document[@"next_page"]);
+}
+
 - (void)testThatJSONRemovesKeysWithNullValues {
     self.responseSerializer.removesKeysWithNullValues = YES;
     NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"text/json"}];
@@ -192,11 +274,100 @@ static NSData * AFJSONTestData() {
     XCTAssertEqualObjects(responseObject[@"arrayWithNulls"], @[]);
 }
 
+- (void)testThatJSONRemovesKeysWithNullValuesInPlaceFromMutableContainers {
+    self.responseSerializer.removesKeysWithNullValues = YES;
+    self.responseSerializer.readingOptions = NSJSONReadingMutableContainers;
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"text/json"}];
+    NSData *data = [@"{\"key\":\"value\",\"nullkey\":null,\"array\":[{\"subnullkey\":null},null]}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    NSMutableDictionary *responseObject = [self.responseSerializer responseObjectForResponse:response data:data error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(responseObject, (@{@"key": @"value", @"array": @[@{}]}));
+    XCTAssertTrue([responseObject isKindOfClass:[NSMutableDictionary class]]);
+    XCTAssertTrue([responseObject[@"array"] isKindOfClass:[NSMutableArray class]]);
+}
+
+- (void)testThatJSONSubtreesWithoutNullValuesAreNotCopied {
+    NSDictionary *withoutNullValues = @{@"key": @"value", @"array": @[@1, @2]};
+    NSDictionary *JSONObject = @{@"clean": withoutNullValues, @"dirty": @{@"nullkey": [NSNull null]}};
+
+    NSDictionary *strippedObject = AFJSONObjectByRemovingKeysWithNullValues(JSONObject, (NSJSONReadingOptions)0);
+    XCTAssertEqual(strippedObject[@"clean"], withoutNullValues);
+    XCTAssertEqualObjects(strippedObject[@"dirty"], @{});
+    XCTAssertEqual(AFJSONObjectByRemovingKeysWithNullValues(withoutNullValues, (NSJSONReadingOptions)0), withoutNullValues);
+}
+
+- (void)testThatNullRemovalFromLargeDocumentMatchesRebuilding {
+    NSData *data = AFJSONTestLargeDocumentData(10000);
+    id JSONObject = [NSJSONSerialization JSONObjectWithData:data options:(NSJSONReadingOptions)0 error:nil];
+    id rebuiltObject = AFJSONTestObjectByRebuildingWithoutNullValues(JSONObject);
+
+    id strippedObject = AFJSONObjectByRemovingKeysWithNullValues(JSONObject, (NSJSONReadingOptions)0);
+    id mutableObject = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+    AFJSONObjectByRemovingKeysWithNullValues(mutableObject, NSJSONReadingMutableContainers);
+
+    XCTAssertEqualObjects(strippedObject, rebuiltObject);
+    XCTAssertEqualObjects(mutableObject, rebuiltObject);
+}
+
+- (void)testThatNullValuesAreRemovedFromImmutableObjectWithMutableContainersOption {
+    NSDictionary *JSONObject = @{@"key": @"value", @"nullkey": [NSNull null], @"array": @[@{@"subnullkey": [NSNull null]}, [NSNull null]]};
+    NSMutableDictionary *mutableObject = [NSMutableDictionary dictionaryWithDictionary:@{@"nullkey": [NSNull null], @"immutable": JSONObject}];
+
+    XCTAssertEqualObjects(AFJSONObjectByRemovingKeysWithNullValues(JSONObject, NSJSONReadingMutableContainers), (@{@"key": @"value", @"array": @[@{}]}));
+    XCTAssertEqual(AFJSONObjectByRemovingKeysWithNullValues(mutableObject, NSJSONReadingMutableContainers), mutableObject);
+    XCTAssertEqualObjects(mutableObject, (@{@"immutable": @{@"key": @"value", @"array": @[@{}]}}));
+}
+
+- (void)testPerformanceOfRemovingNullValuesByRebuilding {
+    if (!self.benchmarksEnabled) {
+        return;
+    }
+
+    id JSONObject = [NSJSONSerialization JSONObjectWithData:AFJSONTestLargeDocumentData(10000) options:(NSJSONReadingOptions)0 error:nil];
+
+    [self measureBlock:^{
+        AFJSONTestObjectByRebuildingWithoutNullValues(JSONObject);
+    }];
+}
+
+- (void)testPerformanceOfRemovingNullValuesByCopyingOnWrite {
+    if (!self.benchmarksEnabled) {
+        return;
+    }
+
+    id JSONObject = [NSJSONSerialization JSONObjectWithData:AFJSONTestLargeDocumentData(10000) options:(NSJSONReadingOptions)0 error:nil];
+
+    [self measureBlock:^{
+        AFJSONObjectByRemovingKeysWithNullValues(JSONObject, (NSJSONReadingOptions)0);
+    }];
+}
+
+- (void)testPerformanceOfRemovingNullValuesInPlace {
+    if (!self.benchmarksEnabled) {
+        return;
+    }
+
+    NSData *data = AFJSONTestLargeDocumentData(10000);
+
+    // Only the removal is measured, since each iteration needs a freshly parsed mutable document
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        id mutableObject = [NSJSONSerialization JSONObjectWithData:data options:NSJSONReadingMutableContainers error:nil];
+
+        [self startMeasuring];
+        AFJSONObjectByRemovingKeysWithNullValues(mutableObject, NSJSONReadingMutableContainers);
+        [self stopMeasuring];
+    }];
+}
+
 - (void)testThatJSONResponseSerializerCanBeCopied {
     [self.responseSerializer setAcceptableStatusCodes:[NSIndexSet indexSetWithIndex:100]];
     [self.responseSerializer setAcceptableContentTypes:[NSSet setWithObject:@"test/type"]];
     [self.responseSerializer setReadingOptions:NSJSONReadingMutableLeaves];
     [self.responseSerializer setRemovesKeysWithNullValues:YES];
+    [self.responseSerializer setParsingBackend:AFJSONParsingBackendStructuralIndex];
+    [self.responseSerializer setDecodesLazily:YES];
 
     AFJSONResponseSerializer *copiedSerializer = [self.responseSerializer copy];
     XCTAssertNotEqual(copiedSerializer, self.responseSerializer);
@@ -204,6 +375,253 @@ static NSData * AFJSONTestData() {
     XCTAssertEqual(copiedSerializer.acceptableContentTypes, self.responseSerializer.acceptableContentTypes);
     XCTAssertEqual(copiedSerializer.readingOptions, self.responseSerializer.readingOptions);
     XCTAssertEqual(copiedSerializer.removesKeysWithNullValues, self.responseSerializer.removesKeysWithNullValues);
+    XCTAssertEqual(copiedSerializer.parsingBackend, self.responseSerializer.parsingBackend);
+    XCTAssertEqual(copiedSerializer.decodesLazily, self.responseSerializer.decodesLazily);
+}
+
+@end
+
+#pragma mark -
+
+@interface AFJSONTestUser : NSObject
+@property (nonatomic, assign) NSUInteger identifier;
+@property (nonatomic, copy) NSString *login;
+@property (nonatomic, strong) NSURL *avatarURL;
+@property (nonatomic, assign) double score;
+@property (nonatomic, copy) NSArray <NSString *> *tags;
+@end
+
+@implementation AFJSONTestUser
+@end
+
+@interface AFJSONModelResponseSerializationTests : AFTestCase
+@property (nonatomic, strong) AFJSONModelResponseSerializer *responseSerializer;
+@end
+
+@implementation AFJSONModelResponseSerializationTests
+
+- (void)setUp {
+    [super setUp];
+    AFJSONModelSchema *schema = [AFJSONModelSchema schemaWithModelClass:[AFJSONTestUser class] propertyNamesByJSONKey:@{@"id": @"identifier", @"login": @"login", @"avatar_url": @"avatarURL", @"score": @"score", @"tags": @"tags"}];
+    self.responseSerializer = [AFJSONModelResponseSerializer serializerWithSchema:schema];
+}
+
+#pragma mark -
+
+- (void)testThatJSONModelResponseSerializerDecodesModels {
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"application/json"}];
+    NSData *data = [NSJSONSerialization dataWithJSONObject:[NSJSONSerialization JSONObjectWithData:AFJSONTestLargeDocumentData(10) options:(NSJSONReadingOptions)0 error:nil][@"items"] options:(NSJSONWritingOptions)0 error:nil];
+
+    NSError *error = nil;
+    NSArray <AFJSONTestUser *> *users = [self.responseSerializer responseObjectForResponse:response data:data error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqual([users count], (NSUInteger)10);
+    XCTAssertEqual(users[3].identifier, (NSUInteger)3);
+    XCTAssertEqualObjects(users[3].login, @"user3");
+    XCTAssertEqualObjects(users[3].avatarURL, [NSURL URLWithString:@"https://example.com/avatars/3.png"]);
+    XCTAssertNil(users[5].avatarURL);
+    XCTAssertEqual(users[3].score, 0.75);
+    XCTAssertEqualObjects(users[3].tags, (@[@"alpha", @"beta", @"gamma"]));
+}
+
+- (void)testThatJSONModelResponseSerializerReportsMismatches {
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"application/json"}];
+    NSData *data = [@"{\"id\": \"1\", \"login\": \"mattt\"}" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    XCTAssertNil([self.responseSerializer responseObjectForResponse:response data:data error:&error]);
+    XCTAssertEqual(error.code, NSCoderReadCorruptError);
+    XCTAssertEqualObjects(error.userInfo[AFJSONModelMismatchesErrorKey], @[@"id: expected an integer within the range of the property, found a string"]);
+}
+
+- (void)testThatJSONModelResponseSerializerWithoutSchemaDecodesFoundationObjects {
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.baseURL statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type":@"application/json"}];
+    self.responseSerializer.schema = nil;
+
+    NSError *error = nil;
+    id responseObject = [self.responseSerializer responseObjectForResponse:response data:AFJSONTestData() error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(responseObject, @{@"foo": @"bar"});
+}
+
+- (void)testThatJSONModelResponseSerializerCanBeCopiedAndArchived {
+    AFJSONModelResponseSerializer *copiedSerializer = [self.responseSerializer copy];
+    XCTAssertNotEqual(copiedSerializer, self.responseSerializer);
+    XCTAssertEqual(copiedSerializer.schema, self.responseSerializer.schema);
+
+    AFJSONModelResponseSerializer *unarchivedSerializer = [NSKeyedUnarchiver unarchiveObjectWithData:[NSKeyedArchiver archivedDataWithRootObject:self.responseSerializer]];
+    XCTAssertEqual(unarchivedSerializer.schema.modelClass, [AFJSONTestUser class]);
+    XCTAssertEqualObjects(unarchivedSerializer.schema.propertyNamesByJSONKey, self.responseSerializer.schema.propertyNamesByJSONKey);
+}
+
+@end
+
+#pragma mark -
+
+@interface AFJSONElementStreamTests : AFTestCase
+@property (nonatomic, strong) AFJSONResponseSerializer *responseSerializer;
+@property (nonatomic, strong) AFURLSessionManager *manager;
+@end
+
+@implementation AFJSONElementStreamTests
+
+- (void)setUp {
+    [super setUp];
+    self.responseSerializer = [AFJSONResponseSerializer serializer];
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (NSError *)finishStream:(AFJSONElementStream *)stream withData:(NSData *)data chunkSize:(NSUInteger)chunkSize {
+    for (NSUInteger offset = 0; offset < [data length]; offset += chunkSize) {
+        [stream dataTask:nil didReceiveData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, [data length] - offset))]];
+    }
+
+    __block NSError *streamError = nil;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    [stream finishWithCompletionHandler:^(NSError *error) {
+        streamError = error;
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    return streamError;
+}
+
+#pragma mark -
+
+- (void)testThatElementsOfTopLevelArrayAreDecodedAcrossChunks {
+    NSData *data = [@" [1, \"a,]\\\"b\" ,{\"k\": [1, {\"]\": 2}]}, [ ], null,-2.5e3,true ] " dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSMutableArray *elements = [NSMutableArray array];
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    AFJSONElementStream *stream = [self.responseSerializer elementStreamWithKeyPath:nil queue:nil elementHandler:^(id element, NSUInteger idx) {
+        [elements addObject:element];
+        [indexes addIndex:idx];
+    }];
+
+    XCTAssertNil([self finishStream:stream withData:data chunkSize:1]);
+
+    NSArray *expectedElements = @[@1, @"a,]\"b", @{@"k": @[@1, @{@"]": @2}]}, @[], [NSNull null], @(-2500), @YES];
+    XCTAssertEqualObjects(elements, expectedElements);
+    XCTAssertEqualObjects(indexes, [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 7)]);
+    XCTAssertEqual(stream.numberOfElements, (NSUInteger)7);
+}
+
+- (void)testThatElementsOfArrayAtKeyPathAreDecoded {
+    NSData *data = [@"{\"items\": [0], \"meta\": {\"data\": {\"items\": [0]}}, \"da\\u0074a\": {\"count\": 2, \"items\": [{\"id\": 1, \"items\": [3]}, {\"id\": 2, \"avatar\": null}]}}" dataUsingEncoding:NSUTF8StringEncoding];
+    self.responseSerializer.removesKeysWithNullValues = YES;
+
+    NSMutableArray *elements = [NSMutableArray array];
+    AFJSONElementStream *stream = [self.responseSerializer elementStreamWithKeyPath:@"data.items" queue:nil elementHandler:^(id element, NSUInteger idx) {
+        [elements addObject:element];
+    }];
+
+    XCTAssertNil([self finishStream:stream withData:data chunkSize:5]);
+
+    NSArray *expectedElements = @[@{@"id": @1, @"items": @[@3]}, @{@"id": @2}];
+    XCTAssertEqualObjects(elements, expectedElements);
+    XCTAssertEqualObjects(stream.keyPath, @"data.items");
+}
+
+- (void)testThatStreamWithoutArrayAtKeyPathFails {
+    AFJSONElementStream *stream = [self.responseSerializer elementStreamWithKeyPath:@"data.rows" queue:nil elementHandler:^(id element, NSUInteger idx) {
+        XCTFail(@"No element should be delivered");
+    }];
+
+    NSError *error = [self finishStream:stream withData:[@"{\"data\": {\"rows\": {\"id\": 1}}}" dataUsingEncoding:NSUTF8StringEncoding] chunkSize:64];
+    XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+}
+
+- (void)testThatTruncatedResponseFailsAfterDeliveringCompleteElements {
+    NSMutableArray *elements = [NSMutableArray array];
+    AFJSONElementStream *stream = [self.responseSerializer elementStreamWithKeyPath:nil queue:nil elementHandler:^(id element, NSUInteger idx) {
+        [elements addObject:element];
+    }];
+
+    NSError *error = [self finishStream:stream withData:[@"[{\"id\": 1}, {\"id\": 2}, {\"id\"" dataUsingEncoding:NSUTF8StringEncoding] chunkSize:12];
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+    NSArray *expectedElements = @[@{@"id": @1}, @{@"id": @2}];
+    XCTAssertEqualObjects(elements, expectedElements);
+}
+
+- (void)serveLargeDocumentData:(NSData *)data {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/json"} body:data];
+        [response setBytesPerSecond:8 * 1024 * 1024];
+        return response;
+    }];
+}
+
+- (void)testThatFirstElementIsHandledBeforeResponseIsReceived {
+    NSData *data = AFJSONTestLargeDocumentData(20000);
+    [self serveLargeDocumentData:data];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"users"]];
+
+    __block NSURLSessionDataTask *task = nil;
+    __block int64_t numberOfBytesReceivedBeforeFirstElement = 0;
+    __block NSUInteger numberOfElements = 0;
+    AFJSONElementStream *stream = [self.responseSerializer elementStreamWithKeyPath:@"items" queue:nil elementHandler:^(id element, NSUInteger idx) {
+        if (idx == 0) {
+            numberOfBytesReceivedBeforeFirstElement = task.countOfBytesReceived;
+        }
+        numberOfElements++;
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Streaming task should complete"];
+    task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(numberOfElements, (NSUInteger)20000);
+    XCTAssertTrue(numberOfBytesReceivedBeforeFirstElement < (int64_t)[data length]);
+}
+
+- (void)testPerformanceOfTimeToFirstStreamedElement {
+    [self serveLargeDocumentData:AFJSONTestLargeDocumentData(20000)];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"users"]];
+
+    // Elements are delivered on the main queue, which runs while the test waits, so measuring can stop at the first one
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        AFJSONElementStream *stream = [self.responseSerializer elementStreamWithKeyPath:@"items" queue:nil elementHandler:^(id element, NSUInteger idx) {
+            if (idx == 0) {
+                [self stopMeasuring];
+            }
+        }];
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Streaming task should complete"];
+        NSURLSessionDataTask *task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        [self startMeasuring];
+        [task resume];
+        [self waitForExpectationsWithCommonTimeout];
+    }];
+}
+
+- (void)testPerformanceOfBufferedDecoding {
+    [self serveLargeDocumentData:AFJSONTestLargeDocumentData(20000)];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"users"]];
+    self.manager.responseSerializer = self.responseSerializer;
+
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Buffered task should complete"];
+        [[self.manager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+            XCTAssertEqual([responseObject[@"items"] count], (NSUInteger)20000);
+            [expectation fulfill];
+        }] resume];
+        [self waitForExpectationsWithCommonTimeout];
+    }];
 }
 
 @end
@@ -0,0 +1,305 @@
+// AFMessagePackSerializationTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFMessagePackSerialization.h"
+#import "AFURLSessionManager.h"
+
+static NSData * AFMessagePackTestDataWithBytes(NSArray <NSNumber *> *bytes) {
+    NSMutableData *data = [NSMutableData dataWithCapacity:[bytes count]];
+    for (NSNumber *byte in bytes) {
+        uint8_t value = [byte unsignedCharValue];
+        [data appendBytes:&value length:1];
+    }
+
+    return data;
+}
+
+// Records in the shape of an API response, with the numbers, booleans and repeated keys JSON spends most of its length on
+static NSArray * AFMessagePackTestRecords(NSUInteger numberOfRecords) {
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity:numberOfRecords];
+    for (NSUInteger idx = 0; idx < numberOfRecords; idx++) {
+        [records addObject:@{
+            @"id": @(3637124 + idx * 7919),
+            @"name": [NSString stringWithFormat:@"repository-%lu", (unsigned long)idx],
+            @"private": @NO,
+            @"owner": @{@"login": [NSString stringWithFormat:@"organization-%lu", (unsigned long)(idx % 97)], @"id": @(1000 + idx % 97), @"site_admin": @NO},
+            @"description": idx % 4 == 0 ? [NSNull null] : @"A delightful networking library",
+            @"stargazers_count": @((idx * 37) % 50000),
+            @"forks_count": @((idx * 11) % 10000),
+            @"score": @(1.0 / (idx + 1)),
+            @"location": @[@(-122.4194155 + idx * 0.001), @(37.7749295 - idx * 0.001)],
+            @"topics": @[@"networking", @"http", @"ios"],
+        }];
+    }
+
+    return records;
+}
+
+@interface AFMessagePackSerializationTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@end
+
+@implementation AFMessagePackSerializationTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *)responseWithContentType:(NSString *)contentType {
+    return [[NSHTTPURLResponse alloc] initWithURL:[AFTestURLProtocol baseURL] statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type": contentType}];
+}
+
+#pragma mark -
+
+- (void)testThatObjectsAreWrittenInTheirShortestForm {
+    NSData *data = [AFMessagePackSerialization dataWithMessagePackObject:@[@1, @-1, @300, @-200, @"a", @YES, [NSNull null], [NSData data], @{}] error:nil];
+
+    XCTAssertEqualObjects(data, AFMessagePackTestDataWithBytes(@[@0x99, @0x01, @0xFF, @0xCD, @0x01, @0x2C, @0xD1, @0xFF, @0x38, @0xA1, @0x61, @0xC3, @0xC0, @0xC4, @0x00, @0x80]));
+}
+
+- (void)testThatObjectsRoundTrip {
+    NSString *longString = [@"" stringByPaddingToLength:70000 withString:@"Zoë 日本語 " startingIndex:0];
+    NSDictionary *object = @{
+        @"integers": @[@0, @127, @128, @65535, @65536, @4294967296LL, @(UINT64_MAX), @-32, @-33, @(INT32_MIN), @(INT64_MIN)],
+        @"floats": @[@1.5f, @(M_PI), @-0.0],
+        @"booleans": @[@YES, @NO],
+        @"null": [NSNull null],
+        @"strings": @[@"", @"Café ☕️ 😀", longString],
+        @"data": [@"binary" dataUsingEncoding:NSUTF8StringEncoding],
+        @"nested": @{@"array": @[@[@[]]], @"map": @{@"key": @{}}},
+        @42: @"integer key",
+    };
+
+    NSError *error = nil;
+    NSData *data = [AFMessagePackSerialization dataWithMessagePackObject:object error:&error];
+    XCTAssertNil(error);
+
+    id decodedObject = [AFMessagePackSerialization messagePackObjectWithData:data options:0 error:&error];
+    XCTAssertNil(error);
+    XCTAssertEqualObjects(decodedObject, object);
+    XCTAssertEqual(decodedObject[@"booleans"][0], @YES);
+    XCTAssertEqualObjects(decodedObject[@"integers"][6], @(UINT64_MAX));
+
+    NSMutableDictionary *mutableObject = [AFMessagePackSerialization messagePackObjectWithData:data options:AFMessagePackReadingMutableContainers error:nil];
+    XCTAssertTrue([mutableObject isKindOfClass:[NSMutableDictionary class]]);
+    XCTAssertNoThrow([mutableObject removeObjectForKey:@"null"]);
+}
+
+- (void)testThatStringsAreWrittenWithTheirLengthInBytes {
+    NSArray <NSString *> *strings = @[[NSString stringWithCString:"Caf\xC3\xA9" encoding:NSUTF8StringEncoding], [[NSString alloc] initWithBytes:"a\0b" length:3 encoding:NSUTF8StringEncoding], [NSString stringWithUTF8String:"ascii"]];
+
+    for (NSString *string in strings) {
+        NSData *stringData = [string dataUsingEncoding:NSUTF8StringEncoding];
+        NSMutableData *expectedData = [NSMutableData dataWithBytes:(uint8_t[]){(uint8_t)(0xA0 | [stringData length])} length:1];
+        [expectedData appendData:stringData];
+
+        XCTAssertEqualObjects([AFMessagePackSerialization dataWithMessagePackObject:string error:nil], expectedData, @"%@", string);
+    }
+}
+
+- (void)testThatDatesRoundTripAsTimestamps {
+    NSArray <NSDate *> *dates = @[[NSDate dateWithTimeIntervalSince1970:1500000000], [NSDate dateWithTimeIntervalSince1970:1500000000.25], [NSDate dateWithTimeIntervalSince1970:-86400.5], [NSDate dateWithTimeIntervalSince1970:20000000000]];
+    NSData *data = [AFMessagePackSerialization dataWithMessagePackObject:dates error:nil];
+    NSArray <NSDate *> *decodedDates = [AFMessagePackSerialization messagePackObjectWithData:data options:0 error:nil];
+
+    XCTAssertEqual([decodedDates count], [dates count]);
+    for (NSUInteger idx = 0; idx < [dates count]; idx++) {
+        XCTAssertEqualWithAccuracy([decodedDates[idx] timeIntervalSince1970], [dates[idx] timeIntervalSince1970], 1e-6);
+    }
+
+    // 32-bit, 64-bit and 96-bit timestamps
+    XCTAssertEqual([[AFMessagePackSerialization dataWithMessagePackObject:dates[0] error:nil] length], (NSUInteger)6);
+    XCTAssertEqual([[AFMessagePackSerialization dataWithMessagePackObject:dates[1] error:nil] length], (NSUInteger)10);
+    XCTAssertEqual([[AFMessagePackSerialization dataWithMessagePackObject:dates[2] error:nil] length], (NSUInteger)15);
+}
+
+- (void)testThatMalformedDataFails {
+    NSArray <NSData *> *malformedData = @[
+        [NSData data],
+        AFMessagePackTestDataWithBytes(@[@0xC1]),
+        AFMessagePackTestDataWithBytes(@[@0x92, @0x01]),
+        AFMessagePackTestDataWithBytes(@[@0xDD, @0xFF, @0xFF, @0xFF, @0xFF]),
+        AFMessagePackTestDataWithBytes(@[@0xA2, @0xC3, @0x28]),
+        AFMessagePackTestDataWithBytes(@[@0xD4, @0x01, @0x00]),
+        AFMessagePackTestDataWithBytes(@[@0x01, @0x02]),
+    ];
+
+    for (NSData *data in malformedData) {
+        NSError *error = nil;
+        XCTAssertNil([AFMessagePackSerialization messagePackObjectWithData:data options:0 error:&error], @"%@", data);
+        XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+        XCTAssertEqual(error.code, NSPropertyListReadCorruptError);
+    }
+
+    NSMutableData *deeplyNestedData = [NSMutableData data];
+    for (NSUInteger idx = 0; idx < 1000; idx++) {
+        [deeplyNestedData appendBytes:"\x91" length:1];
+    }
+    [deeplyNestedData appendBytes:"\x90" length:1];
+    XCTAssertNil([AFMessagePackSerialization messagePackObjectWithData:deeplyNestedData options:0 error:nil]);
+}
+
+- (void)testThatInvalidObjectsFailToWrite {
+    id object = @{@"url": [NSURL URLWithString:@"https://example.com"]};
+    XCTAssertFalse([AFMessagePackSerialization isValidMessagePackObject:object]);
+
+    NSError *error = nil;
+    XCTAssertNil([AFMessagePackSerialization dataWithMessagePackObject:object error:&error]);
+    XCTAssertEqual(error.code, NSPropertyListWriteInvalidError);
+}
+
+- (void)testThatStreamDecoderDecodesObjectsSplitAtEveryByte {
+    NSArray *objects = @[@{@"id": @1, @"name": @"first", @"data": [NSData dataWithBytes:"\x00\x01\x02" length:3]}, @255, @[@"second", @[], @{@"deep": @[@1.5]}], [@"" stringByPaddingToLength:300 withString:@"x" startingIndex:0]];
+    NSMutableData *data = [NSMutableData data];
+    for (id object in objects) {
+        [data appendData:[AFMessagePackSerialization dataWithMessagePackObject:object error:nil]];
+    }
+
+    for (NSUInteger length = 1; length <= [data length]; length++) {
+        AFMessagePackStreamDecoder *decoder = [[AFMessagePackStreamDecoder alloc] init];
+        NSMutableArray *decodedObjects = [NSMutableArray array];
+        for (NSUInteger offset = 0; offset < [data length]; offset += length) {
+            NSError *error = nil;
+            NSArray *batch = [decoder objectsByDecodingData:[data subdataWithRange:NSMakeRange(offset, MIN(length, [data length] - offset))] error:&error];
+            XCTAssertNil(error);
+            [decodedObjects addObjectsFromArray:batch];
+        }
+
+        XCTAssertEqualObjects(decodedObjects, objects, @"Split every %lu bytes", (unsigned long)length);
+        XCTAssertFalse(decoder.hasPartialObject);
+    }
+
+    AFMessagePackStreamDecoder *decoder = [[AFMessagePackStreamDecoder alloc] init];
+    XCTAssertEqualObjects([decoder objectsByDecodingData:[data subdataWithRange:NSMakeRange(0, 10)] error:nil], @[]);
+    XCTAssertTrue(decoder.hasPartialObject);
+
+    NSError *error = nil;
+    XCTAssertNil([decoder objectsByDecodingData:AFMessagePackTestDataWithBytes(@[@0xC1]) error:&error]);
+    XCTAssertEqual(error.code, NSPropertyListReadCorruptError);
+}
+
+- (void)testThatRequestSerializerNegotiatesMessagePack {
+    NSError *error = nil;
+    NSURLRequest *request = [[AFMessagePackRequestSerializer serializer] requestWithMethod:@"POST" URLString:@"http://example.com" parameters:@{@"key": @[@1, @2]} error:&error];
+
+    XCTAssertNil(error);
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Type"], @"application/msgpack");
+    XCTAssertEqualObjects([request valueForHTTPHeaderField:@"Accept"], @"application/msgpack, application/json;q=0.5");
+    XCTAssertEqualObjects([AFMessagePackSerialization messagePackObjectWithData:request.HTTPBody options:0 error:nil], (@{@"key": @[@1, @2]}));
+
+    XCTAssertNil([[AFMessagePackRequestSerializer serializer] requestWithMethod:@"POST" URLString:@"http://example.com" parameters:@{@"key": [NSURL URLWithString:@"https://example.com"]} error:&error]);
+    XCTAssertEqualObjects(error.domain, AFURLRequestSerializationErrorDomain);
+}
+
+- (void)testThatCompoundSerializerDecodesEitherNegotiatedFormat {
+    id object = @{@"id": @1, @"tags": @[@"a", @"b"]};
+    AFCompoundResponseSerializer *responseSerializer = [AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[[AFMessagePackResponseSerializer serializer], [AFJSONResponseSerializer serializer]]];
+
+    NSData *messagePackData = [AFMessagePackSerialization dataWithMessagePackObject:object error:nil];
+    XCTAssertEqualObjects([responseSerializer responseObjectForResponse:[self responseWithContentType:@"application/msgpack"] data:messagePackData error:nil], object);
+
+    NSData *JSONData = [NSJSONSerialization dataWithJSONObject:object options:(NSJSONWritingOptions)0 error:nil];
+    XCTAssertEqualObjects([responseSerializer responseObjectForResponse:[self responseWithContentType:@"application/json"] data:JSONData error:nil], object);
+}
+
+- (void)testThatSequenceOfObjectsIsStreamed {
+    NSMutableData *data = [NSMutableData data];
+    for (NSUInteger idx = 0; idx < 1000; idx++) {
+        [data appendData:[AFMessagePackSerialization dataWithMessagePackObject:@{@"id": @(idx), @"name": @"record"} error:nil]];
+    }
+
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/msgpack"} body:data];
+        response.chunkSize = 100;
+        return response;
+    }];
+
+    NSMutableArray *identifiers = [NSMutableArray array];
+    AFMessagePackStream *stream = [[AFMessagePackResponseSerializer serializer] streamWithQueue:nil objectHandler:^(NSArray *objects) {
+        [identifiers addObjectsFromArray:[objects valueForKey:@"id"]];
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Task should complete"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"records"]];
+    NSURLSessionDataTask *task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(stream.numberOfObjects, (NSUInteger)1000);
+    XCTAssertEqual([identifiers count], (NSUInteger)1000);
+    XCTAssertEqualObjects([identifiers lastObject], @999);
+}
+
+- (void)testThatMessagePackIsSmallerThanJSON {
+    NSArray *records = AFMessagePackTestRecords(5000);
+    NSData *JSONData = [NSJSONSerialization dataWithJSONObject:records options:(NSJSONWritingOptions)0 error:nil];
+    NSData *messagePackData = [AFMessagePackSerialization dataWithMessagePackObject:records error:nil];
+
+    XCTAssertEqual([[AFMessagePackSerialization messagePackObjectWithData:messagePackData options:0 error:nil] count], [records count]);
+    XCTAssertLessThan([messagePackData length], [JSONData length]);
+}
+
+- (void)testPerformanceOfEncodingJSON {
+    NSArray *records = AFMessagePackTestRecords(5000);
+
+    [self measureBlock:^{
+        XCTAssertNotNil([NSJSONSerialization dataWithJSONObject:records options:(NSJSONWritingOptions)0 error:nil]);
+    }];
+}
+
+- (void)testPerformanceOfEncodingMessagePack {
+    NSArray *records = AFMessagePackTestRecords(5000);
+
+    [self measureBlock:^{
+        XCTAssertNotNil([AFMessagePackSerialization dataWithMessagePackObject:records error:nil]);
+    }];
+}
+
+- (void)testPerformanceOfDecodingJSON {
+    NSData *JSONData = [NSJSONSerialization dataWithJSONObject:AFMessagePackTestRecords(5000) options:(NSJSONWritingOptions)0 error:nil];
+
+    [self measureBlock:^{
+        XCTAssertNotNil([NSJSONSerialization JSONObjectWithData:JSONData options:(NSJSONReadingOptions)0 error:nil]);
+    }];
+}
+
+- (void)testPerformanceOfDecodingMessagePack {
+    NSData *messagePackData = [AFMessagePackSerialization dataWithMessagePackObject:AFMessagePackTestRecords(5000) error:nil];
+
+    [self measureBlock:^{
+        XCTAssertNotNil([AFMessagePackSerialization messagePackObjectWithData:messagePackData options:0 error:nil]);
+    }];
+}
+
+@end
@@ -0,0 +1,209 @@
+// AFMultipartResponseSerializerTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFURLSessionManager.h"
+
+@interface AFMultipartResponseSerializerTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFMultipartResponseSerializer *responseSerializer;
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@end
+
+@implementation AFMultipartResponseSerializerTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.responseSerializer = [AFMultipartResponseSerializer serializerWithPartResponseSerializer:[AFCompoundResponseSerializer compoundSerializerWithResponseSerializers:@[[AFJSONResponseSerializer serializer], [AFHTTPResponseSerializer serializer]]]];
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (NSHTTPURLResponse *)responseWithStatusCode:(NSInteger)statusCode
+                                  contentType:(NSString *)contentType
+{
+    return [[NSHTTPURLResponse alloc] initWithURL:[AFTestURLProtocol baseURL] statusCode:statusCode HTTPVersion:@"1.1" headerFields:@{@"Content-Type": contentType}];
+}
+
+- (NSData *)batchResponseData {
+    return [@"This is the preamble.\r\n"
+             "--batch_42\r\n"
+             "Content-Type: application/http\r\n"
+             "Content-ID: <response-1>\r\n"
+             "\r\n"
+             "HTTP/1.1 200 OK\r\n"
+             "Content-Type: application/json\r\n"
+             "\r\n"
+             "{\"id\":1}\r\n"
+             "--batch_42  \r\n"
+             "Content-Type: application/http\r\n"
+             "Content-ID: <response-2>\r\n"
+             "\r\n"
+             "HTTP/1.1 404 Not Found\r\n"
+             "Content-Type: application/json\r\n"
+             "\r\n"
+             "{\"error\":\"not found\"}\r\n"
+             "--batch_42\r\n"
+             "\r\n"
+             "--batch_4 is not a delimiter\r\n"
+             "--batch_42--\r\n"
+             "This is the epilogue." dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+#pragma mark -
+
+- (void)testThatPartsAreDecodedFromBufferedResponse {
+    NSError *error = nil;
+    NSArray <AFMultipartResponsePart *> *parts = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:200 contentType:@"multipart/mixed; boundary=\"batch_42\""] data:[self batchResponseData] error:&error];
+
+    XCTAssertNil(error);
+    XCTAssertEqual([parts count], (NSUInteger)3);
+
+    XCTAssertEqualObjects(parts[0].headerFields[@"Content-ID"], @"<response-1>");
+    XCTAssertEqual(parts[0].response.statusCode, 200);
+    XCTAssertEqualObjects(parts[0].responseObject, @{@"id": @1});
+    XCTAssertNil(parts[0].error);
+
+    XCTAssertEqual(parts[1].response.statusCode, 404);
+    XCTAssertEqualObjects(parts[1].error.domain, AFURLResponseSerializationErrorDomain);
+    XCTAssertEqual(parts[1].error.code, NSURLErrorBadServerResponse);
+
+    XCTAssertEqualObjects(parts[2].headerFields, @{});
+    XCTAssertEqualObjects(parts[2].responseObject, [@"--batch_4 is not a delimiter" dataUsingEncoding:NSUTF8StringEncoding]);
+}
+
+- (void)testThatByteRangesAreDecoded {
+    NSData *data = [@"--THIS_STRING_SEPARATES\r\n"
+                     "Content-Type: text/plain\r\n"
+                     "Content-Range: bytes 500-508/1000\r\n"
+                     "\r\n"
+                     "abcdefghi\r\n"
+                     "--THIS_STRING_SEPARATES\r\n"
+                     "Content-Type: text/plain\r\n"
+                     "Content-Range: bytes 990-999/1000\r\n"
+                     "\r\n"
+                     "0123456789\r\n"
+                     "--THIS_STRING_SEPARATES--\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    NSArray <AFMultipartResponsePart *> *parts = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:206 contentType:@"multipart/byteranges; boundary=THIS_STRING_SEPARATES"] data:data error:&error];
+
+    XCTAssertNil(error);
+    XCTAssertEqual([parts count], (NSUInteger)2);
+    XCTAssertEqual(parts[0].byteRange.location, (NSUInteger)500);
+    XCTAssertEqual(parts[0].byteRange.length, (NSUInteger)9);
+    XCTAssertEqual(parts[0].response.statusCode, 206);
+    XCTAssertEqualObjects(parts[0].data, [@"abcdefghi" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertEqual(parts[1].byteRange.location, (NSUInteger)990);
+    XCTAssertEqual(parts[1].byteRange.length, (NSUInteger)10);
+}
+
+- (void)testThatResponseWithoutCloseDelimiterFailsToDecode {
+    NSData *data = [@"--b\r\n\r\nfirst\r\n--b\r\n\r\ntruncated" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSError *error = nil;
+    id responseObject = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:200 contentType:@"multipart/mixed; boundary=b"] data:data error:&error];
+
+    XCTAssertNil(responseObject);
+    XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+}
+
+- (void)testThatResponseWithoutBoundaryFailsToDecode {
+    NSError *error = nil;
+    id responseObject = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:200 contentType:@"multipart/mixed"] data:[self batchResponseData] error:&error];
+
+    XCTAssertNil(responseObject);
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+}
+
+- (void)testThatMultipartFormDataRequestBodyIsDecodedWithTheSameBoundary {
+    NSMutableURLRequest *request = [[AFHTTPRequestSerializer serializer] multipartFormRequestWithMethod:@"POST" URLString:@"http://example.com" parameters:@{@"key": @"value"} constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+        [formData appendPartWithFileData:[@"{\"id\":2}" dataUsingEncoding:NSUTF8StringEncoding] name:@"file" fileName:@"file.json" mimeType:@"application/json"];
+    } error:nil];
+
+    NSMutableData *body = [NSMutableData data];
+    uint8_t buffer[1024];
+    [request.HTTPBodyStream open];
+    while ([request.HTTPBodyStream hasBytesAvailable]) {
+        NSInteger numberOfBytesRead = [request.HTTPBodyStream read:buffer maxLength:sizeof(buffer)];
+        if (numberOfBytesRead <= 0) {
+            break;
+        }
+        [body appendBytes:buffer length:(NSUInteger)numberOfBytesRead];
+    }
+    [request.HTTPBodyStream close];
+
+    self.responseSerializer.acceptableContentTypes = [NSSet setWithObject:@"multipart/form-data"];
+
+    NSError *error = nil;
+    NSArray <AFMultipartResponsePart *> *parts = [self.responseSerializer responseObjectForResponse:[self responseWithStatusCode:200 contentType:[request valueForHTTPHeaderField:@"Content-Type"]] data:body error:&error];
+
+    XCTAssertNil(error);
+    XCTAssertEqual([parts count], (NSUInteger)2);
+    XCTAssertEqualObjects(parts[0].data, [@"value" dataUsingEncoding:NSUTF8StringEncoding]);
+    XCTAssertEqualObjects(parts[1].responseObject, @{@"id": @2});
+}
+
+- (void)testThatPartsAreStreamedInOrderAcrossChunks {
+    NSMutableString *mutableBody = [NSMutableString string];
+    for (NSUInteger idx = 0; idx < 500; idx++) {
+        [mutableBody appendFormat:@"--part-boundary\r\nContent-Type: application/json\r\n\r\n{\"id\":%lu}\r\n", (unsigned long)idx];
+    }
+    [mutableBody appendString:@"--part-boundary--\r\n"];
+    NSData *data = [mutableBody dataUsingEncoding:NSUTF8StringEncoding];
+
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"multipart/mixed; boundary=part-boundary"} body:data];
+        response.chunkSize = 7;
+        return response;
+    }];
+
+    NSMutableArray *identifiers = [NSMutableArray array];
+    AFMultipartResponseStream *stream = [self.responseSerializer streamWithQueue:nil partHandler:^(NSArray<AFMultipartResponsePart *> *parts) {
+        for (AFMultipartResponsePart *part in parts) {
+            [identifiers addObject:part.responseObject[@"id"] ?: [NSNull null]];
+        }
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Task should complete"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"batch"]];
+    NSURLSessionDataTask *task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(stream.numberOfParts, (NSUInteger)500);
+    XCTAssertEqual([identifiers count], (NSUInteger)500);
+    for (NSUInteger idx = 0; idx < [identifiers count]; idx++) {
+        XCTAssertEqualObjects(identifiers[idx], @(idx));
+    }
+}
+
+@end
@@ -0,0 +1,183 @@
+// AFRequestSchedulerTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFHTTPSessionManager.h"
+#import "AFRequestScheduler.h"
+
+@interface AFRequestSchedulerTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFHTTPSessionManager *manager;
+@property (readwrite, nonatomic, strong) AFRequestScheduler *scheduler;
+@property (readwrite, nonatomic, strong) NSMutableArray <NSString *> *requestedPaths;
+@end
+
+@implementation AFRequestSchedulerTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.manager = [[AFHTTPSessionManager alloc] initWithBaseURL:[AFTestURLProtocol baseURL] sessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    self.manager.responseSerializer = [AFHTTPResponseSerializer serializer];
+    self.scheduler = [[AFRequestScheduler alloc] init];
+    self.manager.requestScheduler = self.scheduler;
+    self.requestedPaths = [NSMutableArray array];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (void)serveResponsesWithLatency:(NSTimeInterval)latency {
+    NSMutableArray *requestedPaths = self.requestedPaths;
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        @synchronized (requestedPaths) {
+            [requestedPaths addObject:[request.URL.host stringByAppendingString:request.URL.path]];
+        }
+
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"text/plain"} body:[NSData data]];
+        response.latency = latency;
+        return response;
+    }];
+}
+
+- (NSURLSessionDataTask *)taskWithURLString:(NSString *)URLString
+                                expectation:(XCTestExpectation *)expectation
+                          completionHandler:(void (^)(NSError *error))completionHandler
+{
+    NSURLRequest *request = [NSURLRequest requestWithURL:[NSURL URLWithString:URLString]];
+    return [self.manager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+        if (completionHandler) {
+            completionHandler(error);
+        }
+        [expectation fulfill];
+    }];
+}
+
+#pragma mark -
+
+- (void)testThatQueuedTasksAreResumedByPriority {
+    [self serveResponsesWithLatency:0.05];
+    self.scheduler.maximumNumberOfConcurrentRequests = 1;
+
+    NSArray *priorities = @[@(AFRequestPriorityLow), @(AFRequestPriorityLow), @(AFRequestPriorityHigh), @(AFRequestPriorityBackground), @(AFRequestPriorityNormal)];
+    [priorities enumerateObjectsUsingBlock:^(NSNumber *priority, NSUInteger idx, __unused BOOL *stop) {
+        NSURLSessionDataTask *task = [self taskWithURLString:[NSString stringWithFormat:@"http://a.test/%lu", (unsigned long)idx] expectation:[self expectationWithDescription:@"Task should complete"] completionHandler:nil];
+        [self.scheduler scheduleTask:task priority:[priority integerValue]];
+    }];
+
+    XCTAssertEqual(self.scheduler.numberOfRunningTasks, (NSUInteger)1);
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)4);
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects(self.requestedPaths, (@[@"a.test/0", @"a.test/2", @"a.test/4", @"a.test/1", @"a.test/3"]));
+    XCTAssertEqual(self.scheduler.numberOfRunningTasks, (NSUInteger)0);
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)0);
+}
+
+- (void)testThatHostAtItsLimitDoesNotHoldBackOtherHosts {
+    [self serveResponsesWithLatency:0.2];
+    self.scheduler.maximumNumberOfConcurrentRequestsPerHost = 1;
+
+    for (NSString *URLString in @[@"http://a.test/1", @"http://a.test/2", @"http://b.test/1"]) {
+        NSURLSessionDataTask *task = [self taskWithURLString:URLString expectation:[self expectationWithDescription:@"Task should complete"] completionHandler:nil];
+        [self.scheduler scheduleTask:task priority:AFRequestPriorityNormal];
+    }
+
+    XCTAssertEqual(self.scheduler.numberOfRunningTasks, (NSUInteger)2);
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)1);
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects([self.requestedPaths lastObject], @"a.test/2");
+}
+
+- (void)testThatQueuedTasksCanBeCancelledAndReprioritized {
+    [self serveResponsesWithLatency:0.1];
+    self.scheduler.maximumNumberOfConcurrentRequests = 1;
+
+    NSURLSessionDataTask *runningTask = [self taskWithURLString:@"http://a.test/running" expectation:[self expectationWithDescription:@"Running task should complete"] completionHandler:nil];
+    NSURLSessionDataTask *cancelledTask = [self taskWithURLString:@"http://a.test/cancelled" expectation:[self expectationWithDescription:@"Cancelled task should complete"] completionHandler:^(NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+    }];
+    NSURLSessionDataTask *queuedTask = [self taskWithURLString:@"http://a.test/queued" expectation:[self expectationWithDescription:@"Queued task should complete"] completionHandler:nil];
+    [self.scheduler scheduleTask:runningTask priority:AFRequestPriorityNormal];
+    [self.scheduler scheduleTask:cancelledTask priority:AFRequestPriorityNormal];
+    [self.scheduler scheduleTask:queuedTask priority:AFRequestPriorityBackground];
+    XCTAssertEqual(queuedTask.priority, 0.0f);
+
+    [self.scheduler cancelTask:cancelledTask];
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)1);
+
+    XCTAssertTrue([self.scheduler setPriority:AFRequestPriorityHigh forTask:queuedTask]);
+    XCTAssertEqual([self.scheduler priorityForTask:queuedTask], AFRequestPriorityHigh);
+    XCTAssertEqual(queuedTask.priority, NSURLSessionTaskPriorityHigh);
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects(self.requestedPaths, (@[@"a.test/running", @"a.test/queued"]));
+    XCTAssertFalse([self.scheduler setPriority:AFRequestPriorityLow forTask:queuedTask]);
+}
+
+- (void)testThatConvenienceMethodsAreScheduled {
+    [self serveResponsesWithLatency:0.05];
+    self.scheduler.maximumNumberOfConcurrentRequests = 2;
+    self.manager.defaultRequestPriority = AFRequestPriorityLow;
+
+    NSMutableArray <NSURLSessionDataTask *> *tasks = [NSMutableArray array];
+    for (NSUInteger idx = 0; idx < 10; idx++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request should succeed"];
+        [tasks addObject:[self.manager GET:[NSString stringWithFormat:@"items/%lu", (unsigned long)idx] parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+            XCTAssertTrue(self.scheduler.numberOfRunningTasks <= 2);
+            [expectation fulfill];
+        } failure:nil]];
+    }
+
+    XCTAssertEqual(self.scheduler.numberOfRunningTasks, (NSUInteger)2);
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)8);
+    XCTAssertEqual([tasks lastObject].state, NSURLSessionTaskStateSuspended);
+    XCTAssertEqual([tasks lastObject].priority, NSURLSessionTaskPriorityLow);
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([self.requestedPaths count], (NSUInteger)10);
+}
+
+- (void)testThatTasksCompleteOnTheSchedulerTheyWereScheduledOn {
+    [self serveResponsesWithLatency:0.05];
+    self.scheduler.maximumNumberOfConcurrentRequests = 1;
+
+    for (NSUInteger idx = 0; idx < 3; idx++) {
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Request should succeed"];
+        [self.manager GET:[NSString stringWithFormat:@"items/%lu", (unsigned long)idx] parameters:nil headers:nil progress:nil success:^(NSURLSessionDataTask *task, id responseObject) {
+            [expectation fulfill];
+        } failure:nil];
+    }
+
+    // The tasks already scheduled still have to free their slots, or the queued ones would never be resumed
+    self.manager.requestScheduler = nil;
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)2);
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(self.scheduler.numberOfRunningTasks, (NSUInteger)0);
+    XCTAssertEqual(self.scheduler.numberOfQueuedTasks, (NSUInteger)0);
+}
+
+@end
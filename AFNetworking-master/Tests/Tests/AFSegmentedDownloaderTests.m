@@ -0,0 +1,191 @@
+// AFSegmentedDownloaderTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+
+#import "AFTestCase.h"
+
+#import "AFSegmentedDownloader.h"
+
+@interface AFSegmentedDownloaderTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFURLSessionManager *manager;
+@property (readwrite, nonatomic, strong) AFSegmentedDownloader *downloader;
+@property (readwrite, nonatomic, strong) NSData *resourceData;
+@property (readwrite, nonatomic, strong) NSURL *resourceURL;
+@property (readwrite, nonatomic, strong) NSURL *destinationURL;
+@property (readwrite, nonatomic, strong) NSMutableArray <NSString *> *requestedRanges;
+@end
+
+@implementation AFSegmentedDownloaderTests
+
+- (void)setUp {
+    [super setUp];
+
+    NSMutableData *resourceData = [NSMutableData dataWithLength:1024 * 1024];
+    SecRandomCopyBytes(kSecRandomDefault, [resourceData length], [resourceData mutableBytes]);
+    self.resourceData = resourceData;
+    self.resourceURL = [[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"resource"];
+    self.destinationURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    self.requestedRanges = [NSMutableArray array];
+
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    self.downloader = [[AFSegmentedDownloader alloc] initWithSessionManager:self.manager];
+    self.downloader.minimumSegmentSize = 1024 * 128;
+    self.downloader.retryInterval = 0.01;
+}
+
+- (void)tearDown {
+    [[NSFileManager defaultManager] removeItemAtURL:self.destinationURL error:nil];
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+// A reference server answering `HEAD` and range requests, each connection limited to the specified rate. Short responses are sent for the ranges passing the test
+- (void)serveResourceAcceptingRanges:(BOOL)acceptsRanges
+                      bytesPerSecond:(NSUInteger)bytesPerSecond
+          truncatingRangesPassingTest:(BOOL (^)(unsigned long long offset))truncationTest
+{
+    NSData *data = self.resourceData;
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSMutableDictionary *headers = [NSMutableDictionary dictionaryWithObjectsAndKeys:@"\"resource\"", @"ETag", @"application/octet-stream", @"Content-Type", nil];
+        if (acceptsRanges) {
+            headers[@"Accept-Ranges"] = @"bytes";
+        }
+
+        if ([request.HTTPMethod isEqualToString:@"HEAD"]) {
+            headers[@"Content-Length"] = [NSString stringWithFormat:@"%lu", (unsigned long)[data length]];
+            return [AFTestServerResponse responseWithStatusCode:200 headers:headers body:nil];
+        }
+
+        NSString *range = [request valueForHTTPHeaderField:@"Range"];
+        AFTestServerResponse *response = nil;
+        if (acceptsRanges && range && [[request valueForHTTPHeaderField:@"If-Range"] isEqualToString:headers[@"ETag"]]) {
+            @synchronized (self) {
+                [self.requestedRanges addObject:range];
+            }
+
+            NSArray *bounds = [[range substringFromIndex:[@"bytes=" length]] componentsSeparatedByString:@"-"];
+            NSUInteger first = (NSUInteger)[bounds[0] longLongValue];
+            NSUInteger last = MIN((NSUInteger)[bounds[1] longLongValue], [data length] - 1);
+            NSData *rangeData = [data subdataWithRange:NSMakeRange(first, last - first + 1)];
+            headers[@"Content-Range"] = [NSString stringWithFormat:@"bytes %lu-%lu/%lu", (unsigned long)first, (unsigned long)last, (unsigned long)[data length]];
+
+            if (truncationTest && truncationTest(first)) {
+                rangeData = [rangeData subdataWithRange:NSMakeRange(0, [rangeData length] / 2)];
+            }
+
+            response = [AFTestServerResponse responseWithStatusCode:206 headers:headers body:rangeData];
+        } else {
+            response = [AFTestServerResponse responseWithStatusCode:200 headers:headers body:data];
+        }
+        [response setBytesPerSecond:bytesPerSecond];
+
+        return response;
+    }];
+}
+
+- (AFSegmentedDownloadTask *)download {
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should complete"];
+    NSURLRequest *request = [NSURLRequest requestWithURL:self.resourceURL];
+    AFSegmentedDownloadTask *task = [self.downloader downloadTaskWithRequest:request progress:nil destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        return self.destinationURL;
+    } completionHandler:^(NSURLResponse * _Nullable response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(filePath, self.destinationURL);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    return task;
+}
+
+#pragma mark -
+
+- (void)testThatSegmentsAreWrittenToTheirOffsets {
+    [self serveResourceAcceptingRanges:YES bytesPerSecond:0 truncatingRangesPassingTest:nil];
+
+    AFSegmentedDownloadTask *task = [self download];
+
+    XCTAssertEqual(task.numberOfSegments, (NSUInteger)4);
+    XCTAssertEqual([self.requestedRanges count], (NSUInteger)4);
+    XCTAssertTrue([self.requestedRanges containsObject:@"bytes=786432-1048575"]);
+    XCTAssertEqual(task.progress.completedUnitCount, (int64_t)[self.resourceData length]);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.destinationURL], self.resourceData);
+}
+
+- (void)testThatResourceWithoutRangeSupportIsDownloadedWithSingleTask {
+    [self serveResourceAcceptingRanges:NO bytesPerSecond:0 truncatingRangesPassingTest:nil];
+
+    AFSegmentedDownloadTask *task = [self download];
+
+    XCTAssertEqual(task.numberOfSegments, (NSUInteger)1);
+    XCTAssertEqual([self.requestedRanges count], (NSUInteger)0);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.destinationURL], self.resourceData);
+}
+
+- (void)testThatInterruptedSegmentContinuesFromLastByte {
+    __block NSUInteger numberOfTruncations = 0;
+    [self serveResourceAcceptingRanges:YES bytesPerSecond:0 truncatingRangesPassingTest:^BOOL(unsigned long long offset) {
+        @synchronized (self) {
+            return offset == 1024 * 256 && numberOfTruncations++ == 0;
+        }
+    }];
+
+    [self download];
+
+    XCTAssertEqual([self.requestedRanges count], (NSUInteger)5);
+    XCTAssertTrue([self.requestedRanges containsObject:@"bytes=393216-524287"]);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.destinationURL], self.resourceData);
+}
+
+#pragma mark - Throughput
+
+- (void)testThatSegmentsOvercomePerConnectionRateLimit {
+    NSUInteger bytesPerSecond = 1024 * 512;
+    NSMutableData *resourceData = [NSMutableData dataWithLength:1024 * 1024 * 2];
+    SecRandomCopyBytes(kSecRandomDefault, [resourceData length], [resourceData mutableBytes]);
+    self.resourceData = resourceData;
+    self.downloader.minimumSegmentSize = 1024 * 256;
+    [self serveResourceAcceptingRanges:YES bytesPerSecond:bytesPerSecond truncatingRangesPassingTest:nil];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should complete"];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSURLSessionDownloadTask *downloadTask = [self.manager downloadTaskWithRequest:[NSURLRequest requestWithURL:self.resourceURL] progress:nil destination:nil completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [downloadTask resume];
+    [self waitForExpectationsWithCommonTimeout];
+    CFAbsoluteTime singleElapsed = CFAbsoluteTimeGetCurrent() - startTime;
+
+    startTime = CFAbsoluteTimeGetCurrent();
+    AFSegmentedDownloadTask *task = [self download];
+    CFAbsoluteTime segmentedElapsed = CFAbsoluteTimeGetCurrent() - startTime;
+
+    // Four connections at the same rate take about a quarter of the time
+    XCTAssertEqual(task.numberOfSegments, (NSUInteger)4);
+    XCTAssertTrue(segmentedElapsed < singleElapsed * 0.5, @"%.2f s segmented, %.2f s single", segmentedElapsed, singleElapsed);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:self.destinationURL], self.resourceData);
+}
+
+@end
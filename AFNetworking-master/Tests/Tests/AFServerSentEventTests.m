@@ -0,0 +1,244 @@
+// AFServerSentEventTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFHTTPSessionManager.h"
+
+@interface AFServerSentEventTests : AFTestCase
+@property (readwrite, nonatomic, strong) AFServerSentEventResponseSerializer *responseSerializer;
+@property (readwrite, nonatomic, strong) AFHTTPSessionManager *manager;
+@property (readwrite, nonatomic, strong) NSMutableArray *lastEventIDHeaders;
+@end
+
+@implementation AFServerSentEventTests
+
+- (void)setUp {
+    [super setUp];
+
+    self.responseSerializer = [AFServerSentEventResponseSerializer serializer];
+    self.manager = [[AFHTTPSessionManager alloc] initWithBaseURL:[AFTestURLProtocol baseURL] sessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    self.lastEventIDHeaders = [NSMutableArray array];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+// Serves the specified bodies to successive requests, recording their `Last-Event-ID` headers, then `204 No Content`
+- (void)serveEventStreamBodies:(NSArray <NSString *> *)bodies {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSUInteger idx = 0;
+        @synchronized (self) {
+            idx = [self.lastEventIDHeaders count];
+            [self.lastEventIDHeaders addObject:[request valueForHTTPHeaderField:@"Last-Event-ID"] ?: [NSNull null]];
+        }
+
+        if (idx >= [bodies count]) {
+            return [AFTestServerResponse responseWithStatusCode:204 headers:nil body:nil];
+        }
+
+        return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"text/event-stream"} body:[bodies[idx] dataUsingEncoding:NSUTF8StringEncoding]];
+    }];
+}
+
+- (NSHTTPURLResponse *)eventStreamResponse {
+    return [[NSHTTPURLResponse alloc] initWithURL:[AFTestURLProtocol baseURL] statusCode:200 HTTPVersion:@"1.1" headerFields:@{@"Content-Type": @"text/event-stream"}];
+}
+
+#pragma mark -
+
+- (void)testThatEventsAreDecodedFromBufferedResponse {
+    NSMutableData *data = [NSMutableData dataWithBytes:"\xEF\xBB\xBF" length:3];
+    [data appendData:[@": comment\r\ndata: first\r\ndata:  second line\r\n\r\nevent: update\rid: 7\rdata\r\rid\nretry: 1500\nunknown: field\n\ndata: incomplete" dataUsingEncoding:NSUTF8StringEncoding]];
+
+    NSError *error = nil;
+    NSArray <AFServerSentEvent *> *events = [self.responseSerializer responseObjectForResponse:[self eventStreamResponse] data:data error:&error];
+
+    XCTAssertNil(error);
+    XCTAssertEqual([events count], (NSUInteger)2);
+    XCTAssertEqualObjects(events[0].type, @"message");
+    XCTAssertEqualObjects(events[0].data, @"first\n second line");
+    XCTAssertNil(events[0].lastEventID);
+    XCTAssertEqualObjects(events[1].type, @"update");
+    XCTAssertEqualObjects(events[1].data, @"");
+    XCTAssertEqualObjects(events[1].lastEventID, @"7");
+}
+
+- (void)testThatEventsSplitAcrossChunksShareTheirTypeAndLastEventID {
+    NSMutableArray <AFServerSentEvent *> *events = [NSMutableArray array];
+    AFServerSentEventStream *stream = [self.responseSerializer streamWithQueue:nil eventHandler:^(NSArray<AFServerSentEvent *> *batch) {
+        [events addObjectsFromArray:batch];
+    }];
+
+    NSData *data = [@"id: 1\r\nevent: tick\r\ndata: 0\r\n\r\nevent: tick\r\ndata: 1\r\n\r\nid: 2\r\nevent: tock\r\ndata: 2\r\n\r\n" dataUsingEncoding:NSUTF8StringEncoding];
+    for (NSUInteger offset = 0; offset < [data length]; offset++) {
+        [stream dataTask:nil didReceiveData:[data subdataWithRange:NSMakeRange(offset, 1)]];
+    }
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    [stream finishWithCompletionHandler:^(NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([events count], (NSUInteger)3);
+    XCTAssertEqualObjects([events valueForKey:@"data"], (@[@"0", @"1", @"2"]));
+    XCTAssertEqual(events[0].type, events[1].type);
+    XCTAssertEqual(events[0].lastEventID, events[1].lastEventID);
+    XCTAssertEqualObjects(events[2].type, @"tock");
+    XCTAssertEqualObjects(stream.lastEventID, @"2");
+}
+
+- (void)testThatEventSourceReconnectsWithLastEventID {
+    [self serveEventStreamBodies:@[@"retry: 10\nid: 1\ndata: a\n\nid: 2\ndata: b\n\n", @"id: 3\ndata: c\n\n"]];
+
+    NSMutableArray *data = [NSMutableArray array];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Event source should end"];
+    AFServerSentEventSource *eventSource = [self.manager eventSourceWithURLString:@"events" parameters:nil headers:nil queue:nil eventHandler:^(NSArray<AFServerSentEvent *> *events) {
+        [data addObjectsFromArray:[events valueForKey:@"data"]];
+    } completionHandler:^(NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects(data, (@[@"a", @"b", @"c"]));
+    XCTAssertEqualObjects(self.lastEventIDHeaders, (@[[NSNull null], @"2", @"3"]));
+    XCTAssertEqual(eventSource.numberOfConnections, (NSUInteger)3);
+    XCTAssertEqual(eventSource.numberOfEvents, (NSUInteger)3);
+    XCTAssertEqualObjects(eventSource.lastEventID, @"3");
+    XCTAssertEqualWithAccuracy(eventSource.reconnectionTime, 0.01, 0.0001);
+    XCTAssertTrue(eventSource.closed);
+}
+
+- (void)testThatEventSourceStopsOnInvalidResponse {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:503 headers:nil body:nil];
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Event source should end"];
+    AFServerSentEventSource *eventSource = [self.manager eventSourceWithURLString:@"events" parameters:nil headers:nil queue:nil eventHandler:^(NSArray<AFServerSentEvent *> *events) {
+        XCTFail(@"No event should be received");
+    } completionHandler:^(NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorBadServerResponse);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(eventSource.numberOfConnections, (NSUInteger)1);
+}
+
+- (void)testThatLineLongerThanMaximumFailsStream {
+    self.responseSerializer.maximumLineLength = 16;
+
+    NSMutableArray *receivedEvents = [NSMutableArray array];
+    AFServerSentEventStream *stream = [self.responseSerializer streamWithQueue:nil eventHandler:^(NSArray<AFServerSentEvent *> *events) {
+        [receivedEvents addObjectsFromArray:events];
+    }];
+
+    // The second line is never terminated
+    [stream dataTask:nil didReceiveData:[@"data: first\n\ndata: 0123456789" dataUsingEncoding:NSUTF8StringEncoding]];
+    [stream dataTask:nil didReceiveData:[@"abcdef" dataUsingEncoding:NSUTF8StringEncoding]];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    [stream finishWithCompletionHandler:^(NSError *error) {
+        XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+        XCTAssertTrue([error.localizedDescription containsString:@"Line 3"]);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([receivedEvents count], (NSUInteger)1);
+    XCTAssertEqualObjects([[receivedEvents firstObject] data], @"first");
+}
+
+- (void)testThatClosedEventSourceDeliversNoMoreEvents {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSMutableString *events = [NSMutableString string];
+        for (NSUInteger idx = 0; idx < 100; idx++) {
+            [events appendFormat:@"data: %lu\n\n", (unsigned long)idx];
+        }
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"text/event-stream"} body:[events dataUsingEncoding:NSUTF8StringEncoding]];
+        response.chunkSize = 10;
+        response.chunkDelay = 0.01;
+        return response;
+    }];
+
+    __block NSUInteger numberOfEvents = 0;
+    __block AFServerSentEventSource *eventSource = nil;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Event source should end"];
+    eventSource = [self.manager eventSourceWithURLString:@"events" parameters:nil headers:nil queue:nil eventHandler:^(NSArray<AFServerSentEvent *> *events) {
+        numberOfEvents += [events count];
+        [eventSource close];
+    } completionHandler:^(NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(numberOfEvents, (NSUInteger)1);
+    XCTAssertTrue(eventSource.closed);
+    XCTAssertNil(eventSource.dataTask);
+}
+
+- (void)testPerformanceOfReceivingEventsFromLocalEventSource {
+    NSUInteger numberOfEvents = 50000;
+    NSMutableString *body = [NSMutableString string];
+    for (NSUInteger idx = 0; idx < numberOfEvents; idx++) {
+        [body appendFormat:@"id: %lu\nevent: %@\ndata: {\"sequence\": %lu, \"price\": 101.25}\n\n", (unsigned long)idx, idx % 2 == 0 ? @"bid" : @"ask", (unsigned long)idx];
+    }
+    [self serveEventStreamBodies:@[body]];
+
+    __block NSUInteger numberOfIterations = 0;
+    __block CFAbsoluteTime elapsed = 0.0;
+    [self measureBlock:^{
+        // Each event source is served the whole stream once, then told to stop reconnecting
+        @synchronized (self) {
+            [self.lastEventIDHeaders removeAllObjects];
+        }
+
+        CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+
+        __block NSUInteger numberOfEventsReceived = 0;
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Event source should end"];
+        AFServerSentEventSource *eventSource = [self.manager eventSourceWithURLString:@"events" parameters:nil headers:nil queue:dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0) eventHandler:^(NSArray<AFServerSentEvent *> *events) {
+            numberOfEventsReceived += [events count];
+        } completionHandler:^(NSError *error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        eventSource.reconnectionTime = 0;
+        [self waitForExpectationsWithCommonTimeout];
+        elapsed += CFAbsoluteTimeGetCurrent() - startTime;
+        numberOfIterations++;
+
+        XCTAssertEqual(numberOfEventsReceived, numberOfEvents);
+        XCTAssertEqualObjects(eventSource.lastEventID, ([NSString stringWithFormat:@"%lu", (unsigned long)numberOfEvents - 1]));
+    }];
+
+    [self recordBenchmarkValue:(double)numberOfEvents * numberOfIterations / elapsed unit:@"events/s" name:@"Local event source"];
+}
+
+@end
@@ -34,4 +34,116 @@
 - (void)waitForExpectationsWithCommonTimeout;
 - (void)waitForExpectationsWithCommonTimeoutUsingHandler:(XCWaitCompletionHandler)handler;
 
+/**
+ Whether the opt-in benchmarks, which move more data than the rest of the suite, are run. Set the `AF_BENCHMARKS` environment variable in the test scheme to run them.
+ */
+@property (nonatomic, assign, readonly) BOOL benchmarksEnabled;
+
+/**
+ The number of bytes a benchmark moves: the number of megabytes in the specified environment variable, or `defaultMegabytes` if it is not set.
+ */
+- (unsigned long long)benchmarkSizeFromEnvironmentVariable:(NSString *)name
+                                           defaultMegabytes:(unsigned long long)defaultMegabytes;
+
+/**
+ Records a figure derived from a benchmark, such as its throughput, as an activity of the test whose attachment is kept with the results, since performance tests only report their durations.
+ */
+- (void)recordBenchmarkValue:(double)value
+                        unit:(NSString *)unit
+                        name:(NSString *)name;
+
 @end
+
+#pragma mark -
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class AFTestServerResponse;
+
+typedef AFTestServerResponse * _Nullable (^AFTestServerRequestHandler)(NSURLRequest *request, NSData * _Nullable body);
+
+/**
+ `AFTestURLProtocol` is a local stand-in for an HTTP server. Sessions created with `+sessionConfiguration` route every request to the request handler instead of the network, so tests that move large amounts of data, or depend on timing, do not depend on a remote host.
+
+ Request bodies are drained on a background queue in 1 MB chunks. Unless `buffersRequestBodies` is `NO`, the complete body is passed to the request handler.
+ */
+@interface AFTestURLProtocol : NSURLProtocol
+
+/**
+ An ephemeral session configuration whose `protocolClasses` contains only `AFTestURLProtocol`.
+ */
++ (NSURLSessionConfiguration *)sessionConfiguration;
+
+/**
+ A base URL for requests made to the stand-in server.
+ */
++ (NSURL *)baseURL;
+
+/**
+ Sets the block producing a response for each request. A `nil` response, or no handler, results in an empty `404` response.
+ */
++ (void)setRequestHandler:(nullable AFTestServerRequestHandler)handler;
+
+/**
+ Whether request bodies are kept in memory and passed to the request handler. `YES` by default; set to `NO` when uploading more data than fits in memory.
+ */
++ (void)setBuffersRequestBodies:(BOOL)buffersRequestBodies;
+
+/**
+ The total number of request body bytes received since the last call to `+reset`.
+ */
++ (unsigned long long)numberOfRequestBodyBytesReceived;
+
+/**
+ The number of requests started since the last call to `+reset`.
+ */
++ (NSUInteger)numberOfRequests;
+
+/**
+ Removes the request handler and resets all counters. Called from `AFTestCase -tearDown`.
+ */
++ (void)reset;
+
+@end
+
+/**
+ A canned response served by `AFTestURLProtocol`.
+ */
+@interface AFTestServerResponse : NSObject
+
+@property (nonatomic, assign) NSInteger statusCode;
+@property (nonatomic, copy, nullable) NSDictionary <NSString *, NSString *> *headers;
+@property (nonatomic, copy, nullable) NSData *body;
+
+/**
+ When set, the request fails with this error instead of producing a response.
+ */
+@property (nonatomic, strong, nullable) NSError *error;
+
+/**
+ Delay before the response headers are delivered. `0` by default.
+ */
+@property (nonatomic, assign) NSTimeInterval latency;
+
+/**
+ Number of body bytes delivered to the client at a time. `16 KB` by default.
+ */
+@property (nonatomic, assign) NSUInteger chunkSize;
+
+/**
+ Delay between two body chunks, which emulates a slow or rate-limited server. `0` by default.
+ */
+@property (nonatomic, assign) NSTimeInterval chunkDelay;
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode
+                               headers:(nullable NSDictionary <NSString *, NSString *> *)headers
+                                  body:(nullable NSData *)body;
+
+/**
+ Sets `chunkDelay` so that the body is delivered at approximately the specified rate.
+ */
+- (void)setBytesPerSecond:(NSUInteger)bytesPerSecond;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -29,6 +29,7 @@
 }
 
 - (void)tearDown {
+    [AFTestURLProtocol reset];
     [super tearDown];
 }
 
@@ -63,4 +64,269 @@
     [self waitForExpectationsWithTimeout:self.networkTimeout handler:handler];
 }
 
+- (BOOL)benchmarksEnabled {
+    return [[NSProcessInfo processInfo] environment][@"AF_BENCHMARKS"] != nil;
+}
+
+- (unsigned long long)benchmarkSizeFromEnvironmentVariable:(NSString *)name
+                                           defaultMegabytes:(unsigned long long)defaultMegabytes
+{
+    NSString *megabytes = [[NSProcessInfo processInfo] environment][name];
+    return (megabytes ? (unsigned long long)[megabytes longLongValue] : defaultMegabytes) * 1024 * 1024;
+}
+
+- (void)recordBenchmarkValue:(double)value
+                        unit:(NSString *)unit
+                        name:(NSString *)name
+{
+    NSString *description = [NSString stringWithFormat:@"%@: %.3f %@", name, value, unit];
+    [XCTContext runActivityNamed:description block:^(id<XCTActivity> activity) {
+        XCTAttachment *attachment = [XCTAttachment attachmentWithString:description];
+        attachment.lifetime = XCTAttachmentLifetimeKeepAlways;
+        [activity addAttachment:attachment];
+    }];
+}
+
+@end
+
+#pragma mark -
+
+static NSUInteger const AFTestURLProtocolRequestBodyBufferSize = 1024 * 1024;
+
+static NSLock *AFTestURLProtocolLock(void) {
+    static NSLock *_lock = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        _lock = [[NSLock alloc] init];
+    });
+
+    return _lock;
+}
+
+static AFTestServerRequestHandler AFTestURLProtocolRequestHandler = nil;
+static BOOL AFTestURLProtocolBuffersRequestBodies = YES;
+static unsigned long long AFTestURLProtocolNumberOfRequestBodyBytesReceived = 0;
+static NSUInteger AFTestURLProtocolNumberOfRequests = 0;
+
+@interface AFTestURLProtocol ()
+@property (atomic, assign, getter = isStopped) BOOL stopped;
+@property (nonatomic, strong) NSThread *clientThread;
+@property (nonatomic, copy) NSArray <NSString *> *clientRunLoopModes;
+@end
+
+@implementation AFTestURLProtocol
+
++ (NSURLSessionConfiguration *)sessionConfiguration {
+    NSURLSessionConfiguration *configuration = [NSURLSessionConfiguration ephemeralSessionConfiguration];
+    configuration.protocolClasses = @[self];
+
+    return configuration;
+}
+
++ (NSURL *)baseURL {
+    return [NSURL URLWithString:@"http://stand-in.afnetworking.test"];
+}
+
++ (void)setRequestHandler:(AFTestServerRequestHandler)handler {
+    [AFTestURLProtocolLock() lock];
+    AFTestURLProtocolRequestHandler = [handler copy];
+    [AFTestURLProtocolLock() unlock];
+}
+
++ (void)setBuffersRequestBodies:(BOOL)buffersRequestBodies {
+    [AFTestURLProtocolLock() lock];
+    AFTestURLProtocolBuffersRequestBodies = buffersRequestBodies;
+    [AFTestURLProtocolLock() unlock];
+}
+
++ (unsigned long long)numberOfRequestBodyBytesReceived {
+    [AFTestURLProtocolLock() lock];
+    unsigned long long numberOfBytes = AFTestURLProtocolNumberOfRequestBodyBytesReceived;
+    [AFTestURLProtocolLock() unlock];
+
+    return numberOfBytes;
+}
+
++ (NSUInteger)numberOfRequests {
+    [AFTestURLProtocolLock() lock];
+    NSUInteger numberOfRequests = AFTestURLProtocolNumberOfRequests;
+    [AFTestURLProtocolLock() unlock];
+
+    return numberOfRequests;
+}
+
++ (void)reset {
+    [AFTestURLProtocolLock() lock];
+    AFTestURLProtocolRequestHandler = nil;
+    AFTestURLProtocolBuffersRequestBodies = YES;
+    AFTestURLProtocolNumberOfRequestBodyBytesReceived = 0;
+    AFTestURLProtocolNumberOfRequests = 0;
+    [AFTestURLProtocolLock() unlock];
+}
+
+#pragma mark - NSURLProtocol
+
++ (BOOL)canInitWithRequest:(__unused NSURLRequest *)request {
+    return YES;
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+    return request;
+}
+
+- (void)startLoading {
+    self.clientThread = [NSThread currentThread];
+    NSString *currentMode = [[NSRunLoop currentRunLoop] currentMode];
+    self.clientRunLoopModes = (currentMode && ![currentMode isEqualToString:NSDefaultRunLoopMode]) ? @[NSDefaultRunLoopMode, currentMode] : @[NSDefaultRunLoopMode];
+
+    [AFTestURLProtocolLock() lock];
+    AFTestServerRequestHandler handler = AFTestURLProtocolRequestHandler;
+    BOOL buffersRequestBodies = AFTestURLProtocolBuffersRequestBodies;
+    AFTestURLProtocolNumberOfRequests++;
+    [AFTestURLProtocolLock() unlock];
+
+    NSURLRequest *request = self.request;
+
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSData *body = [self drainBodyOfRequest:request buffering:buffersRequestBodies];
+        if ([self isStopped]) {
+            return;
+        }
+
+        AFTestServerResponse *response = handler ? handler(request, body) : nil;
+        if (!response) {
+            response = [AFTestServerResponse responseWithStatusCode:404 headers:nil body:nil];
+        }
+
+        [self deliverResponse:response];
+    });
+}
+
+- (void)stopLoading {
+    self.stopped = YES;
+}
+
+#pragma mark -
+
+- (NSData *)drainBodyOfRequest:(NSURLRequest *)request
+                     buffering:(BOOL)buffering
+{
+    NSData *body = request.HTTPBody;
+    unsigned long long numberOfBytes = [body length];
+
+    if (!body && request.HTTPBodyStream) {
+        NSMutableData *mutableBody = buffering ? [NSMutableData data] : nil;
+        NSInputStream *inputStream = request.HTTPBodyStream;
+        uint8_t *buffer = malloc(AFTestURLProtocolRequestBodyBufferSize);
+
+        [inputStream open];
+        while (![self isStopped]) {
+            // Like a socket writer, only read when the stream says it has bytes, so throttled streams set the pace
+            if (![inputStream hasBytesAvailable] && [inputStream streamStatus] == NSStreamStatusOpen) {
+                [NSThread sleepForTimeInterval:0.001];
+                continue;
+            }
+
+            NSInteger numberOfBytesRead = [inputStream read:buffer maxLength:AFTestURLProtocolRequestBodyBufferSize];
+            if (numberOfBytesRead <= 0) {
+                break;
+            }
+
+            [mutableBody appendBytes:buffer length:(NSUInteger)numberOfBytesRead];
+            numberOfBytes += (unsigned long long)numberOfBytesRead;
+        }
+        [inputStream close];
+
+        free(buffer);
+        body = mutableBody;
+    } else if (!buffering) {
+        body = nil;
+    }
+
+    [AFTestURLProtocolLock() lock];
+    AFTestURLProtocolNumberOfRequestBodyBytesReceived += numberOfBytes;
+    [AFTestURLProtocolLock() unlock];
+
+    return body;
+}
+
+- (void)deliverResponse:(AFTestServerResponse *)serverResponse {
+    if (serverResponse.latency > 0.0) {
+        [NSThread sleepForTimeInterval:serverResponse.latency];
+    }
+
+    if (serverResponse.error) {
+        [self performClientBlock:^{
+            [self.client URLProtocol:self didFailWithError:serverResponse.error];
+        }];
+        return;
+    }
+
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:self.request.URL statusCode:serverResponse.statusCode HTTPVersion:@"HTTP/1.1" headerFields:serverResponse.headers];
+    [self performClientBlock:^{
+        [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    }];
+
+    NSData *body = serverResponse.body;
+    NSUInteger chunkSize = MAX(serverResponse.chunkSize, (NSUInteger)1);
+    for (NSUInteger offset = 0; offset < [body length] && ![self isStopped]; offset += chunkSize) {
+        if (offset > 0 && serverResponse.chunkDelay > 0.0) {
+            [NSThread sleepForTimeInterval:serverResponse.chunkDelay];
+        }
+
+        NSData *chunk = [body subdataWithRange:NSMakeRange(offset, MIN(chunkSize, [body length] - offset))];
+        [self performClientBlock:^{
+            [self.client URLProtocol:self didLoadData:chunk];
+        }];
+    }
+
+    [self performClientBlock:^{
+        [self.client URLProtocolDidFinishLoading:self];
+    }];
+}
+
+- (void)performClientBlock:(dispatch_block_t)block {
+    [self performSelector:@selector(invokeClientBlock:) onThread:self.clientThread withObject:[block copy] waitUntilDone:NO modes:self.clientRunLoopModes];
+}
+
+- (void)invokeClientBlock:(dispatch_block_t)block {
+    if (![self isStopped]) {
+        block();
+    }
+}
+
+@end
+
+#pragma mark -
+
+@implementation AFTestServerResponse
+
++ (instancetype)responseWithStatusCode:(NSInteger)statusCode
+                               headers:(NSDictionary <NSString *, NSString *> *)headers
+                                  body:(NSData *)body
+{
+    AFTestServerResponse *response = [[self alloc] init];
+    response.statusCode = statusCode;
+    response.headers = headers;
+    response.body = body;
+
+    return response;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.statusCode = 200;
+    self.chunkSize = 1024 * 16;
+
+    return self;
+}
+
+- (void)setBytesPerSecond:(NSUInteger)bytesPerSecond {
+    self.chunkDelay = bytesPerSecond > 0 ? (NSTimeInterval)self.chunkSize / bytesPerSecond : 0.0;
+}
+
 @end
@@ -20,10 +20,12 @@
 // THE SOFTWARE.
 
 #import <objc/runtime.h>
+#import <sys/resource.h>
 
 #import "AFTestCase.h"
 
 #import "AFURLSessionManager.h"
+#import "AFURLRequestSerialization.h"
 
 #ifdef __MAC_OS_X_VERSION_MIN_REQUIRED
 #define NSFoundationVersionNumber_With_Fixed_28588583_bug 0.0
@@ -224,6 +226,440 @@
     [self waitForExpectationsWithCommonTimeout];
 }
 
+#pragma mark - Upload Benchmarks
+
+- (void)testPerformanceOfMultipartFileUpload {
+    if (!self.benchmarksEnabled) {
+        return;
+    }
+
+    unsigned long long fileSize = [self benchmarkSizeFromEnvironmentVariable:@"AF_BENCHMARK_UPLOAD_SIZE_MB" defaultMegabytes:64];
+
+    // A sparse file keeps setup cheap while still exercising every page of the upload path
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    [[NSFileManager defaultManager] createFileAtPath:[fileURL path] contents:nil attributes:nil];
+    NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingToURL:fileURL error:nil];
+    [fileHandle truncateFileAtOffset:fileSize];
+    [fileHandle closeFile];
+
+    [AFTestURLProtocol setBuffersRequestBodies:NO];
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:204 headers:nil body:nil];
+    }];
+
+    AFURLSessionManager *manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    NSURL *url = [[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"upload"];
+    __block unsigned long long contentLength = 0;
+    __block NSUInteger numberOfUploads = 0;
+
+    // CPU time is that of the whole process, so it includes the stand-in server draining the request bodies
+    struct rusage startUsage;
+    getrusage(RUSAGE_SELF, &startUsage);
+
+    [self measureBlock:^{
+        NSMutableURLRequest *request = [[AFHTTPRequestSerializer serializer] multipartFormRequestWithMethod:@"POST" URLString:[url absoluteString] parameters:nil constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+            [formData appendPartWithFileURL:fileURL name:@"file" fileName:@"large.bin" mimeType:@"application/octet-stream" error:nil];
+        } error:nil];
+        contentLength = strtoull([[request valueForHTTPHeaderField:@"Content-Length"] UTF8String], NULL, 10);
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Upload should complete"];
+        NSURLSessionUploadTask *task = [manager uploadTaskWithStreamedRequest:request progress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        [task resume];
+        [self waitForExpectationsWithCommonTimeout];
+        numberOfUploads++;
+    }];
+
+    struct rusage endUsage;
+    getrusage(RUSAGE_SELF, &endUsage);
+    double CPUTime = (endUsage.ru_utime.tv_sec - startUsage.ru_utime.tv_sec) + (endUsage.ru_utime.tv_usec - startUsage.ru_utime.tv_usec) / 1e6 + (endUsage.ru_stime.tv_sec - startUsage.ru_stime.tv_sec) + (endUsage.ru_stime.tv_usec - startUsage.ru_stime.tv_usec) / 1e6;
+    [self recordBenchmarkValue:CPUTime / ((double)contentLength * numberOfUploads / 1e9) unit:@"CPU s/GB" name:@"Multipart file upload"];
+
+    XCTAssertEqual([AFTestURLProtocol numberOfRequestBodyBytesReceived], contentLength * numberOfUploads);
+
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+}
+
+- (void)testUploadOfUnknownLengthStreamsWithBoundedMemory {
+    NSUInteger chunkLength = 1024 * 64;
+    NSUInteger numberOfChunks = 512;
+
+    CFReadStreamRef readStream = NULL;
+    CFWriteStreamRef writeStream = NULL;
+    CFStreamCreateBoundPair(kCFAllocatorDefault, &readStream, &writeStream, chunkLength);
+    NSInputStream *inputStream = (__bridge_transfer NSInputStream *)readStream;
+    NSOutputStream *outputStream = (__bridge_transfer NSOutputStream *)writeStream;
+
+    [AFTestURLProtocol setBuffersRequestBodies:NO];
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        XCTAssertNil([request valueForHTTPHeaderField:@"Content-Length"]);
+        return [AFTestServerResponse responseWithStatusCode:204 headers:nil body:nil];
+    }];
+
+    AFURLSessionManager *manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    NSURL *url = [[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"upload"];
+    NSMutableURLRequest *request = [[AFHTTPRequestSerializer serializer] requestWithMethod:@"PUT" URLString:[url absoluteString] bodyStream:inputStream length:NSURLSessionTransferSizeUnknown mimeType:@"application/octet-stream" error:nil];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Upload should complete"];
+    NSURLSessionUploadTask *task = [manager uploadTaskWithStreamedRequest:request progress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+
+    // The producer blocks on the bound pair's fixed-size buffer, so no more than one chunk is ever held in memory
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        NSMutableData *chunk = [NSMutableData dataWithLength:chunkLength];
+        [outputStream open];
+        for (NSUInteger idx = 0; idx < numberOfChunks; idx++) {
+            NSUInteger offset = 0;
+            while (offset < chunkLength) {
+                NSInteger numberOfBytesWritten = [outputStream write:(const uint8_t *)[chunk bytes] + offset maxLength:chunkLength - offset];
+                if (numberOfBytesWritten <= 0) {
+                    break;
+                }
+                offset += (NSUInteger)numberOfBytesWritten;
+            }
+        }
+        [outputStream close];
+    });
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual([AFTestURLProtocol numberOfRequestBodyBytesReceived], (unsigned long long)chunkLength * numberOfChunks);
+
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+#pragma mark - Upload Throttling
+
+- (void)testThatThrottledUploadIsHeldToTargetRate {
+    NSUInteger bytesPerSecond = 1024 * 256;
+    NSData *data = [NSMutableData dataWithLength:bytesPerSecond * 2];
+
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:204 headers:nil body:nil];
+    }];
+
+    AFURLSessionManager *manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    manager.uploadBandwidthThrottle = [AFBandwidthThrottle throttleWithBytesPerSecond:bytesPerSecond];
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"upload"]];
+    request.HTTPMethod = @"POST";
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Upload should complete"];
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    NSURLSessionUploadTask *task = [manager uploadTaskWithRequest:request fromData:data progress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    // The initial burst is free, so the upload takes the remainder of the body at the target rate
+    CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - startTime;
+    NSTimeInterval expected = (double)([data length] - manager.uploadBandwidthThrottle.burstSize) / bytesPerSecond;
+    XCTAssertEqual([AFTestURLProtocol numberOfRequestBodyBytesReceived], (unsigned long long)[data length]);
+    XCTAssertTrue(elapsed >= expected * 0.9, @"%.2f s elapsed, expected %.2f s", elapsed, expected);
+    XCTAssertTrue(elapsed <= expected * 1.5 + 1.0, @"%.2f s elapsed, expected %.2f s", elapsed, expected);
+
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+- (void)testThatThrottledFileUploadProvidesNewBodyStream {
+    NSData *data = [@"throttled file upload" dataUsingEncoding:NSUTF8StringEncoding];
+    NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    [data writeToURL:fileURL atomically:YES];
+
+    AFURLSessionManager *manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    manager.uploadBandwidthThrottle = [AFBandwidthThrottle throttleWithBytesPerSecond:1024 * 1024];
+
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"upload"]];
+    request.HTTPMethod = @"POST";
+    NSURLSessionUploadTask *task = [manager uploadTaskWithRequest:request fromFile:fileURL progress:nil completionHandler:nil];
+
+    // As on a redirect or an authentication challenge, which require the body to be sent again
+    XCTestExpectation *expectation = [self expectationWithDescription:@"New body stream should be provided"];
+    [manager URLSession:manager.session task:task needNewBodyStream:^(NSInputStream *bodyStream) {
+        uint8_t buffer[1024];
+        [bodyStream open];
+        NSInteger numberOfBytesRead = [bodyStream read:buffer maxLength:sizeof(buffer)];
+        [bodyStream close];
+
+        XCTAssertEqualObjects([NSData dataWithBytes:buffer length:(NSUInteger)MAX(numberOfBytesRead, 0)], data);
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    [task cancel];
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    [[NSFileManager defaultManager] removeItemAtURL:fileURL error:nil];
+}
+
+- (void)testThatUploadsSharingThrottleShareItsRate {
+    NSUInteger bytesPerSecond = 1024 * 256;
+    NSData *data = [NSMutableData dataWithLength:bytesPerSecond];
+    AFBandwidthThrottle *throttle = [AFBandwidthThrottle throttleWithBytesPerSecond:bytesPerSecond];
+
+    [AFTestURLProtocol setBuffersRequestBodies:NO];
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        return [AFTestServerResponse responseWithStatusCode:204 headers:nil body:nil];
+    }];
+
+    AFURLSessionManager *manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    NSURL *url = [[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"upload"];
+
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+    for (NSUInteger idx = 0; idx < 2; idx++) {
+        NSMutableURLRequest *request = [[AFHTTPRequestSerializer serializer] multipartFormRequestWithMethod:@"POST" URLString:[url absoluteString] parameters:nil constructingBodyWithBlock:^(id<AFMultipartFormData>  _Nonnull formData) {
+            [formData appendPartWithFormData:data name:@"data"];
+            [formData throttleBandwidthWithThrottle:throttle];
+        } error:nil];
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Upload should complete"];
+        NSURLSessionUploadTask *task = [manager uploadTaskWithStreamedRequest:request progress:nil completionHandler:^(NSURLResponse * _Nonnull response, id  _Nullable responseObject, NSError * _Nullable error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        [task resume];
+    }
+    [self waitForExpectationsWithCommonTimeout];
+
+    // Each upload alone would take about a second; together they are held to the shared rate
+    CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - startTime;
+    NSTimeInterval expected = (double)(throttle.numberOfBytesRead - throttle.burstSize) / bytesPerSecond;
+    XCTAssertEqual(throttle.numberOfBytesRead, [AFTestURLProtocol numberOfRequestBodyBytesReceived]);
+    XCTAssertTrue(elapsed >= expected * 0.9, @"%.2f s elapsed, expected %.2f s", elapsed, expected);
+
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+#pragma mark - Resumable Downloads
+
+- (void)serveResourceWithData:(NSData *)data
+                         ETag:(NSString *)ETag
+          rangeRequestHandler:(void (^)(NSURLRequest *request))rangeRequestHandler
+{
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSString *range = [request valueForHTTPHeaderField:@"Range"];
+        AFTestServerResponse *response = nil;
+        if (range && [[request valueForHTTPHeaderField:@"If-Range"] isEqualToString:ETag]) {
+            rangeRequestHandler(request);
+
+            NSUInteger offset = (NSUInteger)[[range substringFromIndex:[@"bytes=" length]] integerValue];
+            NSDictionary *headers = @{@"ETag": ETag, @"Content-Type": @"application/octet-stream", @"Content-Range": [NSString stringWithFormat:@"bytes %lu-%lu/%lu", (unsigned long)offset, (unsigned long)[data length] - 1, (unsigned long)[data length]]};
+            response = [AFTestServerResponse responseWithStatusCode:206 headers:headers body:[data subdataWithRange:NSMakeRange(offset, [data length] - offset)]];
+        } else {
+            response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"ETag": ETag, @"Content-Type": @"application/octet-stream"} body:data];
+        }
+        [response setBytesPerSecond:1024 * 1024];
+
+        return response;
+    }];
+}
+
+- (AFURLSessionManager *)resumableDownloadManager {
+    AFURLSessionManager *manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+    manager.resumableDownloadsDirectoryURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:@"AFURLSessionManagerTests"] isDirectory:YES];
+
+    return manager;
+}
+
+- (void)interruptResumableDownloadWithRequest:(NSURLRequest *)request afterNumberOfBytes:(int64_t)numberOfBytes {
+    AFURLSessionManager *manager = [self resumableDownloadManager];
+    [manager removeResumableDownloadForRequest:request];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should be cancelled"];
+    __block NSURLSessionDataTask *task = [manager resumableDownloadTaskWithRequest:request progress:^(NSProgress * _Nonnull downloadProgress) {
+        if (downloadProgress.completedUnitCount >= numberOfBytes) {
+            [task cancel];
+        }
+    } destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        return targetPath;
+    } completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertEqual(error.code, NSURLErrorCancelled);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    // Discarding the manager stands in for the termination of the process
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+- (void)testThatInterruptedDownloadResumesWithRangeRequest {
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024];
+    SecRandomCopyBytes(kSecRandomDefault, [data length], [data mutableBytes]);
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"resource"]];
+
+    __block NSURLRequest *rangeRequest = nil;
+    [self serveResourceWithData:data ETag:@"\"v1\"" rangeRequestHandler:^(NSURLRequest *request) {
+        rangeRequest = request;
+    }];
+    [self interruptResumableDownloadWithRequest:request afterNumberOfBytes:1024 * 256];
+
+    AFURLSessionManager *manager = [self resumableDownloadManager];
+    NSURL *destinationURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    __block NSNumber *numberOfResumedBytes = nil;
+    [self expectationForNotification:AFNetworkingTaskDidCompleteNotification object:nil handler:^BOOL(NSNotification * _Nonnull notification) {
+        numberOfResumedBytes = notification.userInfo[AFNetworkingTaskDidCompleteResumedByteCountKey];
+        return YES;
+    }];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should complete"];
+    NSURLSessionDataTask *task = [manager resumableDownloadTaskWithRequest:request progress:nil destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        return destinationURL;
+    } completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(filePath, destinationURL);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects([rangeRequest valueForHTTPHeaderField:@"If-Range"], @"\"v1\"");
+    XCTAssertTrue([numberOfResumedBytes longLongValue] >= 1024 * 256);
+    XCTAssertEqual(task.countOfBytesReceived, (int64_t)[data length] - [numberOfResumedBytes longLongValue]);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:destinationURL], data);
+    XCTAssertEqual([[[NSFileManager defaultManager] contentsOfDirectoryAtPath:[manager.resumableDownloadsDirectoryURL path] error:nil] count], (NSUInteger)0);
+
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+- (void)testThatChangedResourceIsDownloadedFromTheStart {
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024];
+    SecRandomCopyBytes(kSecRandomDefault, [data length], [data mutableBytes]);
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"resource"]];
+
+    [self serveResourceWithData:data ETag:@"\"v1\"" rangeRequestHandler:^(NSURLRequest *request) {}];
+    [self interruptResumableDownloadWithRequest:request afterNumberOfBytes:1024 * 256];
+
+    NSMutableData *changedData = [NSMutableData dataWithLength:[data length]];
+    SecRandomCopyBytes(kSecRandomDefault, [changedData length], [changedData mutableBytes]);
+    [self serveResourceWithData:changedData ETag:@"\"v2\"" rangeRequestHandler:^(NSURLRequest *request) {
+        XCTFail(@"The partial file of another version of the resource should not be resumed");
+    }];
+
+    AFURLSessionManager *manager = [self resumableDownloadManager];
+    NSURL *destinationURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    __block NSNumber *numberOfResumedBytes = nil;
+    [self expectationForNotification:AFNetworkingTaskDidCompleteNotification object:nil handler:^BOOL(NSNotification * _Nonnull notification) {
+        numberOfResumedBytes = notification.userInfo[AFNetworkingTaskDidCompleteResumedByteCountKey];
+        return YES;
+    }];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should complete"];
+    NSURLSessionDataTask *task = [manager resumableDownloadTaskWithRequest:request progress:nil destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        return destinationURL;
+    } completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects(numberOfResumedBytes, @0);
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:destinationURL], changedData);
+
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+- (void)testThatMisalignedPartialContentFailsWithBadServerResponse {
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024];
+    SecRandomCopyBytes(kSecRandomDefault, [data length], [data mutableBytes]);
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"resource"]];
+
+    [self serveResourceWithData:data ETag:@"\"v1\"" rangeRequestHandler:^(NSURLRequest *request) {}];
+    [self interruptResumableDownloadWithRequest:request afterNumberOfBytes:1024 * 256];
+
+    // The server answers the range request with content that does not start where the partial file ends
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        if (![request valueForHTTPHeaderField:@"Range"]) {
+            return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"ETag": @"\"v1\"", @"Content-Type": @"application/octet-stream"} body:data];
+        }
+
+        NSDictionary *headers = @{@"ETag": @"\"v1\"", @"Content-Type": @"application/octet-stream", @"Content-Range": [NSString stringWithFormat:@"bytes 0-%lu/%lu", (unsigned long)[data length] - 1, (unsigned long)[data length]]};
+        return [AFTestServerResponse responseWithStatusCode:206 headers:headers body:data];
+    }];
+
+    AFURLSessionManager *manager = [self resumableDownloadManager];
+    NSURL *destinationURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    NSURL * (^destination)(NSURL *, NSURLResponse *) = ^NSURL *(NSURL *targetPath, NSURLResponse *response) {
+        return destinationURL;
+    };
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should fail"];
+    [[manager resumableDownloadTaskWithRequest:request progress:nil destination:destination completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertEqualObjects(error.domain, NSURLErrorDomain);
+        XCTAssertEqual(error.code, NSURLErrorBadServerResponse);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    // With the partial file removed, a new task downloads the resource from the start
+    expectation = [self expectationWithDescription:@"Download should complete"];
+    [[manager resumableDownloadTaskWithRequest:request progress:nil destination:destination completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:destinationURL], data);
+
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
+- (void)testThatUnsatisfiableRangeOfCompletePartialFileCompletesDownload {
+    NSMutableData *data = [NSMutableData dataWithLength:1024 * 1024];
+    SecRandomCopyBytes(kSecRandomDefault, [data length], [data mutableBytes]);
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"resource"]];
+
+    [self serveResourceWithData:data ETag:@"\"v1\"" rangeRequestHandler:^(NSURLRequest *request) {}];
+    [self interruptResumableDownloadWithRequest:request afterNumberOfBytes:1024 * 256];
+
+    // The server reports the partial file to already hold the whole representation
+    __block NSUInteger offset = 0;
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        NSString *range = [request valueForHTTPHeaderField:@"Range"];
+        if (!range) {
+            XCTFail(@"The complete partial file should not be downloaded again");
+            return [AFTestServerResponse responseWithStatusCode:200 headers:@{@"ETag": @"\"v1\"", @"Content-Type": @"application/octet-stream"} body:data];
+        }
+
+        offset = (NSUInteger)[[range substringFromIndex:[@"bytes=" length]] integerValue];
+        NSDictionary *headers = @{@"ETag": @"\"v1\"", @"Content-Type": @"text/plain", @"Content-Range": [NSString stringWithFormat:@"bytes */%lu", (unsigned long)offset]};
+        return [AFTestServerResponse responseWithStatusCode:416 headers:headers body:[@"Range Not Satisfiable" dataUsingEncoding:NSUTF8StringEncoding]];
+    }];
+
+    AFURLSessionManager *manager = [self resumableDownloadManager];
+    NSURL *destinationURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:[[NSUUID UUID] UUIDString]]];
+    __block NSNumber *numberOfResumedBytes = nil;
+    [self expectationForNotification:AFNetworkingTaskDidCompleteNotification object:nil handler:^BOOL(NSNotification * _Nonnull notification) {
+        numberOfResumedBytes = notification.userInfo[AFNetworkingTaskDidCompleteResumedByteCountKey];
+        return YES;
+    }];
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Download should complete"];
+    [[manager resumableDownloadTaskWithRequest:request progress:nil destination:^NSURL * _Nonnull(NSURL * _Nonnull targetPath, NSURLResponse * _Nonnull response) {
+        return destinationURL;
+    } completionHandler:^(NSURLResponse * _Nonnull response, NSURL * _Nullable filePath, NSError * _Nullable error) {
+        XCTAssertNil(error);
+        XCTAssertEqualObjects(filePath, destinationURL);
+        [expectation fulfill];
+    }] resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertTrue(offset >= 1024 * 256);
+    XCTAssertEqualObjects(numberOfResumedBytes, @(offset));
+    XCTAssertEqualObjects([NSData dataWithContentsOfURL:destinationURL], [data subdataWithRange:NSMakeRange(0, offset)]);
+    XCTAssertEqual([[[NSFileManager defaultManager] contentsOfDirectoryAtPath:[manager.resumableDownloadsDirectoryURL path] error:nil] count], (NSUInteger)0);
+
+    [[NSFileManager defaultManager] removeItemAtURL:destinationURL error:nil];
+    [manager invalidateSessionCancelingTasks:YES resetSession:NO];
+}
+
 #pragma mark - rdar://17029580
 
 - (void)testRDAR17029580IsFixed {
@@ -23,15 +23,27 @@
 
 #import "AFURLRequestSerialization.h"
 #import "AFURLResponseSerialization.h"
+#import "AFURLSessionManager.h"
 
 static NSData * AFXMLTestData() {
     return [@"<?xml version=\"1.0\" encoding=\"UTF-8\"?><foo attr1=\"1\" attr2=\"2\"><bar>someValue</bar></foo>" dataUsingEncoding:NSUTF8StringEncoding];
 }
 
+static NSData * AFXMLTestFeedData(NSUInteger numberOfEntries) {
+    NSMutableString *feed = [NSMutableString stringWithString:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<feed xmlns=\"http://www.w3.org/2005/Atom\">\n  <title>Releases</title>\n"];
+    for (NSUInteger idx = 0; idx < numberOfEntries; idx++) {
+        [feed appendFormat:@"  <entry>\n    <id>tag:github.com,2008:Repository/%lu</id>\n    <title>Release %lu &amp; notes</title>\n    <link rel=\"alternate\" href=\"https://github.com/AFNetworking/AFNetworking/releases/%lu\"/>\n    <content type=\"html\"><![CDATA[<p>Fixes &amp; improvements</p>]]></content>\n  </entry>\n", (unsigned long)idx, (unsigned long)idx, (unsigned long)idx];
+    }
+    [feed appendString:@"</feed>\n"];
+
+    return [feed dataUsingEncoding:NSUTF8StringEncoding];
+}
+
 #pragma mark -
 
 @interface AFXMLParserResponseSerializerTests : AFTestCase
 @property (nonatomic, strong) AFXMLParserResponseSerializer *responseSerializer;
+@property (nonatomic, strong) AFURLSessionManager *manager;
 @end
 
 #pragma mark -
@@ -41,6 +53,29 @@ static NSData * AFXMLTestData() {
 - (void)setUp {
     [super setUp];
     self.responseSerializer = [AFXMLParserResponseSerializer serializer];
+    self.manager = [[AFURLSessionManager alloc] initWithSessionConfiguration:[AFTestURLProtocol sessionConfiguration]];
+}
+
+- (void)tearDown {
+    [self.manager invalidateSessionCancelingTasks:YES resetSession:NO];
+    self.manager = nil;
+    [super tearDown];
+}
+
+- (NSError *)finishStream:(AFURLResponseStream *)stream withData:(NSData *)data chunkSize:(NSUInteger)chunkSize {
+    for (NSUInteger offset = 0; offset < [data length]; offset += chunkSize) {
+        [stream dataTask:nil didReceiveData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkSize, [data length] - offset))]];
+    }
+
+    __block NSError *streamError = nil;
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Stream should finish"];
+    [stream finishWithCompletionHandler:^(NSError *error) {
+        streamError = error;
+        [expectation fulfill];
+    }];
+    [self waitForExpectationsWithCommonTimeout];
+
+    return streamError;
 }
 
 - (void)testThatXMLParserResponseSerializerAcceptsApplicationXMLMimeType {
@@ -86,4 +121,153 @@ static NSData * AFXMLTestData() {
     XCTAssertEqual(copiedSerializer.acceptableContentTypes, self.responseSerializer.acceptableContentTypes);
 }
 
+#pragma mark - Streams
+
+- (void)testThatEventStreamReportsEventsAcrossChunks {
+    NSMutableArray <AFXMLEvent *> *events = [NSMutableArray array];
+    AFXMLEventStream *stream = [self.responseSerializer eventStreamWithQueue:nil eventHandler:^(NSArray <AFXMLEvent *> *batch) {
+        [events addObjectsFromArray:batch];
+    }];
+
+    XCTAssertNil([self finishStream:stream withData:AFXMLTestData() chunkSize:3]);
+
+    XCTAssertEqualObjects([events valueForKey:@"name"], (@[@"foo", @"bar", [NSNull null], @"bar", @"foo"]));
+    XCTAssertEqualObjects([events valueForKey:@"depth"], (@[@0, @1, @2, @1, @0]));
+    XCTAssertEqual(events[0].type, AFXMLEventTypeStartElement);
+    XCTAssertEqualObjects(events[0].attributes, (@{@"attr1": @"1", @"attr2": @"2"}));
+    XCTAssertEqual(events[2].type, AFXMLEventTypeText);
+    XCTAssertEqualObjects(events[2].text, @"someValue");
+    XCTAssertEqual(events[4].type, AFXMLEventTypeEndElement);
+    XCTAssertEqual(stream.numberOfEvents, (NSUInteger)5);
+}
+
+- (void)testThatElementStreamBuildsElementsAtPath {
+    NSData *data = [@"<feed><title>Feed</title><entry id=\"1\">One<author><name>Mattt</name></author><entry>nested</entry></entry><meta><entry/></meta><entry id=\"2\"/></feed>" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSMutableArray <AFXMLElement *> *elements = [NSMutableArray array];
+    NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+    AFXMLElementStream *stream = [self.responseSerializer elementStreamWithPath:@"feed/entry" queue:nil elementHandler:^(AFXMLElement *element, NSUInteger idx) {
+        [elements addObject:element];
+        [indexes addIndex:idx];
+    }];
+
+    XCTAssertNil([self finishStream:stream withData:data chunkSize:1]);
+
+    XCTAssertEqual([elements count], (NSUInteger)2);
+    XCTAssertEqualObjects(indexes, [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 2)]);
+    XCTAssertEqualObjects(elements[0].attributes, @{@"id": @"1"});
+    XCTAssertEqualObjects(elements[0].text, @"One");
+    XCTAssertEqualObjects([[elements[0] firstChildNamed:@"author"] firstChildNamed:@"name"].text, @"Mattt");
+    XCTAssertEqualObjects([elements[0] childrenNamed:@"entry"][0].text, @"nested");
+    XCTAssertEqualObjects(elements[1], [[AFXMLElement alloc] initWithName:@"entry" attributes:@{@"id": @"2"} children:nil text:nil]);
+    XCTAssertEqualObjects(stream.path, @"feed/entry");
+    XCTAssertEqual(stream.numberOfElements, (NSUInteger)2);
+}
+
+- (void)testThatWildcardMatchesAnyElementName {
+    NSData *data = [@"<root><a><item>1</item></a><b><item>2</item><other/></b></root>" dataUsingEncoding:NSUTF8StringEncoding];
+
+    NSMutableArray *texts = [NSMutableArray array];
+    AFXMLElementStream *stream = [self.responseSerializer elementStreamWithPath:@"*/*/item" queue:nil elementHandler:^(AFXMLElement *element, NSUInteger idx) {
+        [texts addObject:element.text];
+    }];
+
+    XCTAssertNil([self finishStream:stream withData:data chunkSize:4]);
+    XCTAssertEqualObjects(texts, (@[@"1", @"2"]));
+}
+
+- (void)testThatMalformedResponseFailsAfterDeliveringCompleteElements {
+    NSMutableArray *identifiers = [NSMutableArray array];
+    AFXMLElementStream *stream = [self.responseSerializer elementStreamWithPath:@"feed/entry" queue:nil elementHandler:^(AFXMLElement *element, NSUInteger idx) {
+        [identifiers addObject:element.attributes[@"id"]];
+    }];
+
+    NSError *error = [self finishStream:stream withData:[@"<feed><entry id=\"1\"/><entry id=\"2\"></feed>" dataUsingEncoding:NSUTF8StringEncoding] chunkSize:8];
+    XCTAssertEqualObjects(error.domain, AFURLResponseSerializationErrorDomain);
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+    XCTAssertEqual([error.userInfo[NSUnderlyingErrorKey] code], NSXMLParserTagNameMismatchError);
+    XCTAssertEqualObjects(identifiers, @[@"1"]);
+}
+
+- (void)testThatTruncatedResponseFails {
+    AFXMLEventStream *stream = [self.responseSerializer eventStreamWithQueue:nil eventHandler:^(NSArray <AFXMLEvent *> *events) {}];
+
+    NSError *error = [self finishStream:stream withData:[@"<feed><entry>" dataUsingEncoding:NSUTF8StringEncoding] chunkSize:64];
+    XCTAssertEqual(error.code, NSURLErrorCannotParseResponse);
+    XCTAssertEqual([error.userInfo[NSUnderlyingErrorKey] code], NSXMLParserPrematureDocumentEndError);
+}
+
+- (NSURLRequest *)requestServingFeedData:(NSData *)data {
+    [AFTestURLProtocol setRequestHandler:^AFTestServerResponse * _Nullable(NSURLRequest * _Nonnull request, NSData * _Nullable body) {
+        AFTestServerResponse *response = [AFTestServerResponse responseWithStatusCode:200 headers:@{@"Content-Type": @"application/atom+xml"} body:data];
+        [response setBytesPerSecond:8 * 1024 * 1024];
+        return response;
+    }];
+    self.responseSerializer.acceptableContentTypes = [NSSet setWithObject:@"application/atom+xml"];
+
+    return [NSURLRequest requestWithURL:[[AFTestURLProtocol baseURL] URLByAppendingPathComponent:@"releases.atom"]];
+}
+
+- (void)testThatFirstElementIsHandledBeforeResponseIsReceived {
+    NSData *data = AFXMLTestFeedData(10000);
+    NSURLRequest *request = [self requestServingFeedData:data];
+
+    __block NSURLSessionDataTask *task = nil;
+    __block int64_t numberOfBytesReceivedBeforeFirstElement = 0;
+    __block NSUInteger numberOfElements = 0;
+    AFXMLElementStream *stream = [self.responseSerializer elementStreamWithPath:@"feed/entry" queue:nil elementHandler:^(AFXMLElement *element, NSUInteger idx) {
+        if (idx == 0) {
+            numberOfBytesReceivedBeforeFirstElement = task.countOfBytesReceived;
+        }
+        numberOfElements++;
+    }];
+
+    XCTestExpectation *expectation = [self expectationWithDescription:@"Streaming task should complete"];
+    task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+        XCTAssertNil(error);
+        [expectation fulfill];
+    }];
+    [task resume];
+    [self waitForExpectationsWithCommonTimeout];
+
+    XCTAssertEqual(numberOfElements, (NSUInteger)10000);
+    XCTAssertTrue(numberOfBytesReceivedBeforeFirstElement < (int64_t)[data length]);
+}
+
+- (void)testPerformanceOfTimeToFirstStreamedElement {
+    NSURLRequest *request = [self requestServingFeedData:AFXMLTestFeedData(10000)];
+
+    // Elements are delivered on the main queue, which runs while the test waits, so measuring can stop at the first one
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^{
+        AFXMLElementStream *stream = [self.responseSerializer elementStreamWithPath:@"feed/entry" queue:nil elementHandler:^(AFXMLElement *element, NSUInteger idx) {
+            if (idx == 0) {
+                [self stopMeasuring];
+            }
+        }];
+
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Streaming task should complete"];
+        NSURLSessionDataTask *task = [self.manager dataTaskWithRequest:request responseStream:stream completionHandler:^(NSURLResponse *response, NSError *error) {
+            XCTAssertNil(error);
+            [expectation fulfill];
+        }];
+        [self startMeasuring];
+        [task resume];
+        [self waitForExpectationsWithCommonTimeout];
+    }];
+}
+
+- (void)testPerformanceOfBufferedParsing {
+    NSURLRequest *request = [self requestServingFeedData:AFXMLTestFeedData(10000)];
+    self.manager.responseSerializer = self.responseSerializer;
+
+    [self measureBlock:^{
+        XCTestExpectation *expectation = [self expectationWithDescription:@"Buffered task should complete"];
+        [[self.manager dataTaskWithRequest:request uploadProgress:nil downloadProgress:nil completionHandler:^(NSURLResponse *response, id responseObject, NSError *error) {
+            XCTAssertTrue([responseObject parse]);
+            [expectation fulfill];
+        }] resume];
+        [self waitForExpectationsWithCommonTimeout];
+    }];
+}
+
 @end
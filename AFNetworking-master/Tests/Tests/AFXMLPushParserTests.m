@@ -0,0 +1,236 @@
+// AFXMLPushParserTests.m
+// Copyright (c) 2011–2016 Alamofire Software Foundation ( http://alamofire.org/ )
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "AFTestCase.h"
+
+#import "AFXMLPushParser.h"
+
+@interface AFXMLPushParserTestDelegate : NSObject <AFXMLPushParserDelegate>
+@property (readwrite, nonatomic, strong) NSMutableArray <NSString *> *events;
+@property (readwrite, nonatomic, copy) NSString *abortingElementName;
+@end
+
+@implementation AFXMLPushParserTestDelegate
+
+- (instancetype)init {
+    self = [super init];
+    if (!self) {
+        return nil;
+    }
+
+    self.events = [NSMutableArray array];
+
+    return self;
+}
+
+- (void)parser:(AFXMLPushParser *)parser
+didStartElement:(NSString *)elementName
+    attributes:(NSDictionary <NSString *, NSString *> *)attributes
+{
+    NSMutableString *event = [NSMutableString stringWithFormat:@"<%@", elementName];
+    for (NSString *name in [[attributes allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        [event appendFormat:@" %@=%@", name, attributes[name]];
+    }
+    [event appendFormat:@" @%lu>", (unsigned long)parser.depth];
+    [self.events addObject:event];
+
+    if ([elementName isEqualToString:self.abortingElementName]) {
+        [parser abortParsing];
+    }
+}
+
+- (void)parser:(AFXMLPushParser *)parser
+ didEndElement:(NSString *)elementName
+{
+    [self.events addObject:[NSString stringWithFormat:@"</%@>", elementName]];
+}
+
+- (void)parser:(__unused AFXMLPushParser *)parser
+foundCharacters:(NSString *)string
+{
+    // Text may be reported in several calls, depending on how the data is split
+    NSString *lastEvent = [self.events lastObject];
+    if ([lastEvent hasPrefix:@"\""]) {
+        [self.events replaceObjectAtIndex:[self.events count] - 1 withObject:[[lastEvent substringToIndex:[lastEvent length] - 1] stringByAppendingFormat:@"%@\"", string]];
+    } else {
+        [self.events addObject:[NSString stringWithFormat:@"\"%@\"", string]];
+    }
+}
+
+@end
+
+#pragma mark -
+
+@interface AFXMLPushParserTests : AFTestCase
+@end
+
+@implementation AFXMLPushParserTests
+
+- (NSError *)errorParsingString:(NSString *)string
+                    chunkLength:(NSUInteger)chunkLength
+                         events:(NSArray <NSString *> * __autoreleasing *)events
+{
+    NSData *data = [string dataUsingEncoding:NSUTF8StringEncoding];
+    AFXMLPushParserTestDelegate *delegate = [[AFXMLPushParserTestDelegate alloc] init];
+    AFXMLPushParser *parser = [[AFXMLPushParser alloc] init];
+    parser.delegate = delegate;
+
+    NSError *error = nil;
+    BOOL parsed = YES;
+    for (NSUInteger offset = 0; offset < [data length] && parsed; offset += chunkLength) {
+        parsed = [parser parseData:[data subdataWithRange:NSMakeRange(offset, MIN(chunkLength, [data length] - offset))] error:&error];
+    }
+
+    if (parsed) {
+        [parser finishParsing:&error];
+    }
+
+    if (events) {
+        *events = delegate.events;
+    }
+
+    return error;
+}
+
+#pragma mark -
+
+- (void)testThatDocumentSplitAtEveryByteIsParsed {
+    NSString *document = @"\uFEFF<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE feed [<!ENTITY copy \"(c)\">]>\n"
+        "<!-- <entry> -->\n"
+        "<feed xmlns=\"http://www.w3.org/2005/Atom\" title='Tom &amp; Jerry'>"
+        "<entry id=\"1\"><title>Café &lt;&#233;&#x1F600;&gt; \U0001F600</title><link href=\"a\"/></entry>\r\n"
+        "<?processing instruction?><![CDATA[<raw> ]] & text]]>"
+        "</feed>\n<!-- trailing comment -->\n";
+    NSArray *expectedEvents = @[
+        @"<feed title=Tom & Jerry xmlns=http://www.w3.org/2005/Atom @0>",
+        @"<entry id=1 @1>", @"<title @2>", @"\"Café <é\U0001F600> \U0001F600\"", @"</title>", @"<link href=a @2>", @"</link>", @"</entry>",
+        @"\"\n<raw> ]] & text\"",
+        @"</feed>",
+    ];
+
+    NSUInteger length = [[document dataUsingEncoding:NSUTF8StringEncoding] length];
+    for (NSUInteger chunkLength = 1; chunkLength <= length; chunkLength++) {
+        NSArray *events = nil;
+        NSError *error = [self errorParsingString:document chunkLength:chunkLength events:&events];
+        XCTAssertNil(error, @"Split every %lu bytes", (unsigned long)chunkLength);
+        XCTAssertEqualObjects(events, expectedEvents, @"Split every %lu bytes", (unsigned long)chunkLength);
+    }
+}
+
+- (void)testThatMalformedDocumentsFailWithTheirErrorWhereverTheyAreSplit {
+    NSDictionary <NSString *, NSNumber *> *documents = @{
+        @"": @(NSXMLParserEmptyDocumentError),
+        @"<!-- comment -->": @(NSXMLParserEmptyDocumentError),
+        @"<a><b></a></b>": @(NSXMLParserTagNameMismatchError),
+        @"<a></a><b></b>": @(NSXMLParserExtraContentError),
+        @"text<a/>": @(NSXMLParserLTRequiredError),
+        @"</a>": @(NSXMLParserNotWellBalancedError),
+        @"<a><b>": @(NSXMLParserPrematureDocumentEndError),
+        @"<a><![CDATA[text</a>": @(NSXMLParserPrematureDocumentEndError),
+        @"<a>&nbsp;</a>": @(NSXMLParserUndeclaredEntityError),
+        @"<a>&amp</a>": @(NSXMLParserEntityNotFinishedError),
+        @"<a>&#0;</a>": @(NSXMLParserInvalidCharacterRefError),
+        @"<a b></a>": @(NSXMLParserAttributeHasNoValueError),
+        @"<a b=c></a>": @(NSXMLParserAttributeNotStartedError),
+        @"<a b='<'/>": @(NSXMLParserLessThanSymbolInAttributeError),
+        @"<?xml version='1.0' encoding='ISO-8859-1'?><a/>": @(NSXMLParserEncodingNotSupportedError),
+    };
+
+    [documents enumerateKeysAndObjectsUsingBlock:^(NSString *document, NSNumber *code, __unused BOOL *stop) {
+        NSUInteger length = MAX([[document dataUsingEncoding:NSUTF8StringEncoding] length], (NSUInteger)1);
+        for (NSUInteger chunkLength = 1; chunkLength <= length; chunkLength++) {
+            NSError *error = [self errorParsingString:document chunkLength:chunkLength events:nil];
+            XCTAssertEqualObjects(error.domain, NSXMLParserErrorDomain, @"%@", document);
+            XCTAssertEqual(error.code, [code integerValue], @"%@ split every %lu bytes", document, (unsigned long)chunkLength);
+        }
+    }];
+}
+
+- (void)testThatEventsBeforeAnErrorAreReported {
+    NSArray *events = nil;
+    NSError *error = [self errorParsingString:@"<a><b>text</b><c></a>" chunkLength:4 events:&events];
+
+    XCTAssertEqual(error.code, NSXMLParserTagNameMismatchError);
+    XCTAssertEqualObjects(events, (@[@"<a @0>", @"<b @1>", @"\"text\"", @"</b>", @"<c @1>"]));
+}
+
+- (void)testThatParserDoesNotParseAfterAnError {
+    AFXMLPushParser *parser = [[AFXMLPushParser alloc] init];
+
+    NSError *error = nil;
+    XCTAssertFalse([parser parseData:[@"<a></b>" dataUsingEncoding:NSUTF8StringEncoding] error:&error]);
+    XCTAssertEqual(error.code, NSXMLParserTagNameMismatchError);
+
+    error = nil;
+    XCTAssertFalse([parser parseData:[@"<c/>" dataUsingEncoding:NSUTF8StringEncoding] error:&error]);
+    XCTAssertFalse([parser finishParsing:nil]);
+    XCTAssertEqualObjects(error, parser.parserError);
+}
+
+- (void)testThatMarkupLongerThanMaximumTokenLengthFails {
+    NSString *value = [@"" stringByPaddingToLength:1000 withString:@"x" startingIndex:0];
+    NSData *data = [[NSString stringWithFormat:@"<a b=\"%@\"/>", value] dataUsingEncoding:NSUTF8StringEncoding];
+
+    AFXMLPushParser *parser = [[AFXMLPushParser alloc] init];
+    parser.maximumTokenLength = 100;
+
+    NSError *error = nil;
+    BOOL parsed = YES;
+    for (NSUInteger offset = 0; offset < [data length] && parsed; offset += 10) {
+        parsed = [parser parseData:[data subdataWithRange:NSMakeRange(offset, MIN((NSUInteger)10, [data length] - offset))] error:&error];
+    }
+
+    XCTAssertFalse(parsed);
+    XCTAssertEqual(error.code, NSXMLParserGTRequiredError);
+}
+
+- (void)testThatLongTextIsReportedAsItIsReceived {
+    AFXMLPushParserTestDelegate *delegate = [[AFXMLPushParserTestDelegate alloc] init];
+    AFXMLPushParser *parser = [[AFXMLPushParser alloc] init];
+    parser.maximumTokenLength = 100;
+    parser.delegate = delegate;
+
+    XCTAssertTrue([parser parseData:[@"<a>" dataUsingEncoding:NSUTF8StringEncoding] error:nil]);
+    for (NSUInteger idx = 0; idx < 100; idx++) {
+        XCTAssertTrue([parser parseData:[@"0123456789" dataUsingEncoding:NSUTF8StringEncoding] error:nil]);
+    }
+    XCTAssertEqual([[delegate.events lastObject] length], (NSUInteger)1002);
+
+    XCTAssertTrue([parser parseData:[@"</a>" dataUsingEncoding:NSUTF8StringEncoding] error:nil]);
+    XCTAssertTrue([parser finishParsing:nil]);
+    XCTAssertEqualObjects([delegate.events lastObject], @"</a>");
+}
+
+- (void)testThatAbortingParsingStopsTheParser {
+    AFXMLPushParserTestDelegate *delegate = [[AFXMLPushParserTestDelegate alloc] init];
+    delegate.abortingElementName = @"b";
+
+    AFXMLPushParser *parser = [[AFXMLPushParser alloc] init];
+    parser.delegate = delegate;
+
+    NSError *error = nil;
+    XCTAssertFalse([parser parseData:[@"<a><b/><c/></a>" dataUsingEncoding:NSUTF8StringEncoding] error:&error]);
+    XCTAssertEqual(error.code, NSXMLParserDelegateAbortedParseError);
+    XCTAssertEqualObjects(delegate.events, (@[@"<a @0>", @"<b @1>"]));
+}
+
+@end
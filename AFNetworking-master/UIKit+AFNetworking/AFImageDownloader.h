@@ -69,6 +69,11 @@ typedef NS_ENUM(NSInteger, AFImageDownloadPrioritization) {
  */
 @property (nonatomic, assign) AFImageDownloadPrioritization downloadPrioritizaton;
 
+/**
+ The coalescer the success and failure blocks of downloads are delivered by, so that the blocks of many downloads finishing together run in a few batches on the main queue rather than in one dispatch each. Only a coalescer delivering on the main queue is used. `nil` by default, in which case each block is dispatched to the main queue.
+ */
+@property (nonatomic, strong, nullable) AFCompletionCoalescer *completionCoalescer;
+
 /**
  The shared default instance of `AFImageDownloader` initialized with default values.
  */
@@ -206,9 +206,9 @@
         if (URLIdentifier == nil) {
             if (failure) {
                 NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorBadURL userInfo:nil];
-                dispatch_async(dispatch_get_main_queue(), ^{
+                [self deliverResponseHandlerBlock:^{
                     failure(request, nil, error);
-                });
+                }];
             }
             return;
         }
@@ -230,9 +230,9 @@
                 UIImage *cachedImage = [self.imageCache imageforRequest:request withAdditionalIdentifier:nil];
                 if (cachedImage != nil) {
                     if (success) {
-                        dispatch_async(dispatch_get_main_queue(), ^{
+                        [self deliverResponseHandlerBlock:^{
                             success(request, nil, cachedImage);
-                        });
+                        }];
                     }
                     return;
                 }
@@ -260,9 +260,9 @@
                                    if (error) {
                                        for (AFImageDownloaderResponseHandler *handler in mergedTask.responseHandlers) {
                                            if (handler.failureBlock) {
-                                               dispatch_async(dispatch_get_main_queue(), ^{
+                                               [strongSelf deliverResponseHandlerBlock:^{
                                                    handler.failureBlock(request, (NSHTTPURLResponse *)response, error);
-                                               });
+                                               }];
                                            }
                                        }
                                    } else {
@@ -272,9 +272,9 @@
 
                                        for (AFImageDownloaderResponseHandler *handler in mergedTask.responseHandlers) {
                                            if (handler.successBlock) {
-                                               dispatch_async(dispatch_get_main_queue(), ^{
+                                               [strongSelf deliverResponseHandlerBlock:^{
                                                    handler.successBlock(request, (NSHTTPURLResponse *)response, responseObject);
-                                               });
+                                               }];
                                            }
                                        }
                                        
@@ -327,9 +327,9 @@
             NSDictionary *userInfo = @{NSLocalizedFailureReasonErrorKey:failureReason};
             NSError *error = [NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorCancelled userInfo:userInfo];
             if (handler.failureBlock) {
-                dispatch_async(dispatch_get_main_queue(), ^{
+                [self deliverResponseHandlerBlock:^{
                     handler.failureBlock(imageDownloadReceipt.task.originalRequest, nil, error);
-                });
+                }];
             }
         }
 
@@ -340,6 +340,15 @@
     });
 }
 
+- (void)deliverResponseHandlerBlock:(dispatch_block_t)block {
+    AFCompletionCoalescer *coalescer = self.completionCoalescer;
+    if (coalescer.queue == dispatch_get_main_queue()) {
+        [coalescer enqueueBlock:block];
+    } else {
+        dispatch_async(dispatch_get_main_queue(), block);
+    }
+}
+
 - (AFImageDownloaderMergedTask *)safelyRemoveMergedTaskWithURLIdentifier:(NSString *)URLIdentifier {
     __block AFImageDownloaderMergedTask *mergedTask = nil;
     dispatch_sync(self.synchronizationQueue, ^{